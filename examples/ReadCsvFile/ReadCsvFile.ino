@@ -86,8 +86,9 @@ bool parseLine(char* str) {
   str = strtok(nullptr, ",");
   if (!str) return false;
   
-  // Convert string to double.
-  double d = strtod(str, &ptr);
+  // Convert string to double.  scanDouble() is correctly rounded and
+  // faster than strtod().
+  double d = scanDouble(str, &ptr);
   if (str == ptr || *skipSpace(ptr)) return false;
   Serial.println(d);
   
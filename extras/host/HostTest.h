@@ -0,0 +1,45 @@
+// Helpers shared by the host test and benchmark programs.
+#ifndef HostTest_h
+#define HostTest_h
+#include <stdio.h>
+#include <stdlib.h>
+#include "FsVolume.h"
+#include "FsFile.h"
+#include "HostDevice/HostDevice.h"
+//------------------------------------------------------------------------------
+/** Exit with a message if x is false. */
+#define CHECK(x) do {\
+  if (!(x)) {\
+    printf("FAIL %s:%d %s\n", __FILE__, __LINE__, #x);\
+    exit(1);\
+  }\
+} while (0)
+//------------------------------------------------------------------------------
+/** Volume types for formatRam(). */
+enum HostFsType {HOST_FAT16, HOST_FAT32, HOST_EXFAT};
+//------------------------------------------------------------------------------
+/** Name of a HostFsType. */
+inline const char* fsTypeName(HostFsType type) {
+  return type == HOST_FAT16 ? "FAT16" : type == HOST_FAT32 ? "FAT32" : "exFAT";
+}
+//------------------------------------------------------------------------------
+/** Sector count used by formatRam() for each HostFsType. */
+inline uint32_t fsTypeSectors(HostFsType type) {
+  return type == HOST_FAT16 ? 60000 : type == HOST_FAT32 ? 0X500000 : 0X100000;
+}
+//------------------------------------------------------------------------------
+/** Allocate and format a RAM device. Statistics are cleared on return. */
+inline void formatRam(RamBlockDevice* dev, HostFsType type,
+                      uint32_t sectorCount = 0) {
+  static uint8_t secBuf[512];
+  CHECK(dev->begin(sectorCount ? sectorCount : fsTypeSectors(type)));
+  if (type == HOST_EXFAT) {
+    ExFatFormatter fmt;
+    CHECK(fmt.format(dev, secBuf));
+  } else {
+    FatFormatter fmt;
+    CHECK(fmt.format(dev, secBuf));
+  }
+  dev->clearStats();
+}
+#endif  // HostTest_h
@@ -0,0 +1,65 @@
+// Large writes and reads of a contiguous file and of a file fragmented
+// into single clusters on FAT16, FAT32 and exFAT RAM images.  Transfers
+// of the fragmented file stop at each cluster, as all transfers did
+// before clusterRun().
+//
+// Usage: ClusterRunBench [KiB] [bufferSize]
+#include <string.h>
+#include <vector>
+#include "HostTest.h"
+//------------------------------------------------------------------------------
+static void report(HostFsType type, const char* label, RamBlockDevice* dev) {
+  printf("%s %-12s write calls %5u read calls %5u\n", fsTypeName(type),
+         label, (unsigned)dev->writeCalls(), (unsigned)dev->readCalls());
+}
+//------------------------------------------------------------------------------
+int main(int argc, char** argv) {
+  uint32_t kib = argc > 1 ? atoi(argv[1]) : 1024;
+  size_t bufSize = argc > 2 ? atoi(argv[2]) : 64*1024;
+  // Also used for single cluster writes of up to 128 KiB.
+  std::vector<uint8_t> buf(bufSize > 128*1024 ? bufSize : 128*1024);
+  HostFsType types[] = {HOST_FAT16, HOST_FAT32, HOST_EXFAT};
+  printf("%u KiB, %u byte buffer\n", (unsigned)kib, (unsigned)bufSize);
+  for (HostFsType type : types) {
+    RamBlockDevice dev;
+    FsVolume vol;
+    FsFile file;
+    FsFile other;
+    uint64_t size = 1024ULL*kib;
+    formatRam(&dev, type);
+    CHECK(vol.begin(&dev));
+    uint32_t bpc = 512*vol.sectorsPerCluster();
+    // Fragment the file with a cluster of another file after each cluster.
+    CHECK(file.open(&vol, "fragmented", O_RDWR | O_CREAT));
+    CHECK(other.open(&vol, "other", O_RDWR | O_CREAT));
+    for (uint64_t n = 0; n < size; n += bpc) {
+      CHECK(file.write(buf.data(), bpc) == bpc);
+      CHECK(other.write(buf.data(), bpc) == bpc);
+    }
+    CHECK(other.close());
+    file.rewind();
+    dev.clearStats();
+    for (uint64_t n = 0; n < size; n += bufSize) {
+      CHECK(file.write(buf.data(), bufSize) == bufSize);
+    }
+    file.rewind();
+    for (uint64_t n = 0; n < size; n += bufSize) {
+      CHECK(file.read(buf.data(), bufSize) == (int)bufSize);
+    }
+    report(type, "fragmented", &dev);
+    CHECK(file.close());
+
+    CHECK(file.open(&vol, "contiguous", O_RDWR | O_CREAT));
+    dev.clearStats();
+    for (uint64_t n = 0; n < size; n += bufSize) {
+      CHECK(file.write(buf.data(), bufSize) == bufSize);
+    }
+    file.rewind();
+    for (uint64_t n = 0; n < size; n += bufSize) {
+      CHECK(file.read(buf.data(), bufSize) == (int)bufSize);
+    }
+    report(type, "contiguous", &dev);
+    CHECK(file.close());
+  }
+  return 0;
+}
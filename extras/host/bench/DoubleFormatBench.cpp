@@ -0,0 +1,59 @@
+// Double formatting speed of ostream, fmtDouble() and fmtShortest()
+// compared with snprintf.
+//
+// Usage: DoubleFormatBench [count]
+#include <time.h>
+#include "HostTest.h"
+#include "iostream/bufstream.h"
+#include "common/FmtNumber.h"
+//------------------------------------------------------------------------------
+static void report(const char* label, clock_t start, long count,  // NOLINT
+                   uint32_t check) {
+  double ns = 1e9*(clock() - start)/CLOCKS_PER_SEC/count;
+  printf("%-22s %6.1f ns/value (%u)\n", label, ns, (unsigned)check);
+}
+//------------------------------------------------------------------------------
+int main(int argc, char** argv) {
+  long count = argc > 1 ? atol(argv[1]) : 2000000;  // NOLINT
+  char buf[80];
+  char* end = buf + FMT_DOUBLE_SIZE;
+  uint32_t check = 0;
+  clock_t start = clock();
+  for (long i = 0; i < count; i++) {  // NOLINT
+    obufstream ob(buf, sizeof(buf));
+    ob << i*0.01;
+    check += buf[1];
+  }
+  report("ostream << double", start, count, check);
+  start = clock();
+  for (long i = 0; i < count; i++) {  // NOLINT
+    check += *fmtDouble(end, i*0.01, 2, false);
+  }
+  report("fmtDouble %.2f", start, count, check);
+  start = clock();
+  for (long i = 0; i < count; i++) {  // NOLINT
+    check += snprintf(buf, sizeof(buf), "%.2f", i*0.01);
+  }
+  report("snprintf %.2f", start, count, check);
+  start = clock();
+  for (long i = 0; i < count; i++) {  // NOLINT
+    check += *fmtDouble(end, i*0.37 - 1234.5, 6, false, 'e');
+  }
+  report("fmtDouble %.6e", start, count, check);
+  start = clock();
+  for (long i = 0; i < count; i++) {  // NOLINT
+    check += snprintf(buf, sizeof(buf), "%.6e", i*0.37 - 1234.5);
+  }
+  report("snprintf %.6e", start, count, check);
+  start = clock();
+  for (long i = 0; i < count; i++) {  // NOLINT
+    check += *fmtShortest(end, i*0.37 - 1234.5, false);
+  }
+  report("fmtShortest", start, count, check);
+  start = clock();
+  for (long i = 0; i < count; i++) {  // NOLINT
+    check += snprintf(buf, sizeof(buf), "%.17g", i*0.37 - 1234.5);
+  }
+  report("snprintf %.17g", start, count, check);
+  return 0;
+}
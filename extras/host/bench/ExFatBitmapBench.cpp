@@ -0,0 +1,185 @@
+// exFAT freeClusterCount() and contiguous allocation on a synthetic
+// 256 GB volume compared with the bit at a time loops they replaced.
+// The volume is kept in a sparse device since only the FAT, bitmap and
+// directories are written.
+//
+// Usage: ExFatBitmapBench [percentAllocated]
+#include <string.h>
+#include <time.h>
+#include <unordered_map>
+#include <vector>
+#include "HostTest.h"
+
+static uint64_t seed = 88172645463325252ULL;
+//------------------------------------------------------------------------------
+static uint64_t rnd() {
+  seed ^= seed << 13;
+  seed ^= seed >> 7;
+  seed ^= seed << 17;
+  return seed;
+}
+//------------------------------------------------------------------------------
+// Device that only stores sectors that have been written.
+class SparseBlockDevice : public HostBlockDevice {
+ public:
+  explicit SparseBlockDevice(uint32_t sectorCount) {
+    m_sectorCount = sectorCount;
+  }
+
+ protected:
+  bool devRead(uint32_t sector, uint8_t* dst, size_t ns) {
+    for (; ns; ns--, sector++, dst += HOST_SECTOR_SIZE) {
+      auto it = m_map.find(sector);
+      if (it == m_map.end()) {
+        memset(dst, 0, HOST_SECTOR_SIZE);
+      } else {
+        memcpy(dst, it->second.data(), HOST_SECTOR_SIZE);
+      }
+    }
+    return true;
+  }
+  bool devSync() {return true;}
+  bool devWrite(uint32_t sector, const uint8_t* src, size_t ns) {
+    for (; ns; ns--, sector++, src += HOST_SECTOR_SIZE) {
+      m_map[sector].assign(src, src + HOST_SECTOR_SIZE);
+    }
+    return true;
+  }
+
+ private:
+  std::unordered_map<uint32_t, std::vector<uint8_t>> m_map;
+};
+//------------------------------------------------------------------------------
+// freeClusterCount() as it was, a sector and a bit at a time.
+static uint32_t refFreeCount(HostBlockDevice* dev, ExFatVolume* vol) {
+  uint8_t buf[512];
+  uint32_t nc = 0;
+  uint32_t used = 0;
+  uint32_t sector = vol->clusterHeapStartSector();
+  while (true) {
+    CHECK(dev->readSector(sector++, buf));
+    for (size_t i = 0; i < sizeof(buf); i++) {
+      if (buf[i] == 0XFF) {
+        used += 8;
+      } else if (buf[i]) {
+        for (uint8_t mask = 1; mask; mask <<= 1) {
+          if (mask & buf[i]) {
+            used++;
+          }
+        }
+      }
+      nc += 8;
+      if (nc >= vol->clusterCount()) {
+        return vol->clusterCount() - used;
+      }
+    }
+  }
+}
+//------------------------------------------------------------------------------
+// bitmapFind(0, count) as it was, a sector and a bit at a time.
+static uint32_t refFind(HostBlockDevice* dev, ExFatVolume* vol,
+                        uint32_t start, uint32_t count) {
+  uint8_t buf[512];
+  uint32_t endAlloc = start;
+  uint32_t bgnAlloc = start;
+  size_t i = (start >> 3) & 511;
+  uint8_t mask = 1 << (start & 7);
+  while (true) {
+    CHECK(dev->readSector(vol->clusterHeapStartSector() + (endAlloc >> 12),
+                          buf));
+    for (; i < sizeof(buf); i++) {
+      for (; mask; mask <<= 1) {
+        endAlloc++;
+        if (!(mask & buf[i])) {
+          if ((endAlloc - bgnAlloc) == count) {
+            return bgnAlloc + 2;
+          }
+        } else {
+          bgnAlloc = endAlloc;
+        }
+        if (endAlloc == start) {
+          return 1;
+        }
+        if (endAlloc >= vol->clusterCount()) {
+          endAlloc = bgnAlloc = 0;
+          i = sizeof(buf);
+          break;
+        }
+      }
+      mask = 1;
+    }
+    i = 0;
+  }
+}
+//------------------------------------------------------------------------------
+static void report(const char* label, clock_t start, int n, uint32_t rtn) {
+  double us = 1e6*(clock() - start)/CLOCKS_PER_SEC/n;
+  printf("%-28s %8.0f us (%u)\n", label, us, (unsigned)rtn);
+}
+//------------------------------------------------------------------------------
+int main(int argc, char** argv) {
+  uint32_t percent = argc > 1 ? atoi(argv[1]) : 60;
+  const int N = 20;
+  static uint8_t buf[16*1024];
+  static uint8_t secBuf[512];
+  SparseBlockDevice dev(0X20000000);
+  ExFatFormatter fmt;
+  ExFatVolume vol;
+  ExFatFile file;
+  CHECK(fmt.format(&dev, secBuf));
+  CHECK(vol.begin(&dev));
+  uint32_t nc = vol.clusterCount();
+  uint32_t sys = vol.rootDirectoryCluster() - 1;
+  // Random allocation with a single run of 64 free clusters at the end.
+  std::vector<uint8_t> bm(((nc + 4095)/4096)*512, 0);
+  for (uint32_t i = 0; i < nc; i++) {
+    bool used = i < sys || rnd() % 100 < percent || i % 64 == 63;
+    if (used && i < nc - 64) {
+      bm[i/8] |= 1 << (i%8);
+    }
+  }
+  for (size_t i = 0; i < bm.size()/512; i++) {
+    CHECK(dev.writeSector(vol.clusterHeapStartSector() + i, &bm[512*i]));
+  }
+  CHECK(vol.begin(&dev));
+  printf("%u clusters, %u%% allocated\n", (unsigned)nc, (unsigned)percent);
+
+  clock_t start = clock();
+  uint32_t rtn = 0;
+  for (int i = 0; i < N; i++) {
+    rtn = refFreeCount(&dev, &vol);
+  }
+  report("freeClusterCount old", start, N, rtn);
+  start = clock();
+  for (int i = 0; i < N; i++) {
+    rtn = vol.freeClusterCount();
+  }
+  report("freeClusterCount", start, N, rtn);
+  start = clock();
+  for (int i = 0; i < N; i++) {
+    rtn = vol.freeClusterCount(buf, sizeof(buf));
+  }
+  report("freeClusterCount 16 KiB buf", start, N, rtn);
+
+  // The first free cluster is the search start for bitmapFind(0, 64).
+  uint32_t first = refFind(&dev, &vol, 0, 1) - 2;
+  start = clock();
+  for (int i = 0; i < N; i++) {
+    rtn = refFind(&dev, &vol, first, 64);
+  }
+  report("find 64 clusters old", start, N, rtn);
+  CHECK(rtn == nc - 64 + 2);
+  start = clock();
+  for (int i = 0; i < N; i++) {
+    CHECK(file.open(&vol, "run.bin", O_RDWR | O_CREAT | O_EXCL));
+    CHECK(file.preAllocate(64ULL*vol.bytesPerCluster()));
+    CHECK(file.remove());
+  }
+  report("preAllocate 64 clusters", start, N, rtn);
+  // The run at the end must have been used.
+  CHECK(file.open(&vol, "run.bin", O_RDWR | O_CREAT | O_EXCL));
+  CHECK(file.preAllocate(64ULL*vol.bytesPerCluster()));
+  CHECK(file.close());
+  CHECK(refFind(&dev, &vol, first, 64) == 1);
+  return 0;
+}
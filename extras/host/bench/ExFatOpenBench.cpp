@@ -0,0 +1,106 @@
+// exFAT open by name in a large directory compared with the lookup used
+// before openRootFile() scanned sectors in place.  The old lookup read
+// one 32 byte entry at a time with ExFatFile::read().
+//
+// Usage: ExFatOpenBench [files]
+#include <string.h>
+#include <time.h>
+#include <string>
+#include "HostTest.h"
+#include "ExFatLib/upcase.h"
+//------------------------------------------------------------------------------
+static std::string fileName(int i) {
+  return "Log file " + std::to_string(i) + " with a long descriptive name.csv";
+}
+//------------------------------------------------------------------------------
+// Find name as openRootFile() did before the sector scan.
+static bool refFind(ExFatFile* dir, const char* name) {
+  DirName_t* dirName;
+  DirStream_t* dirStream;
+  uint8_t buf[32];
+  size_t len = strlen(name);
+  uint16_t hash = exFatHashName(name, len, 0);
+  size_t nameOffset = 0;
+  bool inSet = false;
+  dir->rewind();
+  while (dir->read(buf, 32) == 32) {
+    if (buf[0] == 0) {
+      break;
+    }
+    if (!(buf[0] & 0x80)) {
+      inSet = false;
+    } else if (buf[0] == EXFAT_TYPE_FILE) {
+      inSet = true;
+    } else if (inSet && buf[0] == EXFAT_TYPE_STREAM) {
+      dirStream = reinterpret_cast<DirStream_t*>(buf);
+      inSet = dirStream->nameLength == len &&
+              getLe16(dirStream->nameHash) == hash;
+      nameOffset = 0;
+    } else if (inSet && buf[0] == EXFAT_TYPE_NAME) {
+      dirName = reinterpret_cast<DirName_t*>(buf);
+      size_t n = len - nameOffset < 15 ? len - nameOffset : 15;
+      if (!exFatCmpName(dirName, name, nameOffset, n)) {
+        inSet = false;
+      } else if ((nameOffset += n) == len) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+//------------------------------------------------------------------------------
+static void report(const char* label, clock_t start, int count,
+                   RamBlockDevice* dev) {
+  double us = 1e6*(clock() - start)/CLOCKS_PER_SEC/count;
+  printf("%-22s %8.1f us/open %8.1f sectors/open\n",
+         label, us, (double)dev->sectorsRead()/count);
+}
+//------------------------------------------------------------------------------
+int main(int argc, char** argv) {
+  int count = argc > 1 ? atoi(argv[1]) : 3000;
+  RamBlockDevice dev;
+  ExFatVolume vol;
+  ExFatFile dir;
+  ExFatFile file;
+  formatRam(&dev, HOST_EXFAT);
+  CHECK(vol.begin(&dev));
+  CHECK(vol.mkdir("dir"));
+  CHECK(dir.open(&vol, "dir", O_RDONLY));
+  clock_t start = clock();
+  for (int i = 0; i < count; i++) {
+    CHECK(file.open(&dir, fileName(i).c_str(), O_RDWR | O_CREAT | O_EXCL));
+    CHECK(file.close());
+  }
+  printf("%d files, directory %u KB\n", count,
+         (unsigned)(dir.fileSize()/1024));
+  report("create", start, count, &dev);
+
+  // Open a sample spread over the directory.
+  int n = count < 300 ? count : 300;
+  dev.clearStats();
+  start = clock();
+  for (int i = 0; i < n; i++) {
+    CHECK(file.open(&dir, fileName(i*count/n).c_str(), O_RDONLY));
+    CHECK(file.close());
+  }
+  report("open", start, n, &dev);
+  dev.clearStats();
+  start = clock();
+  for (int i = 0; i < n; i++) {
+    CHECK(refFind(&dir, fileName(i*count/n).c_str()));
+  }
+  report("old lookup", start, n, &dev);
+  dev.clearStats();
+  start = clock();
+  for (int i = 0; i < n; i++) {
+    CHECK(!file.open(&dir, fileName(count + i).c_str(), O_RDONLY));
+  }
+  report("open missing", start, n, &dev);
+  dev.clearStats();
+  start = clock();
+  for (int i = 0; i < n; i++) {
+    CHECK(!refFind(&dir, fileName(count + i).c_str()));
+  }
+  report("old lookup missing", start, n, &dev);
+  return 0;
+}
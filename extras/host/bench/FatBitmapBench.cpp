@@ -0,0 +1,62 @@
+// preAllocate() on a nearly full FAT32 volume with and without a RAM
+// allocation bitmap.  Reports the time to build the bitmap and the time
+// and sectors read for each preAllocate().
+//
+// Usage: FatBitmapBench [freeEvery]
+#include <string.h>
+#include <time.h>
+#include <vector>
+#include "HostTest.h"
+//------------------------------------------------------------------------------
+static void report(const char* label, clock_t start, int n,
+                   RamBlockDevice* dev) {
+  double us = 1e6*(clock() - start)/CLOCKS_PER_SEC/n;
+  printf("%-28s %8.0f us %8u sectors read\n", label, us,
+         (unsigned)(dev->sectorsRead()/n));
+}
+//------------------------------------------------------------------------------
+static void bench(RamBlockDevice* dev, bool useBitmap) {
+  const int N = 20;
+  const uint32_t RUN = 40;
+  FatVolume vol;
+  FatFile file;
+  CHECK(vol.begin(dev));
+  std::vector<uint32_t> bitmap(vol.allocationBitmapWords());
+  printf("%s\n", useBitmap ? "with bitmap" : "without bitmap");
+  if (useBitmap) {
+    dev->clearStats();
+    clock_t start = clock();
+    CHECK(vol.setAllocationBitmap(bitmap.data(), bitmap.size()));
+    report("build bitmap", start, 1, dev);
+  }
+  dev->clearStats();
+  clock_t start = clock();
+  for (int i = 0; i < N; i++) {
+    CHECK(file.open(&vol, "run.bin", O_RDWR | O_CREAT | O_EXCL));
+    CHECK(file.preAllocate(RUN*vol.bytesPerCluster()));
+    CHECK(file.remove());
+  }
+  report("preAllocate 40 clusters", start, N, dev);
+}
+//------------------------------------------------------------------------------
+int main(int argc, char** argv) {
+  uint32_t freeEvery = argc > 1 ? atoi(argv[1]) : 37;
+  RamBlockDevice dev;
+  FatVolume vol;
+  formatRam(&dev, HOST_FAT32);
+  CHECK(vol.begin(&dev));
+  CHECK(vol.fatType() == 32);
+  // Mark all clusters after the root directory as end of chain except
+  // single free clusters and one run of 64 clusters at the end.
+  uint32_t nc = vol.clusterCount();
+  uint8_t* fat = dev.data() + 512*vol.fatStartSector();
+  for (uint32_t c = 3; c < nc + 2; c++) {
+    if (c % freeEvery && c < nc + 2 - 64) {
+      setLe32(fat + 4*c, 0X0FFFFFFF);
+    }
+  }
+  printf("%u clusters, one free of %u\n", (unsigned)nc, (unsigned)freeEvery);
+  bench(&dev, false);
+  bench(&dev, true);
+  return 0;
+}
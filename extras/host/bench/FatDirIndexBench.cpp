@@ -0,0 +1,55 @@
+// Creates and opens in one large FAT32 directory with and without a
+// FatDirIndex.  Reports time and sectors read.
+//
+// Usage: FatDirIndexBench [files]
+#include <time.h>
+#include <string>
+#include "HostTest.h"
+//------------------------------------------------------------------------------
+static std::string fileName(int i) {
+  return "Data log " + std::to_string(i) + " long name.csv";
+}
+//------------------------------------------------------------------------------
+static void report(const char* label, clock_t start, int n,
+                   RamBlockDevice* dev) {
+  double ms = 1000.0*(clock() - start)/CLOCKS_PER_SEC;
+  printf("%-24s %5d %8.1f ms %8u sectors read\n",
+         label, n, ms, (unsigned)dev->sectorsRead());
+}
+//------------------------------------------------------------------------------
+static void bench(int count, FatDirIndex* index) {
+  RamBlockDevice dev;
+  FatVolume vol;
+  FatFile dir;
+  FatFile file;
+  formatRam(&dev, HOST_FAT32);
+  CHECK(vol.begin(&dev));
+  vol.setDirIndex(index);
+  CHECK(vol.mkdir("dir"));
+  CHECK(dir.open(&vol, "dir", O_RDONLY));
+  const char* label = index ? "with index" : "without index";
+  printf("%s\n", label);
+  dev.clearStats();
+  clock_t start = clock();
+  for (int i = 0; i < count; i++) {
+    CHECK(file.open(&dir, fileName(i).c_str(), O_RDWR | O_CREAT | O_EXCL));
+    CHECK(file.close());
+  }
+  report("create", start, count, &dev);
+  int n = count/3;
+  dev.clearStats();
+  start = clock();
+  for (int i = 0; i < n; i++) {
+    CHECK(file.open(&dir, fileName((i*7919) % count).c_str(), O_RDONLY));
+    CHECK(file.close());
+  }
+  report("open", start, n, &dev);
+}
+//------------------------------------------------------------------------------
+int main(int argc, char** argv) {
+  int count = argc > 1 ? atoi(argv[1]) : 3000;
+  static FatDirIndexArray<2, 8192> index;
+  bench(count, nullptr);
+  bench(count, &index);
+  return 0;
+}
@@ -0,0 +1,74 @@
+// Integer formatting speed of ostream, fmtUnsigned() and fmtBase10()
+// compared with snprintf.
+//
+// Usage: IntFormatBench [count]
+#include <time.h>
+#include "HostTest.h"
+#include "iostream/bufstream.h"
+#include "common/FmtNumber.h"
+
+static uint64_t seed = 88172645463325252ULL;
+//------------------------------------------------------------------------------
+static uint64_t rnd() {
+  seed ^= seed << 13;
+  seed ^= seed >> 7;
+  seed ^= seed << 17;
+  return seed;
+}
+//------------------------------------------------------------------------------
+// Random 32-bit value with a random number of significant bits.
+static uint32_t rnd32() {
+  uint64_t r = rnd();
+  int bits = r % 33;
+  return bits == 32 ? r >> 8 : (r >> 8) & ((1UL << bits) - 1);
+}
+//------------------------------------------------------------------------------
+static void report(const char* label, clock_t start, long count,  // NOLINT
+                   uint32_t check) {
+  double ns = 1e9*(clock() - start)/CLOCKS_PER_SEC/count;
+  printf("%-22s %6.1f ns/value (%u)\n", label, ns, (unsigned)check);
+}
+//------------------------------------------------------------------------------
+int main(int argc, char** argv) {
+  long count = argc > 1 ? atol(argv[1]) : 5000000;  // NOLINT
+  char buf[40];
+  char* end = buf + sizeof(buf) - 1;
+  uint32_t check = 0;
+  clock_t start = clock();
+  for (long i = 0; i < count; i++) {  // NOLINT
+    obufstream ob(buf, sizeof(buf));
+    uint32_t u = rnd32();
+    ob << u << ' ' << (int32_t)(u ^ 0X5555);
+    check += buf[0];
+  }
+  report("ostream << 32-bit", start, count, check);
+  start = clock();
+  for (long i = 0; i < count; i++) {  // NOLINT
+    uint32_t u = rnd32();
+    check += snprintf(buf, sizeof(buf), "%u %d", u, (int32_t)(u ^ 0X5555));
+  }
+  report("snprintf 32-bit", start, count, check);
+  start = clock();
+  for (long i = 0; i < count; i++) {  // NOLINT
+    obufstream ob(buf, sizeof(buf));
+    ob << (long long)rnd();  // NOLINT
+    check += buf[0];
+  }
+  report("ostream << 64-bit", start, count, check);
+  start = clock();
+  for (long i = 0; i < count; i++) {  // NOLINT
+    check += snprintf(buf, sizeof(buf), "%lld", (long long)rnd());  // NOLINT
+  }
+  report("snprintf 64-bit", start, count, check);
+  start = clock();
+  for (long i = 0; i < 4*count; i++) {  // NOLINT
+    check += *fmtUnsigned(end, rnd32(), 10, false);
+  }
+  report("fmtUnsigned 32-bit", start, 4*count, check);
+  start = clock();
+  for (long i = 0; i < 4*count; i++) {  // NOLINT
+    check += *fmtBase10(end, rnd());
+  }
+  report("fmtBase10 64-bit", start, 4*count, check);
+  return 0;
+}
@@ -0,0 +1,75 @@
+// Read a CRLF log file with a byte at a time fgets(), fgets() and
+// readLine().
+#include <string.h>
+#include <time.h>
+#include "HostTest.h"
+//------------------------------------------------------------------------------
+// fgets() as it was before lines were scanned in the cache.
+static int refFgets(FsFile* file, char* str, int num) {
+  char ch;
+  int n = 0;
+  int r = -1;
+  while ((n + 1) < num && (r = file->read(&ch, 1)) == 1) {
+    if (ch == '\r') {
+      continue;
+    }
+    str[n++] = ch;
+    if (ch == '\n') {
+      break;
+    }
+  }
+  if (r < 0) {
+    return -1;
+  }
+  str[n] = '\0';
+  return n;
+}
+//------------------------------------------------------------------------------
+int main() {
+  HostFsType types[] = {HOST_FAT16, HOST_FAT32, HOST_EXFAT};
+  const char* label[] = {"byte fgets", "fgets", "readLine"};
+  for (HostFsType type : types) {
+    RamBlockDevice dev;
+    FsVolume vol;
+    FsFile file;
+    char line[200];
+    long count = 0;  // NOLINT
+    formatRam(&dev, type);
+    CHECK(vol.begin(&dev));
+    CHECK(file.open(&vol, "log.txt", O_RDWR | O_CREAT | O_TRUNC));
+    while (file.fileSize() < 8000000) {
+      int n = snprintf(line, sizeof(line), "2024-01-01 12:00:%02ld INFO "
+                       "sensor=%ld value=%ld.%03ld status=ok\r\n",
+                       count % 60, count % 17, count*7 % 1000, count % 1000);
+      CHECK(file.write(line, n) == (size_t)n);
+      count++;
+    }
+    CHECK(file.close());
+    for (int mode = 0; mode < 3; mode++) {
+      char buf[128];
+      long lines = 0;  // NOLINT
+      clock_t start = clock();
+      CHECK(file.open(&vol, "log.txt", O_RDONLY));
+      while (true) {
+        const char* str;
+        int n;
+        if (mode == 0) {
+          n = refFgets(&file, buf, sizeof(buf));
+        } else if (mode == 1) {
+          n = file.fgets(buf, sizeof(buf));
+        } else {
+          n = file.readLine(&str, buf, sizeof(buf)) + 1;
+        }
+        if (n <= 0) {
+          break;
+        }
+        lines++;
+      }
+      file.close();
+      CHECK(lines == count);
+      printf("%s %-10s %ld lines %6.1f ms\n", fsTypeName(type), label[mode],
+             lines, 1000.0*(clock() - start)/CLOCKS_PER_SEC);
+    }
+  }
+  return 0;
+}
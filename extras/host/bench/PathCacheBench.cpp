@@ -0,0 +1,65 @@
+// Random opens of files in a nested directory on FAT32 and exFAT RAM
+// images with sector read counts.  Each directory of the path follows 60
+// sibling entries.  Build with and without the path cache to compare, for
+// example
+//   make bench BUILD=build-pc CPPFLAGS=-DFS_PATH_CACHE_ENTRIES=8
+//
+// Usage: PathCacheBench [opens]
+#include <string>
+#include "HostTest.h"
+
+static uint64_t seed = 88172645463325252ULL;
+//------------------------------------------------------------------------------
+static uint64_t rnd() {
+  seed ^= seed << 13;
+  seed ^= seed >> 7;
+  seed ^= seed << 17;
+  return seed;
+}
+//------------------------------------------------------------------------------
+static void siblings(FsVolume* vol, const std::string& dir) {
+  for (int i = 0; i < 60; i++) {
+    FsFile file;
+    std::string name = dir + "/sibling" + std::to_string(i);
+    CHECK(file.open(vol, name.c_str(), O_RDWR | O_CREAT));
+    CHECK(file.close());
+  }
+}
+//------------------------------------------------------------------------------
+int main(int argc, char** argv) {
+  int opens = argc > 1 ? atoi(argv[1]) : 3000;
+  HostFsType types[] = {HOST_FAT32, HOST_EXFAT};
+  printf("%d opens, FS_PATH_CACHE_ENTRIES %u\n", opens,
+         (unsigned)FS_PATH_CACHE_ENTRIES);
+  for (HostFsType type : types) {
+    RamBlockDevice dev;
+    FsVolume vol;
+    FsFile file;
+    std::string dir;
+    formatRam(&dev, type);
+    CHECK(vol.begin(&dev));
+    for (const char* name : {"data", "2026", "10", "18"}) {
+      siblings(&vol, dir);
+      dir += "/";
+      dir += name;
+      CHECK(vol.mkdir(dir.c_str()));
+    }
+    for (int i = 0; i < 60; i++) {
+      std::string name = dir + "/sensor" + std::to_string(i) + ".bin";
+      CHECK(file.open(&vol, name.c_str(), O_RDWR | O_CREAT));
+      CHECK(file.close());
+    }
+    dev.clearStats();
+    uint32_t m = curMs();
+    for (int k = 0; k < opens; k++) {
+      std::string name = dir + "/sensor" + std::to_string(rnd() % 60) + ".bin";
+      CHECK(file.open(&vol, name.c_str(), O_RDONLY));
+      CHECK(file.close());
+    }
+    m = curMs() - m;
+    printf("%s %u ms read calls %u sectors %u\n", fsTypeName(type),
+           (unsigned)m, (unsigned)dev.readCalls(),
+           (unsigned)dev.sectorsRead());
+  }
+  return 0;
+}
@@ -0,0 +1,61 @@
+// CSV rows per second written with printField(), printFields() and
+// printf() on FAT32 and exFAT RAM images.
+//
+// Usage: PrintFieldBench [rows]
+#include <time.h>
+#include "HostTest.h"
+//------------------------------------------------------------------------------
+static double seconds(clock_t start) {
+  return (double)(clock() - start)/CLOCKS_PER_SEC;
+}
+//------------------------------------------------------------------------------
+template<class Vol, class File>
+static void bench(HostFsType type, long rows) {  // NOLINT
+  RamBlockDevice dev;
+  Vol vol;
+  File file;
+  formatRam(&dev, type);
+  CHECK(vol.begin(&dev));
+
+  CHECK(file.open(&vol, "field.csv", O_RDWR | O_CREAT | O_TRUNC));
+  clock_t start = clock();
+  for (long i = 0; i < rows; i++) {  // NOLINT
+    file.printField((uint32_t)i, ',');
+    file.printField((int)(i % 1000) - 500, ',');
+    file.printField(i*0.01, ',');
+    file.printField((uint16_t)(i & 0XFFF), ',');
+    file.printField(i*3, '\n');
+  }
+  double field = seconds(start);
+  uint64_t size = file.fileSize();
+  CHECK(file.close());
+
+  CHECK(file.open(&vol, "fields.csv", O_RDWR | O_CREAT | O_TRUNC));
+  start = clock();
+  for (long i = 0; i < rows; i++) {  // NOLINT
+    file.printFields((uint32_t)i, (int)(i % 1000) - 500, i*0.01,
+                     (uint16_t)(i & 0XFFF), i*3);
+  }
+  double fields = seconds(start);
+  CHECK(file.fileSize() == size);
+  CHECK(file.close());
+
+  CHECK(file.open(&vol, "printf.csv", O_RDWR | O_CREAT | O_TRUNC));
+  start = clock();
+  for (long i = 0; i < rows; i++) {  // NOLINT
+    file.printf("%lu,%d,%.2f,%u,%ld\r\n", (unsigned long)i,  // NOLINT
+                (int)(i % 1000) - 500, i*0.01, (unsigned)(i & 0XFFF), i*3);
+  }
+  double fmt = seconds(start);
+  CHECK(file.fileSize() == size);
+  CHECK(file.close());
+  printf("%s rows/s printField %.0f printFields %.0f printf %.0f\n",
+         fsTypeName(type), rows/field, rows/fields, rows/fmt);
+}
+//------------------------------------------------------------------------------
+int main(int argc, char** argv) {
+  long rows = argc > 1 ? atol(argv[1]) : 500000;  // NOLINT
+  bench<FatVolume, FatFile>(HOST_FAT32, rows);
+  bench<ExFatVolume, ExFatFile>(HOST_EXFAT, rows);
+  return 0;
+}
@@ -0,0 +1,44 @@
+// Line by line reads of a CSV file with fgets() on FAT16, FAT32 and exFAT
+// RAM images with device call counts.  Build with and without read-ahead
+// to compare, for example
+//   make bench BUILD=build-ra CPPFLAGS=-DFS_READ_AHEAD_SECTORS=4
+//
+// Usage: ReadAheadBench [lines]
+#include <string>
+#include "HostTest.h"
+//------------------------------------------------------------------------------
+int main(int argc, char** argv) {
+  int lines = argc > 1 ? atoi(argv[1]) : 8000;
+  HostFsType types[] = {HOST_FAT16, HOST_FAT32, HOST_EXFAT};
+  printf("%d lines, FS_READ_AHEAD_SECTORS %u\n", lines,
+         (unsigned)FS_READ_AHEAD_SECTORS);
+  for (HostFsType type : types) {
+    RamBlockDevice dev;
+    FsVolume vol;
+    FsFile f;
+    std::string csv;
+    formatRam(&dev, type);
+    CHECK(vol.begin(&dev));
+    CHECK(f.open(&vol, "data.csv", O_RDWR | O_CREAT | O_TRUNC));
+    for (int i = 0; i < lines; i++) {
+      csv += std::to_string(i) + "," + std::to_string(i*7 % 1000) + "\n";
+    }
+    CHECK(f.write(csv.data(), csv.size()) == csv.size());
+    CHECK(f.close());
+    CHECK(f.open(&vol, "data.csv", O_RDONLY));
+    char line[40];
+    int n = 0;
+    dev.clearStats();
+    uint32_t m = curMs();
+    while (f.fgets(line, sizeof(line)) > 0) {
+      n++;
+    }
+    m = curMs() - m;
+    CHECK(n == lines);
+    printf("%s %u bytes %u ms read calls %u sectors %u\n", fsTypeName(type),
+           (unsigned)csv.size(), (unsigned)m, (unsigned)dev.readCalls(),
+           (unsigned)dev.sectorsRead());
+    CHECK(f.close());
+  }
+  return 0;
+}
@@ -0,0 +1,164 @@
+// Parse a numeric CSV in memory with scanDouble(), strtod(), istream and
+// the digit loop used before scanDouble().  Also counts fields where the
+// old loop differs from strtod().
+//
+// Usage: ScanFloatBench [MB]
+#include <string.h>
+#include <time.h>
+#include <string>
+#include "HostTest.h"
+#include "iostream/bufstream.h"
+#include "common/FmtNumber.h"
+
+static uint64_t seed = 88172645463325252ULL;
+//------------------------------------------------------------------------------
+static uint64_t rnd() {
+  seed ^= seed << 13;
+  seed ^= seed >> 7;
+  seed ^= seed << 17;
+  return seed;
+}
+//------------------------------------------------------------------------------
+// istream::getDouble() as it was before scanDouble().
+static double oldScan(const char* str, char** ptr) {
+  const uint32_t uint32_max = (uint32_t)-1;
+  const int EXP_LIMIT = 100;
+  bool gotDigit = false;
+  bool gotDot = false;
+  bool expNeg = false;
+  int exp = 0;
+  int fracExp = 0;
+  uint32_t frac = 0;
+  int c = *str++;
+  bool neg = c == '-';
+  if (c == '-' || c == '+') {
+    c = *str++;
+  }
+  while (1) {
+    if (isDigit(c)) {
+      gotDigit = true;
+      if (frac < uint32_max/10) {
+        frac = frac*10 + (c - '0');
+        if (gotDot) {
+          fracExp--;
+        }
+      } else if (!gotDot) {
+        fracExp++;
+      }
+    } else if (!gotDot && c == '.') {
+      gotDot = true;
+    } else {
+      break;
+    }
+    if (fracExp < -EXP_LIMIT || fracExp > EXP_LIMIT) {
+      return 0;
+    }
+    c = *str++;
+  }
+  if (!gotDigit) {
+    return 0;
+  }
+  if (c == 'e' || c == 'E') {
+    c = *str++;
+    expNeg = c == '-';
+    if (c == '-' || c == '+') {
+      c = *str++;
+    }
+    while (isDigit(c)) {
+      exp = exp*10 + (c - '0');
+      c = *str++;
+    }
+  }
+  *ptr = const_cast<char*>(str) - 1;
+  double v = frac;
+  exp = expNeg ? fracExp - exp : fracExp + exp;
+  expNeg = exp < 0;
+  if (expNeg) {
+    exp = -exp;
+  }
+  double pow10 = 10.0;
+  while (exp) {
+    if (exp & 1) {
+      if (expNeg) {
+        v /= pow10;
+      } else {
+        v *= pow10;
+      }
+    }
+    pow10 *= pow10;
+    exp >>= 1;
+  }
+  return neg ? -v : v;
+}
+//------------------------------------------------------------------------------
+// Rows of four fields: %.3f, %.6f, shortest and a small shortest value.
+static void makeCsv(std::string* csv, size_t size) {
+  char buf[FMT_DOUBLE_SIZE + 1];
+  char* end = buf + FMT_DOUBLE_SIZE;
+  int col = 0;
+  while (csv->size() < size) {
+    double d = 2000.0*(rnd() >> 11)/(1ULL << 53) - 1000.0;
+    if (col == 0) {
+      snprintf(buf, sizeof(buf), "%.3f", d);
+      *csv += buf;
+    } else if (col == 1) {
+      snprintf(buf, sizeof(buf), "%.6f", d);
+      *csv += buf;
+    } else {
+      csv->append(fmtShortest(end, col == 3 ? d*1e-6 : d, false), end);
+    }
+    *csv += col == 3 ? '\n' : ',';
+    col = (col + 1) % 4;
+  }
+}
+//------------------------------------------------------------------------------
+int main(int argc, char** argv) {
+  size_t mb = argc > 1 ? atoi(argv[1]) : 100;
+  const char* label[] = {"scanDouble", "strtod", "old loop", "istream"};
+  std::string csv;
+  makeCsv(&csv, mb*1000000);
+  const char* data = csv.c_str();
+  printf("%u MB CSV\n", (unsigned)(csv.size()/1000000));
+  for (int mode = 0; mode < 4; mode++) {
+    double sum = 0;
+    long count = 0;  // NOLINT
+    clock_t start = clock();
+    if (mode == 3) {
+      ibufstream is(data);
+      double d;
+      while (is >> d) {
+        is.ignore();
+        sum += d;
+        count++;
+      }
+    } else {
+      for (const char* p = data; *p;) {
+        char* end;
+        sum += mode == 0 ? scanDouble(p, &end) :
+               mode == 1 ? strtod(p, &end) : oldScan(p, &end);
+        count++;
+        p = *end ? end + 1 : end;
+      }
+    }
+    double ms = 1000.0*(clock() - start)/CLOCKS_PER_SEC;
+    printf("%-10s %ld fields %6.0f ms %6.1f MB/s sum %.17g\n", label[mode],
+           count, ms, csv.size()/(1000.0*ms), sum);
+  }
+  long diff = 0;  // NOLINT
+  long oldDiff = 0;  // NOLINT
+  long count = 0;  // NOLINT
+  for (const char* p = data; *p;) {
+    char* end;
+    char* oldEnd;
+    double a = scanDouble(p, &end);
+    double b = strtod(p, &end);
+    double c = oldScan(p, &oldEnd);
+    diff += memcmp(&a, &b, sizeof(a)) != 0;
+    oldDiff += memcmp(&c, &b, sizeof(c)) != 0;
+    count++;
+    p = *end ? end + 1 : end;
+  }
+  printf("differ from strtod: scanDouble %ld, old loop %ld of %ld\n",
+         diff, oldDiff, count);
+  return diff ? 1 : 0;
+}
@@ -0,0 +1,54 @@
+// Sequential write and read throughput on FAT16, FAT32 and exFAT RAM
+// images with device call counts.
+//
+// Usage: SeqBench [MiB] [bufferSize]
+#include <string.h>
+#include <vector>
+#include "HostTest.h"
+//------------------------------------------------------------------------------
+static double mbps(uint64_t bytes, uint32_t ms) {
+  return ms ? bytes / (1000.0 * ms) : 0;
+}
+//------------------------------------------------------------------------------
+int main(int argc, char** argv) {
+  uint32_t mib = argc > 1 ? atoi(argv[1]) : 64;
+  size_t bufSize = argc > 2 ? atoi(argv[2]) : 512;
+  std::vector<uint8_t> buf(bufSize);
+  HostFsType types[] = {HOST_FAT16, HOST_FAT32, HOST_EXFAT};
+  printf("%u MiB, %u byte buffer\n", (unsigned)mib, (unsigned)bufSize);
+  for (HostFsType type : types) {
+    RamBlockDevice dev;
+    FsVolume vol;
+    FsFile f;
+    formatRam(&dev, type);
+    CHECK(vol.begin(&dev));
+    CHECK(f.open(&vol, "bench.dat", O_RDWR | O_CREAT | O_TRUNC));
+    // Limit the FAT16 file to fit the volume.
+    uint64_t fileSize = (uint64_t)(type == HOST_FAT16 && mib > 20 ? 20 : mib)
+                        << 20;
+    dev.clearStats();
+    uint32_t m = curMs();
+    for (uint64_t n = 0; n < fileSize; n += bufSize) {
+      memset(buf.data(), (uint8_t)n, bufSize);
+      CHECK(f.write(buf.data(), bufSize) == bufSize);
+    }
+    CHECK(f.sync());
+    m = curMs() - m;
+    printf("%s write %.1f MB/s calls %u sectors %u\n", fsTypeName(type),
+           mbps(fileSize, m), (unsigned)dev.writeCalls(),
+           (unsigned)dev.sectorsWritten());
+    f.rewind();
+    dev.clearStats();
+    m = curMs();
+    for (uint64_t n = 0; n < fileSize; n += bufSize) {
+      CHECK(f.read(buf.data(), bufSize) == (int)bufSize);
+      CHECK(buf[0] == (uint8_t)n);
+    }
+    m = curMs() - m;
+    printf("%s read  %.1f MB/s calls %u sectors %u\n", fsTypeName(type),
+           mbps(fileSize, m), (unsigned)dev.readCalls(),
+           (unsigned)dev.sectorsRead());
+    CHECK(f.close());
+  }
+  return 0;
+}
@@ -0,0 +1,46 @@
+// Creates of long names with lost characters in one FAT32 directory.
+// Each name needs a NAME~HHHH short name since ~1 is taken.  The run
+// with rescan adds the directory pass that lfnUniqueSfn() made for each
+// create before the scan in open() checked the hash candidates.  The pass
+// is done with a lookup of a missing short name, which reads the same
+// sectors.
+//
+// Usage: SfnSeqBench [files]
+#include <time.h>
+#include <string>
+#include "HostTest.h"
+//------------------------------------------------------------------------------
+static std::string fileName(int i) {
+  return "Data+log " + std::to_string(i) + ".csv";
+}
+//------------------------------------------------------------------------------
+static void bench(int count, bool rescan) {
+  RamBlockDevice dev;
+  FatVolume vol;
+  FatFile dir;
+  FatFile file;
+  formatRam(&dev, HOST_FAT32);
+  CHECK(vol.begin(&dev));
+  CHECK(vol.mkdir("dir"));
+  CHECK(dir.open(&vol, "dir", O_RDONLY));
+  dev.clearStats();
+  clock_t start = clock();
+  for (int i = 0; i < count; i++) {
+    if (rescan && i) {
+      CHECK(!file.open(&dir, "DAT~0000.CSV", O_RDONLY));
+    }
+    CHECK(file.open(&dir, fileName(i).c_str(), O_RDWR | O_CREAT | O_EXCL));
+    CHECK(file.close());
+  }
+  double ms = 1000.0*(clock() - start)/CLOCKS_PER_SEC;
+  printf("%-16s %5d creates %8.1f ms %8u sectors read\n",
+         rescan ? "with rescan" : "scan only", count, ms,
+         (unsigned)dev.sectorsRead());
+}
+//------------------------------------------------------------------------------
+int main(int argc, char** argv) {
+  int count = argc > 1 ? atoi(argv[1]) : 4000;
+  bench(count, true);
+  bench(count, false);
+  return 0;
+}
@@ -0,0 +1,39 @@
+// Small record writes on FAT16, FAT32 and exFAT RAM images with device
+// call counts.  Build with and without the write-behind buffer to compare,
+// for example
+//   make bench BUILD=build-wb CPPFLAGS=-DFS_WRITE_BUFFER_SECTORS=8
+//
+// Usage: WriteBufferBench [KiB] [recordSize]
+#include <string.h>
+#include <vector>
+#include "HostTest.h"
+//------------------------------------------------------------------------------
+int main(int argc, char** argv) {
+  uint32_t kib = argc > 1 ? atoi(argv[1]) : 512;
+  size_t recordSize = argc > 2 ? atoi(argv[2]) : 64;
+  std::vector<uint8_t> record(recordSize);
+  HostFsType types[] = {HOST_FAT16, HOST_FAT32, HOST_EXFAT};
+  printf("%u KiB, %u byte records, FS_WRITE_BUFFER_SECTORS %u\n",
+         (unsigned)kib, (unsigned)recordSize,
+         (unsigned)FS_WRITE_BUFFER_SECTORS);
+  for (HostFsType type : types) {
+    RamBlockDevice dev;
+    FsVolume vol;
+    FsFile f;
+    formatRam(&dev, type);
+    CHECK(vol.begin(&dev));
+    CHECK(f.open(&vol, "log.dat", O_RDWR | O_CREAT | O_TRUNC));
+    dev.clearStats();
+    uint32_t m = curMs();
+    for (uint32_t n = 0; n < 1024*kib; n += recordSize) {
+      memset(record.data(), (uint8_t)n, recordSize);
+      CHECK(f.write(record.data(), recordSize) == recordSize);
+    }
+    CHECK(f.close());
+    m = curMs() - m;
+    printf("%s %u ms write calls %u sectors %u\n", fsTypeName(type),
+           (unsigned)m, (unsigned)dev.writeCalls(),
+           (unsigned)dev.sectorsWritten());
+  }
+  return 0;
+}
@@ -0,0 +1,143 @@
+// submitRead(), submitWrite() and poll() driven to completion through
+// BlockDeviceInterface for LatencyRamBlockDevice, the synchronous
+// default of RamBlockDevice, range errors and timeouts.
+#include <string.h>
+#include "HostTest.h"
+
+const size_t NS = 8;
+//------------------------------------------------------------------------------
+struct Done {
+  int calls;
+  bool success;
+};
+//------------------------------------------------------------------------------
+static void callback(void* context, bool success) {
+  Done* done = reinterpret_cast<Done*>(context);
+  done->calls++;
+  done->success = success;
+}
+//------------------------------------------------------------------------------
+// Return the number of poll() calls that found the transfer busy.
+static long pollDone(BlockDeviceInterface* dev, Done* done) {  // NOLINT
+  long busy = 0;  // NOLINT
+  while (!dev->poll()) {
+    CHECK(done->calls == 0);
+    busy++;
+  }
+  CHECK(done->calls == 1);
+  CHECK(dev->poll());
+  CHECK(done->calls == 1);
+  return busy;
+}
+//------------------------------------------------------------------------------
+static void fill(uint8_t* buf, int seed) {
+  for (size_t i = 0; i < NS*512; i++) {
+    buf[i] = seed + i*7 + i/512;
+  }
+}
+//------------------------------------------------------------------------------
+// Write and read back NS sectors at sector 10.  Return busy polls.
+static long checkTransfer(BlockDeviceInterface* dev, uint8_t* image,  // NOLINT
+                          int seed) {
+  static uint8_t src[NS*512];
+  static uint8_t dst[NS*512];
+  long busy;  // NOLINT
+  Done done = {0, false};
+  fill(src, seed);
+  CHECK(dev->submitWrite(10, src, NS, callback, &done));
+  busy = pollDone(dev, &done);
+  CHECK(done.success);
+  CHECK(memcmp(image + 10*512, src, sizeof(src)) == 0);
+
+  memset(dst, 0, sizeof(dst));
+  done.calls = 0;
+  CHECK(dev->submitRead(10, dst, NS, callback, &done));
+  busy += pollDone(dev, &done);
+  CHECK(done.success);
+  CHECK(memcmp(dst, src, sizeof(dst)) == 0);
+  return busy;
+}
+//------------------------------------------------------------------------------
+static void checkRange(BlockDeviceInterface* dev) {
+  uint8_t buf[512];
+  Done done = {0, true};
+  CHECK(!dev->submitRead(dev->sectorCount(), buf, 1, callback, &done));
+  CHECK(done.calls == 1 && !done.success);
+  done.success = true;
+  CHECK(!dev->submitWrite(dev->sectorCount() - 1, buf, 2, callback, &done));
+  CHECK(done.calls == 2 && !done.success);
+  CHECK(dev->poll());
+}
+//------------------------------------------------------------------------------
+int main() {
+  RamBlockDevice ram;
+  CHECK(ram.begin(1000));
+  // Default implementation completes before returning.
+  CHECK(checkTransfer(&ram, ram.data(), 1) == 0);
+  checkRange(&ram);
+  printf("RamBlockDevice ok\n");
+
+  LatencyRamBlockDevice dev;
+  BlockDeviceInterface* bdi = &dev;
+  CHECK(dev.begin(1000));
+  dev.setLatency(200, 500);
+  CHECK(checkTransfer(bdi, dev.data(), 2) > 0);
+  checkRange(bdi);
+
+  // A second submit completes the first transfer.
+  static uint8_t a[NS*512];
+  static uint8_t b[NS*512];
+  Done done1 = {0, false};
+  Done done2 = {0, false};
+  fill(a, 3);
+  fill(b, 4);
+  CHECK(bdi->submitWrite(100, a, NS, callback, &done1));
+  CHECK(done1.calls == 0);
+  CHECK(bdi->submitWrite(200, b, NS, callback, &done2));
+  CHECK(done1.calls == 1 && done1.success);
+  pollDone(bdi, &done2);
+  CHECK(done2.success);
+  CHECK(memcmp(dev.data() + 100*512, a, sizeof(a)) == 0);
+  CHECK(memcmp(dev.data() + 200*512, b, sizeof(b)) == 0);
+
+  // Synchronous calls also complete a transfer in progress.
+  done1.calls = 0;
+  memset(b, 0, sizeof(b));
+  CHECK(bdi->submitRead(100, b, NS, callback, &done1));
+  CHECK(bdi->syncDevice());
+  CHECK(done1.calls == 1 && done1.success);
+  CHECK(memcmp(a, b, sizeof(a)) == 0);
+  printf("LatencyRamBlockDevice ok\n");
+
+  // Latency under the timeout.
+  dev.setTimeout(2000);
+  CHECK(checkTransfer(bdi, dev.data(), 5) > 0);
+
+  // Write latency over the timeout.
+  dev.setLatency(200, 5000);
+  fill(b, 6);
+  done1.calls = 0;
+  CHECK(bdi->submitWrite(100, b, NS, callback, &done1));
+  CHECK(bdi->poll() == false);
+  pollDone(bdi, &done1);
+  CHECK(!done1.success);
+  CHECK(memcmp(dev.data() + 100*512, a, sizeof(a)) == 0);
+  CHECK(!bdi->writeSectors(100, b, 1));
+
+  // Read latency over the timeout.
+  dev.setLatency(5000, 200);
+  done1.calls = 0;
+  memset(b, 0, sizeof(b));
+  CHECK(bdi->submitRead(100, b, NS, callback, &done1));
+  pollDone(bdi, &done1);
+  CHECK(!done1.success);
+  CHECK(b[0] == 0 && b[NS*512 - 1] == 0);
+  CHECK(!bdi->readSectors(100, b, 1));
+
+  // No timeout.
+  dev.setTimeout(0);
+  CHECK(bdi->readSectors(100, b, NS));
+  CHECK(memcmp(a, b, sizeof(a)) == 0);
+  printf("timeout ok\n");
+  return 0;
+}
@@ -0,0 +1,80 @@
+// BufferedPrint output to a file and error reporting when the file
+// write fails.
+#include <string.h>
+#include <string>
+#include "HostTest.h"
+#include "common/BufferedPrint.h"
+//------------------------------------------------------------------------------
+// Accepts limit bytes then fails.
+class LimitWriter {
+ public:
+  explicit LimitWriter(size_t limit) : m_limit(limit), m_syncs(0) {}
+  size_t write(const void* buf, size_t n) {
+    size_t m = n < m_limit ? n : m_limit;
+    m_data.append(reinterpret_cast<const char*>(buf), m);
+    m_limit -= m;
+    return m;
+  }
+  bool sync() {
+    m_syncs++;
+    return true;
+  }
+  std::string m_data;
+  size_t m_limit;
+  int m_syncs;
+};
+//------------------------------------------------------------------------------
+int main() {
+  RamBlockDevice dev;
+  FsVolume vol;
+  FsFile file;
+  std::string expect;
+  formatRam(&dev, HOST_FAT32);
+  CHECK(vol.begin(&dev));
+  CHECK(file.open(&vol, "print.txt", O_RDWR | O_CREAT | O_TRUNC));
+  {
+    BufferedPrint<FsFile, 64> bp(&file);
+    for (int i = 0; i < 1000; i++) {
+      std::string line = std::to_string(i) + (i % 7 ? "," : "\r\n");
+      bp.print(line.c_str());
+      expect += line;
+      if (i % 100 == 0) {
+        // Large write that bypasses the buffer.
+        std::string big(100 + i % 50, 'a' + i % 26);
+        bp.write(big.c_str());
+        expect += big;
+      }
+    }
+    CHECK(bp.sync());
+    CHECK(!bp.getWriteError());
+  }
+  std::string got(expect.size(), 0);
+  CHECK(file.seekSet(0));
+  CHECK(file.read(&got[0], got.size()) == (int)got.size());
+  CHECK(file.read() < 0);
+  CHECK(got == expect);
+  CHECK(file.close());
+
+  // flush() of a full buffer fails.
+  LimitWriter lw(100);
+  BufferedPrint<LimitWriter, 32> bp(&lw);
+  for (int i = 0; i < 100; i++) {
+    bp.write('x');
+  }
+  CHECK(!bp.getWriteError());
+  CHECK(bp.sync());
+  CHECK(lw.m_data.size() == 100 && lw.m_syncs == 1);
+  bp.write('y');
+  CHECK(!bp.sync());
+  CHECK(bp.getWriteError());
+  CHECK(lw.m_syncs == 1);
+  bp.clearWriteError();
+
+  // Large write that bypasses the buffer fails.
+  char big[40];
+  memset(big, 'z', sizeof(big));
+  CHECK(bp.write(big, sizeof(big)) == 0);
+  CHECK(bp.getWriteError());
+  printf("ok\n");
+  return 0;
+}
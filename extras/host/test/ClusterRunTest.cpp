@@ -0,0 +1,98 @@
+// Multi-sector reads that cross cluster boundaries.  Two files are
+// written in alternating runs of clusters so each run is a fragment, and
+// a third file is preallocated so it is contiguous.  A read of a whole
+// file must use one device call for each fragment.  Random reads are
+// checked against a model.
+#include <string>
+#include "HostTest.h"
+
+static uint64_t seed = 88172645463325252ULL;
+//------------------------------------------------------------------------------
+static uint64_t rnd() {
+  seed ^= seed << 13;
+  seed ^= seed >> 7;
+  seed ^= seed << 17;
+  return seed;
+}
+//------------------------------------------------------------------------------
+static std::string rndData(size_t n) {
+  std::string s(n, 0);
+  for (auto& c : s) {
+    c = rnd();
+  }
+  return s;
+}
+//------------------------------------------------------------------------------
+// Read all of a file with one call.  Return the number of device reads.
+static uint32_t readAll(RamBlockDevice* dev, FsFile* file,
+                        const std::string& model) {
+  std::string got(model.size(), 0);
+  CHECK(file->seekSet(0));
+  dev->clearStats();
+  CHECK(file->read(&got[0], got.size()) == (int)got.size());
+  CHECK(got == model);
+  return dev->readCalls();
+}
+//------------------------------------------------------------------------------
+static void randomReads(FsFile* file, const std::string& model) {
+  for (int k = 0; k < 200; k++) {
+    size_t pos = rnd() % model.size();
+    size_t n = 1 + rnd() % (64*1024);
+    std::string got(n, 0);
+    if (n > model.size() - pos) {
+      n = model.size() - pos;
+    }
+    CHECK(file->seekSet(pos));
+    CHECK(file->read(&got[0], got.size()) == (int)n);
+    CHECK(got.compare(0, n, model, pos, n) == 0);
+  }
+}
+//------------------------------------------------------------------------------
+static void check(HostFsType type) {
+  RamBlockDevice dev;
+  FsVolume vol;
+  FsFile file[3];
+  std::string model[3];
+  uint32_t runs[2] = {0, 0};
+  formatRam(&dev, type);
+  CHECK(vol.begin(&dev));
+  uint32_t bpc = 512*vol.sectorsPerCluster();
+  for (int i = 0; i < 3; i++) {
+    std::string name = "file" + std::to_string(i);
+    CHECK(file[i].open(&vol, name.c_str(), O_RDWR | O_CREAT));
+  }
+  // Alternate runs of one to six clusters.
+  for (int k = 0; k < 40; k++) {
+    int i = k & 1;
+    std::string data = rndData((1 + rnd() % 6)*bpc);
+    CHECK(file[i].write(data.data(), data.size()) == data.size());
+    model[i] += data;
+    runs[i]++;
+  }
+  model[2] = rndData(60*bpc);
+  CHECK(file[2].preAllocate(model[2].size()));
+  CHECK(file[2].write(model[2].data(), model[2].size()) == model[2].size());
+  for (int i = 0; i < 3; i++) {
+    CHECK(file[i].sync());
+  }
+  // Data sectors are read directly.  Other reads are FAT sectors.
+  uint32_t calls = readAll(&dev, &file[2], model[2]);
+  CHECK(calls == 1);
+  for (int i = 0; i < 2; i++) {
+    calls = readAll(&dev, &file[i], model[i]);
+    CHECK(runs[i] <= calls && calls <= runs[i] + 2);
+  }
+  for (int i = 0; i < 3; i++) {
+    randomReads(&file[i], model[i]);
+    CHECK(file[i].close());
+  }
+  printf("%s ok, %u and %u fragments, %u byte clusters\n", fsTypeName(type),
+         (unsigned)runs[0], (unsigned)runs[1], (unsigned)bpc);
+}
+//------------------------------------------------------------------------------
+int main() {
+  check(HOST_FAT16);
+  check(HOST_FAT32);
+  check(HOST_EXFAT);
+  return 0;
+}
@@ -0,0 +1,307 @@
+// fmtDouble(), fmtShortest() and ostream double insertion checked against
+// snprintf.  Shortest output must read back exactly, have no shorter
+// form that reads back, and be correctly rounded.
+//
+// Usage: DoubleFormatTest [count]
+//        DoubleFormatTest float firstBits lastBits
+// The second form checks fmtShortest() for a range of float bit patterns.
+#include <math.h>
+#include <string.h>
+#include "HostTest.h"
+#include "iostream/bufstream.h"
+#include "common/FmtNumber.h"
+
+static uint64_t seed = 88172645463325252ULL;
+//------------------------------------------------------------------------------
+static uint64_t rnd() {
+  seed ^= seed << 13;
+  seed ^= seed >> 7;
+  seed ^= seed << 17;
+  return seed;
+}
+//------------------------------------------------------------------------------
+static double randDouble() {
+  uint64_t r = rnd();
+  double v;
+  switch (rnd() % 4) {
+    case 0:
+      memcpy(&v, &r, sizeof(v));
+      return v;
+    case 1:
+      return (double)(r >> (rnd() % 64))/pow(10, rnd() % 20);
+    case 2:
+      return ldexp((double)(r >> 11), (int)(rnd() % 200) - 150);
+    default:
+      return (double)(int64_t)(r % 2000001 - 1000000)/pow(10, rnd() % 8);
+  }
+}
+//------------------------------------------------------------------------------
+static double parse(const char* str, double) {
+  return strtod(str, nullptr);
+}
+//------------------------------------------------------------------------------
+static float parse(const char* str, float) {
+  return strtof(str, nullptr);
+}
+//------------------------------------------------------------------------------
+static void fail(const char* what, double v, const char* ref,
+                 const char* got) {
+  printf("%s %a ref [%s] got [%s]\n", what, v, ref, got);
+  CHECK(false);
+}
+//------------------------------------------------------------------------------
+// Expected shortest layout for digits dig with decimal exponent k.
+static void layout(const char* dig, int nd, int k, char* out) {
+  if (k < -4 || k >= 17) {
+    *out++ = dig[0];
+    if (nd > 1) {
+      *out++ = '.';
+      memcpy(out, dig + 1, nd - 1);
+      out += nd - 1;
+    }
+    sprintf(out, "e%c%02d", k < 0 ? '-' : '+', abs(k));
+    return;
+  }
+  if (k < 0) {
+    *out++ = '0';
+    *out++ = '.';
+    for (int i = 0; i < -k - 1; i++) {
+      *out++ = '0';
+    }
+    memcpy(out, dig, nd);
+    out += nd;
+  } else {
+    for (int i = 0; i <= k; i++) {
+      *out++ = i < nd ? dig[i] : '0';
+    }
+    if (nd > k + 1) {
+      *out++ = '.';
+      memcpy(out, dig + k + 1, nd - k - 1);
+      out += nd - k - 1;
+    }
+  }
+  *out = '\0';
+}
+//------------------------------------------------------------------------------
+template<typename T>
+static void checkShortest(T v) {
+  char buf[FMT_DOUBLE_SIZE + 1];
+  char ref[64];
+  char exp[64];
+  char* end = buf + FMT_DOUBLE_SIZE;
+  *end = '\0';
+  char* got = fmtShortest(end, v, false);
+  if (parse(got, v) != v) {
+    fail("read back", v, "", got);
+  }
+  // Like the other formatters, -0.0 is printed as 0.
+  if (v < 0) {
+    if (*got++ != '-') {
+      fail("sign", v, "", got);
+    }
+    v = -v;
+  }
+  if (v == 0) {
+    if (strcmp(got, "0")) {
+      fail("zero", v, "0", got);
+    }
+    return;
+  }
+  // Significant digits of got.
+  char dig[40] = {0};
+  int nd = 0;
+  for (char* p = got; *p && *p != 'e'; p++) {
+    if (isDigit(*p)) {
+      dig[nd++] = *p;
+    }
+  }
+  char* d = dig;
+  while (*d == '0') {
+    d++;
+    nd--;
+  }
+  while (nd > 1 && d[nd - 1] == '0') {
+    nd--;
+  }
+  d[nd] = '\0';
+  if (nd > (sizeof(T) == 4 ? 9 : 17)) {
+    fail("too long", v, "", got);
+  }
+  // One less digit must not read back.
+  if (nd > 1) {
+    snprintf(ref, sizeof(ref), "%.*e", nd - 2, (double)v);
+    if (parse(ref, v) == v) {
+      fail("not shortest", v, ref, got);
+    }
+  }
+  // Correctly rounded nd digits unless those do not read back.
+  snprintf(ref, sizeof(ref), "%.*e", nd - 1, (double)v);
+  char rd[40];
+  int k = 0;
+  for (char* p = ref; *p != 'e'; p++) {
+    if (*p != '.') {
+      rd[k++] = *p;
+    }
+  }
+  rd[k] = '\0';
+  if (strcmp(rd, d)) {
+    if (parse(ref, v) == v) {
+      fail("not closest", v, ref, got);
+    }
+    return;
+  }
+  layout(rd, nd, atoi(strchr(ref, 'e') + 1), exp);
+  if (strcmp(exp, got)) {
+    fail("layout", v, exp, got);
+  }
+}
+//------------------------------------------------------------------------------
+// Compare fmtDouble() with printf conversion c at precision prec.
+static void checkFmt(double v, int prec, bool alt, char c) {
+  char buf[FMT_DOUBLE_SIZE + 1];
+  char ref[400];
+  char fmt[10];
+  char* end = buf + FMT_DOUBLE_SIZE;
+  *end = '\0';
+  if (v == 0 && signbit(v)) {
+    return;
+  }
+  snprintf(fmt, sizeof(fmt), alt ? "%%#.*%c" : "%%.*%c", c);
+  snprintf(ref, sizeof(ref), fmt, prec, v);
+  char* got = fmtDouble(end, v, prec, alt, c);
+  // glibc drops the zeros %#g must keep if rounding carries to a new
+  // digit, for example 999.5 with %#.3g is 1.e+03, not 1.00e+03.
+  if (alt && (c == 'g' || c == 'G') &&
+      (strstr(ref, "1.e") || strstr(ref, "1.E"))) {
+    return;
+  }
+  if (strcmp(ref, got)) {
+    fail(fmt, v, ref, got);
+  }
+}
+//------------------------------------------------------------------------------
+static void checkStream(double v, int prec) {
+  char buf[200];
+  char ref[200];
+  bool big = fabs(v) >= 1e17;
+  {
+    obufstream ob(buf, sizeof(buf));
+    ob << setprecision(prec) << v;
+    snprintf(ref, sizeof(ref), big ? "%.*e" : "%.*f", prec, v);
+    CHECK(strcmp(ref, buf) == 0);
+  }
+  {
+    obufstream ob(buf, sizeof(buf));
+    ob << scientific << uppercase << setprecision(prec) << v;
+    snprintf(ref, sizeof(ref), "%.*E", prec, v);
+    CHECK(strcmp(ref, buf) == 0);
+  }
+  if (!big) {
+    obufstream ob(buf, sizeof(buf));
+    ob << showpos << setw(30) << setprecision(prec) << v;
+    snprintf(ref, sizeof(ref), "%+30.*f", prec, v);
+    CHECK(strcmp(ref, buf) == 0);
+  }
+  if (!big) {
+    obufstream ob(buf, sizeof(buf));
+    ob << internal << setfill('0') << setw(30) << setprecision(prec) << v;
+    snprintf(ref, sizeof(ref), "%030.*f", prec, v);
+    CHECK(strcmp(ref, buf) == 0);
+  }
+  if (!big) {
+    obufstream ob(buf, sizeof(buf));
+    ob << showpoint << setprecision(0) << v;
+    snprintf(ref, sizeof(ref), "%#.0f", v);
+    CHECK(strcmp(ref, buf) == 0);
+  }
+  {
+    obufstream ob(buf, sizeof(buf));
+    ob << defaultfloat << v;
+    CHECK(strtod(buf, nullptr) == v);
+  }
+  float f = v;
+  if (isfinite(f)) {
+    obufstream ob(buf, sizeof(buf));
+    ob << defaultfloat << f;
+    CHECK(strtof(buf, nullptr) == f);
+  }
+}
+//------------------------------------------------------------------------------
+int main(int argc, char** argv) {
+  if (argc > 3 && strcmp(argv[1], "float") == 0) {
+    uint32_t first = strtoul(argv[2], nullptr, 0);
+    uint32_t last = strtoul(argv[3], nullptr, 0);
+    for (uint64_t b = first; b <= last; b++) {
+      uint32_t u = b;
+      float f;
+      memcpy(&f, &u, sizeof(f));
+      if (isfinite(f)) {
+        checkShortest(f);
+      }
+    }
+    printf("float 0X%X to 0X%X ok\n", (unsigned)first, (unsigned)last);
+    return 0;
+  }
+  long count = argc > 1 ? atol(argv[1]) : 300000;  // NOLINT
+  const char* conv = "feEgG";
+  double special[] = {
+    0.0, 1.0, 0.1, 0.5, 0.125, 2.5, 1.5, 0.05, 0.15, 0.25, 0.35, 2.675, 1e16,
+    1e17, 99999999999999999.0, 9.5, 0.95, 999.5, 5e-324, 1e-323,
+    2.2250738585072014e-308, 2.225073858507201e-308, 1.7976931348623157e308,
+    1e308, 1e-300, 9007199254740993.0, 4294967295.0, 4294967296.0,
+    123456789012345678.0, 0.000001, 1e-5, 1e-4, 0.3, 1e23, 8.41e21, 5e-310,
+    1.5e-320, INFINITY, -INFINITY, NAN, -2.5, -0.0
+  };
+  for (double v : special) {
+    for (int prec = 0; prec <= 17; prec++) {
+      for (const char* c = conv; *c; c++) {
+        if (*c == 'f' && fabs(v) >= 1e17) {
+          continue;
+        }
+        if ((*c == 'e' || *c == 'E') && prec > 16) {
+          continue;
+        }
+        checkFmt(v, prec, false, *c);
+        checkFmt(v, prec, true, *c);
+      }
+    }
+    if (isfinite(v)) {
+      checkShortest(v);
+    }
+    if (isfinite((float)v)) {
+      checkShortest((float)v);
+    }
+  }
+  printf("special values ok\n");
+  for (long i = 0; i < count; i++) {  // NOLINT
+    double v = randDouble();
+    if (!isfinite(v)) {
+      continue;
+    }
+    checkShortest(v);
+    int prec = rnd() % 18;
+    char c = conv[rnd() % 5];
+    if (c == 'f' && fabs(v) >= 1e17) {
+      c = 'e';
+    }
+    if ((c == 'e' || c == 'E') && prec > 16) {
+      prec = 16;
+    }
+    checkFmt(v, prec, rnd() & 1, c);
+    float f = v;
+    if (isfinite(f)) {
+      checkShortest(f);
+    }
+  }
+  printf("fmtDouble ok %ld values\n", count);
+  for (long i = 0; i < count/4; i++) {  // NOLINT
+    int64_t n = rnd() % 20000001 - 10000000;
+    double v = n/pow(10, rnd() % 9);
+    if (i % 7 == 0) {
+      v = ldexp((double)(rnd() >> 11), (int)(rnd() % 300) - 200);
+    }
+    checkStream(v, rnd() % 10);
+  }
+  printf("ostream ok %ld values\n", count/4);
+  return 0;
+}
@@ -0,0 +1,226 @@
+// exFAT cluster allocation and free cluster count for random allocation
+// bitmaps.  A model of the bitmap and of the search start predicts where
+// preAllocate() and file growth place clusters.  The bitmap on the device
+// must match the model after each operation.
+#include <string.h>
+#include <string>
+#include <utility>
+#include <vector>
+#include "HostTest.h"
+
+typedef std::pair<uint32_t, uint32_t> Run;
+typedef std::vector<Run> Runs;
+
+static uint64_t seed = 88172645463325252ULL;
+static std::vector<uint8_t> bm;
+static uint32_t nc;
+// Model of m_bitmapStart, the search start for bitmapFind(0, n).
+static uint32_t hint;
+//------------------------------------------------------------------------------
+static uint64_t rnd() {
+  seed ^= seed << 13;
+  seed ^= seed >> 7;
+  seed ^= seed << 17;
+  return seed;
+}
+//------------------------------------------------------------------------------
+static bool isSet(uint32_t i) {
+  return bm[i/8] >> (i%8) & 1;
+}
+//------------------------------------------------------------------------------
+static void setBit(uint32_t i, bool value) {
+  if (value) {
+    bm[i/8] |= 1 << (i%8);
+  } else {
+    bm[i/8] &= ~(1 << (i%8));
+  }
+}
+//------------------------------------------------------------------------------
+// Find count free bits in [bgn, end) one bit at a time.
+static int64_t refScan(uint32_t bgn, uint32_t end, uint32_t count) {
+  uint32_t run = 0;
+  for (uint32_t i = bgn; i < end; i++) {
+    if (isSet(i)) {
+      run = 0;
+    } else if (++run >= count) {
+      return i + 1 - run;
+    }
+  }
+  return -1;
+}
+//------------------------------------------------------------------------------
+// Expected bitmapFind() result, one if no space.
+static uint32_t refFind(uint32_t cluster, uint32_t count) {
+  uint32_t start = cluster ? cluster - 2 : hint;
+  if (start >= nc) {
+    start = 0;
+  }
+  int64_t r = refScan(start, nc, count);
+  if (r < 0 && start) {
+    r = refScan(0, start, count);
+  }
+  if (r < 0) {
+    return 1;
+  }
+  if (cluster == 0 && count == 1) {
+    hint = r;
+  }
+  return r + 2;
+}
+//------------------------------------------------------------------------------
+// Expected bitmapModify().
+static void refModify(uint32_t cluster, uint32_t count, bool value) {
+  uint32_t start = cluster - 2;
+  for (uint32_t i = start; i < start + count; i++) {
+    CHECK(isSet(i) != value);
+    setBit(i, value);
+  }
+  if (value) {
+    if (start <= hint && hint < start + count) {
+      hint = start + count < nc ? start + count : 0;
+    }
+  } else if (start < hint) {
+    hint = start;
+  }
+}
+//------------------------------------------------------------------------------
+static void checkBitmap(RamBlockDevice* dev, ExFatVolume* vol) {
+  uint8_t* bitmap = dev->data() + 512*vol->clusterHeapStartSector();
+  CHECK(memcmp(bitmap, bm.data(), (nc + 7)/8) == 0);
+}
+//------------------------------------------------------------------------------
+static void checkFreeCount(ExFatVolume* vol) {
+  static uint8_t buf[16*512];
+  uint32_t used = 0;
+  for (uint32_t i = 0; i < nc; i++) {
+    used += isSet(i);
+  }
+  CHECK(vol->freeClusterCount() == nc - used);
+  CHECK(vol->freeClusterCount(buf, 512) == nc - used);
+  CHECK(vol->freeClusterCount(buf, 3*512) == nc - used);
+  CHECK(vol->freeClusterCount(buf, sizeof(buf)) == nc - used);
+}
+//------------------------------------------------------------------------------
+// Contiguous file of count clusters.
+static void preAllocate(ExFatVolume* vol, const char* name, uint32_t count,
+                        Runs* runs) {
+  ExFatFile file;
+  CHECK(file.open(vol, name, O_RDWR | O_CREAT | O_EXCL));
+  uint32_t find = refFind(0, count);
+  bool ok = file.preAllocate((uint64_t)count*vol->bytesPerCluster());
+  CHECK(ok == (find > 1));
+  if (ok) {
+    refModify(find, count, true);
+    runs->push_back(Run(find, count));
+    CHECK(file.close());
+  } else {
+    CHECK(file.remove());
+  }
+}
+//------------------------------------------------------------------------------
+// Create or extend a file a cluster at a time.
+static void grow(ExFatVolume* vol, const char* name, uint32_t count,
+                 Runs* runs) {
+  static uint8_t buf[128*1024];
+  ExFatFile file;
+  uint32_t bpc = vol->bytesPerCluster();
+  uint32_t last = 0;
+  CHECK(bpc <= sizeof(buf));
+  if (runs->empty()) {
+    CHECK(file.open(vol, name, O_RDWR | O_CREAT | O_EXCL));
+  } else {
+    CHECK(file.open(vol, name, O_RDWR | O_AT_END));
+    last = runs->back().first + runs->back().second - 1;
+  }
+  for (uint32_t n = 0; n < count; n++) {
+    uint32_t find = refFind(last ? last + 1 : 0, 1);
+    if (find < 2) {
+      CHECK(file.write(buf, bpc) != bpc);
+      break;
+    }
+    CHECK(file.write(buf, bpc) == bpc);
+    refModify(find, 1, true);
+    runs->push_back(Run(find, 1));
+    last = find;
+  }
+  if (runs->empty()) {
+    CHECK(file.remove());
+  } else {
+    CHECK(file.close());
+  }
+}
+//------------------------------------------------------------------------------
+static void remove(ExFatVolume* vol, const char* name, Runs* runs) {
+  ExFatFile file;
+  CHECK(file.open(vol, name, O_RDWR));
+  CHECK(file.remove());
+  for (Run& r : *runs) {
+    refModify(r.first, r.second, false);
+  }
+  runs->clear();
+}
+//------------------------------------------------------------------------------
+int main() {
+  RamBlockDevice dev;
+  ExFatVolume vol;
+  formatRam(&dev, HOST_EXFAT, 0X400000);
+  CHECK(vol.begin(&dev));
+  nc = vol.clusterCount();
+  // The bitmap, upcase table and root directory are at the heap start.
+  uint32_t sys = vol.rootDirectoryCluster() - 1;
+  CHECK(sys < 64);
+  const uint32_t FILE_COUNT = 20;
+  Runs files[FILE_COUNT];
+  bool grown[FILE_COUNT] = {false};
+  for (int trial = 0; trial < 40; trial++) {
+    // Percent of clusters allocated.  Nearly full bitmaps make extended
+    // files wrap to the start of the bitmap.
+    uint32_t density = trial % 3 == 1 ? 96 + rnd() % 5 : rnd() % 101;
+    bm.assign((nc + 7)/8, 0);
+    for (uint32_t i = 0; i < nc; i++) {
+      setBit(i, i < sys || rnd() % 100 < density);
+    }
+    if (trial % 3 == 0) {
+      // Long free runs.
+      for (uint32_t i = sys; i < nc; i++) {
+        if (i % 97 < 40) {
+          setBit(i, false);
+        }
+      }
+    }
+    // A new image for each trial limits the RAM used by file data.
+    formatRam(&dev, HOST_EXFAT, 0X400000);
+    memcpy(dev.data() + 512*vol.clusterHeapStartSector(), bm.data(),
+           bm.size());
+    CHECK(vol.begin(&dev));
+    hint = 0;
+    refFind(0, 1);
+    checkFreeCount(&vol);
+    // Files are kept and extended so searches start at many places
+    // and wrap at the end of the bitmap.
+    for (int k = 0; k < 200; k++) {
+      uint32_t i = rnd() % FILE_COUNT;
+      std::string name = "file" + std::to_string(i);
+      if (grown[i] && !files[i].empty() && rnd() % 3) {
+        grow(&vol, name.c_str(), 1 + rnd() % 16, &files[i]);
+      } else if (!files[i].empty()) {
+        remove(&vol, name.c_str(), &files[i]);
+      } else if ((grown[i] = rnd() % 3 == 0)) {
+        grow(&vol, name.c_str(), 1 + rnd() % 4, &files[i]);
+      } else {
+        uint32_t count = 1 + (rnd() % 4 ? rnd() % 40 : rnd() % 1000);
+        preAllocate(&vol, name.c_str(), count, &files[i]);
+      }
+      checkBitmap(&dev, &vol);
+    }
+    checkFreeCount(&vol);
+    for (uint32_t i = 0; i < FILE_COUNT; i++) {
+      if (!files[i].empty()) {
+        remove(&vol, ("file" + std::to_string(i)).c_str(), &files[i]);
+      }
+    }
+    checkBitmap(&dev, &vol);
+  }
+  printf("%u clusters, 40 bitmaps ok\n", (unsigned)nc);
+  return 0;
+}
@@ -0,0 +1,126 @@
+// exFAT open by name in the root and a subdirectory.  Names of many
+// lengths are opened with other case, missing names must fail, and new
+// files must reuse the entries of removed files.  The tree is checked
+// against a model after each step.
+#include <ctype.h>
+#include <map>
+#include <string>
+#include "HostTest.h"
+
+typedef std::map<std::string, std::string> Model;
+//------------------------------------------------------------------------------
+static std::string fileName(int i, int len) {
+  std::string name = "File" + std::to_string(i) + " ";
+  do {
+    name += 'a' + (name.size() + i) % 26;
+  } while (name.size() < (size_t)len);
+  return name;
+}
+//------------------------------------------------------------------------------
+static std::string upper(const std::string& str) {
+  std::string rtn = str;
+  for (char& c : rtn) {
+    c = toupper(c);
+  }
+  return rtn;
+}
+//------------------------------------------------------------------------------
+static void create(ExFatFile* dir, Model* model, const std::string& name) {
+  ExFatFile file;
+  CHECK(file.open(dir, name.c_str(), O_RDWR | O_CREAT | O_EXCL));
+  CHECK(file.write(name.c_str(), name.size()) == name.size());
+  CHECK(file.close());
+  (*model)[upper(name)] = name;
+}
+//------------------------------------------------------------------------------
+static void checkOpen(ExFatFile* dir, const Model& model) {
+  ExFatFile file;
+  char buf[300];
+  for (auto& m : model) {
+    const std::string& name = m.second;
+    // Open with the name in upper case and check the content.
+    CHECK(file.open(dir, m.first.c_str(), O_RDONLY));
+    CHECK(file.fileSize() == name.size());
+    CHECK(file.read(buf, sizeof(buf)) == (int)name.size());
+    CHECK(name.compare(0, name.size(), buf, name.size()) == 0);
+    CHECK(file.close());
+    CHECK(!file.open(dir, name.c_str(), O_RDWR | O_CREAT | O_EXCL));
+    // Names that differ in the last character or the length.
+    std::string miss = name;
+    miss.back() = miss.back() == '~' ? '!' : '~';
+    if (!model.count(upper(miss))) {
+      CHECK(!file.open(dir, miss.c_str(), O_RDONLY));
+    }
+    miss = name.substr(0, name.size() - 1);
+    if (!model.count(upper(miss))) {
+      CHECK(!file.open(dir, miss.c_str(), O_RDONLY));
+    }
+    CHECK(!file.open(dir, (name + "x").c_str(), O_RDONLY));
+  }
+}
+//------------------------------------------------------------------------------
+static void checkList(ExFatFile* dir, const Model& model) {
+  ExFatFile file;
+  char name[300];
+  size_t n = 0;
+  dir->rewind();
+  while (file.openNext(dir, O_RDONLY)) {
+    CHECK(file.getName(name, sizeof(name)));
+    if (!file.isDir()) {
+      auto it = model.find(upper(name));
+      CHECK(it != model.end() && it->second == name);
+      n++;
+    }
+    CHECK(file.close());
+  }
+  CHECK(n == model.size());
+}
+//------------------------------------------------------------------------------
+static void check(ExFatVolume* vol, ExFatFile* dir, const char* label) {
+  Model model;
+  for (int i = 0; i < 400; i++) {
+    create(dir, &model, fileName(i, 6 + (i*37) % 200));
+  }
+  checkOpen(dir, model);
+  checkList(dir, model);
+  printf("%s create ok\n", label);
+
+  // Remove every third file and create files with the same name lengths.
+  // Each file has one cluster so the free count only changes if the
+  // directory grows.
+  uint32_t freeCount = vol->freeClusterCount();
+  ExFatFile file;
+  for (int i = 0; i < 400; i += 3) {
+    std::string name = fileName(i, 6 + (i*37) % 200);
+    CHECK(file.open(dir, upper(name).c_str(), O_RDWR));
+    CHECK(file.remove());
+    model.erase(upper(name));
+  }
+  checkOpen(dir, model);
+  for (int i = 0; i < 400; i += 3) {
+    create(dir, &model, fileName(i + 1000, 6 + (i*37) % 200));
+  }
+  CHECK(vol->freeClusterCount() == freeCount);
+  checkOpen(dir, model);
+  checkList(dir, model);
+  printf("%s reuse ok, %u files\n", label, (unsigned)model.size());
+}
+//------------------------------------------------------------------------------
+int main() {
+  RamBlockDevice dev;
+  ExFatVolume vol;
+  ExFatFile root;
+  ExFatFile sub;
+  formatRam(&dev, HOST_EXFAT);
+  CHECK(vol.begin(&dev));
+  CHECK(root.openRoot(&vol));
+  CHECK(sub.mkdir(&root, "Sub Dir"));
+  check(&vol, &root, "root");
+  check(&vol, &sub, "subdir");
+  CHECK(sub.close());
+  CHECK(vol.begin(&dev));
+  CHECK(sub.open(&vol, "SUB DIR", O_RDONLY));
+  CHECK(sub.isDir());
+  CHECK(sub.close());
+  return 0;
+}
@@ -0,0 +1,118 @@
+// FAT16 and FAT32 allocation with a RAM allocation bitmap compared with
+// the same operations on a volume that scans the FAT.  Both FATs must be
+// the same after each operation and the bitmap must match the FAT.
+#include <string.h>
+#include <string>
+#include <vector>
+#include "HostTest.h"
+
+static uint64_t seed = 88172645463325252ULL;
+static uint8_t buf[64*1024];
+//------------------------------------------------------------------------------
+static uint64_t rnd() {
+  seed ^= seed << 13;
+  seed ^= seed >> 7;
+  seed ^= seed << 17;
+  return seed;
+}
+//------------------------------------------------------------------------------
+static void checkFat(FatVolume* vol, FatVolume* ref,
+                     const std::vector<uint32_t>& bitmap) {
+  for (uint32_t c = 2; c < vol->clusterCount() + 2; c++) {
+    uint32_t f = 0;
+    uint32_t r = 0;
+    // fg is zero for end of chain.
+    int8_t fg = vol->dbgFat(c, &f);
+    CHECK(fg >= 0 && fg == ref->dbgFat(c, &r));
+    CHECK(f == r);
+    bool used = fg == 0 || f != 0;
+    CHECK(((bitmap[(c - 2)/32] >> ((c - 2) & 31)) & 1) == used);
+  }
+}
+//------------------------------------------------------------------------------
+static uint32_t usedCount(const std::vector<uint32_t>& bitmap) {
+  uint32_t n = 0;
+  for (uint32_t w : bitmap) {
+    n += __builtin_popcount(w);
+  }
+  return n;
+}
+//------------------------------------------------------------------------------
+// Apply operation op with parameter arg to a volume.
+static void apply(FatVolume* vol, uint32_t op, uint32_t arg) {
+  FatFile file;
+  std::string name = "file" + std::to_string(arg % 40);
+  uint32_t bpc = vol->bytesPerCluster();
+  uint32_t n = 1 + arg % 8;
+  bool exists = vol->exists(name.c_str());
+  if (op < 40) {
+    // Append clusters.
+    CHECK(file.open(vol, name.c_str(), O_RDWR | O_CREAT | O_AT_END));
+    for (uint32_t i = 0; i < n; i++) {
+      if (file.write(buf, bpc) != bpc) {
+        break;
+      }
+    }
+    CHECK(file.close());
+  } else if (op < 60) {
+    // Contiguous clusters.
+    if (!exists) {
+      CHECK(file.open(vol, name.c_str(), O_RDWR | O_CREAT));
+      file.preAllocate(bpc*(1 + arg % 200));
+      CHECK(file.close());
+    }
+  } else if (op < 75) {
+    if (exists) {
+      CHECK(file.open(vol, name.c_str(), O_RDWR));
+      CHECK(file.truncate(file.fileSize()/2));
+      CHECK(file.close());
+    }
+  } else if (exists) {
+    CHECK(vol->remove(name.c_str()));
+  }
+}
+//------------------------------------------------------------------------------
+static void check(HostFsType type) {
+  RamBlockDevice dev;
+  RamBlockDevice refDev;
+  FatVolume vol;
+  FatVolume ref;
+  formatRam(&dev, type);
+  formatRam(&refDev, type);
+  CHECK(vol.begin(&dev));
+  CHECK(ref.begin(&refDev));
+  CHECK(vol.bytesPerCluster() <= sizeof(buf));
+  std::vector<uint32_t> bitmap(vol.allocationBitmapWords());
+  CHECK(!vol.setAllocationBitmap(bitmap.data(), bitmap.size() - 1));
+  CHECK(vol.setAllocationBitmap(bitmap.data(), bitmap.size()));
+  for (int k = 0; k < 1500; k++) {
+    uint32_t op = rnd() % 100;
+    uint32_t arg = rnd();
+    apply(&vol, op, arg);
+    apply(&ref, op, arg);
+    if (k % 50 == 0) {
+      checkFat(&vol, &ref, bitmap);
+      CHECK(vol.freeClusterCount() ==
+            (int32_t)(vol.clusterCount() - usedCount(bitmap)));
+    }
+  }
+  checkFat(&vol, &ref, bitmap);
+  int32_t freeCount = vol.clusterCount() - usedCount(bitmap);
+  CHECK(vol.freeClusterCount() == freeCount);
+  CHECK(ref.freeClusterCount() == freeCount);
+  // The bitmap built after a remount must be the same.
+  std::vector<uint32_t> copy = bitmap;
+  CHECK(vol.begin(&dev));
+  CHECK(vol.freeClusterCount() == freeCount);
+  CHECK(vol.setAllocationBitmap(bitmap.data(), bitmap.size()));
+  CHECK(bitmap == copy);
+  CHECK(vol.freeClusterCount() == freeCount);
+  printf("%s ok, %u of %u clusters free\n", fsTypeName(type),
+         (unsigned)freeCount, (unsigned)vol.clusterCount());
+}
+//------------------------------------------------------------------------------
+int main() {
+  check(HOST_FAT16);
+  check(HOST_FAT32);
+  return 0;
+}
@@ -0,0 +1,206 @@
+// FAT directory name index checked against a model.  Random creates,
+// opens, removes, renames, rmdir and mkdir run with a FatDirIndex that
+// holds fewer directories than the volume has, so slots are replaced.
+// One directory has more names than a slot holds.
+#include <ctype.h>
+#include <map>
+#include <string>
+#include <vector>
+#include "HostTest.h"
+
+struct Entry {
+  std::string dir;
+  std::string name;
+  std::string data;
+};
+typedef std::map<std::string, Entry> Model;
+
+static uint64_t seed = 88172645463325252ULL;
+static int nameCount = 0;
+//------------------------------------------------------------------------------
+static uint64_t rnd() {
+  seed ^= seed << 13;
+  seed ^= seed >> 7;
+  seed ^= seed << 17;
+  return seed;
+}
+//------------------------------------------------------------------------------
+static std::string upper(const std::string& str) {
+  std::string rtn = str;
+  for (char& c : rtn) {
+    c = toupper(c);
+  }
+  return rtn;
+}
+//------------------------------------------------------------------------------
+// New name, short, lower case short, long or with lost characters.
+static std::string newName() {
+  std::string n = std::to_string(nameCount++);
+  switch (rnd() % 4) {
+    case 0:
+      return "F" + n + ".TXT";
+    case 1:
+      return "f" + n + ".txt";
+    case 2:
+      return "Long name " + n + std::string(rnd() % 80, 'x') + ".dat";
+    default:
+      return "a+b " + n + ".csv";
+  }
+}
+//------------------------------------------------------------------------------
+static std::string path(const std::string& dir, const std::string& name) {
+  return dir + "/" + name;
+}
+//------------------------------------------------------------------------------
+static void create(FatVolume* vol, Model* model, const std::string& dir) {
+  FatFile file;
+  std::string name = newName();
+  std::string p = path(dir, name);
+  CHECK(file.open(vol, p.c_str(), O_RDWR | O_CREAT | O_EXCL));
+  CHECK(file.write(p.c_str(), p.size()) == p.size());
+  CHECK(file.close());
+  (*model)[upper(p)] = {dir, name, p};
+}
+//------------------------------------------------------------------------------
+static void checkOpen(FatVolume* vol, const Entry& e) {
+  FatFile file;
+  char buf[200];
+  CHECK(file.open(vol, upper(path(e.dir, e.name)).c_str(), O_RDONLY));
+  CHECK(file.read(buf, sizeof(buf)) == (int)e.data.size());
+  CHECK(e.data.compare(0, e.data.size(), buf, e.data.size()) == 0);
+  CHECK(file.close());
+}
+//------------------------------------------------------------------------------
+static void checkDir(FatVolume* vol, const Model& model,
+                     const std::string& dir) {
+  FatFile dirFile;
+  FatFile file;
+  char name[256];
+  size_t n = 0;
+  CHECK(dirFile.open(vol, dir.empty() ? "/" : dir.c_str(), O_RDONLY));
+  while (file.openNext(&dirFile, O_RDONLY)) {
+    CHECK(file.getName(name, sizeof(name)));
+    bool isDir = file.isDir();
+    CHECK(file.close());
+    if (isDir) {
+      continue;
+    }
+    auto it = model.find(upper(path(dir, name)));
+    CHECK(it != model.end() && it->second.name == name);
+    n++;
+  }
+  for (auto& m : model) {
+    n -= m.second.dir == dir;
+  }
+  CHECK(n == 0);
+}
+//------------------------------------------------------------------------------
+static const Entry* randomFile(const Model& model) {
+  if (model.empty()) {
+    return nullptr;
+  }
+  auto it = model.begin();
+  std::advance(it, rnd() % model.size());
+  return &it->second;
+}
+//------------------------------------------------------------------------------
+static void check(HostFsType type) {
+  RamBlockDevice dev;
+  FatVolume vol;
+  FatDirIndexArray<3, 256> index;
+  Model model;
+  std::vector<std::string> dirs = {""};
+  int dirCount = 0;
+  formatRam(&dev, type);
+  CHECK(vol.begin(&dev));
+  vol.setDirIndex(&index);
+  // More names than a slot holds.
+  std::string big = "/Big directory";
+  CHECK(vol.mkdir(big.c_str()));
+  for (int i = 0; i < 400; i++) {
+    create(&vol, &model, big);
+  }
+  for (int i = 0; i < 6; i++) {
+    dirs.push_back("/Dir " + std::to_string(dirCount++));
+    CHECK(vol.mkdir(dirs.back().c_str()));
+  }
+  dirs.push_back(big);
+  for (int op = 0; op < 4000; op++) {
+    const std::string& dir = dirs[rnd() % dirs.size()];
+    const Entry* e = randomFile(model);
+    uint32_t r = rnd() % 100;
+    if (r < 35 || !e) {
+      create(&vol, &model, dir);
+    } else if (r < 55) {
+      checkOpen(&vol, *e);
+    } else if (r < 60) {
+      FatFile file;
+      std::string p = path(dir, newName());
+      CHECK(!file.open(&vol, p.c_str(), O_RDONLY));
+    } else if (r < 75) {
+      CHECK(vol.remove(path(e->dir, e->name).c_str()));
+      model.erase(upper(path(e->dir, e->name)));
+    } else if (r < 90) {
+      Entry n = {dir, newName(), e->data};
+      CHECK(vol.rename(path(e->dir, e->name).c_str(),
+                       path(n.dir, n.name).c_str()));
+      model.erase(upper(path(e->dir, e->name)));
+      model[upper(path(n.dir, n.name))] = n;
+      checkOpen(&vol, n);
+    } else if (r < 94 && dir != big && !dir.empty()) {
+      // Empty the directory, remove it and make a new directory that
+      // may use the same cluster.
+      for (auto it = model.begin(); it != model.end();) {
+        if (it->second.dir == dir) {
+          CHECK(vol.remove(path(dir, it->second.name).c_str()));
+          it = model.erase(it);
+        } else {
+          ++it;
+        }
+      }
+      // The slot for the removed directory must be dropped.
+      FatFile dirFile;
+      DirFat_t entry;
+      CHECK(dirFile.open(&vol, dir.c_str(), O_RDONLY));
+      CHECK(dirFile.dirEntry(&entry));
+      CHECK(dirFile.close());
+      uint32_t cluster = (uint32_t)getLe16(entry.firstClusterHigh) << 16 |
+                         getLe16(entry.firstClusterLow);
+      // A lookup indexes the directory.
+      CHECK(!dirFile.open(&vol, path(dir, "missing").c_str(), O_RDONLY));
+      CHECK(index.get(cluster));
+      CHECK(vol.rmdir(dir.c_str()));
+      CHECK(!index.get(cluster));
+      std::string newDir = "/Dir " + std::to_string(dirCount++);
+      CHECK(vol.mkdir(newDir.c_str()));
+      for (int i = 0; i < 5; i++) {
+        create(&vol, &model, newDir);
+      }
+      checkDir(&vol, model, newDir);
+      dirs[&dir - &dirs[0]] = newDir;
+    }
+    if (op % 500 == 499) {
+      for (auto& d : dirs) {
+        checkDir(&vol, model, d);
+      }
+    }
+  }
+  for (auto& m : model) {
+    checkOpen(&vol, m.second);
+  }
+  // The volume must match the model without an index.
+  CHECK(vol.begin(&dev));
+  for (auto& d : dirs) {
+    checkDir(&vol, model, d);
+  }
+  for (auto& m : model) {
+    checkOpen(&vol, m.second);
+  }
+  printf("%s ok, %u files\n", fsTypeName(type), (unsigned)model.size());
+}
+//------------------------------------------------------------------------------
+int main() {
+  check(HOST_FAT16);
+  check(HOST_FAT32);
+  return 0;
+}
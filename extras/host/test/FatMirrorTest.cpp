@@ -0,0 +1,142 @@
+// The second FAT must be the same as the first FAT after FatFile::sync()
+// and syncFatMirror().  Run with USE_DEFERRED_FAT_MIRROR nonzero and several
+// values of FS_CACHE_SECTOR_COUNT, see the variants in the Makefile.
+#include <string.h>
+#include <string>
+#include "HostTest.h"
+
+static uint64_t seed = 88172645463325252ULL;
+static uint8_t buf[32*1024];
+//------------------------------------------------------------------------------
+static uint64_t rnd() {
+  seed ^= seed << 13;
+  seed ^= seed >> 7;
+  seed ^= seed << 17;
+  return seed;
+}
+//------------------------------------------------------------------------------
+// RAM device that counts writes to the second FAT.
+class MirrorDevice : public RamBlockDevice {
+ public:
+  void setFat2(uint32_t bgn, uint32_t end) {
+    m_fat2Bgn = bgn;
+    m_fat2End = end;
+    m_fat2Writes = 0;
+  }
+  uint32_t fat2Writes() const {return m_fat2Writes;}
+
+ protected:
+  bool devWrite(uint32_t sector, const uint8_t* src, size_t ns) {
+    if (sector < m_fat2End && (sector + ns) > m_fat2Bgn) {
+      m_fat2Writes++;
+    }
+    return RamBlockDevice::devWrite(sector, src, ns);
+  }
+
+ private:
+  uint32_t m_fat2Bgn = 0;
+  uint32_t m_fat2End = 0;
+  uint32_t m_fat2Writes = 0;
+};
+//------------------------------------------------------------------------------
+static void checkMirror(MirrorDevice* dev, FatVolume* vol) {
+  uint8_t* fat1 = dev->data() + 512*vol->fatStartSector();
+  uint8_t* fat2 = fat1 + 512*vol->sectorsPerFat();
+  CHECK(memcmp(fat1, fat2, 512*vol->sectorsPerFat()) == 0);
+}
+//------------------------------------------------------------------------------
+// Random appends, preAllocate(), truncates and removes.
+static void randomOp(FatVolume* vol) {
+  FatFile file;
+  std::string name = "file" + std::to_string(rnd() % 30);
+  uint32_t bpc = vol->bytesPerCluster();
+  uint32_t op = rnd() % 100;
+  bool exists = vol->exists(name.c_str());
+  if (op < 40) {
+    CHECK(file.open(vol, name.c_str(), O_RDWR | O_CREAT | O_AT_END));
+    for (uint32_t n = 1 + rnd() % 4; n; n--) {
+      if (file.write(buf, bpc) != bpc) {
+        break;
+      }
+    }
+    CHECK(file.close());
+  } else if (op < 60) {
+    if (!exists) {
+      CHECK(file.open(vol, name.c_str(), O_RDWR | O_CREAT));
+      file.preAllocate(bpc*(1 + rnd() % 300));
+      CHECK(file.close());
+    }
+  } else if (op < 75) {
+    if (exists) {
+      CHECK(file.open(vol, name.c_str(), O_RDWR));
+      CHECK(file.truncate(file.fileSize()/2));
+      CHECK(file.close());
+    }
+  } else if (exists) {
+    CHECK(vol->remove(name.c_str()));
+  }
+}
+//------------------------------------------------------------------------------
+static void check(HostFsType type) {
+  MirrorDevice dev;
+  FatVolume vol;
+  FatFile file;
+  formatRam(&dev, type);
+  CHECK(vol.begin(&dev));
+  CHECK(vol.bytesPerCluster() <= sizeof(buf));
+  uint32_t fat2 = vol.fatStartSector() + vol.sectorsPerFat();
+  dev.setFat2(fat2, fat2 + vol.sectorsPerFat());
+  checkMirror(&dev, &vol);
+
+  // One cluster, the FAT change stays in one sector.
+  CHECK(file.open(&vol, "small", O_RDWR | O_CREAT));
+  CHECK(file.write(buf, vol.bytesPerCluster()) == vol.bytesPerCluster());
+#if USE_DEFERRED_FAT_MIRROR
+  CHECK(dev.fat2Writes() == 0);
+#endif  // USE_DEFERRED_FAT_MIRROR
+  CHECK(file.sync());
+  CHECK(dev.fat2Writes() > 0);
+  checkMirror(&dev, &vol);
+  CHECK(file.close());
+
+  // A chain that spans more FAT sectors than are deferred.
+  uint32_t perSector = 512/(type == HOST_FAT16 ? 2 : 4);
+  CHECK(40*perSector < vol.clusterCount());
+  dev.setFat2(fat2, fat2 + vol.sectorsPerFat());
+  CHECK(file.open(&vol, "large", O_RDWR | O_CREAT));
+  CHECK(file.preAllocate((uint64_t)40*perSector*vol.bytesPerCluster()));
+  CHECK(dev.fat2Writes() > 0);
+  CHECK(file.close());
+  checkMirror(&dev, &vol);
+  // Changes at both ends of the FAT.
+  CHECK(file.open(&vol, "small", O_RDWR | O_AT_END));
+  CHECK(file.write(buf, vol.bytesPerCluster()) == vol.bytesPerCluster());
+  CHECK(vol.remove("large"));
+  CHECK(file.write(buf, vol.bytesPerCluster()) == vol.bytesPerCluster());
+  CHECK(file.close());
+  checkMirror(&dev, &vol);
+
+  for (int k = 0; k < 2000; k++) {
+    randomOp(&vol);
+    if (k % 40 == 0) {
+      CHECK(vol.syncFatMirror());
+      checkMirror(&dev, &vol);
+    } else if (k % 20 == 0) {
+      CHECK(file.open(&vol, "small", O_RDWR | O_AT_END));
+      CHECK(file.write(buf, 100) == 100);
+      CHECK(file.sync());
+      checkMirror(&dev, &vol);
+      CHECK(file.close());
+    }
+  }
+  CHECK(vol.syncFatMirror());
+  checkMirror(&dev, &vol);
+  printf("%s ok, %u FAT sectors, cache %u\n", fsTypeName(type),
+         (unsigned)vol.sectorsPerFat(), (unsigned)FS_CACHE_SECTOR_COUNT);
+}
+//------------------------------------------------------------------------------
+int main() {
+  check(HOST_FAT16);
+  check(HOST_FAT32);
+  return 0;
+}
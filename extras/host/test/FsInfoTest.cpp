@@ -0,0 +1,127 @@
+// FAT32 FSInfo free count and next free hint.  FSInfo must be written by
+// sync, ignored if a signature is bad, and its values ignored if out of
+// range.  The free count is written as 0XFFFFFFFF while it is unknown.
+// The next free hint follows the first cluster of the last new chain.
+#include <string.h>
+#include "HostTest.h"
+
+static uint8_t buf[64*1024];
+//------------------------------------------------------------------------------
+// The FSInfo sector follows the boot sector of the first partition.
+static FsInfo_t* fsInfo(RamBlockDevice* dev) {
+  uint32_t sector = getLe32(dev->data() + 446 + 8) + 1;
+  return reinterpret_cast<FsInfo_t*>(dev->data() + 512*sector);
+}
+//------------------------------------------------------------------------------
+// Count free clusters in the first FAT on the device.
+static uint32_t fatFree(RamBlockDevice* dev, FatVolume* vol) {
+  const uint8_t* fat = dev->data() + 512*vol->fatStartSector();
+  uint32_t free = 0;
+  for (uint32_t c = 2; c < vol->clusterCount() + 2; c++) {
+    if ((getLe32(fat + 4*c) & 0X0FFFFFFF) == 0) {
+      free++;
+    }
+  }
+  return free;
+}
+//------------------------------------------------------------------------------
+// Create a file of n clusters and sync it.  Return its first cluster.
+static uint32_t addFile(FatVolume* vol, const char* name, uint32_t n) {
+  FatFile file;
+  CHECK(file.open(vol, name, O_RDWR | O_CREAT | O_EXCL));
+  for (uint32_t i = 0; i < n; i++) {
+    CHECK(file.write(buf, vol->bytesPerCluster()) == vol->bytesPerCluster());
+  }
+  CHECK(file.sync());
+  dir_t dir;
+  CHECK(file.dirEntry(&dir));
+  CHECK(file.close());
+  return (uint32_t)getLe16(dir.firstClusterHigh) << 16 |
+         getLe16(dir.firstClusterLow);
+}
+//------------------------------------------------------------------------------
+// Mount with FSInfo that must be ignored.
+static void checkIgnored(RamBlockDevice* dev, FatVolume* vol,
+                         const char* name, bool signatureOk) {
+  FsInfo_t* fsi = fsInfo(dev);
+  uint8_t save[512];
+  CHECK(vol->begin(dev));
+  uint32_t free = fatFree(dev, vol);
+  dev->clearStats();
+  CHECK(vol->freeClusterCount() == (int32_t)free);
+  CHECK(dev->readCalls() > 0);
+  memcpy(save, fsi, 512);
+  // The search for free clusters must start at the beginning.
+  CHECK(addFile(vol, name, 1) < 1000);
+  if (!signatureOk) {
+    CHECK(memcmp(save, fsi, 512) == 0);
+  } else {
+    CHECK(getLe32(fsi->freeCount) == free - 1);
+  }
+}
+//------------------------------------------------------------------------------
+int main() {
+#if USE_FAT_FSINFO && MAINTAIN_FREE_CLUSTER_COUNT
+  RamBlockDevice dev;
+  FatVolume vol;
+  formatRam(&dev, HOST_FAT32);
+  FsInfo_t* fsi = fsInfo(&dev);
+  CHECK(getLe32(fsi->freeCount) == 0XFFFFFFFF);
+  CHECK(vol.begin(&dev));
+
+  // The count is unknown until freeClusterCount() is called.
+  uint32_t first = addFile(&vol, "a", 3);
+  CHECK(getLe32(fsi->freeCount) == 0XFFFFFFFF);
+  CHECK(getLe32(fsi->nextFree) == first + 1);
+  CHECK(vol.freeClusterCount() == (int32_t)fatFree(&dev, &vol));
+  first = addFile(&vol, "b", 5);
+  CHECK(getLe32(fsi->freeCount) == fatFree(&dev, &vol));
+  CHECK(getLe32(fsi->nextFree) == first + 1);
+
+  // A mount uses the count without a scan of the FAT.
+  CHECK(vol.begin(&dev));
+  dev.clearStats();
+  CHECK(vol.freeClusterCount() == (int32_t)fatFree(&dev, &vol));
+  CHECK(dev.readCalls() == 0);
+
+  // A mount uses the next free hint.
+  setLe32(fsi->nextFree, 1000);
+  CHECK(vol.begin(&dev));
+  CHECK(addFile(&vol, "c", 2) == 1000);
+  CHECK(getLe32(fsi->nextFree) == 1001);
+  CHECK(getLe32(fsi->freeCount) == fatFree(&dev, &vol));
+
+  // Bad signatures.
+  uint8_t* sig[] = {fsi->leadSignature, fsi->structSignature,
+                    fsi->trailSignature};
+  const char* names[] = {"lead", "struct", "trail"};
+  for (int i = 0; i < 3; i++) {
+    uint32_t good = getLe32(sig[i]);
+    setLe32(sig[i], good ^ 1);
+    setLe32(fsi->freeCount, 5);
+    setLe32(fsi->nextFree, 1000);
+    checkIgnored(&dev, &vol, names[i], false);
+    setLe32(sig[i], good);
+  }
+
+  // Out of range values.
+  setLe32(fsi->freeCount, vol.clusterCount() + 1);
+  setLe32(fsi->nextFree, vol.clusterCount() + 2);
+  checkIgnored(&dev, &vol, "range1", true);
+  setLe32(fsi->freeCount, vol.clusterCount() + 1);
+  setLe32(fsi->nextFree, 1);
+  checkIgnored(&dev, &vol, "range2", true);
+
+  // An out of range count is unknown and written as 0XFFFFFFFF.
+  setLe32(fsi->freeCount, 0X80000000);
+  CHECK(vol.begin(&dev));
+  first = addFile(&vol, "d", 1);
+  CHECK(getLe32(fsi->freeCount) == 0XFFFFFFFF);
+  CHECK(getLe32(fsi->nextFree) == first + 1);
+  CHECK(vol.freeClusterCount() == (int32_t)fatFree(&dev, &vol));
+  printf("FAT32 ok, %u free clusters\n", (unsigned)vol.freeClusterCount());
+#else  // USE_FAT_FSINFO && MAINTAIN_FREE_CLUSTER_COUNT
+  printf("FSInfo not used\n");
+#endif  // USE_FAT_FSINFO && MAINTAIN_FREE_CLUSTER_COUNT
+  return 0;
+}
@@ -0,0 +1,208 @@
+// Integer formatting and extraction checked against a reference built on
+// snprintf and strtoull.  Covers the ostream inserters and istream
+// extractors for all integer types with base, showbase, showpos,
+// uppercase, width and adjust flags, plus fmtBase10() and fmtUnsigned().
+//
+// Usage: IntFormatTest [count]
+#include <errno.h>
+#include <string.h>
+#include <string>
+#include "HostTest.h"
+#include "iostream/bufstream.h"
+#include "common/FmtNumber.h"
+
+static uint64_t seed = 88172645463325252ULL;
+//------------------------------------------------------------------------------
+static uint64_t rnd() {
+  seed ^= seed << 13;
+  seed ^= seed >> 7;
+  seed ^= seed << 17;
+  return seed;
+}
+//------------------------------------------------------------------------------
+// Random value with a random number of significant bits.
+static uint64_t rndBits() {
+  uint64_t r = rnd();
+  int bits = rnd() % 65;
+  return bits == 64 ? r : r & ((1ULL << bits) - 1);
+}
+//------------------------------------------------------------------------------
+// Expected ostream output.  Negative values are printed in hex and octal
+// as 32-bit two's complement or as 64-bit for types wider than 32 bits.
+template<typename T>
+static std::string refInsert(T v, int flags) {
+  char digits[30];
+  bool isSigned = (T)-1 < 0;
+  bool neg = isSigned && (long long)v < 0;  // NOLINT
+  int base = flags & 1 ? 16 : flags & 2 ? 8 : 10;
+  unsigned long long u;  // NOLINT
+  if (neg && base == 10) {
+    u = 0 - (unsigned long long)(long long)v;  // NOLINT
+  } else if (neg && sizeof(T) <= 4) {
+    u = (uint32_t)v;
+  } else {
+    u = (unsigned long long)v;  // NOLINT
+  }
+  snprintf(digits, sizeof(digits),
+           base == 10 ? "%llu" : base == 8 ? "%llo" : flags & 8 ? "%llX" :
+           "%llx", u);
+  std::string prefix;
+  if (base == 10) {
+    if (neg) {
+      prefix = "-";
+    } else if (flags & 16) {
+      prefix = "+";
+    }
+  } else if (flags & 4) {
+    prefix = base == 8 ? "0" : flags & 8 ? "0X" : "0x";
+  }
+  std::string str = prefix + digits;
+  if ((flags & 32) && str.size() < 24) {
+    std::string fill(24 - str.size(), ' ');
+    if (flags & 64) {
+      str += fill;
+    } else if (flags & 128) {
+      str = prefix + fill + digits;
+    } else {
+      str = fill + str;
+    }
+  }
+  return str;
+}
+//------------------------------------------------------------------------------
+template<typename T>
+static void checkInsert(T v, int flags) {
+  char buf[100];
+  obufstream ob(buf, sizeof(buf));
+  if (flags & 1) {
+    ob << hex;
+  } else if (flags & 2) {
+    ob << oct;
+  }
+  if (flags & 4) {
+    ob << showbase;
+  }
+  if (flags & 8) {
+    ob << uppercase;
+  }
+  if (flags & 16) {
+    ob << showpos;
+  }
+  if (flags & 32) {
+    ob << setw(24);
+  }
+  if (flags & 64) {
+    ob << left;
+  } else if (flags & 128) {
+    ob << internal;
+  }
+  ob << v;
+  CHECK(ob.good());
+  std::string ref = refInsert(v, flags);
+  if (ref != buf) {
+    printf("size %d flags %d ostream '%s' ref '%s'\n",
+           (int)sizeof(T), flags, buf, ref.c_str());
+    CHECK(false);
+  }
+}
+//------------------------------------------------------------------------------
+// Extract str as T in base and compare with strtoull and the range of T.
+template<typename T>
+static void checkExtract(const char* str, int base) {
+  bool isSigned = (T)-1 < 0;
+  const char* digits = str;
+  bool neg = *digits == '-';
+  if (*digits == '-' || *digits == '+') {
+    digits++;
+  }
+  errno = 0;
+  unsigned long long mag = strtoull(digits, nullptr, base);  // NOLINT
+  // Largest magnitude, one more for a negative signed value.
+  unsigned long long max = isSigned ?  // NOLINT
+      (1ULL << (8*sizeof(T) - 1)) - 1 + neg :
+      (unsigned long long)(T)-1;  // NOLINT
+  bool ok = errno == 0 && mag <= max;
+  T expect = neg ? (T)(0 - mag) : (T)mag;
+  T v = 0;
+  ibufstream ib(str);
+  if (base == 16) {
+    ib >> hex;
+  } else if (base == 8) {
+    ib >> oct;
+  }
+  ib >> v;
+  if (ok != !ib.fail() || (ok && v != expect)) {
+    printf("size %d base %d '%s' ok %d fail %d\n",
+           (int)sizeof(T), base, str, ok, ib.fail());
+    CHECK(false);
+  }
+}
+//------------------------------------------------------------------------------
+template<typename T>
+static void checkExtract(uint64_t mag, bool neg, int base) {
+  char str[40];
+  snprintf(str, sizeof(str),
+           base == 10 ? "%s%llu" : base == 8 ? "%s%llo" : "%s0x%llx",
+           neg ? "-" : "", (unsigned long long)mag);  // NOLINT
+  checkExtract<T>(str, base);
+}
+//------------------------------------------------------------------------------
+static void checkFmt(uint64_t u) {
+  char buf[30];
+  char ref[30];
+  char* end = buf + sizeof(buf) - 1;
+  *end = '\0';
+  snprintf(ref, sizeof(ref), "%llu", (unsigned long long)u);  // NOLINT
+  CHECK(strcmp(fmtBase10(end, u), ref) == 0);
+  CHECK(strcmp(fmtUnsigned(end, u, 10, false), ref) == 0);
+  snprintf(ref, sizeof(ref), "%llX", (unsigned long long)u);  // NOLINT
+  CHECK(strcmp(fmtUnsigned(end, u, 16, true), ref) == 0);
+  snprintf(ref, sizeof(ref), "%llo", (unsigned long long)u);  // NOLINT
+  CHECK(strcmp(fmtUnsigned(end, u, 8, false), ref) == 0);
+  snprintf(ref, sizeof(ref), "%u", (uint32_t)u);
+  CHECK(strcmp(fmtBase10(end, (uint32_t)u), ref) == 0);
+  snprintf(ref, sizeof(ref), "%x", (uint32_t)u);
+  CHECK(strcmp(fmtUnsigned(end, (uint32_t)u, 16, false), ref) == 0);
+}
+//------------------------------------------------------------------------------
+int main(int argc, char** argv) {
+  long count = argc > 1 ? atol(argv[1]) : 200000;  // NOLINT
+  const char* edge[] = {"0", "-0", "+7", "0x", "127", "128", "-128", "-129",
+    "32767", "-32768", "32768", "65535", "65536", "2147483647",
+    "-2147483648", "2147483648", "4294967295", "4294967296",
+    "9223372036854775807", "-9223372036854775808", "9223372036854775808",
+    "18446744073709551615", "18446744073709551616",
+    "99999999999999999999999"};
+  for (const char* str : edge) {
+    checkExtract<short>(str, 10);  // NOLINT
+    checkExtract<unsigned short>(str, 10);  // NOLINT
+    checkExtract<int>(str, 10);
+    checkExtract<unsigned int>(str, 10);
+    checkExtract<long>(str, 10);  // NOLINT
+    checkExtract<unsigned long>(str, 10);  // NOLINT
+  }
+  for (long i = 0; i < count; i++) {  // NOLINT
+    uint64_t r = rndBits();
+    int flags = rnd() & 0XFF;
+    checkInsert((short)r, flags);  // NOLINT
+    checkInsert((unsigned short)r, flags);  // NOLINT
+    checkInsert((int)r, flags);
+    checkInsert((unsigned int)r, flags);
+    checkInsert((long)r, flags);  // NOLINT
+    checkInsert((unsigned long)r, flags);  // NOLINT
+    checkInsert((long long)r, flags);  // NOLINT
+    checkInsert((unsigned long long)r, flags);  // NOLINT
+    checkFmt(r);
+
+    bool neg = rnd() & 1;
+    int base = flags & 1 ? 16 : flags & 2 ? 8 : 10;
+    checkExtract<short>(r, neg, base);  // NOLINT
+    checkExtract<unsigned short>(r, neg, base);  // NOLINT
+    checkExtract<int>(r, neg, base);
+    checkExtract<unsigned int>(r, neg, base);
+    checkExtract<long>(r, neg, base);  // NOLINT
+    checkExtract<unsigned long>(r, neg, base);  // NOLINT
+  }
+  printf("ok %ld values\n", count);
+  return 0;
+}
@@ -0,0 +1,131 @@
+// Reads that overlap sectors held by the write-behind buffer or the
+// read-ahead buffer.  Random writes, aligned sector writes, reads,
+// truncates and reads by a second file are checked against a model.  Run
+// with FS_WRITE_BUFFER_SECTORS and FS_READ_AHEAD_SECTORS nonzero, see the
+// variants in the Makefile.
+#include <algorithm>
+#include <string>
+#include "HostTest.h"
+
+static uint64_t seed = 88172645463325252ULL;
+//------------------------------------------------------------------------------
+static uint64_t rnd() {
+  seed ^= seed << 13;
+  seed ^= seed >> 7;
+  seed ^= seed << 17;
+  return seed;
+}
+//------------------------------------------------------------------------------
+static std::string rndData(size_t n) {
+  std::string s(n, 0);
+  for (auto& c : s) {
+    c = rnd();
+  }
+  return s;
+}
+//------------------------------------------------------------------------------
+static void checkRead(FsFile* file, const std::string& model, size_t pos,
+                      size_t n) {
+  std::string got(n, 0);
+  if (pos > model.size()) {
+    pos = model.size();
+  }
+  if (n > model.size() - pos) {
+    n = model.size() - pos;
+  }
+  CHECK(file->seekSet(pos));
+  CHECK(file->read(&got[0], got.size()) == (int)n);
+  CHECK(got.compare(0, n, model, pos, n) == 0);
+}
+//------------------------------------------------------------------------------
+static void checkFile(FsVolume* vol, const char* path,
+                      const std::string& model) {
+  FsFile file;
+  CHECK(file.open(vol, path, O_RDONLY));
+  CHECK(file.fileSize() == model.size());
+  checkRead(&file, model, 0, model.size() + 1);
+  CHECK(file.close());
+}
+//------------------------------------------------------------------------------
+static void write(FsFile* file, std::string* model, size_t pos,
+                  const std::string& data) {
+  CHECK(file->seekSet(pos));
+  CHECK(file->write(data.data(), data.size()) == data.size());
+  if (model->size() < pos + data.size()) {
+    model->resize(pos + data.size());
+  }
+  model->replace(pos, data.size(), data);
+}
+//------------------------------------------------------------------------------
+static void check(HostFsType type) {
+  RamBlockDevice dev;
+  FsVolume vol;
+  FsFile file;
+  std::string model;
+  const char* path = "/data.bin";
+  formatRam(&dev, type);
+  CHECK(vol.begin(&dev));
+  CHECK(file.open(&vol, path, O_RDWR | O_CREAT));
+  for (int k = 0; k < 3000; k++) {
+    uint32_t op = rnd() % 100;
+    size_t pos = rnd() % 2 ? model.size() : rnd() % (model.size() + 1);
+    if (op < 35) {
+      // Records that fill sectors held by the buffer.
+      write(&file, &model, pos, rndData(1 + rnd() % 2000));
+    } else if (op < 50) {
+      // Aligned writes of one or more sectors.
+      pos &= ~511;
+      write(&file, &model, pos, rndData(512*(1 + rnd() % 12)));
+    } else if (op < 60) {
+      // Read back the end of a write that may still be buffered.
+      checkRead(&file, model, model.size() - model.size() % 512, 512);
+    } else if (op < 75) {
+      checkRead(&file, model, pos, 1 + rnd() % 600);
+    } else if (op < 85) {
+      // Direct reads of whole sectors.
+      checkRead(&file, model, pos & ~511, 512*(1 + rnd() % 16));
+    } else if (op < 88) {
+      size_t length = model.size() - rnd() % (model.size()/4 + 1);
+      CHECK(file.truncate(length));
+      model.resize(length);
+    } else if (op < 92) {
+      // A second file sees the data after a sync.
+      CHECK(file.sync());
+      checkFile(&vol, path, model);
+    } else if (op < 97) {
+      // Small reads by a second file use read-ahead.  Writes by the first
+      // file must replace sectors that were read ahead.
+      CHECK(file.sync());
+      FsFile reader;
+      CHECK(reader.open(&vol, path, O_RDONLY));
+      for (size_t at = 0; at < model.size();) {
+        size_t n = 1 + rnd() % 100;
+        checkRead(&reader, model, at, n);
+        at += n;
+        size_t end = at + rnd() % 2048;
+        if (rnd() % 8 == 0 && end < model.size()) {
+          size_t len = 1 + rnd() % 1024;
+          write(&file, &model, end, rndData(std::min(len, model.size() - end)));
+        }
+      }
+      CHECK(reader.close());
+    } else if (model.size() > 300000) {
+      CHECK(file.truncate(rnd() % 1000));
+      model.resize(file.fileSize());
+    }
+  }
+  CHECK(file.close());
+  checkFile(&vol, path, model);
+  CHECK(vol.begin(&dev));
+  checkFile(&vol, path, model);
+  printf("%s ok, %u bytes, writes %u/%u\n", fsTypeName(type),
+         (unsigned)model.size(), (unsigned)dev.writeCalls(),
+         (unsigned)dev.sectorsWritten());
+}
+//------------------------------------------------------------------------------
+int main() {
+  check(HOST_FAT16);
+  check(HOST_FAT32);
+  check(HOST_EXFAT);
+  return 0;
+}
@@ -0,0 +1,146 @@
+// fgets() and readLine() compared with a byte at a time fgets() on
+// fragmented files with CR, LF, NUL and other delimiters, several
+// buffer sizes and random seeks.
+#include <string.h>
+#include "HostTest.h"
+#include "common/FsLineScan.h"
+//------------------------------------------------------------------------------
+// fgets() as it was before lines were scanned in the cache.
+static int refFgets(FsFile* file, char* str, int num, const char* delim) {
+  char ch;
+  int n = 0;
+  int r = -1;
+  while ((n + 1) < num && (r = file->read(&ch, 1)) == 1) {
+    if (ch == '\r') {
+      continue;
+    }
+    str[n++] = ch;
+    if (!delim) {
+      if (ch == '\n') {
+        break;
+      }
+    } else if (strchr(delim, ch)) {
+      break;
+    }
+  }
+  if (r < 0) {
+    return -1;
+  }
+  str[n] = '\0';
+  return n;
+}
+//------------------------------------------------------------------------------
+static void writeFiles(FsVolume* vol) {
+  static const char alpha[] = "abc\r\n,;xyz\n\r\n\0";
+  static char chunk[70000];
+  FsFile a;
+  FsFile b;
+  CHECK(a.open(vol, "a.txt", O_RDWR | O_CREAT | O_TRUNC));
+  CHECK(b.open(vol, "b.txt", O_RDWR | O_CREAT | O_TRUNC));
+  // Interleave writes so the files are fragmented.
+  for (int k = 0; k < 6; k++) {
+    int len = rand() % 70000;
+    for (int i = 0; i < len; i++) {
+      chunk[i] = rand() % 8 ? alpha[rand() % sizeof(alpha)]
+                            : 'a' + rand() % 26;
+    }
+    if (k % 3 == 0) {
+      // long lines
+      for (int i = 0; i < len; i++) {
+        if (chunk[i] == '\n' && rand() % 4) {
+          chunk[i] = 'q';
+        }
+      }
+    }
+    CHECK(a.write(chunk, len) == (size_t)len);
+    CHECK(b.write(chunk, len / 3) == (size_t)len / 3);
+  }
+  CHECK(a.close());
+  CHECK(b.close());
+}
+//------------------------------------------------------------------------------
+static void checkFgets(FsVolume* vol, const char* name, const char* delim,
+                       int num) {
+  static char s1[100001];
+  static char s2[100001];
+  FsFile x;
+  FsFile y;
+  CHECK(x.open(vol, name, O_RDONLY));
+  CHECK(y.open(vol, name, O_RDONLY));
+  for (int i = 0;; i++) {
+    int r1 = refFgets(&x, s1, num, delim);
+    int r2 = y.fgets(s2, num, const_cast<char*>(delim));
+    CHECK(r1 == r2);
+    CHECK(r1 < 0 || memcmp(s1, s2, r1 + 1) == 0);
+    CHECK(x.curPosition() == y.curPosition());
+    if (r1 <= 0 || (num == 1 && i > 3)) {
+      break;
+    }
+    if (i % 50 == 7) {
+      uint64_t pos = rand() % (x.fileSize() + 1);
+      CHECK(x.seekSet(pos));
+      CHECK(y.seekSet(pos));
+    }
+  }
+}
+//------------------------------------------------------------------------------
+// Return the number of lines returned in the cache.
+static long checkReadLine(FsVolume* vol, const char* name,
+                          const char* delim, int num) {
+  static char s1[100001];
+  static char s2[100001];
+  FsLineScan scan(delim);
+  long views = 0;
+  FsFile x;
+  FsFile y;
+  CHECK(x.open(vol, name, O_RDONLY));
+  CHECK(y.open(vol, name, O_RDONLY));
+  while (true) {
+    const char* line;
+    int r1 = refFgets(&x, s1, num, delim);
+    int r2 = y.readLine(&line, s2, num, delim);
+    if (r1 == 0) {
+      CHECK(r2 == -1);
+      break;
+    }
+    int len = r1 > 0 && scan.isDelim(s1[r1 - 1]) ? r1 - 1 : r1;
+    CHECK(r2 == len);
+    CHECK(memcmp(line, s1, len) == 0);
+    if (line == s2) {
+      CHECK(s2[len] == '\0');
+    } else {
+      views++;
+    }
+    CHECK(x.curPosition() == y.curPosition());
+  }
+  return views;
+}
+//------------------------------------------------------------------------------
+int main() {
+  const char* delims[] = {nullptr, "\n", ",", ",;\n", "\r", "", "\r\n"};
+  const char* names[] = {"a.txt", "b.txt"};
+  const int nums[] = {1, 2, 3, 7, 64, 513, 2000, 100000};
+  HostFsType types[] = {HOST_FAT16, HOST_FAT32, HOST_EXFAT};
+  srand(1);
+  for (HostFsType type : types) {
+    RamBlockDevice dev;
+    FsVolume vol;
+    long views = 0;
+    formatRam(&dev, type);
+    CHECK(vol.begin(&dev));
+    writeFiles(&vol);
+    for (const char* name : names) {
+      for (const char* delim : delims) {
+        for (int num : nums) {
+          checkFgets(&vol, name, delim, num);
+          if (num > 1) {
+            views += checkReadLine(&vol, name, delim, num);
+          }
+        }
+      }
+    }
+    CHECK(views > 0);
+    printf("%s ok, %ld lines in cache\n", fsTypeName(type), views);
+  }
+  return 0;
+}
@@ -0,0 +1,100 @@
+// Recursive ls() and FsDirIterator compared with a list made by
+// openNext() and getName() for a tree with names longer than an
+// FsDirEntry name.
+#include <string.h>
+#include <string>
+#include <vector>
+#include "HostTest.h"
+#include "common/FsDirIterator.h"
+//------------------------------------------------------------------------------
+class StringPrint : public print_t {
+ public:
+  size_t write(uint8_t b) {
+    str += static_cast<char>(b);
+    return 1;
+  }
+  using print_t::write;
+  std::string str;
+};
+//------------------------------------------------------------------------------
+static std::string longName(int i) {
+  std::string name = "entry " + std::to_string(i) + " ";
+  name += std::string(i % 3 ? 20 : 100, 'a' + i % 26);
+  return i % 4 ? name + ".txt" : name;
+}
+//------------------------------------------------------------------------------
+static void makeTree(FsVolume* vol, const std::string& path, int depth) {
+  for (int i = 0; i < 12; i++) {
+    std::string name = path + "/" + longName(i + 12*depth);
+    if (depth < 3 && i % 5 == 0) {
+      CHECK(vol->mkdir(name.c_str()));
+      makeTree(vol, name, depth + 1);
+    } else {
+      FsFile file;
+      CHECK(file.open(vol, name.c_str(), O_RDWR | O_CREAT));
+      CHECK(file.close());
+    }
+  }
+}
+//------------------------------------------------------------------------------
+// ls() as it was before readDir().
+static void refLs(FsFile* dir, std::string* str, int indent) {
+  FsFile file;
+  char name[256];
+  dir->rewind();
+  while (file.openNext(dir, O_RDONLY)) {
+    CHECK(file.getName(name, sizeof(name)));
+    *str += std::string(indent, ' ') + name;
+    if (file.isDir()) {
+      *str += "/";
+    }
+    *str += "\r\n";
+    if (file.isDir()) {
+      refLs(&file, str, indent + 2);
+    }
+    file.close();
+  }
+}
+//------------------------------------------------------------------------------
+static void checkIterator(FsFile* dir, size_t size) {
+  char name[256];
+  std::vector<std::string> ref;
+  FsFile file;
+  dir->rewind();
+  while (file.openNext(dir, O_RDONLY)) {
+    file.getName(name, size);
+    ref.push_back(name);
+    file.close();
+  }
+  size_t n = 0;
+  dir->rewind();
+  FsDirIterator<FsFile> it(dir, name, size);
+  while (it.next(O_RDONLY)) {
+    CHECK(n < ref.size() && ref[n++] == name);
+    CHECK(it.file()->isOpen());
+  }
+  CHECK(n == ref.size());
+}
+//------------------------------------------------------------------------------
+int main() {
+  HostFsType types[] = {HOST_FAT16, HOST_FAT32, HOST_EXFAT};
+  for (HostFsType type : types) {
+    RamBlockDevice dev;
+    FsVolume vol;
+    FsFile root;
+    StringPrint sp;
+    std::string ref;
+    formatRam(&dev, type);
+    CHECK(vol.begin(&dev));
+    makeTree(&vol, "", 0);
+    CHECK(root.open(&vol, "/", O_RDONLY));
+    refLs(&root, &ref, 0);
+    root.ls(&sp, LS_R);
+    CHECK(sp.str == ref);
+    for (size_t size : {13, 20, 64, 256}) {
+      checkIterator(&root, size);
+    }
+    printf("%s ok\n", fsTypeName(type));
+  }
+  return 0;
+}
@@ -0,0 +1,100 @@
+// openNext(dir, oflag, name, size) compared with openNext() and getName()
+// for a directory of 8571 names with buffer sizes from 13 to 256.  Names
+// are short names, long names of up to 255 characters, and names of files
+// that have been removed and replaced.  The names must be read in one
+// forward pass over the directory.
+#include <string>
+#include <vector>
+#include "HostTest.h"
+
+const int NAME_COUNT = 8571;
+//------------------------------------------------------------------------------
+static std::string fileName(int i) {
+  std::string name = std::to_string(i);
+  if (i % 7 == 0) {
+    return "F" + name + ".TXT";
+  }
+  size_t len = i % 50 == 1 ? 200 + i % 52 : 8 + (37*i) % 40;
+  name += " ";
+  while (name.size() < len) {
+    name += 'a' + (name.size() + i) % 26;
+  }
+  return i % 3 ? name + ".dat" : name;
+}
+//------------------------------------------------------------------------------
+// Sectors read by a pass over a directory with openNext().
+static uint32_t scanReads(RamBlockDevice* dev, FsFile* dir) {
+  FsFile file;
+  dir->rewind();
+  dev->clearStats();
+  while (file.openNext(dir, O_RDONLY)) {
+    file.close();
+  }
+  return dev->sectorsRead();
+}
+//------------------------------------------------------------------------------
+// Names from openNext() and getName().
+static std::vector<std::string> refNames(FsFile* dir, size_t size) {
+  std::vector<std::string> ref;
+  FsFile file;
+  char name[256];
+  dir->rewind();
+  while (file.openNext(dir, O_RDONLY)) {
+    file.getName(name, size);
+    ref.push_back(name);
+    file.close();
+  }
+  return ref;
+}
+//------------------------------------------------------------------------------
+static void check(HostFsType type) {
+  RamBlockDevice dev;
+  FsVolume vol;
+  FsFile dir;
+  FsFile file;
+  char name[256];
+  formatRam(&dev, type);
+  CHECK(vol.begin(&dev));
+  CHECK(vol.mkdir("dir"));
+  CHECK(dir.open(&vol, "dir", O_RDONLY));
+  for (int i = 0; i < NAME_COUNT; i++) {
+    CHECK(file.open(&dir, fileName(i).c_str(), O_RDWR | O_CREAT));
+    CHECK(file.close());
+  }
+  // Free entries are reused by new names of other lengths.
+  for (int i = 0; i < NAME_COUNT; i += 97) {
+    CHECK(dir.remove(fileName(i).c_str()));
+    CHECK(file.open(&dir, fileName(i + NAME_COUNT).c_str(),
+                    O_RDWR | O_CREAT));
+    CHECK(file.close());
+  }
+  uint32_t scan = scanReads(&dev, &dir);
+  uint32_t refReads = 0;
+  uint32_t reads = 0;
+  for (size_t size = 13; size <= 256; size++) {
+    dev.clearStats();
+    std::vector<std::string> ref = refNames(&dir, size);
+    refReads = dev.sectorsRead();
+    CHECK(ref.size() == NAME_COUNT);
+    size_t n = 0;
+    dir.rewind();
+    dev.clearStats();
+    while (file.openNext(&dir, O_RDONLY, name, size)) {
+      CHECK(n < ref.size() && ref[n++] == name);
+      CHECK(file.isOpen());
+      file.close();
+    }
+    reads = dev.sectorsRead();
+    CHECK(n == ref.size());
+    // No sector is read more than once.
+    CHECK(reads <= scan);
+  }
+  printf("%s ok, %u reads, getName() %u reads\n", fsTypeName(type),
+         (unsigned)reads, (unsigned)refReads);
+}
+//------------------------------------------------------------------------------
+int main() {
+  check(HOST_FAT32);
+  check(HOST_EXFAT);
+  return 0;
+}
@@ -0,0 +1,198 @@
+// Path opens after directories are renamed, moved, removed and made
+// again.  A cached path component must never open a directory that has
+// been renamed or removed.  Random operations are checked against a model
+// of the tree.  Run with FS_PATH_CACHE_ENTRIES nonzero, see the variants
+// in the Makefile.
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include "HostTest.h"
+
+typedef std::map<std::string, std::string> Files;
+typedef std::set<std::string> Dirs;
+
+static uint64_t seed = 88172645463325252ULL;
+static int nameCount = 0;
+//------------------------------------------------------------------------------
+static uint64_t rnd() {
+  seed ^= seed << 13;
+  seed ^= seed >> 7;
+  seed ^= seed << 17;
+  return seed;
+}
+//------------------------------------------------------------------------------
+// Short names are cached, names longer than 16 bytes are not.
+static std::string newName() {
+  std::string n = std::to_string(nameCount++);
+  return rnd() % 4 ? "d" + n : "Directory name " + n;
+}
+//------------------------------------------------------------------------------
+static bool under(const std::string& path, const std::string& dir) {
+  return path.compare(0, dir.size() + 1, dir + "/") == 0;
+}
+//------------------------------------------------------------------------------
+static void create(FsVolume* vol, Files* files, const std::string& path) {
+  FsFile file;
+  CHECK(file.open(vol, path.c_str(), O_RDWR | O_CREAT | O_EXCL));
+  std::string data = path + " " + std::to_string(nameCount++);
+  CHECK(file.write(data.data(), data.size()) == data.size());
+  CHECK(file.close());
+  (*files)[path] = data;
+}
+//------------------------------------------------------------------------------
+static void checkOpen(FsVolume* vol, const std::string& path,
+                      const std::string& data) {
+  FsFile file;
+  char buf[200];
+  CHECK(file.open(vol, path.c_str(), O_RDONLY));
+  CHECK(file.read(buf, sizeof(buf)) == (int)data.size());
+  CHECK(data.compare(0, data.size(), buf, data.size()) == 0);
+  CHECK(file.close());
+}
+//------------------------------------------------------------------------------
+static std::string pickDir(const Dirs& dirs) {
+  auto it = dirs.begin();
+  std::advance(it, rnd() % dirs.size());
+  return *it;
+}
+//------------------------------------------------------------------------------
+static std::string pickFile(const Files& files) {
+  auto it = files.begin();
+  std::advance(it, rnd() % files.size());
+  return it->first;
+}
+//------------------------------------------------------------------------------
+// Rename or move dir to a new name in a directory that is not under it.
+static void moveDir(FsVolume* vol, Dirs* dirs, Files* files,
+                    std::vector<std::string>* gone, const std::string& dir) {
+  std::string parent = pickDir(*dirs);
+  if (parent == dir || under(parent, dir)) {
+    parent = dir.substr(0, dir.rfind('/'));
+  }
+  std::string to = parent + "/" + newName();
+  CHECK(vol->rename(dir.c_str(), to.c_str()));
+  Dirs newDirs;
+  for (auto& d : *dirs) {
+    newDirs.insert(d == dir || under(d, dir) ? to + d.substr(dir.size()) : d);
+  }
+  *dirs = newDirs;
+  Files newFiles;
+  for (auto& f : *files) {
+    if (under(f.first, dir)) {
+      gone->push_back(f.first);
+      newFiles[to + f.first.substr(dir.size())] = f.second;
+    } else {
+      newFiles.insert(f);
+    }
+  }
+  *files = newFiles;
+}
+//------------------------------------------------------------------------------
+// Remove the files of a leaf directory and the directory, then make a
+// directory with the same name.
+static void remakeDir(FsVolume* vol, Dirs* dirs, Files* files,
+                      std::vector<std::string>* gone, const std::string& dir) {
+  for (auto& d : *dirs) {
+    if (under(d, dir)) {
+      return;
+    }
+  }
+  for (auto it = files->begin(); it != files->end();) {
+    if (under(it->first, dir)) {
+      CHECK(vol->remove(it->first.c_str()));
+      gone->push_back(it->first);
+      it = files->erase(it);
+    } else {
+      ++it;
+    }
+  }
+  CHECK(vol->rmdir(dir.c_str()));
+  CHECK(vol->mkdir(dir.c_str()));
+}
+//------------------------------------------------------------------------------
+static void check(HostFsType type) {
+  RamBlockDevice dev;
+  FsVolume vol;
+  Dirs dirs;
+  Files files;
+  std::vector<std::string> gone;
+  formatRam(&dev, type);
+  CHECK(vol.begin(&dev));
+
+  // A repeated open of a deep path uses the cache.
+  CHECK(vol.mkdir("/data/2026/10/18", true));
+  for (int i = 0; i < 60; i++) {
+    std::string n = "/data/2026/10/18/sensor" + std::to_string(i) + ".bin";
+    create(&vol, &files, n);
+    create(&vol, &files, "/data/2026/10/s" + std::to_string(i));
+  }
+  std::string path = "/data/2026/10/18/sensor59.bin";
+  FsFile leaf;
+  FsFile file;
+  checkOpen(&vol, path, files[path]);
+  dev.clearStats();
+  CHECK(file.open(&vol, path.c_str(), O_RDONLY));
+  uint32_t reads = dev.sectorsRead();
+  CHECK(file.close());
+  // Compare with an open relative to the last directory of the path.
+  CHECK(leaf.open(&vol, "/data/2026/10/18", O_RDONLY));
+  dev.clearStats();
+  CHECK(file.open(&leaf, "sensor59.bin", O_RDONLY));
+  uint32_t leafReads = dev.sectorsRead();
+  CHECK(file.close());
+  CHECK(leaf.close());
+#if FS_PATH_CACHE_ENTRIES
+  CHECK(reads == leafReads);
+#else  // FS_PATH_CACHE_ENTRIES
+  CHECK(reads > leafReads);
+#endif  // FS_PATH_CACHE_ENTRIES
+  // The cached components must not be used after a rename or rmdir.
+  CHECK(vol.rename("/data/2026/10", "/data/2026/11"));
+  CHECK(!vol.exists(path.c_str()));
+  CHECK(vol.mkdir("/data/2026/10/18", true));
+  CHECK(!vol.exists(path.c_str()));
+  CHECK(vol.rmdir("/data/2026/10/18"));
+  CHECK(vol.rmdir("/data/2026/10"));
+  CHECK(vol.rename("/data/2026/11", "/data/2026/10"));
+  checkOpen(&vol, path, files[path]);
+
+  dirs = {"/data", "/data/2026", "/data/2026/10", "/data/2026/10/18"};
+  for (int k = 0; k < 3000; k++) {
+    uint32_t op = rnd() % 100;
+    std::string dir = pickDir(dirs);
+    if (op < 40 && !files.empty()) {
+      std::string f = pickFile(files);
+      checkOpen(&vol, f, files[f]);
+    } else if (op < 50 && !gone.empty()) {
+      std::string g = gone[rnd() % gone.size()];
+      if (!files.count(g)) {
+        CHECK(!vol.exists(g.c_str()));
+      }
+    } else if (op < 65) {
+      create(&vol, &files, dir + "/" + newName() + ".txt");
+    } else if (op < 75 && dirs.size() < 30) {
+      std::string d = dir + "/" + newName();
+          CHECK(vol.mkdir(d.c_str()));
+      dirs.insert(d);
+    } else if (op < 90) {
+      moveDir(&vol, &dirs, &files, &gone, dir);
+    } else {
+      remakeDir(&vol, &dirs, &files, &gone, dir);
+    }
+  }
+  CHECK(vol.begin(&dev));
+  for (auto& f : files) {
+    checkOpen(&vol, f.first, f.second);
+  }
+  printf("%s ok, %u files, %u dirs, path open %u reads\n",
+         fsTypeName(type), (unsigned)files.size(), (unsigned)dirs.size(),
+         (unsigned)reads);
+}
+//------------------------------------------------------------------------------
+int main() {
+  check(HOST_FAT16);
+  check(HOST_FAT32);
+  check(HOST_EXFAT);
+  return 0;
+}
@@ -0,0 +1,116 @@
+// Files written on an SdRamBlockDevice after preAllocate() declares a
+// pre-erase range.  Pre-erased sectors that are not written in a stream
+// become undefined, so data must read back intact after sequential,
+// out of order and rewritten sections, syncs and writes to other files.
+#include <string.h>
+#include <vector>
+#include "HostTest.h"
+
+const uint32_t LOG_SIZE = 3000000;
+
+static uint32_t seed = 12345;
+//------------------------------------------------------------------------------
+static uint32_t rnd(uint32_t n) {
+  seed = 1664525*seed + 1013904223;
+  return (seed >> 8) % n;
+}
+//------------------------------------------------------------------------------
+// Write random data at pos and update the model.
+static void writeAt(FsFile* file, std::vector<uint8_t>* model, uint32_t pos,
+                    uint32_t len) {
+  static uint8_t buf[10000];
+  for (uint32_t i = 0; i < len; i++) {
+    buf[i] = rnd(256);
+  }
+  CHECK(file->seekSet(pos));
+  CHECK(file->write(buf, len) == len);
+  if (model->size() < pos + len) {
+    model->resize(pos + len);
+  }
+  memcpy(&(*model)[pos], buf, len);
+}
+//------------------------------------------------------------------------------
+// Write [begin, end) of the log file in random length pieces with syncs
+// and appends to other.txt.
+static void writeRange(FsFile* log, std::vector<uint8_t>* logModel,
+                       FsFile* other, std::vector<uint8_t>* otherModel,
+                       uint32_t begin, uint32_t end) {
+  for (uint32_t pos = begin; pos < end;) {
+    uint32_t len = 1 + rnd(rnd(4) ? 3000 : 10000);
+    if (len > end - pos) {
+      len = end - pos;
+    }
+    writeAt(log, logModel, pos, len);
+    pos += len;
+    if (rnd(20) == 0) {
+      CHECK(log->sync());
+    }
+    if (rnd(30) == 0) {
+      writeAt(other, otherModel, otherModel->size(), 1 + rnd(2000));
+    }
+  }
+}
+//------------------------------------------------------------------------------
+static void checkFile(FsVolume* vol, const char* path,
+                      const std::vector<uint8_t>& model) {
+  std::vector<uint8_t> buf(model.size() + 1);
+  FsFile file;
+  CHECK(file.open(vol, path, O_RDONLY));
+  CHECK(file.fileSize() == model.size());
+  CHECK(file.read(&buf[0], buf.size()) == (int)model.size());
+  CHECK(memcmp(&buf[0], &model[0], model.size()) == 0);
+  CHECK(file.close());
+}
+//------------------------------------------------------------------------------
+int main() {
+  HostFsType types[] = {HOST_FAT16, HOST_FAT32, HOST_EXFAT};
+  for (HostFsType type : types) {
+    SdRamBlockDevice dev;
+    FsVolume vol;
+    FsFile log;
+    FsFile other;
+    std::vector<uint8_t> logModel;
+    std::vector<uint8_t> otherModel;
+    std::vector<uint8_t> beforeModel;
+    formatRam(&dev, type);
+    CHECK(vol.begin(&dev));
+    CHECK(other.open(&vol, "before.txt", O_RDWR | O_CREAT));
+    writeAt(&other, &beforeModel, 0, 9000);
+    CHECK(other.close());
+    CHECK(other.open(&vol, "other.txt", O_RDWR | O_CREAT));
+    CHECK(log.open(&vol, "log.bin", O_RDWR | O_CREAT));
+    CHECK(log.preAllocate(LOG_SIZE));
+    uint32_t erased = dev.sectorsErased();
+
+    // Sequential, then past a gap, then fill the gap.  exFAT can't seek
+    // past the valid length so it has no gap.
+    uint32_t gap = type == HOST_EXFAT ? LOG_SIZE/3 : 2*LOG_SIZE/3;
+    writeRange(&log, &logModel, &other, &otherModel, 0, LOG_SIZE/3);
+    // The first stream pre-erases the whole file.
+    CHECK(dev.sectorsErased() - erased >= LOG_SIZE/512);
+    writeRange(&log, &logModel, &other, &otherModel, gap, LOG_SIZE - 1000);
+    writeRange(&log, &logModel, &other, &otherModel, LOG_SIZE/3, gap);
+
+    // Rewrite pieces in random order.
+    for (int i = 0; i < 200; i++) {
+      writeAt(&log, &logModel, rnd(LOG_SIZE - 2000), 1 + rnd(2000));
+      if (rnd(10) == 0) {
+        CHECK(log.sync());
+      }
+    }
+    writeRange(&log, &logModel, &other, &otherModel,
+               LOG_SIZE - 1000, LOG_SIZE);
+    CHECK(log.close());
+    CHECK(other.close());
+
+    // Read back from a new mount.
+    FsVolume vol2;
+    CHECK(vol2.begin(&dev));
+    checkFile(&vol2, "log.bin", logModel);
+    checkFile(&vol2, "other.txt", otherModel);
+    checkFile(&vol2, "before.txt", beforeModel);
+    printf("%s ok, ACMD23 %u, pre-erased %u\n", fsTypeName(type),
+           (unsigned)dev.acmd23Calls(), (unsigned)dev.sectorsErased());
+  }
+  return 0;
+}
@@ -0,0 +1,108 @@
+// FatFile and ExFatFile printf(), printField() and printFields() output
+// compared with a reference built with vsnprintf.  Lines are long enough
+// to cross sector boundaries.
+#include <stdarg.h>
+#include <string.h>
+#include <string>
+#include "HostTest.h"
+//------------------------------------------------------------------------------
+class Ref {
+ public:
+  void printf(const char* fmt, ...) {
+    char buf[1000];
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+    str += buf;
+  }
+  void term(char c) {
+    if (c == '\n') {
+      str += "\r\n";
+    } else if (c) {
+      str += c;
+    }
+  }
+  std::string str;
+};
+//------------------------------------------------------------------------------
+template<class File>
+static void writeFile(File* file, Ref* ref) {
+  srand(5);
+  for (int i = 0; i < 20000; i++) {
+    int a = rand() - RAND_MAX/2;
+    long b = rand();  // NOLINT
+    double d = (rand() - RAND_MAX/2)/1000.0;
+    switch (i % 8) {
+      case 0:
+        file->printField(a, ',');
+        file->printField((int16_t)a, ';');
+        file->printField((uint16_t)b, '\n');
+        ref->printf("%d,%d;%u", a, (int16_t)a, (uint16_t)b);
+        ref->term('\n');
+        break;
+      case 1:
+        file->printField(d, ',', i % 5);
+        file->printField((float)d, '\n');
+        ref->printf("%.*f,%.2f", i % 5, d, (double)(float)d);
+        ref->term('\n');
+        break;
+      case 2:
+        file->printField(b, 0);
+        file->printField((int8_t)(a % 127), '\t');
+        ref->printf("%ld%d\t", b, (int8_t)(a % 127));
+        break;
+      case 3:
+        file->printf("%d|%5d|%-6d|%06d|%x|%X|%#x|%o|%lu|%s|%10s|%-10s|%c\n",
+                     a, a % 1000, a % 100, a % 999, a, (int)b, (int)b,
+                     (int)b, b, "abc", "xy", "z", 'A' + i % 26);
+        ref->printf("%d|%5d|%-6d|%06d|%x|%X|%#x|%o|%lu|%s|%10s|%-10s|%c\n",
+                    a, a % 1000, a % 100, a % 999, a, (int)b, (int)b,
+                    (int)b, b, "abc", "xy", "z", 'A' + i % 26);
+        break;
+      case 4:
+        file->printf("%.3f %e %8.2f %+d % d\n", d, d, d, a, a);
+        ref->printf("%.3f %e %8.2f %+d % d\n", d, d, d, a, a);
+        break;
+      case 5:
+        file->printf("%s", "no newline ");
+        ref->printf("%s", "no newline ");
+        break;
+      case 6:
+        file->printf("long line %0200d %-150s|\n", a, "pad");
+        ref->printf("long line %0200d %-150s|\n", a, "pad");
+        break;
+      default:
+        file->printFields((uint32_t)b*3, "name", (int8_t)-128, -4.5, 7u);
+        ref->printf("%u,name,-128,-4.50,7", (uint32_t)b*3);
+        ref->term('\n');
+        break;
+    }
+  }
+}
+//------------------------------------------------------------------------------
+template<class Vol, class File>
+static void check(HostFsType type) {
+  RamBlockDevice dev;
+  Vol vol;
+  File file;
+  Ref ref;
+  formatRam(&dev, type);
+  CHECK(vol.begin(&dev));
+  CHECK(file.open(&vol, "print.txt", O_RDWR | O_CREAT | O_TRUNC));
+  writeFile(&file, &ref);
+  std::string got(ref.str.size(), 0);
+  CHECK(file.fileSize() == ref.str.size());
+  CHECK(file.seekSet(0));
+  CHECK(file.read(&got[0], got.size()) == (int)got.size());
+  CHECK(file.close());
+  CHECK(got == ref.str);
+  printf("%s ok, %u bytes\n", fsTypeName(type), (unsigned)got.size());
+}
+//------------------------------------------------------------------------------
+int main() {
+  check<FatVolume, FatFile>(HOST_FAT16);
+  check<FatVolume, FatFile>(HOST_FAT32);
+  check<ExFatVolume, ExFatFile>(HOST_EXFAT);
+  return 0;
+}
@@ -0,0 +1,187 @@
+// scanDouble(), scanFloat() and istream extraction of double and float
+// checked against strtod() and strtof() for edge cases, random bit
+// patterns, near halfway values and long digit strings.
+//
+// Usage: ScanFloatTest [count]
+#include <math.h>
+#include <string.h>
+#include "HostTest.h"
+#include "iostream/bufstream.h"
+#include "common/FmtNumber.h"
+
+static uint64_t seed = 88172645463325252ULL;
+//------------------------------------------------------------------------------
+static uint64_t rnd() {
+  seed ^= seed << 13;
+  seed ^= seed >> 7;
+  seed ^= seed << 17;
+  return seed;
+}
+//------------------------------------------------------------------------------
+static void check(const char* str) {
+  char* e1;
+  char* e2;
+  double a = strtod(str, &e1);
+  double b = scanDouble(str, &e2);
+  if (memcmp(&a, &b, sizeof(a)) || e1 != e2) {
+    printf("%s: %.17g %.17g\n", str, a, b);
+    CHECK(false);
+  }
+  float fa = strtof(str, &e1);
+  float fb = scanFloat(str, &e2);
+  if (memcmp(&fa, &fb, sizeof(fa)) || e1 != e2) {
+    printf("%s: %.9g %.9g\n", str, fa, fb);
+    CHECK(false);
+  }
+}
+//------------------------------------------------------------------------------
+// Move the last digit before the exponent down, up or not at all.
+static void nudge(char* buf) {
+  char* p = strchr(buf, 'e') - 1;
+  int k = rnd() % 3;
+  if (k == 0) {
+    while (*p == '0' || *p == '.') {
+      p--;
+    }
+    if (*p > '0') {
+      (*p)--;
+    }
+  } else if (k == 1) {
+    while (*p == '9' || *p == '.') {
+      p--;
+    }
+    if (*p < '9') {
+      (*p)++;
+    }
+  }
+}
+//------------------------------------------------------------------------------
+// Random digits with a random decimal point and exponent.
+static void digits(char* buf, int maxExp) {
+  int nd = 1 + rnd() % 30;
+  int dot = rnd() % (nd + 1);
+  char* p = buf;
+  if (rnd() & 1) {
+    *p++ = '-';
+  }
+  for (int j = 0; j < nd; j++) {
+    if (j == dot) {
+      *p++ = '.';
+    }
+    *p++ = '0' + rnd() % 10;
+  }
+  snprintf(p, 10, "e%d", (int)(rnd() % (2*maxExp)) - maxExp);
+}
+//------------------------------------------------------------------------------
+static void sweep(long count) {  // NOLINT
+  char buf[1000];
+  for (long i = 0; i < count; i++) {  // NOLINT
+    uint64_t bits = rnd();
+    double d;
+    float f;
+    memcpy(&d, &bits, sizeof(d));
+    memcpy(&f, &bits, sizeof(f));
+    if (!isfinite(d) || !isfinite(f)) {
+      continue;
+    }
+    switch (i % 8) {
+      case 0:
+        snprintf(buf, sizeof(buf), "%.17g", d);
+        break;
+      case 1:
+        snprintf(buf, sizeof(buf), "%.*e", (int)(rnd() % 25), d);
+        break;
+      case 2: {
+        char* str = fmtShortest(buf + 100, d, false);
+        buf[100] = '\0';
+        memmove(buf, str, buf + 101 - str);
+        break;
+      }
+      case 3: {
+        // Near halfway between two doubles.
+        long double h = ((long double)d + nextafter(d, INFINITY))/2;
+        snprintf(buf, sizeof(buf), "%.*Le", 20 + (int)(rnd() % 780), h);
+        nudge(buf);
+        break;
+      }
+      case 4: {
+        // Near halfway between two floats.
+        double h = ((double)f + nextafterf(f, INFINITY))/2;
+        snprintf(buf, sizeof(buf), "%.*e", 8 + (int)(rnd() % 120), h);
+        nudge(buf);
+        break;
+      }
+      case 5:
+        snprintf(buf, sizeof(buf), "%.*g", 1 + (int)(rnd() % 12), f);
+        break;
+      case 6:
+        digits(buf, i & 8 ? 350 : 70);
+        break;
+      default:
+        snprintf(buf, sizeof(buf), "%.*f", (int)(rnd() % 8),
+                 d*1e-300*(double)(rnd() % 1000000));
+        break;
+    }
+    check(buf);
+  }
+}
+//------------------------------------------------------------------------------
+// istream extraction of a field followed by a comma.
+static void checkStream(long count) {  // NOLINT
+  char buf[100];
+  for (long i = 0; i < count; i++) {  // NOLINT
+    uint64_t bits = rnd();
+    double v;
+    memcpy(&v, &bits, sizeof(v));
+    if (!isfinite(v)) {
+      continue;
+    }
+    snprintf(buf, sizeof(buf), "%.*g,", 1 + (int)(rnd() % 17), v);
+    double d;
+    char c = 0;
+    ibufstream is(buf);
+    is >> d >> c;
+    double r = strtod(buf, nullptr);
+    if (isfinite(r)) {
+      CHECK(!is.fail() && c == ',');
+      CHECK(memcmp(&d, &r, sizeof(d)) == 0);
+    }
+    float fr = strtof(buf, nullptr);
+    if (isfinite(fr)) {
+      float fl;
+      ibufstream isf(buf);
+      isf >> fl;
+      CHECK(!isf.fail());
+      CHECK(memcmp(&fl, &fr, sizeof(fl)) == 0);
+    }
+  }
+}
+//------------------------------------------------------------------------------
+int main(int argc, char** argv) {
+  long count = argc > 1 ? atol(argv[1]) : 300000;  // NOLINT
+  const char* edge[] = {
+    "0", "-0", "1", "1e23", "9007199254740993", "1.7976931348623157e308",
+    "1.7976931348623158e308", "1.7976931348623159e308",
+    "2.4703282292062327e-324", "2.4703282292062328e-324",
+    "4.9406564584124654e-324", "1e-400", "1e400", "  +12.5e-3x", ".5", "5.",
+    ".", "e5", "1e", "1e+", "1.5.3", "00000.000001230000e0000010",
+    "3.4028235677973366e38", "3.4028235e38", "3.4028236e38", "1.4e-45",
+    "7.0064923216240854e-46", "7.006492321624086e-46",
+    "0.000000000000000000000000000000000000000000001",
+    "123456789012345678901234567890",
+    "1.00000000000000011102230246251565404236316680908203125",
+    "1.00000000000000011102230246251565404236316680908203124",
+    "1.00000000000000011102230246251565404236316680908203126",
+    "2.2250738585072011e-308", "2.2250738585072012e-308", "1e308", "1e309",
+    "-1e-5", "1e99999999", "1e-99999999", "0e99999"
+  };
+  for (const char* str : edge) {
+    check(str);
+  }
+  printf("edge cases ok\n");
+  sweep(count);
+  printf("scan ok %ld values\n", count);
+  checkStream(count/4);
+  printf("istream ok %ld values\n", count/4);
+  return 0;
+}
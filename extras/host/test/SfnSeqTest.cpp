@@ -0,0 +1,136 @@
+// Short names generated for long names with lost characters.  Many long
+// names share a base so ~1 is taken and NAME~HHHH names are used.  Short
+// name files take some of the hash candidates, sometimes all that the
+// scan in open() checks.  The generated name must be the first free name
+// in the order of the rescan in lfnUniqueSfn().
+#include <string.h>
+#include <set>
+#include <string>
+#include "HostTest.h"
+
+typedef std::set<std::string> SfnSet;
+
+static uint64_t seed = 88172645463325252ULL;
+// Hash candidates checked by the scan in open().
+const uint8_t SCAN_HASH_SEQ = 8;
+//------------------------------------------------------------------------------
+static uint64_t rnd() {
+  seed ^= seed << 13;
+  seed ^= seed >> 7;
+  seed ^= seed << 17;
+  return seed;
+}
+//------------------------------------------------------------------------------
+static std::string shortName(FatFile* file) {
+  DirFat_t dir;
+  CHECK(file->dirEntry(&dir));
+  return std::string(reinterpret_cast<char*>(dir.name), 11);
+}
+//------------------------------------------------------------------------------
+// Candidate seq for a long name with the ~1 short name sfn1.  Sequence
+// numbers from two are NAME~HHHH names.
+static std::string candidate(const std::string& sfn1,
+                             const std::string& name, uint8_t seq) {
+  if (seq == 1) {
+    return sfn1;
+  }
+  uint16_t hash = seq + name.size();
+  for (char c : name) {
+    hash = ((hash << 5) + hash) ^ c;
+  }
+  size_t pos = sfn1.find('~');
+  CHECK(pos < 7);
+  if (pos > 3) {
+    pos = 3;
+  }
+  char hex[5];
+  snprintf(hex, sizeof(hex), "%04X", hash);
+  std::string sfn = sfn1;
+  sfn[pos] = '~';
+  sfn.replace(pos + 1, 4, hex);
+  return sfn;
+}
+//------------------------------------------------------------------------------
+// 8.3 path for an 11 character short name.
+static std::string path83(const std::string& dir, const std::string& sfn) {
+  std::string base = sfn.substr(0, 8);
+  std::string ext = sfn.substr(8);
+  std::string rtn = dir + "/" + base.substr(0, base.find(' '));
+  if (ext[0] != ' ') {
+    rtn += "." + ext.substr(0, ext.find(' '));
+  }
+  return rtn;
+}
+//------------------------------------------------------------------------------
+// Long names are head + n + tail.
+static void check(RamBlockDevice* dev, FatVolume* vol,
+                  const std::string& head, const std::string& tail) {
+  static int dirCount = 0;
+  FatFile file;
+  SfnSet used;
+  std::string dir = "/Dir " + std::to_string(dirCount++);
+  CHECK(vol->mkdir(dir.c_str()));
+  int fallbacks = 0;
+  for (int n = 0; n < 60; n++) {
+    std::string name = head + std::to_string(n) + tail;
+    // The ~1 name from an empty directory.
+    CHECK(file.open(vol, ("/scratch/" + name).c_str(), O_RDWR | O_CREAT));
+    std::string sfn1 = shortName(&file);
+    CHECK(file.remove());
+    CHECK(sfn1.find("~1") < 7);
+    // Take some of the hash candidates with 8.3 files.
+    uint32_t r = rnd() % 4;
+    for (uint8_t seq = 2; seq < 2 + SCAN_HASH_SEQ + 2; seq++) {
+      bool take = r == 0 ? seq < 2 + SCAN_HASH_SEQ + rnd() % 3 :
+                  r == 1 ? rnd() % 2 : false;
+      std::string sfn = candidate(sfn1, name, seq);
+      if (take && !used.count(sfn)) {
+        CHECK(file.open(vol, path83(dir, sfn).c_str(),
+                        O_RDWR | O_CREAT | O_EXCL));
+        CHECK(shortName(&file) == sfn);
+        CHECK(file.close());
+        used.insert(sfn);
+      }
+    }
+    // Expected name from a rescan for each candidate.
+    std::string expect;
+    for (uint8_t seq = 1; seq < 100; seq++) {
+      expect = candidate(sfn1, name, seq);
+      if (!used.count(expect)) {
+        fallbacks += seq >= 2 + SCAN_HASH_SEQ;
+        break;
+      }
+    }
+    CHECK(file.open(vol, (dir + "/" + name).c_str(),
+                    O_RDWR | O_CREAT | O_EXCL));
+    CHECK(shortName(&file) == expect);
+    CHECK(file.close());
+    used.insert(expect);
+  }
+  // All long names must open after a remount.
+  CHECK(vol->begin(dev));
+  for (int n = 0; n < 60; n++) {
+    std::string name = head + std::to_string(n) + tail;
+    CHECK(file.open(vol, (dir + "/" + name).c_str(), O_RDONLY));
+    CHECK(file.close());
+  }
+  printf("%sN%s ok, %u short names, %d fallbacks\n", head.c_str(),
+         tail.c_str(), (unsigned)used.size(), fallbacks);
+  CHECK(fallbacks > 0);
+}
+//------------------------------------------------------------------------------
+int main() {
+  RamBlockDevice dev;
+  FatVolume vol;
+  formatRam(&dev, HOST_FAT32);
+  CHECK(vol.begin(&dev));
+  CHECK(vol.mkdir("/scratch"));
+  // The ~ of the ~1 name is at positions 6, 4, 3, 2 and 1.
+  check(&dev, &vol, "Long name ", ".txt");
+  check(&dev, &vol, "Long+name", "");
+  check(&dev, &vol, "Lost.c++", "");
+  check(&dev, &vol, "a+b.csv", "");
+  check(&dev, &vol, "a+.txt", "");
+  check(&dev, &vol, "+.dat", "");
+  return 0;
+}
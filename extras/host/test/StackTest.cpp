@@ -0,0 +1,196 @@
+// Model based regression test of the whole stack on FAT16, FAT32 and
+// exFAT RAM images.  Files are written, truncated, renamed and removed
+// while a std::map holds the expected content.
+//
+// Usage: StackTest [iterations]
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+#include "HostTest.h"
+
+static std::mt19937 rng(1234);
+static std::map<std::string, std::string> model;
+//------------------------------------------------------------------------------
+static std::string rnd(size_t n) {
+  std::string s(n, 0);
+  for (auto& c : s) {
+    c = rng();
+  }
+  return s;
+}
+//------------------------------------------------------------------------------
+static std::string manyName(int i) {
+  return "/many/File_" + std::to_string(i) +
+         (i % 3 ? ".txt" : " long name with spaces.text");
+}
+//------------------------------------------------------------------------------
+static void verifyAll(FsVolume* vol) {
+  for (auto& kv : model) {
+    FsFile f;
+    CHECK(f.open(vol, kv.first.c_str(), O_RDONLY));
+#if USE_FILE_EXTENT_MAP
+    static FsExtentMapArray<3> xmap;
+    CHECK(f.setExtentMap(&xmap));
+#endif  // USE_FILE_EXTENT_MAP
+    CHECK(f.fileSize() == kv.second.size());
+    std::string got(kv.second.size(), 0);
+    // Read with random chunk sizes.
+    size_t pos = 0;
+    while (pos < got.size()) {
+      size_t n = 1 + rng() % 3000;
+      if (n > got.size() - pos) {
+        n = got.size() - pos;
+      }
+      CHECK(f.read(&got[pos], n) == (int)n);
+      pos += n;
+    }
+    CHECK(f.read() == -1);
+    CHECK(got == kv.second);
+    // Random seeks.
+    for (int i = 0; i < 20 && got.size(); i++) {
+      size_t p = rng() % got.size();
+      char c;
+      CHECK(f.seekSet(p));
+      CHECK(f.read(&c, 1) == 1);
+      CHECK(c == got[p]);
+    }
+    f.close();
+  }
+}
+//------------------------------------------------------------------------------
+static void writeFiles(FsVolume* vol, int iter) {
+  CHECK(vol->mkdir("/dir one/sub dir/deep", true));
+  CHECK(vol->mkdir("/many"));
+  std::vector<FsFile> file(4);
+  std::vector<std::string> names(4);
+  for (int k = 0; k < 4; k++) {
+    names[k] = "/dir one/sub dir/interleaved file number " +
+               std::to_string(k) + ".dat";
+    CHECK(file[k].open(vol, names[k].c_str(), O_RDWR | O_CREAT | O_TRUNC));
+    model[names[k]] = "";
+  }
+  for (int i = 0; i < iter; i++) {
+    int k = rng() % 4;
+    std::string d = rnd(1 + rng() % 5000);
+    CHECK(file[k].write(d.data(), d.size()) == d.size());
+    model[names[k]] += d;
+    if (i % 17 == 0) {
+      CHECK(file[k].sync());
+    }
+  }
+  for (auto& f : file) {
+    CHECK(f.close());
+  }
+  for (int i = 0; i < 120; i++) {
+    std::string n = manyName(i);
+    std::string d = rnd(rng() % 700);
+    FsFile f;
+    CHECK(f.open(vol, n.c_str(), O_RDWR | O_CREAT | O_EXCL));
+    CHECK(f.write(d.data(), d.size()) == d.size());
+    CHECK(f.close());
+    model[n] = d;
+  }
+  for (int i = 0; i < 120; i += 7) {
+    CHECK(vol->remove(manyName(i).c_str()));
+    model.erase(manyName(i));
+  }
+  CHECK(!vol->exists(manyName(0).c_str()));
+  CHECK(vol->exists(manyName(1).c_str()));
+  CHECK(vol->rename(manyName(1).c_str(), "/dir one/renamed.txt"));
+  model["/dir one/renamed.txt"] = model[manyName(1)];
+  model.erase(manyName(1));
+
+  // Truncate, append and overwrite in the middle.
+  FsFile f;
+  CHECK(f.open(vol, names[0].c_str(), O_RDWR));
+  uint64_t length = model[names[0]].size() / 3;
+  CHECK(f.truncate(length));
+  model[names[0]].resize(length);
+  CHECK(f.seekEnd());
+  std::string d = rnd(12345);
+  CHECK(f.write(d.data(), d.size()) == d.size());
+  model[names[0]] += d;
+  CHECK(f.seekSet(777));
+  std::string e = rnd(3000);
+  CHECK(f.write(e.data(), e.size()) == e.size());
+  model[names[0]].replace(777, 3000, e);
+  CHECK(f.close());
+}
+//------------------------------------------------------------------------------
+static void textFile(FsVolume* vol) {
+  FsFile f;
+  std::string all;
+  CHECK(f.open(vol, "/lines.txt", O_RDWR | O_CREAT | O_TRUNC));
+  for (int i = 0; i < 500; i++) {
+    all += "line " + std::to_string(i) + std::string(rng() % 80, 'x') + "\n";
+  }
+  CHECK(f.write(all.data(), all.size()) == all.size());
+  model["/lines.txt"] = all;
+  f.rewind();
+  char line[200];
+  size_t pos = 0;
+  int n;
+  while ((n = f.fgets(line, sizeof(line))) > 0) {
+    size_t e = all.find('\n', pos);
+    CHECK(std::string(line, n) == all.substr(pos, e + 1 - pos));
+    pos = e + 1;
+  }
+  CHECK(pos == all.size());
+  f.close();
+}
+//------------------------------------------------------------------------------
+static size_t countDir(FsVolume* vol, const char* path) {
+  FsFile dir;
+  FsFile f;
+  size_t n = 0;
+  CHECK(dir.open(vol, path, O_RDONLY));
+  while (f.openNext(&dir, O_RDONLY)) {
+    n++;
+    f.close();
+  }
+  return n;
+}
+//------------------------------------------------------------------------------
+int main(int argc, char** argv) {
+  int iter = argc > 1 ? atoi(argv[1]) : 300;
+  HostFsType types[] = {HOST_FAT16, HOST_FAT32, HOST_EXFAT};
+  for (HostFsType type : types) {
+    RamBlockDevice dev;
+    uint32_t free0;
+    uint32_t m = curMs();
+    model.clear();
+    formatRam(&dev, type);
+    {
+      FsVolume vol;
+      CHECK(vol.begin(&dev));
+      free0 = vol.freeClusterCount();
+      writeFiles(&vol, iter);
+      textFile(&vol);
+      verifyAll(&vol);
+      // 120 files less 18 removed and one renamed.
+      CHECK(countDir(&vol, "/many") == 101);
+      CHECK(vol.freeClusterCount() < free0);
+    }
+    // Mount again, verify, then remove everything.
+    {
+      FsVolume vol;
+      CHECK(vol.begin(&dev));
+      verifyAll(&vol);
+      for (auto& kv : model) {
+        CHECK(vol.remove(kv.first.c_str()));
+      }
+      CHECK(vol.rmdir("/dir one/sub dir/deep"));
+      CHECK(vol.rmdir("/dir one/sub dir"));
+      CHECK(vol.rmdir("/dir one"));
+      CHECK(vol.rmdir("/many"));
+      CHECK(vol.freeClusterCount() == free0);
+    }
+    printf("%s ok %u ms reads %u/%u writes %u/%u syncs %u\n",
+           fsTypeName(type), (unsigned)(curMs() - m),
+           (unsigned)dev.readCalls(), (unsigned)dev.sectorsRead(),
+           (unsigned)dev.writeCalls(), (unsigned)dev.sectorsWritten(),
+           (unsigned)dev.syncCalls());
+  }
+  return 0;
+}
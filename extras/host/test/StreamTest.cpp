@@ -0,0 +1,152 @@
+// Model based test of fstream and estream buffering.  Random put, write,
+// get, peek and seek calls are checked against a std::string for several
+// setbuf() sizes, then the file is read back.
+//
+// Usage: StreamTest [operations]
+#include <string.h>
+#include <random>
+#include <string>
+#include "HostTest.h"
+#include "iostream/fstream.h"
+
+static std::mt19937 rng(4321);
+static char streamBuf[4096];
+static const size_t bufSizes[] = {0, 1, 7, 64, 512, 4096};
+//------------------------------------------------------------------------------
+template<class Stream>
+static void modelTest(size_t bufSize, int ops) {
+  std::string model = "0123456789";
+  size_t pos = 0;
+  Stream fs;
+  fs.open("model.bin", ios::in | ios::out | ios::trunc | ios::binary);
+  CHECK(fs.is_open());
+  CHECK(fs.setbuf(bufSize ? streamBuf : nullptr, bufSize));
+  fs << model.c_str();
+  CHECK(fs.good());
+  fs.seekg(0);
+
+  // Reported case, read after put must return file data.
+  fs.seekp(3);
+  fs.put('X');
+  model[3] = 'X';
+  CHECK(fs.peek() == '4');
+  CHECK(fs.get() == '4');
+  CHECK(fs.tellg() == 5);
+  pos = 5;
+
+  for (int i = 0; i < ops; i++) {
+    int c;
+    switch (rng() % 8) {
+    case 0:
+    case 1:
+      c = 'a' + rng() % 26;
+      fs.put(c);
+      if (pos < model.size()) {
+        model[pos] = c;
+      } else {
+        model += c;
+      }
+      pos++;
+      break;
+
+    case 2: {
+        std::string s(1 + rng() % (2*bufSize + 20), 'A' + rng() % 26);
+        fs << s.c_str();
+        model.replace(pos, s.size(), s);
+        pos += s.size();
+      }
+      break;
+
+    case 3:
+    case 4:
+      c = fs.get();
+      if (pos < model.size()) {
+        CHECK(c == (uint8_t)model[pos]);
+        pos++;
+      } else {
+        CHECK(c == -1 && fs.eof());
+        fs.clear();
+      }
+      break;
+
+    case 5:
+      c = fs.peek();
+      if (pos < model.size()) {
+        CHECK(c == (uint8_t)model[pos]);
+      } else {
+        CHECK(c == -1);
+        fs.clear();
+      }
+      break;
+
+    case 6:
+      pos = rng() % (model.size() + 1);
+      fs.seekg(pos);
+      break;
+
+    case 7:
+      if (rng() % 2) {
+        pos = model.size();
+        fs.seekp(0, ios::end);
+      } else {
+        pos = rng() % (model.size() + 1);
+        fs.seekp(pos);
+      }
+      break;
+    }
+    CHECK(fs.good());
+    CHECK(fs.tellg() == pos);
+  }
+  fs.close();
+  fs.open("model.bin", ios::in | ios::binary);
+  CHECK(fs.is_open());
+  CHECK(fs.setbuf(bufSize ? streamBuf : nullptr, bufSize));
+  for (size_t n = 0; n < model.size(); n++) {
+    CHECK(fs.get() == (uint8_t)model[n]);
+  }
+  CHECK(fs.get() == -1);
+  fs.close();
+}
+//------------------------------------------------------------------------------
+// CR LF pairs split across buffer boundaries in text mode.
+template<class Stream>
+static void textTest(size_t bufSize) {
+  Stream fs;
+  fs.open("text.txt", ios::in | ios::out | ios::trunc);
+  CHECK(fs.is_open());
+  CHECK(fs.setbuf(bufSize ? streamBuf : nullptr, bufSize));
+  for (int i = 0; i < 200; i++) {
+    fs << "line " << i << (i % 5 ? "\n" : "\r");
+  }
+  fs.seekg(0);
+  for (int i = 0; i < 200; i++) {
+    char line[20];
+    char expect[20];
+    fs.getline(line, sizeof(line), i % 5 ? '\n' : '\r');
+    snprintf(expect, sizeof(expect), "line %d", i);
+    CHECK(fs.good());
+    CHECK(strcmp(line, expect) == 0);
+  }
+  CHECK(fs.get() == -1);
+  fs.close();
+}
+//------------------------------------------------------------------------------
+template<class Volume, class Stream>
+static void streamTest(HostFsType type, int ops) {
+  RamBlockDevice dev;
+  Volume vol;
+  formatRam(&dev, type);
+  CHECK(vol.begin(&dev));
+  for (size_t bufSize : bufSizes) {
+    modelTest<Stream>(bufSize, ops);
+    textTest<Stream>(bufSize);
+  }
+  printf("%s ok\n", fsTypeName(type));
+}
+//------------------------------------------------------------------------------
+int main(int argc, char** argv) {
+  int ops = argc > 1 ? atoi(argv[1]) : 20000;
+  streamTest<FatVolume, fstream>(HOST_FAT32, ops);
+  streamTest<ExFatVolume, estream>(HOST_EXFAT, ops);
+  return 0;
+}
@@ -24,6 +24,14 @@
  */
 #ifndef BlockDevice_h
 #define  BlockDevice_h
+#include "FsConfig.h"
+#if ENABLE_ARDUINO_FEATURES
 #include "SdCard/SdCard.h"
+/** Volumes are mounted on an SD card. */
 typedef SdCard BlockDevice;
+#else  // ENABLE_ARDUINO_FEATURES
+#include "BlockDeviceInterface.h"
+/** Volumes are mounted on any device, see HostDevice/HostDevice.h. */
+typedef BlockDeviceInterface BlockDevice;
+#endif  // ENABLE_ARDUINO_FEATURES
 #endif  // BlockDevice_h
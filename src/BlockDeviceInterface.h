@@ -30,6 +30,13 @@
  */
 #include <stdint.h>
 #include <stddef.h>
+/**
+ * Completion callback for asynchronous sector transfers.
+ *
+ * \param[in] context Value passed to submitRead() or submitWrite().
+ * \param[in] success true if the transfer succeeded.
+ */
+typedef void (*BlockIoCallback)(void* context, bool success);
 /**
  * \class BlockDeviceInterface
  * \brief BlockDeviceInterface class.
@@ -58,6 +65,70 @@ class BlockDeviceInterface {
    */
   virtual bool readSectors(uint32_t sector, uint8_t* dst, size_t ns) = 0;
 
+  /**
+   * Advance an asynchronous transfer without blocking.
+   *
+   * The completion callback is called from poll() when the transfer
+   * finishes.
+   *
+   * \return true if no transfer is in progress.
+   */
+  virtual bool poll() {
+    return true;
+  }
+
+  /**
+   * Start an asynchronous read of 512 byte sectors.
+   *
+   * Only one transfer may be in progress.  Any transfer in progress is
+   * completed first.  The default implementation does a synchronous
+   * read and calls the callback before returning.
+   *
+   * \param[in] sector Logical sector to be read.
+   * \param[out] dst Pointer to the location that will receive the data.
+   *                 It must remain valid until the transfer completes.
+   * \param[in] ns Number of sectors to be read.
+   * \param[in] callback Function called when the transfer completes.
+   * \param[in] context Value passed to callback.
+   * \return The value true is returned if the transfer was started and
+   * the value false is returned for failure.
+   */
+  virtual bool submitRead(uint32_t sector, uint8_t* dst, size_t ns,
+                          BlockIoCallback callback = nullptr,
+                          void* context = nullptr) {
+    bool rtn = readSectors(sector, dst, ns);
+    if (callback) {
+      callback(context, rtn);
+    }
+    return rtn;
+  }
+
+  /**
+   * Start an asynchronous write of 512 byte sectors.
+   *
+   * Only one transfer may be in progress.  Any transfer in progress is
+   * completed first.  The default implementation does a synchronous
+   * write and calls the callback before returning.
+   *
+   * \param[in] sector Logical sector to be written.
+   * \param[in] src Pointer to the location of the data to be written.
+   *                It must remain valid until the transfer completes.
+   * \param[in] ns Number of sectors to be written.
+   * \param[in] callback Function called when the transfer completes.
+   * \param[in] context Value passed to callback.
+   * \return The value true is returned if the transfer was started and
+   * the value false is returned for failure.
+   */
+  virtual bool submitWrite(uint32_t sector, const uint8_t* src, size_t ns,
+                           BlockIoCallback callback = nullptr,
+                           void* context = nullptr) {
+    bool rtn = writeSectors(sector, src, ns);
+    if (callback) {
+      callback(context, rtn);
+    }
+    return rtn;
+  }
+
   /** \return device size in sectors. */
   virtual uint32_t sectorCount() = 0;
 
@@ -87,5 +158,19 @@ class BlockDeviceInterface {
    * the value false is returned for failure.
    */
   virtual bool writeSectors(uint32_t sector, const uint8_t* src, size_t ns) = 0;
+
+  /**
+   * Declare a range of sectors with no data that must be preserved.
+   *
+   * A device may pre-erase the rest of the range when a multi-sector
+   * write starts in the range.  The range shrinks as it is written.
+   *
+   * \param[in] sector First sector in the range.
+   * \param[in] count Number of sectors in the range.
+   */
+  virtual void preEraseHint(uint32_t sector, uint32_t count) {
+    (void)sector;
+    (void)count;
+  }
 };
 #endif  // BlockDeviceInterface_h
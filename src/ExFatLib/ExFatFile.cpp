@@ -23,6 +23,7 @@
  * DEALINGS IN THE SOFTWARE.
  */
 #include "../common/DebugMacros.h"
+#include "../common/FsLineScan.h"
 #include "ExFatFile.h"
 #include "ExFatVolume.h"
 #include "upcase.h"
@@ -34,30 +35,89 @@ bool ExFatFile::close() {
   return rtn;
 }
 //------------------------------------------------------------------------------
-int ExFatFile::fgets(char* str, int num, char* delim) {
-  char ch;
-  int n = 0;
-  int r = -1;
-  while ((n + 1) < num && (r = read(&ch, 1)) == 1) {
-    // delete CR
-    if (ch == '\r') {
-      continue;
-    }
-    str[n++] = ch;
-    if (!delim) {
-      if (ch == '\n') {
-        break;
+// Limit ns to the sectors that follow sector sectorOfCluster of m_curCluster
+// in physically adjacent clusters.  m_curCluster is advanced to the cluster
+// of the last sector.  Clusters are added at the end of the chain if
+// allocate is true.  Return zero for an error.
+size_t ExFatFile::clusterRun(uint32_t sectorOfCluster,
+                             size_t ns, bool allocate) {
+  size_t maxNs = m_vol->sectorsPerCluster() - sectorOfCluster;
+  uint32_t index = m_curPosition >> m_vol->bytesPerClusterShift();
+  while (maxNs < ns) {
+    uint32_t cc = m_curCluster;
+    int8_t fg;
+    index++;
+    if (isContiguous()) {
+      // Clusters before the end of data are allocated.
+      if (((uint64_t)index << m_vol->bytesPerClusterShift()) < m_dataLength) {
+        m_curCluster++;
+        fg = 1;
+      } else {
+        fg = 0;
       }
     } else {
-      if (strchr(delim, ch)) {
+      fg = nextCluster(index);
+      if (fg < 0) {
+        DBG_FAIL_MACRO;
+        goto fail;
+      }
+    }
+    if (fg == 0) {
+      if (!allocate) {
+        m_curCluster = cc;
         break;
       }
+      if (!addCluster()) {
+        DBG_FAIL_MACRO;
+        goto fail;
+      }
     }
+#if USE_FILE_EXTENT_MAP
+    if (m_extentMap) {
+      m_extentMap->put(index, m_curCluster);
+    }
+#endif  // USE_FILE_EXTENT_MAP
+    if (m_curCluster != (cc + 1)) {
+      // Next cluster is linked but not adjacent.
+      m_curCluster = cc;
+      break;
+    }
+    maxNs += m_vol->sectorsPerCluster();
   }
-  if (r < 0) {
-    // read error
+  return maxNs < ns ? maxNs : ns;
+
+fail:
+  return 0;
+}
+//------------------------------------------------------------------------------
+int ExFatFile::fgets(char* str, int num, char* delim) {
+  FsLineScan scan(delim);
+  const uint8_t* src;
+  int n = 0;
+  if (num < 2) {
+    // no space for data
     return -1;
   }
+  while ((n + 1) < num) {
+    int m = readCache(&src);
+    if (m <= 0) {
+      if (m < 0) {
+        // read error
+        return -1;
+      }
+      break;
+    }
+    const uint8_t* end = scan.find(src, m);
+    size_t len = end ? end - src + 1 : m;
+    size_t k;
+    size_t used = FsLineScan::copy(str + n, num - 1 - n, src, len, &k);
+    m_curPosition += used;
+    n += k;
+    if (end && used == len) {
+      // delimiter transferred
+      break;
+    }
+  }
   str[n] = '\0';
   return n;
 }
@@ -72,6 +132,22 @@ void ExFatFile::fsetpos(fspos_t* pos) {
   m_curCluster = pos->cluster;
 }
 //-----------------------------------------------------------------------------
+int8_t ExFatFile::nextCluster(uint32_t index) {
+#if USE_FILE_EXTENT_MAP
+  if (m_extentMap) {
+    if (m_extentMap->get(index, &m_curCluster)) {
+      return 1;
+    }
+    int8_t fg = m_vol->fatGet(m_curCluster, &m_curCluster);
+    if (fg > 0) {
+      m_extentMap->put(index, m_curCluster);
+    }
+    return fg;
+  }
+#endif  // USE_FILE_EXTENT_MAP
+  return m_vol->fatGet(m_curCluster, &m_curCluster);
+}
+//-----------------------------------------------------------------------------
 bool ExFatFile::openNext(ExFatFile* dir, uint8_t oflag) {
   if (isOpen() || !dir->isDir() || (dir->curPosition() & 0X1F)) {
     DBG_FAIL_MACRO;
@@ -82,6 +158,28 @@ bool ExFatFile::openNext(ExFatFile* dir, uint8_t oflag) {
  fail:
   return false;
 }
+//-----------------------------------------------------------------------------
+bool ExFatFile::openNext(ExFatFile* dir, uint8_t oflag,
+                         ExChar_t* name, size_t size) {
+  if (!name || size == 0) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  if (!openNext(dir, oflag)) {
+    goto fail;
+  }
+  // The name entries were just read so getName() is served by the cache.
+  // Skip them so the next call doesn't go back to an earlier sector.
+  if (!getName(name, size) || !dir->seekCur(32*(m_setCount - 1))) {
+    close();
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  return true;
+
+ fail:
+  return false;
+}
 //------------------------------------------------------------------------------
 bool ExFatFile::parsePathName(const ExChar_t* path,
                             ExName_t* fname, const ExChar_t** ptr) {
@@ -161,7 +259,7 @@ bool ExFatFile::open(ExFatFile* dirFile, const ExChar_t* path, uint8_t oflag) {
     if (*path == 0) {
       break;
     }
-    if (!open(dirFile, &fname, O_READ)) {
+    if (!openPathDir(dirFile, &fname)) {
       DBG_FAIL_MACRO;
       goto fail;
     }
@@ -175,6 +273,50 @@ fail:
   return false;
 }
 //-----------------------------------------------------------------------------
+// Open a path component that should be a directory.
+bool ExFatFile::openPathDir(ExFatFile* dirFile, ExName_t* fname) {
+#if FS_PATH_CACHE_ENTRIES
+  size_t size = fname->len*sizeof(ExChar_t);
+  FsPathCache* cache = &dirFile->m_vol->m_pathCache;
+  uint32_t parent = dirFile->m_firstCluster;
+  FsPathCacheEntry* entry = cache->get(parent, fname->lfn, size);
+  if (entry) {
+    memset(this, 0, sizeof(ExFatFile));
+    m_attributes = entry->attributes;
+    m_flags = entry->flags;
+    m_setCount = entry->count;
+    m_vol = dirFile->m_vol;
+    m_dirPos.cluster = entry->location;
+    m_dirPos.position = entry->position;
+    m_dirPos.isContiguous = dirFile->isContiguous();
+    m_firstCluster = entry->cluster;
+    m_dataLength = entry->length;
+    m_validLength = entry->length;
+    return true;
+  }
+  if (!open(dirFile, fname, O_READ)) {
+    return false;
+  }
+  // Directory length must fit the cache entry.
+  if (isSubDir() && m_validLength == m_dataLength &&
+      m_dataLength <= 0XFFFFFFFF) {
+    entry = cache->put(parent, fname->lfn, size);
+    if (entry) {
+      entry->position = m_dirPos.position;
+      entry->location = m_dirPos.cluster;
+      entry->cluster = m_firstCluster;
+      entry->length = m_dataLength;
+      entry->attributes = m_attributes;
+      entry->flags = m_flags;
+      entry->count = m_setCount;
+    }
+  }
+  return true;
+#else  // FS_PATH_CACHE_ENTRIES
+  return open(dirFile, fname, O_READ);
+#endif  // FS_PATH_CACHE_ENTRIES
+}
+//-----------------------------------------------------------------------------
 bool ExFatFile::openRootFile(ExFatFile* dir, const ExChar_t* name,
                           uint8_t nameLength, uint8_t oflag) {
   int n;
@@ -193,49 +335,40 @@ bool ExFatFile::openRootFile(ExFatFile* dir, const ExChar_t* name,
   uint8_t freeCount = 0;
   uint8_t freeNeed;
   bool inSet = false;
+  int8_t fg;
+  uint8_t setCount = 0;
+  uint16_t setAttributes = 0;
+  uint32_t sector;
+  uint32_t ns;
+  const uint8_t* src;
+  ExFatVolume* vol;
+  DirPos_t pos;
+  DirPos_t setPos;
 
   // error if already open
   if (isOpen() || !dir->isDir()) {
     DBG_FAIL_MACRO;
     goto fail;
   }
-  if (name) {
-    nameHash = exFatHashName(name, nameLength, 0);
-    dir->rewind();
-  }
   freeNeed = 2 + (nameLength + 14)/15;
-
-  while (1) {
-    n = dir->read(buf, 32);
-    if (n == 0) {
-      goto create;
-    }
-    if (n != 32) {
-      DBG_FAIL_MACRO;
-      goto fail;
-    }
-    if (!(buf[0] & 0x80)) {
-      if (freeCount == 0) {
-        freePos.position = dir->curPosition() - 32;
-        freePos.cluster = dir->curCluster();
-      }
-      if (freeCount < freeNeed) {
-        freeCount++;
-      }
-      if (!buf[0]) {
+  if (!name) {
+    // Open the next file from the current position.
+    while (1) {
+      n = dir->read(buf, 32);
+      if (n == 0) {
         goto create;
       }
-    } else if (!inSet) {
-      if (freeCount < freeNeed) {
-        freeCount = 0;
+      if (n != 32) {
+        DBG_FAIL_MACRO;
+        goto fail;
       }
-      if (buf[0] != EXFAT_TYPE_FILE) {
+      if (!(buf[0] & 0x80)) {
+        if (!buf[0]) {
+          goto create;
+        }
         continue;
       }
-      inSet = true;
-    }
-    switch (buf[0]) {
-      case EXFAT_TYPE_FILE:
+      if (buf[0] == EXFAT_TYPE_FILE) {
         memset(this, 0, sizeof(ExFatFile));
         dirFile = reinterpret_cast<DirFile_t*>(buf);
         m_setCount = dirFile->setCount;
@@ -248,50 +381,140 @@ bool ExFatFile::openRootFile(ExFatFile* dir, const ExChar_t* name,
         m_dirPos.cluster = dir->curCluster();
         m_dirPos.position = dir->curPosition() - 32;
         m_dirPos.isContiguous = dir->isContiguous();
-        break;
-
-      case EXFAT_TYPE_STREAM:
+        inSet = true;
+      } else if (buf[0] == EXFAT_TYPE_STREAM && inSet) {
         dirStream = reinterpret_cast<DirStream_t*>(buf);
         m_flags = oflag & FILE_FLAG_OFLAG;
         if (dirStream->flags & EXFAT_FLAG_CONTIGUOUS) {
           m_flags |= FILE_FLAG_CONTIGUOUS;
         }
-        nameOffset = 0;
         m_validLength = getLe64(dirStream->validLength);
         m_firstCluster = getLe32(dirStream->firstCluster);
         m_dataLength = getLe64(dirStream->dataLength);
-        if (!name) {
-          goto found;
+        goto found;
+      }
+    }
+  }
+  nameHash = exFatHashName(name, nameLength, 0);
+  dir->rewind();
+  // Scan entries in place a sector at a time.  Entry sets are rejected by
+  // the name length and hash in the stream entry before names are compared.
+  vol = dir->volume();
+  pos.cluster = dir->isRoot() ? vol->rootDirectoryCluster()
+                              : dir->m_firstCluster;
+  pos.position = 0;
+  pos.isContiguous = dir->isContiguous();
+  while (1) {
+    if (pos.isContiguous && pos.position >= dir->m_validLength) {
+      goto scanEnd;
+    }
+    ns = (pos.position & vol->clusterMask()) >> vol->bytesPerSectorShift();
+    sector = vol->clusterStartSector(pos.cluster) + ns;
+    src = nullptr;
+#if FS_READ_AHEAD_SECTORS
+    src = vol->cacheReadAhead(sector, vol->sectorsPerCluster() - ns);
+#endif  // FS_READ_AHEAD_SECTORS
+    if (!src) {
+      src = vol->dataCacheGet(sector, FsCache::CACHE_FOR_READ);
+      if (!src) {
+        DBG_FAIL_MACRO;
+        goto fail;
+      }
+    }
+    for (const uint8_t* end = src + vol->bytesPerSector();
+         src < end; src += 32, pos.position += 32) {
+      if (!(src[0] & 0x80)) {
+        if (freeCount == 0) {
+          freePos = pos;
         }
+        if (freeCount < freeNeed) {
+          freeCount++;
+        }
+        if (!src[0]) {
+          pos.position += 32;
+          goto scanEnd;
+        }
+        inSet = false;
+        continue;
+      }
+      if (freeCount < freeNeed) {
+        freeCount = 0;
+      }
+      if (src[0] == EXFAT_TYPE_FILE) {
+        dirFile = reinterpret_cast<DirFile_t*>(const_cast<uint8_t*>(src));
+        setCount = dirFile->setCount;
+        setAttributes = getLe16(dirFile->attributes);
+        setPos = pos;
+        inSet = true;
+      } else if (!inSet) {
+        continue;
+      } else if (src[0] == EXFAT_TYPE_STREAM) {
+        dirStream = reinterpret_cast<DirStream_t*>(const_cast<uint8_t*>(src));
         if (nameLength != dirStream->nameLength ||
             nameHash != getLe16(dirStream->nameHash)) {
           inSet = false;
-          break;
+          continue;
         }
-        break;
-
-      case EXFAT_TYPE_NAME:
-        dirName = reinterpret_cast<DirName_t*>(buf);
+        memset(this, 0, sizeof(ExFatFile));
+        m_setCount = setCount;
+        m_attributes = setAttributes & FILE_ATTR_COPY;
+        if (!(m_attributes & EXFAT_ATTRIB_DIRECTORY)) {
+          m_attributes |= FILE_ATTR_FILE;
+        }
+        m_vol = vol;
+        m_dirPos = setPos;
+        m_flags = oflag & FILE_FLAG_OFLAG;
+        if (dirStream->flags & EXFAT_FLAG_CONTIGUOUS) {
+          m_flags |= FILE_FLAG_CONTIGUOUS;
+        }
+        nameOffset = 0;
+        m_validLength = getLe64(dirStream->validLength);
+        m_firstCluster = getLe32(dirStream->firstCluster);
+        m_dataLength = getLe64(dirStream->dataLength);
+      } else if (src[0] == EXFAT_TYPE_NAME) {
+        dirName = reinterpret_cast<DirName_t*>(const_cast<uint8_t*>(src));
         nCmp = nameLength - nameOffset;
         if (nCmp > 15) {
           nCmp = 15;
         }
         if (!exFatCmpName(dirName, name, nameOffset, nCmp)) {
           inSet = false;
-          break;
+          continue;
         }
         nameOffset += nCmp;
-
         if (nameOffset == nameLength) {
+          // Leave dir positioned after the entry set.
+          dir->m_curPosition = pos.position + 32;
+          dir->m_curCluster = pos.cluster;
           goto found;
         }
-        break;
-
-      default:
-        break;
+      }
+    }
+    if ((pos.position & vol->clusterMask()) == 0) {
+      if (pos.isContiguous) {
+        if (pos.position >= dir->m_validLength) {
+          goto scanEnd;
+        }
+        pos.cluster++;
+      } else {
+        fg = vol->fatGet(pos.cluster, &pos.cluster);
+        if (fg < 0) {
+          DBG_FAIL_MACRO;
+          goto fail;
+        }
+        if (fg == 0) {
+          goto scanEnd;
+        }
+      }
     }
   }
 
+ scanEnd:
+  // Position dir after the last entry read for create.
+  dir->m_curPosition = pos.position;
+  dir->m_curCluster = pos.cluster;
+  goto create;
+
  found:
   // Don't open if create only.
   if (oflag & O_EXCL) {
@@ -509,15 +732,97 @@ size_t ExFatFile::printName(print_t* pr) {
   return 0;
 }
 //-----------------------------------------------------------------------------
+// Find the device sector for m_curPosition and its index in the cluster.
+// m_curCluster is advanced at the start of a cluster.  Return one for
+// success, zero at the end of a directory's cluster chain, or -1 for error.
+int8_t ExFatFile::curSector(uint32_t* sector, uint32_t* sectorOfCluster) {
+  uint32_t clusterOffset = m_curPosition & m_vol->clusterMask();
+  if (clusterOffset == 0) {
+    if (m_curPosition == 0) {
+      m_curCluster = isRoot()
+                     ? m_vol->rootDirectoryCluster() : m_firstCluster;
+    } else if (isContiguous()) {
+      m_curCluster++;
+    } else {
+      int8_t fg = nextCluster(m_curPosition >> m_vol->bytesPerClusterShift());
+      if (fg < 0 || (fg == 0 && !isDir())) {
+        DBG_FAIL_MACRO;
+        return -1;
+      }
+      if (fg == 0) {
+        // EOF if directory.
+        return 0;
+      }
+    }
+  }
+  *sectorOfCluster = clusterOffset >> m_vol->bytesPerSectorShift();
+  *sector = m_vol->clusterStartSector(m_curCluster) + *sectorOfCluster;
+  return 1;
+}
+//-----------------------------------------------------------------------------
+// Return a pointer to the data at the current position in *ptr and the
+// number of bytes left in the sector or file.  The caller must consume at
+// least one byte since m_curCluster is advanced at the start of a cluster.
+int ExFatFile::readCache(const uint8_t** ptr) {
+  int8_t fg;
+  size_t n;
+  uint16_t sectorOffset;
+  uint32_t sector;
+  uint32_t sectorOfCluster;
+  const uint8_t* src = nullptr;
+
+  if (!isReadable()) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  sectorOffset = m_curPosition & m_vol->sectorMask();
+  n = m_vol->bytesPerSector() - sectorOffset;
+  if (isContiguous() || isFile()) {
+    if ((m_curPosition + n) > m_validLength) {
+      n = m_validLength - m_curPosition;
+    }
+  }
+  if (n == 0) {
+    return 0;
+  }
+  fg = curSector(&sector, &sectorOfCluster);
+  if (fg < 0) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  if (fg == 0) {
+    return 0;
+  }
+#if FS_READ_AHEAD_SECTORS
+  if (isFile()) {
+    // use read-ahead buffer for sequential reads
+    uint32_t ns = m_vol->sectorsPerCluster() - sectorOfCluster;
+    src = m_vol->cacheReadAhead(sector, ns);
+  }
+#endif  // FS_READ_AHEAD_SECTORS
+  if (!src) {
+    src = m_vol->dataCacheGet(sector, FsCache::CACHE_FOR_READ);
+    if (!src) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+  }
+  *ptr = src + sectorOffset;
+  return n;
+
+fail:
+  m_error |= READ_ERROR;
+  return -1;
+}
+//-----------------------------------------------------------------------------
 int ExFatFile::read(void* buf, size_t count) {
   uint8_t* dst = reinterpret_cast<uint8_t*>(buf);
   int8_t fg;
   size_t toRead = count;
   size_t n;
-  uint8_t* cache;
   uint16_t sectorOffset;
   uint32_t sector;
-  uint32_t clusterOffset;
+  uint32_t sectorOfCluster;
 
   if (!isReadable()) {
     DBG_FAIL_MACRO;
@@ -529,59 +834,50 @@ int ExFatFile::read(void* buf, size_t count) {
     }
   }
   while (toRead) {
-    clusterOffset = m_curPosition & m_vol->clusterMask();
-    sectorOffset = clusterOffset & m_vol->sectorMask();
-    if (clusterOffset == 0) {
-      if (m_curPosition == 0) {
-        m_curCluster = isRoot()
-                       ? m_vol->rootDirectoryCluster() : m_firstCluster;
-      } else if (isContiguous()) {
-        m_curCluster++;
-      } else {
-        fg = m_vol->fatGet(m_curCluster, &m_curCluster);
-        if (fg < 0) {
-          DBG_FAIL_MACRO;
-          goto fail;
-        }
-        if (fg == 0) {
-          // EOF if directory.
-          if (isDir()) {
-            break;
-          }
-          DBG_FAIL_MACRO;
-          goto fail;
-        }
-      }
+    sectorOffset = m_curPosition & m_vol->sectorMask();
+    fg = curSector(&sector, &sectorOfCluster);
+    if (fg < 0) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    if (fg == 0) {
+      break;
     }
-    sector = m_vol->clusterStartSector(m_curCluster) +
-             (clusterOffset >> m_vol->bytesPerSectorShift());
     if (sectorOffset != 0 || toRead < m_vol->bytesPerSector()
-                          || sector == m_vol->dataCacheSector()) {
+                          || m_vol->dataCacheContains(sector)) {
       n = m_vol->bytesPerSector() - sectorOffset;
       if (n > toRead) {
         n = toRead;
       }
-      // read sector to cache and copy data to caller
-      cache = m_vol->dataCacheGet(sector, FsCache::CACHE_FOR_READ);
-      if (!cache) {
-        DBG_FAIL_MACRO;
-        goto fail;
+      const uint8_t* src = nullptr;
+#if FS_READ_AHEAD_SECTORS
+      if (isFile()) {
+        // use read-ahead buffer for sequential reads
+        uint32_t ns = m_vol->sectorsPerCluster() - sectorOfCluster;
+        src = m_vol->cacheReadAhead(sector, ns);
+      }
+#endif  // FS_READ_AHEAD_SECTORS
+      if (!src) {
+        // read sector to cache
+        src = m_vol->dataCacheGet(sector, FsCache::CACHE_FOR_READ);
+        if (!src) {
+          DBG_FAIL_MACRO;
+          goto fail;
+        }
       }
-      uint8_t* src = cache + sectorOffset;
-      memcpy(dst, src, n);
+      // copy data to caller
+      memcpy(dst, src + sectorOffset, n);
 #if USE_MULTI_SECTOR_IO
     } else if (toRead >= 2*m_vol->bytesPerSector()) {
-      uint32_t ns = toRead >> m_vol->bytesPerSectorShift();
-      if (!isContiguous()) {
-        uint32_t maxNs = m_vol->sectorsPerCluster()
-                         - (clusterOffset >> m_vol->bytesPerSectorShift());
-        if (ns > maxNs) {
-          ns = maxNs;
-        }
+      // Read across adjacent clusters.
+      size_t ns = clusterRun(sectorOfCluster,
+                             toRead >> m_vol->bytesPerSectorShift(), false);
+      if (ns == 0) {
+        DBG_FAIL_MACRO;
+        goto fail;
       }
       n = ns << m_vol->bytesPerSectorShift();
-      if (m_vol->dataCacheSector() <= sector
-          && m_vol->dataCacheSector() < (sector + ns)) {
+      if (m_vol->dataCacheContains(sector, ns)) {
         // flush cache if a sector is in the cache
         if (!m_vol->dataCacheSync()) {
           DBG_FAIL_MACRO;
@@ -612,6 +908,191 @@ fail:
   return -1;
 }
 //------------------------------------------------------------------------------
+int ExFatFile::readDir(FsDirEntry* entry, size_t count,
+                       const FsDirFilter* filter) {
+  DirFile_t* dirFile;
+  DirStream_t* dirStream;
+  DirName_t* dirName;
+  uint8_t* cache;
+  bool inSet = false;
+  uint8_t nameLength = 0;
+  uint8_t nameOffset = 0;
+  size_t k = 0;
+  size_t n = 0;
+
+  if (!isDir() || (m_curPosition & 0X1F)) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  while (n < count) {
+    cache = readDirCache();
+    if (!cache) {
+      if (getError()) {
+        DBG_FAIL_MACRO;
+        goto fail;
+      }
+      break;
+    }
+    if (!(cache[0] & 0x80)) {
+      if (!cache[0]) {
+        break;
+      }
+      inSet = false;
+      continue;
+    }
+    if (cache[0] == EXFAT_TYPE_FILE) {
+      dirFile = reinterpret_cast<DirFile_t*>(cache);
+      entry->attributes = getLe16(dirFile->attributes) & FS_ATTRIB_COPY;
+      inSet = !filter || !(entry->attributes & filter->skip);
+      entry->createDateTime = getLe32(dirFile->createTime);
+      entry->modifyDateTime = getLe32(dirFile->modifyTime);
+      entry->dirPosition = m_curPosition - 32;
+      nameLength = 0;
+    } else if (!inSet) {
+      continue;
+    } else if (cache[0] == EXFAT_TYPE_STREAM) {
+      dirStream = reinterpret_cast<DirStream_t*>(cache);
+      entry->fileSize = getLe64(dirStream->validLength);
+      entry->firstCluster = getLe32(dirStream->firstCluster);
+      nameLength = dirStream->nameLength;
+      nameOffset = 0;
+      k = 0;
+    } else if (cache[0] == EXFAT_TYPE_NAME && nameOffset < nameLength) {
+      // Names are decoded in place and truncated to fit the entry.
+      dirName = reinterpret_cast<DirName_t*>(cache);
+      for (uint8_t in = 0; in < 15 && nameOffset < nameLength; in++) {
+        uint16_t c = getLe16(dirName->unicode + 2*in);
+        if ((k + 1) < sizeof(entry->name)) {
+          entry->name[k++] = c < 0X7F ? c : '?';
+        }
+        nameOffset++;
+      }
+      if (nameOffset < nameLength) {
+        continue;
+      }
+      entry->name[k] = 0;
+      inSet = false;
+      if (filter && !filter->matchName(entry->name)) {
+        continue;
+      }
+      entry++;
+      n++;
+    }
+  }
+  return n;
+
+fail:
+  return -1;
+}
+//------------------------------------------------------------------------------
+// Read the next 32 byte directory entry into the cache.
+uint8_t* ExFatFile::readDirCache() {
+  DirPos_t pos;
+  uint8_t b;
+  int n = read(&b, 1);
+  if (n != 1) {
+    if (n != 0) {
+      DBG_FAIL_MACRO;
+    }
+    goto fail;
+  }
+  pos.cluster = m_curCluster;
+  pos.position = m_curPosition - 1;
+  m_curPosition += 31;
+  return m_vol->dirCache(&pos, FsCache::CACHE_FOR_READ);
+
+fail:
+  return nullptr;
+}
+//------------------------------------------------------------------------------
+int ExFatFile::readLine(const char** line, char* buf, size_t size,
+                        const char* delim) {
+  FsLineScan scan(delim);
+  const uint8_t* src;
+  const uint8_t* end;
+  size_t k;
+  size_t len;
+  size_t used;
+  int n;
+  int m;
+  if (size < 2) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  m = readCache(&src);
+  if (m <= 0) {
+    // EOF or read error
+    goto fail;
+  }
+  end = scan.find(src, m);
+  if (end) {
+    len = end - src;
+    k = len && end[-1] == '\r' ? len - 1 : len;
+    if ((k + 1) < size && !memchr(src, '\r', k)) {
+      // return the line in the cache
+      m_curPosition += len + 1;
+      *line = reinterpret_cast<const char*>(src);
+      return k;
+    }
+    len++;
+  } else {
+    len = m;
+  }
+  // copy the line to buf
+  *line = buf;
+  used = FsLineScan::copy(buf, size - 1, src, len, &k);
+  m_curPosition += used;
+  n = k;
+  if (!(end && used == len) && (n + 1) < (int)size) {
+    m = fgets(buf + n, size - n, const_cast<char*>(delim));
+    if (m < 0) {
+      goto fail;
+    }
+    n += m;
+  }
+  if (n == 0) {
+    // only CR before EOF
+    goto fail;
+  }
+  buf[n] = '\0';
+  if (scan.isDelim(buf[n - 1])) {
+    buf[--n] = '\0';
+  }
+  return n;
+
+fail:
+  return -1;
+}
+//------------------------------------------------------------------------------
+int ExFatFile::readUntil(char terminator, void* buf, size_t count) {
+  char* dst = reinterpret_cast<char*>(buf);
+  const uint8_t* src;
+  const void* end;
+  size_t n = 0;
+  while (n < count) {
+    int m = readCache(&src);
+    if (m <= 0) {
+      if (m < 0) {
+        return -1;
+      }
+      break;
+    }
+    size_t k = (count - n) < (size_t)m ? count - n : m;
+    end = memchr(src, terminator, k);
+    if (end) {
+      k = reinterpret_cast<const uint8_t*>(end) - src;
+      memcpy(dst + n, src, k);
+      // skip terminator
+      m_curPosition += k + 1;
+      return n + k;
+    }
+    memcpy(dst + n, src, k);
+    m_curPosition += k;
+    n += k;
+  }
+  return n;
+}
+//------------------------------------------------------------------------------
 bool ExFatFile::remove(const ExChar_t* path) {
   ExFatFile file;
   if (!file.open(this, path, O_WRITE)) {
@@ -659,12 +1140,17 @@ bool ExFatFile::seekSet(uint64_t pos) {
   if (nNew < nCur || m_curPosition == 0) {
     // must follow chain from first cluster
     m_curCluster = isRoot() ? m_vol->rootDirectoryCluster() : m_firstCluster;
-  } else {
-    // advance from curPosition
-    nNew -= nCur;
+    nCur = 0;
   }
-  while (nNew--) {
-    if (m_vol->fatGet(m_curCluster, &m_curCluster) <= 0) {
+#if USE_FILE_EXTENT_MAP
+  if (m_extentMap && m_extentMap->mappedCount() > nCur) {
+    // start at the mapped cluster closest to the new position
+    nCur = m_extentMap->lookup(nNew, &m_curCluster);
+  }
+#endif  // USE_FILE_EXTENT_MAP
+  // advance from cluster nCur
+  while (nCur < nNew) {
+    if (nextCluster(++nCur) <= 0) {
       DBG_FAIL_MACRO;
       goto fail;
     }
@@ -678,3 +1164,23 @@ fail:
   m_curCluster = tmp;
   return false;
 }
+#if USE_FILE_EXTENT_MAP
+//------------------------------------------------------------------------------
+bool ExFatFile::setExtentMap(FsExtentMap* map) {
+  if (!isFile()) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  m_extentMap = map;
+  if (map) {
+    map->clear();
+    if (m_firstCluster) {
+      map->put(0, m_firstCluster);
+    }
+  }
+  return true;
+
+fail:
+  return false;
+}
+#endif  // USE_FILE_EXTENT_MAP
@@ -28,23 +28,22 @@
 #include "../common/PrintTemplates.h"
 #include "ExFatVolume.h"
 //-----------------------------------------------------------------------------
-size_t ExFatFile::printFileSize(print_t* pr) {
-  uint64_t n = m_validLength;
+static size_t printSize(print_t* pr, uint64_t n) {
   char buf[21];
   char *str = &buf[sizeof(buf) - 1];
   char *bgn = str - 12;
   *str = '\0';
-  do {
-    uint64_t m = n;
-    n /= 10;
-    *--str = m - 10*n + '0';
-  } while (n);
+  str = fmtBase10(str, n);
   while (str > bgn) {
     *--str = ' ';
   }
   return pr->write(str);
 }
 //-----------------------------------------------------------------------------
+size_t ExFatFile::printFileSize(print_t* pr) {
+  return printSize(pr, m_validLength);
+}
+//-----------------------------------------------------------------------------
 size_t ExFatFile::printCreateDateTime(print_t* pr) {
   DirFile_t* df = reinterpret_cast<DirFile_t*>
                  (m_vol->dirCache(&m_dirPos, FsCache::CACHE_FOR_READ));
@@ -70,47 +69,58 @@ fail:
 }
 //------------------------------------------------------------------------------
 void ExFatFile::ls(print_t* pr) {
-  ExFatFile file;
-  rewind();
-  while (file.openNext(this, O_READ)) {
-    if (!file.isHidden()) {
-      file.printName(pr);
-      if (file.isDir()) {
-        pr->write('/');
-      }
-      pr->write('\r');
-      pr->write('\n');
-    }
-    file.close();
-  }
+  ls(pr, 0);
 }
 //------------------------------------------------------------------------------
 void ExFatFile::ls(print_t* pr, uint8_t flags, uint8_t indent) {
-  ExFatFile file;
+  FsDirEntry entry;
+  lsDir(pr, flags, indent, &entry);
+}
+//------------------------------------------------------------------------------
+// One entry is shared by all levels of a recursive list.  It is not used
+// after the call to list a subdirectory.
+void ExFatFile::lsDir(print_t* pr, uint8_t flags, uint8_t indent,
+                      FsDirEntry* entry) {
+  FsDirFilter filter = {FS_ATTRIB_HIDDEN, nullptr};
+  if (flags & LS_A) {
+    filter.skip = 0;
+  }
   rewind();
-  while (file.openNext(this, O_READ)) {
-    // indent for dir level
-    if (!file.isHidden() || (flags & LS_A)) {
-      for (uint8_t i = 0; i < indent; i++) {
-        pr->write(' ');
-      }
-      if (flags & LS_DATE) {
-        file.printModifyDateTime(pr);
-        pr->write(' ');
-      }
-      if (flags & LS_SIZE) {
-        file.printFileSize(pr);
-        pr->write(' ');
+  while (readDir(entry, 1, &filter) == 1) {
+    ExFatFile file;
+    // Open the file only to recurse or for a name too long for entry.
+    if (entry->isTruncated() || ((flags & LS_R) && entry->isDir())) {
+      uint32_t pos = curPosition();
+      if (!seekSet(entry->dirPosition) || !file.openNext(this, O_READ) ||
+          !seekSet(pos)) {
+        DBG_FAIL_MACRO;
+        return;
       }
+    }
+    // indent for dir level
+    for (uint8_t i = 0; i < indent; i++) {
+      pr->write(' ');
+    }
+    if (flags & LS_DATE) {
+      fsPrintDateTime(pr, entry->modifyDateTime);
+      pr->write(' ');
+    }
+    if (flags & LS_SIZE) {
+      printSize(pr, entry->fileSize);
+      pr->write(' ');
+    }
+    if (entry->isTruncated()) {
       file.printName(pr);
-      if (file.isDir()) {
-        pr->write('/');
-      }
-      pr->write('\r');
-      pr->write('\n');
-      if ((flags & LS_R) && file.isDir()) {
-        file.ls(pr, flags, indent + 2);
-      }
+    } else {
+      pr->write(entry->name);
+    }
+    if (entry->isDir()) {
+      pr->write('/');
+    }
+    pr->write('\r');
+    pr->write('\n');
+    if ((flags & LS_R) && entry->isDir()) {
+      file.lsDir(pr, flags, indent + 2, entry);
     }
     file.close();
   }
@@ -118,21 +128,27 @@ void ExFatFile::ls(print_t* pr, uint8_t flags, uint8_t indent) {
 //------------------------------------------------------------------------------
 int ExFatFile::printf(const char* fmt, ...) {
   va_list ap;
+  FmtBuffer<ExFatFile> buf(this);
   va_start(ap, fmt);
-  return vfprintf(this, fmt, ap);
+  int n = vfprintf(&buf, fmt, ap);
+  return buf.flush() ? n : -1;
 }
 //------------------------------------------------------------------------------
 int ExFatFile::mprintf(const char* fmt, ...) {
   va_list ap;
+  FmtBuffer<ExFatFile> buf(this);
   va_start(ap, fmt);
-  return vmprintf(this, fmt, ap);
+  int n = vmprintf(&buf, fmt, ap);
+  return buf.flush() ? n : -1;
 }
 #if ENABLE_ARDUINO_FEATURES
 //------------------------------------------------------------------------------
 int ExFatFile::mprintf(const __FlashStringHelper *ifsh, ...) {
   va_list ap;
+  FmtBuffer<ExFatFile> buf(this);
   va_start(ap, ifsh);
-  return vmprintf(this, ifsh, ap);
+  int n = vmprintf(&buf, ifsh, ap);
+  return buf.flush() ? n : -1;
 }
 #endif  // ENABLE_ARDUINO_FEATURES
 
@@ -146,6 +146,8 @@ bool ExFatFile::addDirCluster() {
     }
   }
   if (!isRoot()) {
+    // Cached paths may have the old length.
+    m_vol->pathCacheClear();
     m_flags |= FILE_FLAG_DIR_DIRTY;
     m_dataLength  += m_vol->bytesPerCluster();
     m_validLength += m_vol->bytesPerCluster();
@@ -245,6 +247,8 @@ bool ExFatFile::preAllocate(uint64_t length) {
     DBG_FAIL_MACRO;
     goto fail;
   }
+  // New clusters have no data so the device may pre-erase them.
+  m_vol->preEraseHint(find, need);
   m_dataLength = length;
   m_firstCluster = find;
   m_flags |= FILE_FLAG_DIR_DIRTY | FILE_FLAG_CONTIGUOUS;
@@ -294,6 +298,8 @@ bool ExFatFile::remove() {
     // Mark entry not used.
     cache[0] &= 0x7F;
   }
+  // Cached paths may use the removed entry.
+  m_vol->pathCacheClear();
   // Set this file closed.
   m_attributes = FILE_ATTR_CLOSED;
   m_flags = 0;
@@ -418,8 +424,8 @@ bool ExFatFile::syncDir() {
         df = reinterpret_cast<DirFile_t*>(cache);
         setCount = df->setCount;
         setLe16(df->attributes, m_attributes & FILE_ATTR_COPY);
+        m_vol->dataCacheDirty();
         if (FsDateTime::callback) {
-          m_vol->dataCacheDirty();
           uint16_t date, time;
           FsDateTime::callback(&date, &time);
           setLe16(df->modifyTime, time);
@@ -527,6 +533,12 @@ bool ExFatFile::truncate() {
   }
   m_dataLength = m_curPosition;
   m_validLength = m_curPosition;
+#if USE_FILE_EXTENT_MAP
+  if (m_extentMap) {
+    m_extentMap->truncate(m_curCluster ?
+      1 + ((m_curPosition - 1) >> m_vol->bytesPerClusterShift()) : 0);
+  }
+#endif  // USE_FILE_EXTENT_MAP
   m_flags |= FILE_FLAG_DIR_DIRTY;
   return sync();
 
@@ -568,7 +580,9 @@ size_t ExFatFile::write(const void* buf, size_t nbyte) {
 
         if (isContiguous()) {
           uint32_t lc = m_firstCluster;
-          lc += (m_dataLength - 1) >> m_vol->bytesPerClusterShift();
+          if (m_dataLength) {
+            lc += (m_dataLength - 1) >> m_vol->bytesPerClusterShift();
+          }
           if (m_curCluster < lc) {
             m_curCluster++;
             fg = 1;
@@ -576,7 +590,7 @@ size_t ExFatFile::write(const void* buf, size_t nbyte) {
             fg = 0;
           }
         } else {
-          fg = m_vol->fatGet(m_curCluster, &m_curCluster);
+          fg = nextCluster(m_curPosition >> m_vol->bytesPerClusterShift());
           if (fg < 0) {
             DBG_FAIL_MACRO;
             goto fail;
@@ -601,6 +615,13 @@ size_t ExFatFile::write(const void* buf, size_t nbyte) {
           m_curCluster = m_firstCluster;
         }
       }
+#if USE_FILE_EXTENT_MAP
+      if (m_extentMap) {
+        // record a new cluster - ignored if already mapped
+        m_extentMap->put(m_curPosition >> m_vol->bytesPerClusterShift(),
+                         m_curCluster);
+      }
+#endif  // USE_FILE_EXTENT_MAP
     }
     // sector for data write
     sector = m_vol->clusterStartSector(m_curCluster) +
@@ -630,28 +651,32 @@ size_t ExFatFile::write(const void* buf, size_t nbyte) {
       uint8_t* dst = cache + sectorOffset;
       memcpy(dst, src, n);
       if (m_vol->bytesPerSector() == (n + sectorOffset)) {
+#if FS_WRITE_BUFFER_SECTORS
+        // Move full sector to the write-behind buffer.
+        if (!m_vol->writeBehind(sector, cache)) {
+          DBG_FAIL_MACRO;
+          goto fail;
+        }
+#else  // FS_WRITE_BUFFER_SECTORS
         // Force write if sector is full - improves large writes.
         if (!m_vol->dataCacheSync()) {
           DBG_FAIL_MACRO;
           goto fail;
         }
+#endif  // FS_WRITE_BUFFER_SECTORS
       }
 #if USE_MULTI_SECTOR_IO
     } else if (toWrite >= 2*m_vol->bytesPerSector()) {
-      // use multiple sector write command
-      uint32_t ns = toWrite >> m_vol->bytesPerSectorShift();
-      // Limit writes to current cluster.
-      uint32_t maxNs = m_vol->sectorsPerCluster()
-                       - (clusterOffset >> m_vol->bytesPerSectorShift());
-      if (ns > maxNs) {
-        ns = maxNs;
+      // use multiple sector write command across adjacent clusters
+      size_t ns = clusterRun(clusterOffset >> m_vol->bytesPerSectorShift(),
+                             toWrite >> m_vol->bytesPerSectorShift(), true);
+      if (ns == 0) {
+        DBG_FAIL_MACRO;
+        goto fail;
       }
       n = ns << m_vol->bytesPerSectorShift();
-      if (m_vol->dataCacheSector() <= sector
-          && m_vol->dataCacheSector() < (sector + ns)) {
-        // invalidate cache if sector is in cache
-        m_vol->dataCacheInvalidate();
-      }
+      // invalidate cached sectors that will be overwritten
+      m_vol->dataCacheInvalidate(sector, ns);
       if (!m_vol->writeSectors(sector, src, ns)) {
         DBG_FAIL_MACRO;
         goto fail;
@@ -660,10 +685,7 @@ size_t ExFatFile::write(const void* buf, size_t nbyte) {
     } else {
       // use single sector write command
       n = m_vol->bytesPerSector();
-      if (m_vol->dataCacheSector() == sector) {
-        m_vol->dataCacheInvalidate();
-      }
-      if (!m_vol->writeSector(sector, src)) {
+      if (!m_vol->writeBehind(sector, src)) {
         DBG_FAIL_MACRO;
         goto fail;
       }
@@ -26,51 +26,6 @@
 #include "ExFatVolume.h"
 #include "../common/FsStructs.h"
 
-//-----------------------------------------------------------------------------
-void FsCache::invalidate() {
-  m_status = 0;
-  m_sector = 0XFFFFFFFF;
-}
-//-----------------------------------------------------------------------------
-uint8_t* FsCache::get(uint32_t sector, uint8_t option) {
-  if (!m_blockDev) {
-    DBG_FAIL_MACRO;
-    goto fail;
-  }
-  if (m_sector != sector) {
-    if (!sync()) {
-      DBG_FAIL_MACRO;
-      goto fail;
-    }
-    if (!(option & CACHE_OPTION_NO_READ)) {
-      if (!m_blockDev->readSector(sector, m_cacheBuffer)) {
-        DBG_FAIL_MACRO;
-        goto fail;
-      }
-    }
-    m_status = 0;
-    m_sector = sector;
-  }
-  m_status |= option & CACHE_STATUS_MASK;
-  return m_cacheBuffer;
-
-fail:
-  return nullptr;
-}
-//------------------------------------------------------------------------------
-bool FsCache::sync() {
-  if (m_status & CACHE_STATUS_DIRTY) {
-    if (!m_blockDev->writeSector(m_sector, m_cacheBuffer)) {
-      DBG_FAIL_MACRO;
-      goto fail;
-    }
-    m_status &= ~CACHE_STATUS_DIRTY;
-  }
-  return true;
-
-fail:
-  return false;
-}
 //=============================================================================
 bool ExFatPartition::init(BlockDevice* dev, uint8_t part) {
   uint32_t volStart = 0;
@@ -130,51 +85,115 @@ bool ExFatPartition::init(BlockDevice* dev, uint8_t part) {
   return false;
 }
 //-----------------------------------------------------------------------------
+// Number of bits in a bitmap sector.
+const uint32_t BITS_PER_SECTOR = 8*512;
+//-----------------------------------------------------------------------------
+// Count set bits in the first nb bits of a bitmap.
+static uint32_t bitmapCount(const uint8_t* bitmap, uint32_t nb) {
+  uint32_t n = 0;
+  for (; nb >= 32; nb -= 32, bitmap += 4) {
+    n += popcount32(getLe32(bitmap));
+  }
+  if (nb) {
+    n += popcount32(getLe32(bitmap) & ((1UL << nb) - 1));
+  }
+  return n;
+}
+//-----------------------------------------------------------------------------
 // return 0 if error, 1 if no space, else start cluster.
 uint32_t ExFatPartition::bitmapFind(uint32_t cluster, uint32_t count) {
   uint32_t start = cluster ? cluster - 2 : m_bitmapStart;
+  uint32_t found;
+  int8_t rtn;
   if (start >= m_clusterCount) {
     start = 0;
   }
-  uint32_t endAlloc = start;
-  uint32_t bgnAlloc = start;
-  uint16_t sectorSize = 1 << m_bytesPerSectorShift;
-  size_t i = (start >> 3) & (sectorSize - 1);
-  uint8_t* cache;
-  uint8_t mask = 1 << (start & 7);
-  while (true) {
-    uint32_t sector = m_clusterHeapStartSector +
-                     (endAlloc >> (m_bytesPerSectorShift + 3));
-    cache = bitmapCacheGet(sector, FsCache::CACHE_FOR_READ);
+  // Search from start to end of bitmap then wrap to start.
+  rtn = bitmapFindRun(start, m_clusterCount, count, &found);
+  if (rtn == 0 && start) {
+    rtn = bitmapFindRun(0, start, count, &found);
+  }
+  if (rtn < 0) {
+    return 0;
+  }
+  if (rtn == 0) {
+    return 1;
+  }
+  if (cluster == 0 && count == 1) {
+    // Start at found sector.  bitmapModify may increase this.
+    m_bitmapStart = found;
+  }
+  return found + 2;
+}
+//-----------------------------------------------------------------------------
+// Find count free clusters in [bgn, end) a word at a time.
+// return -1 if error, 0 if not found, 1 if found.
+int8_t ExFatPartition::bitmapFindRun(uint32_t bgn, uint32_t end,
+                                     uint32_t count, uint32_t* found) {
+  uint32_t pos = bgn;
+  // Length of free run that ends at pos.
+  uint32_t run = 0;
+  while (pos < end) {
+    uint32_t sector = m_clusterHeapStartSector + pos/BITS_PER_SECTOR;
+    uint32_t sectorEnd = (pos/BITS_PER_SECTOR + 1)*BITS_PER_SECTOR;
+    if (sectorEnd > end) {
+      sectorEnd = end;
+    }
+    uint8_t* cache = bitmapCacheGet(sector, FsCache::CACHE_FOR_READ);
     if (!cache) {
-      return 0;
+      DBG_FAIL_MACRO;
+      return -1;
     }
-    for (; i < sectorSize; i++) {
-      for (; mask; mask <<= 1) {
-        endAlloc++;
-        if (!(mask & cache[i])) {
-          if ((endAlloc - bgnAlloc) == count) {
-            if (cluster == 0 && count == 1) {
-              // Start at found sector.  bitmapModify may increase this.
-              m_bitmapStart = bgnAlloc;
-            }
-            return bgnAlloc + 2;
-          }
-        } else {
-          bgnAlloc = endAlloc;
+    while (pos < sectorEnd) {
+      uint8_t bit = pos & 31;
+      uint32_t nb = 32 - bit;
+      if (nb > (sectorEnd - pos)) {
+        nb = sectorEnd - pos;
+      }
+      uint32_t w = getLe32(cache + ((pos/8) & m_sectorMask & ~3)) >> bit;
+      if (nb < 32) {
+        w &= (1UL << nb) - 1;
+      }
+      while (nb) {
+        // Free clusters are zero bits.
+        uint32_t n = w ? ctz32(w) : 32;
+        if (n > nb) {
+          n = nb;
         }
-        if (endAlloc == start) {
+        if ((run + n) >= count) {
+          *found = pos - run;
           return 1;
         }
-        if (endAlloc >= m_clusterCount) {
-          endAlloc = bgnAlloc = 0;
-          i = sectorSize;
+        run += n;
+        pos += n;
+        nb -= n;
+        if (nb == 0) {
           break;
         }
+        w >>= n;
+        if (count >= 32) {
+          // Runs inside the word are too short so skip to the free
+          // clusters at the top of the word.
+          n = nb - (32 - clz32(w));
+          run = 0;
+          pos += nb - n;
+          nb = n;
+          w = 0;
+          continue;
+        }
+        // Skip allocated clusters.
+        n = ~w ? ctz32(~w) : 32;
+        if (n > nb) {
+          n = nb;
+        }
+        run = 0;
+        pos += n;
+        nb -= n;
+        if (n < 32) {
+          w >>= n;
+        }
       }
-      mask = 1;
     }
-    i = 0;
   }
   return 0;
 }
@@ -230,6 +249,28 @@ bool ExFatPartition::bitmapModify(uint32_t cluster,
   return false;
 }
 //-----------------------------------------------------------------------------
+#if FS_READ_AHEAD_SECTORS
+// Return sector data from the read-ahead buffer or nullptr to use the cache.
+// count is the number of sectors left in the cluster.
+const uint8_t* ExFatPartition::cacheReadAhead(uint32_t sector,
+                                              uint32_t count) {
+  const uint8_t* src = m_readAhead.get(sector);
+  if (!src && count > 1 && m_readAhead.isNext(sector) &&
+      !m_dataCache.contains(sector)) {
+    if (count > m_readAhead.capacity()) {
+      count = m_readAhead.capacity();
+    }
+    // Device must have current data for the run.
+    if ((!m_dataCache.contains(sector, count) || m_dataCache.sync()) &&
+        writeBufferSync(sector, count)) {
+      src = m_readAhead.fill(sector, count);
+    }
+  }
+  m_readAhead.setLast(sector);
+  return src;
+}
+#endif  // FS_READ_AHEAD_SECTORS
+//-----------------------------------------------------------------------------
 uint32_t ExFatPartition::chainSize(uint32_t cluster) {
   uint32_t n = 0;
   int8_t status;
@@ -342,32 +383,53 @@ bool ExFatPartition::freeChain(uint32_t cluster) {
 }
 //-----------------------------------------------------------------------------
 uint32_t ExFatPartition::freeClusterCount() {
-  uint32_t nc = 0;
   uint32_t sector = m_clusterHeapStartSector;
   uint32_t usedCount = 0;
   uint8_t* cache;
 
-  while (true) {
-    cache = dataCacheGet(sector++, FsCache::CACHE_FOR_READ);
+  for (uint32_t nc = 0; nc < m_clusterCount; nc += BITS_PER_SECTOR) {
+    cache = bitmapCacheGet(sector++, FsCache::CACHE_FOR_READ);
     if (!cache) {
       return 0;
     }
-    for (size_t i = 0; i < m_bytesPerSector; i++) {
-      if (cache[i] == 0XFF) {
-        usedCount+= 8;
-      } else if (cache[i]) {
-        for (uint8_t mask = 1; mask ; mask <<=1) {
-          if ((mask & cache[i])) {
-            usedCount++;
-          }
-        }
-      }
-      nc += 8;
-      if (nc >= m_clusterCount) {
-        return m_clusterCount - usedCount;
-      }
+    uint32_t nb = m_clusterCount - nc;
+    if (nb > BITS_PER_SECTOR) {
+      nb = BITS_PER_SECTOR;
+    }
+    usedCount += bitmapCount(cache, nb);
+  }
+  return m_clusterCount - usedCount;
+}
+//-----------------------------------------------------------------------------
+uint32_t ExFatPartition::freeClusterCount(uint8_t* buf, size_t size) {
+  uint32_t sector = m_clusterHeapStartSector;
+  uint32_t usedCount = 0;
+  size_t maxSectors = size >> m_bytesPerSectorShift;
+  if (maxSectors < 2) {
+    return freeClusterCount();
+  }
+  // Bitmap sectors on the device must be current.
+  if (!bitmapCacheSync()) {
+    DBG_FAIL_MACRO;
+    return 0;
+  }
+  uint32_t nc = 0;
+  while (nc < m_clusterCount) {
+    uint32_t nb = m_clusterCount - nc;
+    size_t ns = (nb + BITS_PER_SECTOR - 1)/BITS_PER_SECTOR;
+    if (ns > maxSectors) {
+      ns = maxSectors;
+      nb = ns*BITS_PER_SECTOR;
+    }
+    if (!readSectors(sector, buf, ns)) {
+      DBG_FAIL_MACRO;
+      return 0;
     }
+    usedCount += bitmapCount(buf, nb);
+    sector += ns;
+    nc += nb;
   }
+  return m_clusterCount - usedCount;
 }
 //-----------------------------------------------------------------------------
 uint32_t ExFatPartition::rootLength() {
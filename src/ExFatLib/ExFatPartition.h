@@ -32,84 +32,14 @@
 #include "BlockDevice.h"
 #include "ExFatConfig.h"
 #include "ExFatTypes.h"
+#include "../common/FsCache.h"
+#include "../common/FsPathCache.h"
+#include "../common/FsReadAhead.h"
+#include "../common/FsWriteBuffer.h"
 /** Type for exFAT partition */
 const uint8_t FAT_TYPE_EXFAT = 64;
 
 class ExFatFile;
-//==============================================================================
-/**
- * \class FsCache
- * \brief Sector cache.
- */
-class FsCache {
- public:
-  /** Cached sector is dirty */
-  static const uint8_t CACHE_STATUS_DIRTY = 1;
-  /** Cache sector status bits */
-  static const uint8_t CACHE_STATUS_MASK = CACHE_STATUS_DIRTY;
-  /** Sync existing sector but do not read new sector. */
-  static const uint8_t CACHE_OPTION_NO_READ = 2;
-  /** Cache sector for read. */
-  static const uint8_t CACHE_FOR_READ = 0;
-  /** Cache sector for write. */
-  static const uint8_t CACHE_FOR_WRITE = CACHE_STATUS_DIRTY;
-  /** Reserve cache sector for write - do not read from sector device. */
-  static const uint8_t CACHE_RESERVE_FOR_WRITE
-    = CACHE_STATUS_DIRTY | CACHE_OPTION_NO_READ;
-
-  FsCache() : m_blockDev(nullptr) {
-    invalidate();
-  }
-
-  /** \return Cache sector address. */
-  uint8_t* cacheBuffer() {
-    return m_cacheBuffer;
-  }
-  /** \return Clear the cache and returns a pointer to the cache. */
-  uint8_t* clear() {
-    if (isDirty() && !sync()) {
-      return nullptr;
-    }
-    invalidate();
-    return m_cacheBuffer;
-  }
-  /** Set current sector dirty. */
-  void dirty() {
-    m_status |= CACHE_STATUS_DIRTY;
-  }
-  /** Initialize the cache.
-   * \param[in] blockDev Block device for this partition.
-   */
-  void init(BlockDevice* blockDev) {
-    m_blockDev = blockDev;
-    invalidate();
-  }
-  /** Invalidate current cache sector. */
-  void invalidate();
-  /** \return dirty status */
-  bool isDirty() {
-    return m_status & CACHE_STATUS_DIRTY;
-  }
-  /** \return Logical sector number for cached sector. */
-  uint32_t sector() {
-    return m_sector;
-  }
-  /** Fill cache with sector data.
-   * \param[in] sector Sector to read.
-   * \param[in] option mode for cached sector.
-   * \return Address of cached sector. */
-  uint8_t* get(uint32_t sector, uint8_t option);
-  /** Write current sector if dirty.
-   * \return true for success else false.
-   */
-  bool sync();
-
- private:
-  uint8_t m_status;
-  BlockDevice* m_blockDev;
-  uint32_t m_sector;
-  uint8_t m_cacheBuffer[512];
-};
 //=============================================================================
 /**
  * \class ExFatPartition
@@ -147,6 +77,14 @@ class ExFatPartition {
   uint8_t fatType() const {return m_fatType;}
   /** \return the free cluster count. */
   uint32_t freeClusterCount();
+  /** Count free clusters with multi-sector reads of the allocation bitmap.
+   * \param[in] buf Buffer for bitmap sectors.
+   * \param[in] size Size of \a buf in bytes.  The bitmap is read one
+   *            sector at a time through the cache if \a size is less
+   *            than two sectors.
+   * \return the free cluster count or zero if an error occurs.
+   */
+  uint32_t freeClusterCount(uint8_t* buf, size_t size);
   /** Initialize a exFAT partition.
    * \param[in] dev The blockDevice for the partition.
    * \param[in] part The partition to be used.  Legal values for \a part are
@@ -183,6 +121,8 @@ class ExFatPartition {
  private:
   friend class ExFatFile;
   uint32_t bitmapFind(uint32_t cluster, uint32_t count);
+  int8_t bitmapFindRun(uint32_t bgn, uint32_t end,
+                       uint32_t count, uint32_t* found);
   bool bitmapModify(uint32_t cluster, uint32_t count, bool value);
   //----------------------------------------------------------------------------
   // Cache functions.
@@ -191,6 +131,13 @@ class ExFatPartition {
     return m_bitmapCache.get(sector, option);
 #else  // USE_EXFAT_BITMAP_CACHE
     return m_dataCache.get(sector, option);
+#endif  // USE_EXFAT_BITMAP_CACHE
+  }
+  bool bitmapCacheSync() {
+#if USE_EXFAT_BITMAP_CACHE
+    return m_bitmapCache.sync();
+#else  // USE_EXFAT_BITMAP_CACHE
+    return m_dataCache.sync();
 #endif  // USE_EXFAT_BITMAP_CACHE
   }
   void cacheInit(BlockDevice* dev) {
@@ -198,17 +145,39 @@ class ExFatPartition {
     m_bitmapCache.init(dev);
 #endif  // USE_EXFAT_BITMAP_CACHE
     m_dataCache.init(dev);
+#if FS_WRITE_BUFFER_SECTORS
+    m_writeBuffer.init(dev);
+#endif  // FS_WRITE_BUFFER_SECTORS
+#if FS_READ_AHEAD_SECTORS
+    m_readAhead.init(dev);
+#endif  // FS_READ_AHEAD_SECTORS
+    pathCacheClear();
   }
   bool cacheSync() {
 #if USE_EXFAT_BITMAP_CACHE
-    return m_bitmapCache.sync() && m_dataCache.sync() && syncDevice();
+    return writeBufferSync() && m_bitmapCache.sync() && m_dataCache.sync() &&
+           syncDevice();
 #else  // USE_EXFAT_BITMAP_CACHE
-    return m_dataCache.sync() && syncDevice();
+    return writeBufferSync() && m_dataCache.sync() && syncDevice();
 #endif  // USE_EXFAT_BITMAP_CACHE
   }
-  void dataCacheDirty() {m_dataCache.dirty();}
-  void dataCacheInvalidate() {m_dataCache.invalidate();}
+  bool dataCacheContains(uint32_t sector, size_t ns = 1) {
+    return m_dataCache.contains(sector, ns);
+  }
+  void dataCacheDirty() {
+    m_dataCache.dirty();
+    readAheadInvalidate(m_dataCache.sector(), 1);
+  }
+  void dataCacheInvalidate(uint32_t sector, size_t ns = 1) {
+    m_dataCache.invalidate(sector, ns);
+  }
   uint8_t* dataCacheGet(uint32_t sector, uint8_t option) {
+    if (!writeBufferSync(sector, 1)) {
+      return nullptr;
+    }
+    if (option & FsCache::CACHE_STATUS_DIRTY) {
+      readAheadInvalidate(sector, 1);
+    }
     return m_dataCache.get(sector, option);
   }
   uint32_t dataCacheSector() {return m_dataCache.sector();}
@@ -230,16 +199,76 @@ class ExFatPartition {
     return m_blockDev->syncDevice();
   }
   bool readSector(uint32_t sector, uint8_t* dst) {
-    return m_blockDev->readSector(sector, dst);
+    return writeBufferSync(sector, 1) && m_blockDev->readSector(sector, dst);
   }
   bool readSectors(uint32_t sector, uint8_t* dst, size_t count) {
-    return m_blockDev->readSectors(sector, dst, count);
+    return writeBufferSync(sector, count) &&
+           m_blockDev->readSectors(sector, dst, count);
   }
   bool writeSector(uint32_t sector, const uint8_t* src) {
-    return m_blockDev->writeSector(sector, src);
+    readAheadInvalidate(sector, 1);
+    return writeBufferSync() && m_blockDev->writeSector(sector, src);
   }
   bool writeSectors(uint32_t sector, const uint8_t* src, size_t count) {
-    return m_blockDev->writeSectors(sector, src, count);
+    readAheadInvalidate(sector, count);
+    return writeBufferSync() && m_blockDev->writeSectors(sector, src, count);
+  }
+  // A sector is never in both the write buffer and the data cache.
+#if FS_WRITE_BUFFER_SECTORS
+  FsWriteBufferArray<FS_WRITE_BUFFER_SECTORS> m_writeBuffer;
+  bool writeBehind(uint32_t sector, const uint8_t* src) {
+    if (!m_writeBuffer.write(sector, src)) {
+      return false;
+    }
+    m_dataCache.invalidate(sector, 1);
+    readAheadInvalidate(sector, 1);
+    return true;
+  }
+  bool writeBufferSync() {
+    return m_writeBuffer.sync();
+  }
+  bool writeBufferSync(uint32_t sector, size_t count) {
+    return !m_writeBuffer.contains(sector, count) || m_writeBuffer.sync();
+  }
+#else  // FS_WRITE_BUFFER_SECTORS
+  bool writeBehind(uint32_t sector, const uint8_t* src) {
+    m_dataCache.invalidate(sector, 1);
+    return writeSector(sector, src);
+  }
+  bool writeBufferSync() {
+    return true;
+  }
+  bool writeBufferSync(uint32_t sector, size_t count) {
+    (void)sector;
+    (void)count;
+    return true;
+  }
+#endif  // FS_WRITE_BUFFER_SECTORS
+  // Read-ahead data must be invalidated when a sector is modified.
+#if FS_READ_AHEAD_SECTORS
+  FsReadAheadArray<FS_READ_AHEAD_SECTORS> m_readAhead;
+  const uint8_t* cacheReadAhead(uint32_t sector, uint32_t count);
+  void readAheadInvalidate(uint32_t sector, size_t count) {
+    m_readAhead.invalidate(sector, count);
+  }
+#else  // FS_READ_AHEAD_SECTORS
+  void readAheadInvalidate(uint32_t sector, size_t count) {
+    (void)sector;
+    (void)count;
+  }
+#endif  // FS_READ_AHEAD_SECTORS
+  // Cached paths must be cleared when a directory entry is removed or changed.
+#if FS_PATH_CACHE_ENTRIES
+  FsPathCacheArray<FS_PATH_CACHE_ENTRIES> m_pathCache;
+  void pathCacheClear() {
+    m_pathCache.clear();
+  }
+#else  // FS_PATH_CACHE_ENTRIES
+  void pathCacheClear() {}
+#endif  // FS_PATH_CACHE_ENTRIES
+  void preEraseHint(uint32_t cluster, uint32_t count) {
+    m_blockDev->preEraseHint(clusterStartSector(cluster),
+                             count << m_sectorsPerClusterShift);
   }
   //----------------------------------------------------------------------------
   static const uint8_t  m_bytesPerSectorShift = 9;
@@ -247,9 +276,9 @@ class ExFatPartition {
   static const uint16_t m_sectorMask = 0x1FF;
   //----------------------------------------------------------------------------
 #if USE_EXFAT_BITMAP_CACHE
-  FsCache  m_bitmapCache;
+  FsCacheArray<1> m_bitmapCache;
 #endif  // USE_EXFAT_BITMAP_CACHE
-  FsCache  m_dataCache;
+  FsCacheArray<FS_CACHE_SECTOR_COUNT> m_dataCache;
   uint32_t m_bitmapStart;
   uint32_t m_fatStartSector;
   uint32_t m_fatLength;
@@ -0,0 +1,151 @@
+/**
+ * Copyright (c) 20011-2017 Bill Greiman
+ * This file is part of the SdFs library for SD memory cards.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#include "FatDirIndex.h"
+//------------------------------------------------------------------------------
+FatDirIndex::FatDirIndex(FatDirIndexSlot* slot, uint32_t* table,
+                         uint8_t slotCount, size_t tableSize) :
+  m_slot(slot), m_mask(tableSize - 1), m_clock(0), m_slotCount(slotCount) {
+  for (uint8_t i = 0; i < slotCount; i++) {
+    m_slot[i].table = table + i*tableSize;
+  }
+  clear();
+}
+//------------------------------------------------------------------------------
+void FatDirIndex::clear() {
+  for (uint8_t i = 0; i < m_slotCount; i++) {
+    m_slot[i].status = 0;
+    m_slot[i].lastUse = 0;
+  }
+  m_clock = 0;
+}
+//------------------------------------------------------------------------------
+FatDirIndexSlot* FatDirIndex::get(uint32_t dirCluster) {
+  for (uint8_t i = 0; i < m_slotCount; i++) {
+    FatDirIndexSlot* slot = &m_slot[i];
+    if ((slot->status & SLOT_STATUS_VALID) && slot->dirCluster == dirCluster) {
+      slot->lastUse = ++m_clock;
+      return slot;
+    }
+  }
+  return nullptr;
+}
+//------------------------------------------------------------------------------
+void FatDirIndex::insert(FatDirIndexSlot* slot, uint16_t hash,
+                         uint16_t index) {
+  if (slot->status & SLOT_STATUS_OVERFLOW) {
+    return;
+  }
+  // Keep the load factor at or below 3/4.
+  if (4UL*(slot->count + 1) > 3UL*(m_mask + 1)) {
+    slot->status |= SLOT_STATUS_OVERFLOW;
+    return;
+  }
+  if (hash == 0) {
+    hash = 1;
+  }
+  size_t pos = hash & m_mask;
+  while (slot->table[pos]) {
+    pos = (pos + 1) & m_mask;
+  }
+  slot->table[pos] = (uint32_t)hash << 16 | index;
+  slot->count++;
+}
+//------------------------------------------------------------------------------
+void FatDirIndex::invalidate(uint32_t dirCluster) {
+  FatDirIndexSlot* slot = get(dirCluster);
+  if (slot) {
+    slot->status = 0;
+    slot->lastUse = 0;
+  }
+}
+//------------------------------------------------------------------------------
+bool FatDirIndex::next(FatDirIndexSlot* slot, uint16_t hash, size_t* pos,
+                       uint16_t* index) {
+  if (hash == 0) {
+    hash = 1;
+  }
+  // Position is one plus the offset from the home position.
+  for (size_t i = *pos; i <= m_mask; i++) {
+    uint32_t rec = slot->table[(hash + i) & m_mask];
+    if (rec == 0) {
+      break;
+    }
+    if ((rec >> 16) == hash) {
+      *pos = i + 1;
+      *index = rec;
+      return true;
+    }
+  }
+  *pos = m_mask + 1;
+  return false;
+}
+//------------------------------------------------------------------------------
+void FatDirIndex::remove(FatDirIndexSlot* slot, uint16_t index) {
+  size_t i = 0;
+  while (i <= m_mask) {
+    uint32_t rec = slot->table[i];
+    if (rec == 0 || (uint16_t)rec != index) {
+      i++;
+      continue;
+    }
+    // Backward shift deletion keeps probe sequences unbroken.
+    size_t hole = i;
+    size_t j = i;
+    while (true) {
+      j = (j + 1) & m_mask;
+      rec = slot->table[j];
+      if (rec == 0) {
+        break;
+      }
+      size_t home = (rec >> 16) & m_mask;
+      if (((j - home) & m_mask) >= ((j - hole) & m_mask)) {
+        slot->table[hole] = rec;
+        hole = j;
+      }
+    }
+    slot->table[hole] = 0;
+    slot->count--;
+    // Check position i again since a record may have moved into it.
+  }
+}
+//------------------------------------------------------------------------------
+FatDirIndexSlot* FatDirIndex::replace(uint32_t dirCluster) {
+  FatDirIndexSlot* slot = &m_slot[0];
+  for (uint8_t i = 1; i < m_slotCount; i++) {
+    if (m_slot[i].lastUse < slot->lastUse) {
+      slot = &m_slot[i];
+    }
+  }
+  for (size_t i = 0; i <= m_mask; i++) {
+    slot->table[i] = 0;
+  }
+  slot->dirCluster = dirCluster;
+  slot->lastUse = ++m_clock;
+  slot->endIndex = 0;
+  slot->freeIndex = 0;
+  slot->count = 0;
+  slot->status = SLOT_STATUS_VALID;
+  return slot;
+}
@@ -0,0 +1,143 @@
+/**
+ * Copyright (c) 20011-2017 Bill Greiman
+ * This file is part of the SdFs library for SD memory cards.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#ifndef FatDirIndex_h
+#define FatDirIndex_h
+/**
+ * \file
+ * \brief FatDirIndex directory lookup class.
+ */
+#include <stdint.h>
+#include <stddef.h>
+/**
+ * \struct FatDirIndexSlot
+ * \brief Index state for one directory.
+ */
+struct FatDirIndexSlot {
+  /** First cluster of the directory, zero for a FAT16 root. */
+  uint32_t dirCluster;
+  /** Index clock at last use. */
+  uint32_t lastUse;
+  /** Index of the first never used entry or the entry count at EOF. */
+  uint32_t endIndex;
+  /** All entries before this index are in use. */
+  uint32_t freeIndex;
+  /** Number of records in the hash table. */
+  uint16_t count;
+  /** Slot status bits. */
+  uint8_t  status;
+  /** Hash table, records are (hash << 16) | entryIndex or zero if empty. */
+  uint32_t* table;
+};
+//==============================================================================
+/**
+ * \class FatDirIndex
+ * \brief Hash index of names in recently used FAT directories.
+ *
+ * Each slot holds a hash table for one directory.  The table maps a hash
+ * of each long name and each short name to the index of the short name
+ * entry.  Lookups read only the entries for matching hashes so every
+ * record is a hint that is verified against the directory.  Directories
+ * are replaced in least recently used order and a directory with more
+ * names than a slot can hold is not indexed.
+ */
+class FatDirIndex {
+ public:
+  /** Slot is in use. */
+  static const uint8_t SLOT_STATUS_VALID = 1;
+  /** Directory has too many names for a slot. */
+  static const uint8_t SLOT_STATUS_OVERFLOW = 2;
+
+  /** Remove all directories from the index. */
+  void clear();
+  /** Find the slot for a directory.
+   * \param[in] dirCluster First cluster of the directory.
+   * \return The slot or nullptr if the directory is not in the index.
+   */
+  FatDirIndexSlot* get(uint32_t dirCluster);
+  /** Add a record for a short name entry.  The slot is marked overflow
+   * if the table is too full.
+   * \param[in] slot Slot for the directory.
+   * \param[in] hash Hash of a name.
+   * \param[in] index Index of the short name entry.
+   */
+  void insert(FatDirIndexSlot* slot, uint16_t hash, uint16_t index);
+  /** Remove a directory from the index.
+   * \param[in] dirCluster First cluster of the directory.
+   */
+  void invalidate(uint32_t dirCluster);
+  /** Find the next record with a hash.
+   * \param[in] slot Slot for the directory.
+   * \param[in] hash Hash of a name.
+   * \param[in,out] pos Table position, set to zero for the first call.
+   * \param[out] index Index of the short name entry for the record.
+   * \return true if a record was found else false.
+   */
+  bool next(FatDirIndexSlot* slot, uint16_t hash, size_t* pos,
+            uint16_t* index);
+  /** Remove all records for an entry.
+   * \param[in] slot Slot for the directory.
+   * \param[in] index Index of the short name entry.
+   */
+  void remove(FatDirIndexSlot* slot, uint16_t index);
+  /** Replace the least recently used slot with an empty slot.
+   * \param[in] dirCluster First cluster of the directory.
+   * \return The new slot.
+   */
+  FatDirIndexSlot* replace(uint32_t dirCluster);
+
+ protected:
+  /// @cond SHOW_PROTECTED
+  FatDirIndex(FatDirIndexSlot* slot, uint32_t* table, uint8_t slotCount,
+              size_t tableSize);
+  /// @endcond
+
+ private:
+  FatDirIndex(const FatDirIndex&);
+  FatDirIndex& operator=(const FatDirIndex&);
+
+  FatDirIndexSlot* m_slot;
+  size_t m_mask;
+  uint32_t m_clock;
+  uint8_t m_slotCount;
+};
+//------------------------------------------------------------------------------
+/**
+ * \class FatDirIndexArray
+ * \brief FatDirIndex with storage for D directories of up to 3*N/4 names.
+ *
+ * A long name uses two records, one for the long name and one for the
+ * short name.  N must be a power of two.  The index uses about 4*D*N bytes.
+ */
+template<uint8_t D, size_t N>
+class FatDirIndexArray : public FatDirIndex {
+ public:
+  FatDirIndexArray() : FatDirIndex(m_slots, m_tables, D, N) {}
+
+ private:
+  static_assert(N >= 16 && (N & (N - 1)) == 0, "N must be a power of two");
+  FatDirIndexSlot m_slots[D];
+  uint32_t m_tables[D*N];
+};
+#endif  // FatDirIndex_h
@@ -23,6 +23,7 @@
  * DEALINGS IN THE SOFTWARE.
  */
 #include "../common/DebugMacros.h"
+#include "../common/FsLineScan.h"
 #include "FatFile.h"
 #include "FatVolume.h"
 //------------------------------------------------------------------------------
@@ -113,6 +114,60 @@ bool FatFile::close() {
   return rtn;
 }
 //------------------------------------------------------------------------------
+// Limit ns to the sectors that follow sector sectorOfCluster of m_curCluster
+// in physically adjacent clusters.  m_curCluster is advanced to the cluster
+// of the last sector.  Clusters are added at the end of the chain if
+// allocate is true.  Return zero for an error.
+size_t FatFile::clusterRun(uint8_t sectorOfCluster, size_t ns, bool allocate) {
+  size_t maxNs = m_vol->sectorsPerCluster() - sectorOfCluster;
+  uint32_t index = m_curPosition >> m_vol->bytesPerClusterShift();
+  while (maxNs < ns) {
+    uint32_t cc = m_curCluster;
+    int8_t fg;
+    index++;
+#if USE_FAT_FILE_FLAG_CONTIGUOUS
+    if (isFile() && isContiguous() &&
+        m_fileSize > (index << m_vol->bytesPerClusterShift())) {
+      m_curCluster++;
+      fg = 1;
+    } else {
+      fg = nextCluster(index);
+    }
+#else  // USE_FAT_FILE_FLAG_CONTIGUOUS
+    fg = nextCluster(index);
+#endif  // USE_FAT_FILE_FLAG_CONTIGUOUS
+    if (fg < 0) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    if (fg == 0) {
+      if (!allocate) {
+        m_curCluster = cc;
+        break;
+      }
+      if (!addCluster()) {
+        DBG_FAIL_MACRO;
+        goto fail;
+      }
+    }
+#if USE_FILE_EXTENT_MAP
+    if (m_extentMap) {
+      m_extentMap->put(index, m_curCluster);
+    }
+#endif  // USE_FILE_EXTENT_MAP
+    if (m_curCluster != (cc + 1)) {
+      // Next cluster is linked but not adjacent.
+      m_curCluster = cc;
+      break;
+    }
+    maxNs += m_vol->sectorsPerCluster();
+  }
+  return maxNs < ns ? maxNs : ns;
+
+fail:
+  return 0;
+}
+//------------------------------------------------------------------------------
 bool FatFile::contiguousRange(uint32_t* bgnSector, uint32_t* endSector) {
   // error if no clusters
   if (m_firstCluster == 0) {
@@ -163,6 +218,8 @@ bool FatFile::preAllocate(uint32_t length) {
     DBG_FAIL_MACRO;
     goto fail;
   }
+  // New clusters have no data so the device may pre-erase them.
+  m_vol->preEraseHint(m_firstCluster, need);
   m_fileSize = length;
 
 #if USE_FAT_FILE_FLAG_CONTIGUOUS
@@ -200,28 +257,32 @@ fail:
 }
 //------------------------------------------------------------------------------
 int FatFile::fgets(char* str, int num, char* delim) {
-  char ch;
+  FsLineScan scan(delim);
+  const uint8_t* src;
   int n = 0;
-  int r = -1;
-  while ((n + 1) < num && (r = read(&ch, 1)) == 1) {
-    // delete CR
-    if (ch == '\r') {
-      continue;
-    }
-    str[n++] = ch;
-    if (!delim) {
-      if (ch == '\n') {
-        break;
-      }
-    } else {
-      if (strchr(delim, ch)) {
-        break;
+  if (num < 2) {
+    // no space for data
+    return -1;
+  }
+  while ((n + 1) < num) {
+    int m = readCache(&src);
+    if (m <= 0) {
+      if (m < 0) {
+        // read error
+        return -1;
       }
+      break;
+    }
+    const uint8_t* end = scan.find(src, m);
+    size_t len = end ? end - src + 1 : m;
+    size_t k;
+    size_t used = FsLineScan::copy(str + n, num - 1 - n, src, len, &k);
+    m_curPosition += used;
+    n += k;
+    if (end && used == len) {
+      // delimiter transferred
+      break;
     }
-  }
-  if (r < 0) {
-    // read error
-    return -1;
   }
   str[n] = '\0';
   return n;
@@ -348,6 +409,22 @@ bool FatFile::mkdir(FatFile* parent, fname_t* fname) {
 fail:
   return false;
 }
+//------------------------------------------------------------------------------
+int8_t FatFile::nextCluster(uint32_t index) {
+#if USE_FILE_EXTENT_MAP
+  if (m_extentMap) {
+    if (m_extentMap->get(index, &m_curCluster)) {
+      return 1;
+    }
+    int8_t fg = m_vol->fatGet(m_curCluster, &m_curCluster);
+    if (fg > 0) {
+      m_extentMap->put(index, m_curCluster);
+    }
+    return fg;
+  }
+#endif  // USE_FILE_EXTENT_MAP
+  return m_vol->fatGet(m_curCluster, &m_curCluster);
+}
 //-----------------------------------------------------------------------------
 bool FatFile::open(const char* path, uint8_t oflag) {
   return open(FatVolume::cwv(), path, oflag);
@@ -387,7 +464,7 @@ bool FatFile::open(FatFile* dirFile, const char* path, uint8_t oflag) {
     if (*path == 0) {
       break;
     }
-    if (!open(dirFile, &fname, O_READ)) {
+    if (!openPathDir(dirFile, &fname)) {
       DBG_FAIL_MACRO;
       goto fail;
     }
@@ -401,6 +478,53 @@ fail:
   return false;
 }
 //------------------------------------------------------------------------------
+// Open a path component that should be a directory.
+bool FatFile::openPathDir(FatFile* dirFile, fname_t* fname) {
+#if FS_PATH_CACHE_ENTRIES
+#if USE_LONG_FILE_NAMES
+  const void* name = fname->lfn;
+  size_t size = fname->len;
+#else  // USE_LONG_FILE_NAMES
+  const void* name = fname->sfn;
+  size_t size = sizeof(fname->sfn);
+#endif  // USE_LONG_FILE_NAMES
+  FsPathCache* cache = &dirFile->m_vol->m_pathCache;
+  uint32_t parent = dirFile->m_firstCluster;
+  FsPathCacheEntry* entry = cache->get(parent, name, size);
+  if (entry) {
+    memset(this, 0, sizeof(FatFile));
+    m_attributes = entry->attributes;
+    m_flags = entry->flags;
+    m_lfnOrd = entry->count;
+    m_dirIndex = entry->position;
+    m_vol = dirFile->m_vol;
+    m_dirCluster = parent;
+    m_dirSector = entry->location;
+    m_fileSize = entry->length;
+    m_firstCluster = entry->cluster;
+    return true;
+  }
+  if (!open(dirFile, fname, O_READ)) {
+    return false;
+  }
+  if (isSubDir()) {
+    entry = cache->put(parent, name, size);
+    if (entry) {
+      entry->position = m_dirIndex;
+      entry->location = m_dirSector;
+      entry->cluster = m_firstCluster;
+      entry->length = m_fileSize;
+      entry->attributes = m_attributes;
+      entry->flags = m_flags;
+      entry->count = m_lfnOrd;
+    }
+  }
+  return true;
+#else  // FS_PATH_CACHE_ENTRIES
+  return open(dirFile, fname, O_READ);
+#endif  // FS_PATH_CACHE_ENTRIES
+}
+//------------------------------------------------------------------------------
 bool FatFile::open(FatFile* dirFile, uint16_t index, uint8_t oflag) {
   uint8_t checksum = 0;
   uint8_t lfnOrd = 0;
@@ -533,9 +657,15 @@ fail:
 }
 //------------------------------------------------------------------------------
 bool FatFile::openNext(FatFile* dirFile, uint8_t oflag) {
+  return openNext(dirFile, oflag, nullptr, 0);
+}
+//------------------------------------------------------------------------------
+bool FatFile::openNext(FatFile* dirFile, uint8_t oflag,
+                       char* name, size_t size) {
   uint8_t checksum = 0;
   ldir_t* ldir;
   uint8_t lfnOrd = 0;
+  uint8_t order = 0;
   uint16_t index;
 
   // Check for not open and valid directory..
@@ -543,6 +673,10 @@ bool FatFile::openNext(FatFile* dirFile, uint8_t oflag) {
     DBG_FAIL_MACRO;
     goto fail;
   }
+  if (name && size < 13) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
   while (1) {
     // read entry into cache
     index = dirFile->curPosition()/32;
@@ -569,13 +703,37 @@ bool FatFile::openNext(FatFile* dirFile, uint8_t oflag) {
         DBG_FAIL_MACRO;
         goto fail;
       }
+      if (!name) {
+        return true;
+      }
+#if USE_LONG_FILE_NAMES
+      // The name is complete if every long name entry was read in order.
+      if (lfnOrd && order == 1) {
+        return true;
+      }
+#endif  // USE_LONG_FILE_NAMES
+      if (!getName(name, size)) {
+        close();
+        DBG_FAIL_MACRO;
+        goto fail;
+      }
       return true;
     } else if (isLongName(dir)) {
       ldir = reinterpret_cast<ldir_t*>(dir);
       if (ldir->order & FAT_ORDER_LAST_LONG_ENTRY) {
-        lfnOrd = ldir->order & 0X1F;
+        lfnOrd = order = ldir->order & 0X1F;
         checksum = ldir->checksum;
+      } else if (order > 1 && ldir->order == order - 1 &&
+                 ldir->checksum == checksum) {
+        order--;
+      } else {
+        order = 0;
+      }
+#if USE_LONG_FILE_NAMES
+      if (name && order) {
+        lfnGetName(ldir, name, size);
       }
+#endif  // USE_LONG_FILE_NAMES
     } else {
       lfnOrd = 0;
     }
@@ -627,9 +785,108 @@ int FatFile::peek() {
   return c;
 }
 //------------------------------------------------------------------------------
+// Find the device sector for m_curPosition and its index in the cluster.
+// m_curCluster is advanced at the start of a cluster.  Return one for
+// success, zero at the end of a directory's cluster chain, or -1 for error.
+int8_t FatFile::curSector(uint32_t* sector, uint8_t* sectorOfCluster) {
+  if (isRootFixed()) {
+    *sectorOfCluster = 0;
+    *sector = m_vol->rootDirStart()
+              + (m_curPosition >> m_vol->bytesPerSectorShift());
+    return 1;
+  }
+  *sectorOfCluster = m_vol->sectorOfCluster(m_curPosition);
+  if ((m_curPosition & m_vol->sectorMask()) == 0 && *sectorOfCluster == 0) {
+    // start of new cluster
+    if (m_curPosition == 0) {
+      // use first cluster in file
+      m_curCluster = isRoot32() ? m_vol->rootDirStart() : m_firstCluster;
+#if USE_FAT_FILE_FLAG_CONTIGUOUS
+    } else if (isFile() && isContiguous()) {
+      m_curCluster++;
+#endif  // USE_FAT_FILE_FLAG_CONTIGUOUS
+    } else {
+      // get next cluster from FAT
+      int8_t fg = nextCluster(m_curPosition >> m_vol->bytesPerClusterShift());
+      if (fg < 0 || (fg == 0 && !isDir())) {
+        DBG_FAIL_MACRO;
+        return -1;
+      }
+      if (fg == 0) {
+        return 0;
+      }
+    }
+  }
+  *sector = m_vol->clusterStartSector(m_curCluster) + *sectorOfCluster;
+  return 1;
+}
+//------------------------------------------------------------------------------
+// Return a pointer to the data at the current position in *ptr and the
+// number of bytes left in the sector or file.  The caller must consume at
+// least one byte since m_curCluster is advanced at the start of a cluster.
+int FatFile::readCache(const uint8_t** ptr) {
+  int8_t fg;
+  uint8_t sectorOfCluster;
+  uint16_t offset;
+  uint32_t sector;
+  size_t n;
+  const uint8_t* src = nullptr;
+  cache_t* pc;
+
+  if (!isReadable()) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  offset = m_curPosition & m_vol->sectorMask();
+  n = m_vol->bytesPerSector() - offset;
+  if (isFile()) {
+    uint32_t tmp32 = m_fileSize - m_curPosition;
+    if (n > tmp32) {
+      n = tmp32;
+    }
+  } else if (isRootFixed()) {
+    uint16_t tmp16 = 32*m_vol->m_rootDirEntryCount - (uint16_t)m_curPosition;
+    if (n > tmp16) {
+      n = tmp16;
+    }
+  }
+  if (n == 0) {
+    return 0;
+  }
+  fg = curSector(&sector, &sectorOfCluster);
+  if (fg < 0) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  if (fg == 0) {
+    return 0;
+  }
+#if FS_READ_AHEAD_SECTORS
+  if (isFile()) {
+    // use read-ahead buffer for sequential reads
+    uint8_t ns = m_vol->sectorsPerCluster() - sectorOfCluster;
+    src = m_vol->cacheReadAhead(sector, ns);
+  }
+#endif  // FS_READ_AHEAD_SECTORS
+  if (!src) {
+    pc = m_vol->cacheFetchData(sector, FatCache::CACHE_FOR_READ);
+    if (!pc) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    src = pc->data;
+  }
+  *ptr = src + offset;
+  return n;
+
+fail:
+  m_error |= READ_ERROR;
+  return -1;
+}
+//------------------------------------------------------------------------------
 int FatFile::read(void* buf, size_t nbyte) {
   int8_t fg;
-  uint8_t sectorOfCluster = 0;
+  uint8_t sectorOfCluster;
   uint8_t* dst = reinterpret_cast<uint8_t*>(buf);
   uint16_t offset;
   size_t toRead;
@@ -657,65 +914,53 @@ int FatFile::read(void* buf, size_t nbyte) {
   while (toRead) {
     size_t n;
     offset = m_curPosition & m_vol->sectorMask();  // offset in sector
-    if (isRootFixed()) {
-      sector = m_vol->rootDirStart()
-               + (m_curPosition >> m_vol->bytesPerSectorShift());
-    } else {
-      sectorOfCluster = m_vol->sectorOfCluster(m_curPosition);
-      if (offset == 0 && sectorOfCluster == 0) {
-        // start of new cluster
-        if (m_curPosition == 0) {
-          // use first cluster in file
-          m_curCluster = isRoot32() ? m_vol->rootDirStart() : m_firstCluster;
-#if USE_FAT_FILE_FLAG_CONTIGUOUS
-        } else if (isFile() && isContiguous()) {
-          m_curCluster++;
-#endif  // USE_FAT_FILE_FLAG_CONTIGUOUS
-        } else {
-          // get next cluster from FAT
-          fg = m_vol->fatGet(m_curCluster, &m_curCluster);
-          if (fg < 0) {
-            DBG_FAIL_MACRO;
-            goto fail;
-          }
-          if (fg == 0) {
-            if (isDir()) {
-              break;
-            }
-            DBG_FAIL_MACRO;
-            goto fail;
-          }
-        }
-      }
-      sector = m_vol->clusterStartSector(m_curCluster) + sectorOfCluster;
+    fg = curSector(&sector, &sectorOfCluster);
+    if (fg < 0) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    if (fg == 0) {
+      break;
     }
     if (offset != 0 || toRead < m_vol->bytesPerSector()
-        || sector == m_vol->cacheSectorNumber()) {
+        || m_vol->cacheContains(sector)) {
       // amount to be read from current sector
       n = m_vol->bytesPerSector() - offset;
       if (n > toRead) {
         n = toRead;
       }
-      // read sector to cache and copy data to caller
-      pc = m_vol->cacheFetchData(sector, FatCache::CACHE_FOR_READ);
-      if (!pc) {
-        DBG_FAIL_MACRO;
-        goto fail;
+      const uint8_t* src = nullptr;
+#if FS_READ_AHEAD_SECTORS
+      if (isFile()) {
+        // use read-ahead buffer for sequential reads
+        uint8_t ns = m_vol->sectorsPerCluster() - sectorOfCluster;
+        src = m_vol->cacheReadAhead(sector, ns);
       }
-      uint8_t* src = pc->data + offset;
-      memcpy(dst, src, n);
+#endif  // FS_READ_AHEAD_SECTORS
+      if (!src) {
+        // read sector to cache
+        pc = m_vol->cacheFetchData(sector, FatCache::CACHE_FOR_READ);
+        if (!pc) {
+          DBG_FAIL_MACRO;
+          goto fail;
+        }
+        src = pc->data;
+      }
+      // copy data to caller
+      memcpy(dst, src + offset, n);
 #if USE_MULTI_SECTOR_IO
     } else if (toRead >= 2*m_vol->bytesPerSector()) {
-      uint8_t ns = toRead >> m_vol->bytesPerSectorShift();
+      size_t ns = toRead >> m_vol->bytesPerSectorShift();
       if (!isRootFixed()) {
-        uint8_t mb = m_vol->sectorsPerCluster() - sectorOfCluster;
-        if (mb < ns) {
-          ns = mb;
+        // Read across adjacent clusters.
+        ns = clusterRun(sectorOfCluster, ns, false);
+        if (ns == 0) {
+          DBG_FAIL_MACRO;
+          goto fail;
         }
       }
       n = ns << m_vol->bytesPerSectorShift();
-      if (m_vol->cacheSectorNumber() <= sector
-          && sector < (m_vol->cacheSectorNumber() + ns)) {
+      if (m_vol->cacheContains(sector, ns)) {
         // flush cache if a sector is in the cache
         if (!m_vol->cacheSyncData()) {
           DBG_FAIL_MACRO;
@@ -773,6 +1018,89 @@ int8_t FatFile::readDir(dir_t* dir) {
   }
 }
 //------------------------------------------------------------------------------
+int FatFile::readDir(FsDirEntry* entry, size_t count,
+                     const FsDirFilter* filter) {
+  uint8_t checksum = 0;
+  ldir_t* ldir;
+  uint8_t lfnOrd = 0;
+  uint8_t order = 0;
+  uint32_t lfnPosition = 0;
+  uint32_t position;
+  size_t n = 0;
+  // if not a directory file or miss-positioned return an error
+  if (!isDir() || (0X1F & m_curPosition)) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  while (n < count) {
+    position = m_curPosition;
+    dir_t* dir = readDirCache();
+    if (!dir) {
+      if (getError()) {
+        DBG_FAIL_MACRO;
+        goto fail;
+      }
+      break;
+    }
+    // done if last entry
+    if (dir->name[0] == FAT_NAME_FREE) {
+      break;
+    }
+    // skip empty slot or '.' or '..'
+    if (dir->name[0] == '.' || dir->name[0] == FAT_NAME_DELETED) {
+      lfnOrd = 0;
+    } else if (isFileOrSubdir(dir)) {
+      // Use the long name only if all entries were read in order.
+      bool lfn = USE_LONG_FILE_NAMES && lfnOrd && order == 1 &&
+                 checksum == lfnChecksum(dir->name);
+      lfnOrd = 0;
+      if (filter && (dir->attributes & filter->skip)) {
+        continue;
+      }
+      if (!lfn) {
+        dirName(dir, entry->name);
+      }
+      if (filter && !filter->matchName(entry->name)) {
+        continue;
+      }
+      entry->fileSize = getLe32(dir->fileSize);
+      entry->firstCluster = (uint32_t)getLe16(dir->firstClusterHigh) << 16
+                            | getLe16(dir->firstClusterLow);
+      entry->createDateTime = (uint32_t)getLe16(dir->createDate) << 16
+                              | getLe16(dir->createTime);
+      entry->modifyDateTime = (uint32_t)getLe16(dir->modifyDate) << 16
+                              | getLe16(dir->modifyTime);
+      entry->dirPosition = lfn ? lfnPosition : position;
+      entry->attributes = dir->attributes & FS_ATTRIB_COPY;
+      entry++;
+      n++;
+    } else if (isLongName(dir)) {
+      ldir = reinterpret_cast<ldir_t*>(dir);
+      if (ldir->order & FAT_ORDER_LAST_LONG_ENTRY) {
+        lfnOrd = order = ldir->order & 0X1F;
+        checksum = ldir->checksum;
+        lfnPosition = position;
+      } else if (order > 1 && ldir->order == order - 1 &&
+                 ldir->checksum == checksum) {
+        order--;
+      } else {
+        order = 0;
+      }
+#if USE_LONG_FILE_NAMES
+      if (order) {
+        lfnGetName(ldir, entry->name, sizeof(entry->name));
+      }
+#endif  // USE_LONG_FILE_NAMES
+    } else {
+      lfnOrd = 0;
+    }
+  }
+  return n;
+
+fail:
+  return -1;
+}
+//------------------------------------------------------------------------------
 // Read next directory entry into the cache
 // Assumes file is correctly positioned
 dir_t* FatFile::readDirCache(bool skipReadOk) {
@@ -797,6 +1125,94 @@ fail:
   return nullptr;
 }
 //------------------------------------------------------------------------------
+int FatFile::readLine(const char** line, char* buf, size_t size,
+                      const char* delim) {
+  FsLineScan scan(delim);
+  const uint8_t* src;
+  const uint8_t* end;
+  size_t k;
+  size_t len;
+  size_t used;
+  int n;
+  int m;
+  if (size < 2) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  m = readCache(&src);
+  if (m <= 0) {
+    // EOF or read error
+    goto fail;
+  }
+  end = scan.find(src, m);
+  if (end) {
+    len = end - src;
+    k = len && end[-1] == '\r' ? len - 1 : len;
+    if ((k + 1) < size && !memchr(src, '\r', k)) {
+      // return the line in the cache
+      m_curPosition += len + 1;
+      *line = reinterpret_cast<const char*>(src);
+      return k;
+    }
+    len++;
+  } else {
+    len = m;
+  }
+  // copy the line to buf
+  *line = buf;
+  used = FsLineScan::copy(buf, size - 1, src, len, &k);
+  m_curPosition += used;
+  n = k;
+  if (!(end && used == len) && (n + 1) < (int)size) {
+    m = fgets(buf + n, size - n, const_cast<char*>(delim));
+    if (m < 0) {
+      goto fail;
+    }
+    n += m;
+  }
+  if (n == 0) {
+    // only CR before EOF
+    goto fail;
+  }
+  buf[n] = '\0';
+  if (scan.isDelim(buf[n - 1])) {
+    buf[--n] = '\0';
+  }
+  return n;
+
+fail:
+  return -1;
+}
+//------------------------------------------------------------------------------
+int FatFile::readUntil(char terminator, void* buf, size_t count) {
+  char* dst = reinterpret_cast<char*>(buf);
+  const uint8_t* src;
+  const void* end;
+  size_t n = 0;
+  while (n < count) {
+    int m = readCache(&src);
+    if (m <= 0) {
+      if (m < 0) {
+        return -1;
+      }
+      break;
+    }
+    size_t k = (count - n) < (size_t)m ? count - n : m;
+    end = memchr(src, terminator, k);
+    if (end) {
+      k = reinterpret_cast<const uint8_t*>(end) - src;
+      memcpy(dst + n, src, k);
+      // skip terminator
+      m_curPosition += k + 1;
+      return n + k;
+    }
+    memcpy(dst + n, src, k);
+    m_curPosition += k;
+    n += k;
+  }
+  return n;
+}
+//------------------------------------------------------------------------------
 bool FatFile::remove(const char* path) {
   FatFile file;
   if (!file.open(this, path, O_WRITE)) {
@@ -954,6 +1370,12 @@ bool FatFile::rmdir() {
       goto fail;
     }
   }
+#if USE_FAT_DIR_INDEX
+  // Clusters of this directory may be used by a new directory.
+  if (m_vol->m_dirNameIndex) {
+    m_vol->m_dirNameIndex->invalidate(m_firstCluster);
+  }
+#endif  // USE_FAT_DIR_INDEX
   // convert empty directory to normal file for remove
   m_attributes = FILE_ATTR_FILE;
   m_flags |= FILE_FLAG_WRITE;
@@ -1075,12 +1497,17 @@ bool FatFile::seekSet(uint32_t pos) {
   if (nNew < nCur || m_curPosition == 0) {
     // must follow chain from first cluster
     m_curCluster = isRoot32() ? m_vol->rootDirStart() : m_firstCluster;
-  } else {
-    // advance from curPosition
-    nNew -= nCur;
+    nCur = 0;
   }
-  while (nNew--) {
-    if (m_vol->fatGet(m_curCluster, &m_curCluster) <= 0) {
+#if USE_FILE_EXTENT_MAP
+  if (m_extentMap && m_extentMap->mappedCount() > nCur) {
+    // start at the mapped cluster closest to the new position
+    nCur = m_extentMap->lookup(nNew, &m_curCluster);
+  }
+#endif  // USE_FILE_EXTENT_MAP
+  // advance from cluster nCur
+  while (nCur < nNew) {
+    if (nextCluster(++nCur) <= 0) {
       DBG_FAIL_MACRO;
       goto fail;
     }
@@ -1095,6 +1522,26 @@ fail:
   m_curCluster = tmp;
   return false;
 }
+#if USE_FILE_EXTENT_MAP
+//------------------------------------------------------------------------------
+bool FatFile::setExtentMap(FsExtentMap* map) {
+  if (!isFile()) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  m_extentMap = map;
+  if (map) {
+    map->clear();
+    if (m_firstCluster) {
+      map->put(0, m_firstCluster);
+    }
+  }
+  return true;
+
+fail:
+  return false;
+}
+#endif  // USE_FILE_EXTENT_MAP
 //------------------------------------------------------------------------------
 bool FatFile::sync() {
   uint16_t date, time;
@@ -1222,6 +1669,12 @@ bool FatFile::truncate() {
     }
   }
   m_fileSize = m_curPosition;
+#if USE_FILE_EXTENT_MAP
+  if (m_extentMap) {
+    m_extentMap->truncate(m_curCluster ?
+      1 + ((m_curPosition - 1) >> m_vol->bytesPerClusterShift()) : 0);
+  }
+#endif  // USE_FILE_EXTENT_MAP
 
   // need to update directory entry
   m_flags |= FILE_FLAG_DIR_DIRTY;
@@ -1273,14 +1726,14 @@ size_t FatFile::write(const void* buf, size_t nbyte) {
           m_curCluster++;
           fg = 1;
         } else {
-          fg = m_vol->fatGet(m_curCluster, &m_curCluster);
+          fg = nextCluster(m_curPosition >> m_vol->bytesPerClusterShift());
           if (fg < 0) {
             DBG_FAIL_MACRO;
             goto fail;
           }
         }
 #else  // USE_FAT_FILE_FLAG_CONTIGUOUS
-        int8_t fg = m_vol->fatGet(m_curCluster, &m_curCluster);
+        int8_t fg = nextCluster(m_curPosition >> m_vol->bytesPerClusterShift());
         if (fg < 0) {
           DBG_FAIL_MACRO;
           goto fail;
@@ -1305,6 +1758,13 @@ size_t FatFile::write(const void* buf, size_t nbyte) {
           m_curCluster = m_firstCluster;
         }
       }
+#if USE_FILE_EXTENT_MAP
+      if (m_extentMap) {
+        // record a new cluster - ignored if already mapped
+        m_extentMap->put(m_curPosition >> m_vol->bytesPerClusterShift(),
+                         m_curCluster);
+      }
+#endif  // USE_FILE_EXTENT_MAP
     }
     // sector for data write
     uint32_t sector = m_vol->clusterStartSector(m_curCluster)
@@ -1335,26 +1795,33 @@ size_t FatFile::write(const void* buf, size_t nbyte) {
       uint8_t* dst = pc->data + sectorOffset;
       memcpy(dst, src, n);
       if (m_vol->bytesPerSector() == (n + sectorOffset)) {
+#if FS_WRITE_BUFFER_SECTORS
+        // Move full sector to the write-behind buffer.
+        if (!m_vol->writeBehind(sector, pc->data)) {
+          DBG_FAIL_MACRO;
+          goto fail;
+        }
+#else  // FS_WRITE_BUFFER_SECTORS
         // Force write if sector is full - improves large writes.
         if (!m_vol->cacheSyncData()) {
           DBG_FAIL_MACRO;
           goto fail;
         }
+#endif  // FS_WRITE_BUFFER_SECTORS
       }
 #if USE_MULTI_SECTOR_IO
     } else if (nToWrite >= 2*m_vol->bytesPerSector()) {
-      // use multiple sector write command
-      uint8_t maxSectors = m_vol->sectorsPerCluster() - sectorOfCluster;
-      uint8_t nSector = nToWrite >> m_vol->bytesPerSectorShift();
-      if (nSector > maxSectors) {
-        nSector = maxSectors;
+      // use multiple sector write command across adjacent clusters
+      size_t nSector = clusterRun(sectorOfCluster,
+                                  nToWrite >> m_vol->bytesPerSectorShift(),
+                                  true);
+      if (nSector == 0) {
+        DBG_FAIL_MACRO;
+        goto fail;
       }
       n = nSector << m_vol->bytesPerSectorShift();
-      if (m_vol->cacheSectorNumber() <= sector
-          && sector < (m_vol->cacheSectorNumber() + nSector)) {
-        // invalidate cache if sector is in cache
-        m_vol->cacheInvalidate();
-      }
+      // invalidate cached sectors that will be overwritten
+      m_vol->cacheInvalidate(sector, nSector);
       if (!m_vol->writeSectors(sector, src, nSector)) {
         DBG_FAIL_MACRO;
         goto fail;
@@ -1363,10 +1830,7 @@ size_t FatFile::write(const void* buf, size_t nbyte) {
     } else {
       // use single sector write command
       n = m_vol->bytesPerSector();
-      if (m_vol->cacheSectorNumber() == sector) {
-        m_vol->cacheInvalidate();
-      }
-      if (!m_vol->writeSector(sector, src)) {
+      if (!m_vol->writeBehind(sector, src)) {
         DBG_FAIL_MACRO;
         goto fail;
       }
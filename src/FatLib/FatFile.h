@@ -32,9 +32,12 @@
 #include <stddef.h>
 #include <limits.h>
 #include "FatLibConfig.h"
+#include "../common/FmtBuffer.h"
 #include "../common/FmtNumber.h"
 #include "../common/FsApiConstants.h"
 #include "../common/FsDateTime.h"
+#include "../common/FsDirEntry.h"
+#include "../common/FsExtentMap.h"
 #include "../common/FsStructs.h"
 #include "FatPartition.h"
 class FatVolume;
@@ -299,6 +302,7 @@ class FatFile {
    * (including the final null byte). Usually the length
    * of the array \a str is used.
    * \param[in] delim Optional set of delimiters. The default is "\n".
+   * A NUL byte is also a delimiter if \a delim is given.
    *
    * \return For success fgets() returns the length of the string in \a str.
    * If no data is read, fgets() returns zero for EOF or -1 if an error occurred.
@@ -529,6 +533,26 @@ class FatFile {
    * \return true for success or false for failure.
    */
   bool openNext(FatFile* dirFile, uint8_t oflag = O_READ);
+  /** Open the next file or subdirectory in a directory and get its name.
+   *
+   * The long name is decoded while the directory is read so no
+   * directory entries are read again to get the name.
+   *
+   * \param[in] dirFile An open FatFile instance for the directory
+   *                    containing the file to be opened.
+   *
+   * \param[in] oflag bitwise-inclusive OR of open mode flags.
+   *                  See see FatFile::open(FatFile*, const char*, uint8_t).
+   *
+   * \param[out] name An array of characters for the file's name.
+   *
+   * \param[in] size The size of the array in bytes. The array
+   *             must be at least 13 bytes long.  The file's name will be
+   *             truncated if the file's name is too long.
+   *
+   * \return true for success or false for failure.
+   */
+  bool openNext(FatFile* dirFile, uint8_t oflag, char* name, size_t size);
   /** Open a volume's root directory.
    *
    * \param[in] vol The FAT volume containing the root directory to be opened.
@@ -568,29 +592,31 @@ class FatFile {
   /** Print a number followed by a field terminator.
    * \param[in] value The number to be printed.
    * \param[in] term The field terminator.  Use '\\n' for CR LF.
-   * \param[in] prec Number of digits after decimal point.
+   * \param[in] prec Number of digits after decimal point.  Use
+   *                 FMT_SHORTEST for the shortest form that reads back
+   *                 as the same value.
    * \return The number of bytes written or -1 if an error occurs.
    */
   size_t printField(double value, char term, uint8_t prec = 2) {
-    char buf[24];
-    char* str = buf + sizeof(buf);
-    if (term) {
-      *--str = term;
-      if (term == '\n') {
-        *--str = '\r';
-      }
-    }
-    str = fmtDouble(str, value, prec, false);
-    return write(str, buf + sizeof(buf) - str);
+    // one direct write per field
+    FmtBuffer<FatFile, 1> buf(this);
+    buf.field(value, term, prec);
+    buf.flush();
+    return buf.count();
   }
   /** Print a number followed by a field terminator.
    * \param[in] value The number to be printed.
    * \param[in] term The field terminator.  Use '\\n' for CR LF.
-   * \param[in] prec Number of digits after decimal point.
+   * \param[in] prec Number of digits after decimal point.  Use
+   *                 FMT_SHORTEST for the shortest form that reads back
+   *                 as the same value.
    * \return The number of bytes written or -1 if an error occurs.
    */
   size_t printField(float value, char term, uint8_t prec = 2) {
-    return printField(static_cast<double>(value), term, prec);
+    FmtBuffer<FatFile, 1> buf(this);
+    buf.field(value, term, prec);
+    buf.flush();
+    return buf.count();
   }
   /** Print a number followed by a field terminator.
    * \param[in] value The number to be printed.
@@ -599,29 +625,30 @@ class FatFile {
    */
   template <typename Type>
   size_t printField(Type value, char term) {
-    char sign = 0;
-    char buf[3*sizeof(Type) + 3];
-    char* str = buf + sizeof(buf);
-
-    if (term) {
-      *--str = term;
-      if (term == '\n') {
-        *--str = '\r';
-      }
-    }
-    if (value < 0) {
-      value = -value;
-      sign = '-';
-    }
-    if (sizeof(Type) < 4) {
-      str = fmtBase10(str, (uint16_t)value);
-    } else {
-      str = fmtBase10(str, (uint32_t)value);
-    }
-    if (sign) {
-      *--str = sign;
-    }
-    return write(str, &buf[sizeof(buf)] - str);
+    // one direct write per field
+    FmtBuffer<FatFile, 1> buf(this);
+    buf.field(value, term);
+    buf.flush();
+    return buf.count();
+  }
+  /** Print a CSV row.
+   *
+   * The values are separated by commas and followed by CR LF.  Numbers
+   * are formatted as in printField() with two digits after the decimal
+   * point for floating values.  Strings are printed without quotes.
+   *
+   * The row is written with one call to write() if it fits in
+   * FS_FMT_BUFFER_SIZE bytes.
+   *
+   * \param[in] values The values to be printed.
+   * \return The number of bytes written or -1 if an error occurs.
+   */
+  template <typename... Types>
+  size_t printFields(Types... values) {
+    FmtBuffer<FatFile> buf(this);
+    buf.fields(values...);
+    buf.flush();
+    return buf.count();
   }
   /** Print a file's modify date and time
    *
@@ -686,6 +713,58 @@ class FatFile {
    * a directory file or an I/O error occurred.
    */
   int8_t readDir(dir_t* dir);
+  /** Read the names and metadata of the next files in a directory.
+   *
+   * Entries are filled from the cached directory sectors without
+   * opening the files.  The '.' and '..' entries are skipped.
+   *
+   * \param[out] entry Array of entries to be filled.
+   *
+   * \param[in] count Number of entries in the array.
+   *
+   * \param[in] filter Entries to skip, nullptr for all entries.
+   *
+   * \return The number of entries filled, zero at the end of the
+   * directory or -1 if an error occurs.
+   */
+  int readDir(FsDirEntry* entry, size_t count = 1,
+              const FsDirFilter* filter = nullptr);
+  /** Read a line without copying it if possible.
+   *
+   * The line is read as in fgets() with \a buf and \a size, then the
+   * delimiter is removed.  A line that fills \a buf is continued by the
+   * next call.
+   *
+   * If the line lies inside one sector and contains no CR before the
+   * delimiter, \a *line points into the volume cache and no data is
+   * copied.  This line is not null terminated and is only valid until the
+   * next call that accesses the volume.  Otherwise the line is copied to
+   * \a buf and null terminated.
+   *
+   * \param[out] line Set to the start of the line.
+   * \param[out] buf Buffer for lines that can not be returned in the cache.
+   * \param[in] size Size of \a buf, at least two.
+   * \param[in] delim Optional set of delimiters. The default is "\n".
+   * A NUL byte is also a delimiter if \a delim is given.
+   *
+   * \return The length of the line or -1 at end-of-file or if an error
+   * occurred.  Use getError() to check for an error.
+   */
+  int readLine(const char** line, char* buf, size_t size,
+               const char* delim = nullptr);
+  /** Read bytes until a terminator is found.
+   *
+   * The terminator is consumed but not stored.  If \a count bytes are
+   * stored first, the terminator is left for the next read.
+   *
+   * \param[in] terminator Character that ends the read.
+   * \param[out] buf Pointer to the location that will receive the data.
+   * \param[in] count Maximum number of bytes to store.
+   *
+   * \return The number of bytes stored, zero at EOF, or -1 if an error
+   * occurred.
+   */
+  int readUntil(char terminator, void* buf, size_t count);
   /** Remove a file.
    *
    * The directory entry and all data for the file are deleted.
@@ -765,6 +844,18 @@ class FatFile {
    * the value false is returned for failure.
    */
   bool rmRfStar();
+#if USE_FILE_EXTENT_MAP
+  /** Attach a cluster extent map to an open file.
+   *
+   * The map is cleared and then filled as the file's cluster chain is
+   * followed.  The map is detached when the file is opened again.
+   *
+   * \param[in] map The extent map or nullptr to detach the current map.
+   *
+   * \return true for success or false if the file is not an open file.
+   */
+  bool setExtentMap(FsExtentMap* map);
+#endif  // USE_FILE_EXTENT_MAP
   /** Set the files position to current position + \a pos. See seekSet().
    * \param[in] offset The new position in bytes from the current position.
    * \return true for success or false for failure.
@@ -931,14 +1022,29 @@ class FatFile {
   bool addCluster();
   bool addDirCluster();
   dir_t* cacheDirEntry(uint8_t action);
+  size_t clusterRun(uint8_t sectorOfCluster, size_t ns, bool allocate);
+#if USE_FAT_DIR_INDEX
+  bool dirIndexBuild(FatDirIndexSlot* slot);
+  int8_t dirIndexFindSfn(FatDirIndexSlot* slot, const uint8_t* sfn);
+  int8_t dirIndexMatch(uint16_t index, fname_t* fname, uint8_t* lfnOrd,
+                       bool* fnameFound);
+  FatDirIndexSlot* dirIndexSlot();
+#endif  // USE_FAT_DIR_INDEX
+  static void dirName(const DirFat_t* dir, char* name);
   static uint8_t lfnChecksum(uint8_t* name);
-  bool lfnUniqueSfn(fname_t* fname);
+  static bool lfnGetName(ldir_t *ldir, char* name, size_t n);
+  bool lfnUniqueSfn(fname_t* fname, const uint8_t* seqUsed);
+  void lsDir(print_t* pr, uint8_t flags, uint8_t indent, FsDirEntry* entry);
   bool openCluster(FatFile* file);
   static bool parsePathName(const char* str, fname_t* fname, const char** ptr);
   bool mkdir(FatFile* parent, fname_t* fname);
+  int8_t nextCluster(uint32_t index);
   bool open(FatFile* dirFile, fname_t* fname, uint8_t oflag);
   bool openCachedEntry(FatFile* dirFile, uint16_t cacheIndex, uint8_t oflag,
                        uint8_t lfnOrd);
+  bool openPathDir(FatFile* dirFile, fname_t* fname);
+  int8_t curSector(uint32_t* sector, uint8_t* sectorOfCluster);
+  int readCache(const uint8_t** ptr);
   dir_t* readDirCache(bool skipReadOk = false);
 
   // bits defined in m_flags
@@ -969,9 +1075,13 @@ class FatFile {
   uint32_t   m_dirSector;        // sector for this files directory entry
   uint32_t   m_fileSize;         // file size in bytes
   uint32_t   m_firstCluster;     // first cluster of file
+#if USE_FILE_EXTENT_MAP
+  FsExtentMap* m_extentMap;      // optional cluster extent map
+#endif  // USE_FILE_EXTENT_MAP
 };
 
 #include "../common/ArduinoFiles.h"
+#if ENABLE_ARDUINO_FEATURES
 /**
  * \class File
  * \brief FAT16/FAT32 file with Arduino Stream.
@@ -989,4 +1099,5 @@ class File : public StreamFile<FatFile, uint32_t> {
     return tmpFile;
   }
 };
+#endif  // ENABLE_ARDUINO_FEATURES
 #endif  // FatFile_h
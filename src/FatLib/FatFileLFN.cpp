@@ -51,6 +51,44 @@ static uint16_t Bernstein(uint16_t hash, const char *str, size_t len) {
   return hash;
 }
 //------------------------------------------------------------------------------
+// Generated short names are NAME~HHHH where HHHH is a hash of the long name
+// and a sequence number.
+const uint8_t FIRST_HASH_SEQ = 2;  // min value is 2
+// Number of sequence numbers checked by the directory scan in open().
+const uint8_t SCAN_HASH_SEQ = 8;
+//------------------------------------------------------------------------------
+static uint16_t sfnSeqHash(const fname_t* fname, uint8_t seq) {
+  return Bernstein(seq + fname->len, fname->lfn, fname->len);
+}
+//------------------------------------------------------------------------------
+// Set the seqUsed bit for each scanned sequence number whose generated
+// short name is name.
+static void sfnSeqCheck(const fname_t* fname, const uint16_t* seqHash,
+                        const uint8_t* name, uint8_t* seqUsed) {
+  uint8_t pos = fname->seqPos > 3 ? 3 : fname->seqPos;
+  uint16_t hex = 0;
+  if (memcmp(name, fname->sfn, pos) || name[pos] != '~' ||
+      memcmp(name + pos + 5, fname->sfn + pos + 5, 6 - pos)) {
+    return;
+  }
+  for (uint8_t i = pos + 1; i < pos + 5; i++) {
+    uint8_t c = name[i];
+    if ('0' <= c && c <= '9') {
+      c -= '0';
+    } else if ('A' <= c && c <= 'F') {
+      c -= 'A' - 10;
+    } else {
+      return;
+    }
+    hex = hex << 4 | c;
+  }
+  for (uint8_t i = 0; i < SCAN_HASH_SEQ; i++) {
+    if (seqHash[i] == hex) {
+      *seqUsed |= 1 << i;
+    }
+  }
+}
+//------------------------------------------------------------------------------
 /**
  * Fetch a 16-bit long file name character.
  *
@@ -69,7 +107,7 @@ static uint16_t lfnGetChar(ldir_t *ldir, uint8_t i) {
   return 0;
 }
 //------------------------------------------------------------------------------
-static bool lfnGetName(ldir_t *ldir, char* name, size_t n) {
+bool FatFile::lfnGetName(ldir_t *ldir, char* name, size_t n) {
   uint8_t i;
   size_t k = 13*((ldir->order & 0X1F) - 1);
   for (i = 0; i < 13; i++) {
@@ -120,6 +158,228 @@ static void lfnPutName(ldir_t *ldir, const char* name, size_t n) {
     lfnPutChar(ldir, i, c);
   }
 }
+#if USE_FAT_DIR_INDEX
+//------------------------------------------------------------------------------
+// Name hashes are a sum of per character terms so the long name hash can be
+// built from LFN entries in any order.  Short names use positions 256-266.
+static uint32_t dirHashTerm(uint8_t c, uint16_t k) {
+  uint32_t x = (c | (uint32_t)k << 8)*0X9E3779B1UL;
+  return x ^ (x >> 15);
+}
+//------------------------------------------------------------------------------
+static uint16_t dirHashFinish(uint32_t hash) {
+  return hash ^ (hash >> 16);
+}
+//------------------------------------------------------------------------------
+static uint16_t lfnHash(const char* lfn, size_t len) {
+  uint32_t hash = 0;
+  for (size_t k = 0; k < len; k++) {
+    hash += dirHashTerm(lfnToLower(lfn[k]), k);
+  }
+  return dirHashFinish(hash);
+}
+//------------------------------------------------------------------------------
+static uint16_t sfnHash(const uint8_t* sfn) {
+  uint32_t hash = 0;
+  for (uint8_t k = 0; k < 11; k++) {
+    hash += dirHashTerm(sfn[k], 256 + k);
+  }
+  return dirHashFinish(hash);
+}
+//------------------------------------------------------------------------------
+bool FatFile::dirIndexBuild(FatDirIndexSlot* slot) {
+  FatDirIndex* index = m_vol->m_dirNameIndex;
+  bool lfnOk = false;
+  uint8_t lfnOrd = 0;
+  uint8_t order = 0;
+  uint8_t checksum = 0;
+  uint32_t hash = 0;
+  uint32_t freeIndex = 0XFFFFFFFF;
+  uint32_t curIndex;
+  dir_t* dir;
+  ldir_t* ldir;
+
+  rewind();
+  while (1) {
+    curIndex = m_curPosition/32;
+    dir = readDirCache(true);
+    if (!dir) {
+      if (getError()) {
+        DBG_FAIL_MACRO;
+        goto fail;
+      }
+      break;
+    }
+    if (dir->name[0] == FAT_NAME_FREE) {
+      break;
+    }
+    if (dir->name[0] == FAT_NAME_DELETED) {
+      if (freeIndex > curIndex) {
+        freeIndex = curIndex;
+      }
+      lfnOrd = 0;
+    } else if (dir->name[0] == '.') {
+      lfnOrd = 0;
+    } else if (isLongName(dir)) {
+      ldir = reinterpret_cast<ldir_t*>(dir);
+      if (!lfnOrd) {
+        if ((ldir->order & FAT_ORDER_LAST_LONG_ENTRY) == 0) {
+          continue;
+        }
+        lfnOrd = order = ldir->order & 0X1F;
+        checksum = ldir->checksum;
+        lfnOk = true;
+        hash = 0;
+      } else if (ldir->order != --order || checksum != ldir->checksum) {
+        lfnOrd = 0;
+        continue;
+      }
+      size_t k = 13*(order - 1);
+      for (uint8_t i = 0; i < 13; i++, k++) {
+        uint16_t u = lfnGetChar(ldir, i);
+        if (u == 0) {
+          break;
+        }
+        if (u > 255) {
+          // Can't match a char name.
+          lfnOk = false;
+          break;
+        }
+        hash += dirHashTerm(lfnToLower(u), k);
+      }
+    } else if (isFileOrSubdir(dir)) {
+      if (lfnOrd && lfnOk && order == 1 &&
+          lfnChecksum(dir->name) == checksum) {
+        index->insert(slot, dirHashFinish(hash), curIndex);
+      }
+      index->insert(slot, sfnHash(dir->name), curIndex);
+      lfnOrd = 0;
+    } else {
+      lfnOrd = 0;
+    }
+  }
+  slot->endIndex = curIndex;
+  slot->freeIndex = freeIndex < curIndex ? freeIndex : curIndex;
+  return true;
+
+fail:
+  return false;
+}
+//------------------------------------------------------------------------------
+int8_t FatFile::dirIndexFindSfn(FatDirIndexSlot* slot, const uint8_t* sfn) {
+  uint16_t hash = sfnHash(sfn);
+  size_t pos = 0;
+  uint16_t index;
+  dir_t* dir;
+
+  while (m_vol->m_dirNameIndex->next(slot, hash, &pos, &index)) {
+    if (!seekSet(32UL*index)) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    dir = readDirCache();
+    if (!dir) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    if (dir->name[0] != FAT_NAME_FREE && isFileOrSubdir(dir) &&
+        !memcmp(sfn, dir->name, 11)) {
+      return 1;
+    }
+  }
+  return 0;
+
+fail:
+  return -1;
+}
+//------------------------------------------------------------------------------
+int8_t FatFile::dirIndexMatch(uint16_t index, fname_t* fname,
+                              uint8_t* lfnOrd, bool* fnameFound) {
+  bool sfnMatch;
+  uint8_t checksum;
+  size_t len = fname->len;
+  dir_t* dir;
+  ldir_t* ldir;
+
+  if (!seekSet(32UL*index)) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  dir = readDirCache();
+  if (!dir) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  // Record may be stale.
+  if (dir->name[0] == FAT_NAME_FREE || dir->name[0] == FAT_NAME_DELETED ||
+      dir->name[0] == '.' || !isFileOrSubdir(dir)) {
+    return 0;
+  }
+  sfnMatch = !memcmp(dir->name, fname->sfn, sizeof(fname->sfn));
+  checksum = lfnChecksum(dir->name);
+  for (uint8_t order = 1; order <= index; order++) {
+    size_t k = 13*(order - 1);
+    if (k >= len || !seekSet(32UL*(index - order))) {
+      break;
+    }
+    ldir = reinterpret_cast<ldir_t*>(readDirCache());
+    if (!ldir) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    if (ldir->attributes != FAT_ATTRIB_LONG_NAME ||
+        order != (ldir->order & 0X1F) || checksum != ldir->checksum) {
+      break;
+    }
+    uint8_t i;
+    for (i = 0; i < 13 && k < len; i++, k++) {
+      uint16_t u = lfnGetChar(ldir, i);
+      if (u > 255 || lfnToLower(u) != lfnToLower(fname->lfn[k])) {
+        break;
+      }
+    }
+    if (k < len && i < 13) {
+      // Character mismatch.
+      break;
+    }
+    if (ldir->order & FAT_ORDER_LAST_LONG_ENTRY) {
+      if (k == len && (i == 13 || lfnGetChar(ldir, i) == 0)) {
+        *lfnOrd = order;
+        return 1;
+      }
+      break;
+    }
+  }
+  if (sfnMatch) {
+    if (!(fname->flags & FNAME_FLAG_LOST_CHARS)) {
+      *lfnOrd = 0;
+      return 1;
+    }
+    *fnameFound = true;
+  }
+  return 0;
+
+fail:
+  return -1;
+}
+//------------------------------------------------------------------------------
+FatDirIndexSlot* FatFile::dirIndexSlot() {
+  FatDirIndex* index = m_vol->m_dirNameIndex;
+  FatDirIndexSlot* slot;
+  if (!index) {
+    return nullptr;
+  }
+  slot = index->get(m_firstCluster);
+  if (!slot) {
+    slot = index->replace(m_firstCluster);
+    if (!dirIndexBuild(slot)) {
+      index->invalidate(m_firstCluster);
+      return nullptr;
+    }
+  }
+  return slot->status & FatDirIndex::SLOT_STATUS_OVERFLOW ? nullptr : slot;
+}
+#endif  // USE_FAT_DIR_INDEX
 //==============================================================================
 bool FatFile::getName(char* name, size_t size) {
   FatFile dirFile;
@@ -306,6 +566,13 @@ bool FatFile::open(FatFile* dirFile, fname_t* fname, uint8_t oflag) {
   dir_t* dir;
   ldir_t* ldir;
   size_t len = fname->len;
+  bool seqScanned = false;
+  uint8_t seqUsed = 0;
+  uint16_t seqHash[SCAN_HASH_SEQ];
+#if USE_FAT_DIR_INDEX
+  FatDirIndex* nameIndex;
+  FatDirIndexSlot* slot;
+#endif  // USE_FAT_DIR_INDEX
 
   if (!dirFile->isDir() || isOpen()) {
     DBG_FAIL_MACRO;
@@ -314,6 +581,72 @@ bool FatFile::open(FatFile* dirFile, fname_t* fname, uint8_t oflag) {
   // Number of directory entries needed.
   freeNeed = fname->flags & FNAME_FLAG_NEED_LFN ? 1 + (len + 12)/13 : 1;
 
+#if USE_FAT_DIR_INDEX
+  nameIndex = dirFile->m_vol->m_dirNameIndex;
+  slot = dirFile->dirIndexSlot();
+  if (slot) {
+    // Check entries with a matching long or short name hash.
+    for (uint8_t pass = 0; pass < 2; pass++) {
+      uint16_t hash = pass ? sfnHash(fname->sfn) : lfnHash(fname->lfn, len);
+      size_t pos = 0;
+      uint16_t index;
+      while (nameIndex->next(slot, hash, &pos, &index)) {
+        int8_t rtn = dirFile->dirIndexMatch(index, fname, &lfnOrd,
+                                            &fnameFound);
+        if (rtn < 0) {
+          DBG_FAIL_MACRO;
+          goto fail;
+        }
+        if (rtn) {
+          // Cache the short name entry.
+          if (!dirFile->seekSet(32UL*index) || !dirFile->readDirCache()) {
+            DBG_FAIL_MACRO;
+            goto fail;
+          }
+          curIndex = index;
+          goto found;
+        }
+      }
+    }
+    // Not found so find free entries starting at the first hole.
+    if (!dirFile->seekSet(32UL*slot->freeIndex)) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    do {
+      curIndex = dirFile->m_curPosition/32;
+      // The first entry must be read since the cache may hold another sector.
+      dir = dirFile->readDirCache(curIndex != slot->freeIndex);
+      if (!dir) {
+        if (dirFile->getError()) {
+          DBG_FAIL_MACRO;
+          goto fail;
+        }
+        break;
+      }
+      if (dir->name[0] == FAT_NAME_DELETED ||
+          dir->name[0] == FAT_NAME_FREE) {
+        if (freeFound == 0) {
+          freeIndex = curIndex;
+        }
+        freeFound++;
+        if (dir->name[0] == FAT_NAME_FREE) {
+          break;
+        }
+      } else {
+        freeFound = 0;
+      }
+    } while (freeFound < freeNeed);
+    goto create;
+  }
+#endif  // USE_FAT_DIR_INDEX
+  // Collect generated short names in the scan for lfnUniqueSfn().
+  if (fname->flags & FNAME_FLAG_LOST_CHARS) {
+    for (uint8_t i = 0; i < SCAN_HASH_SEQ; i++) {
+      seqHash[i] = sfnSeqHash(fname, FIRST_HASH_SEQ + i);
+    }
+    seqScanned = true;
+  }
   dirFile->rewind();
   while (1) {
     curIndex = dirFile->m_curPosition/32;
@@ -352,6 +685,11 @@ bool FatFile::open(FatFile* dirFile, fname_t* fname, uint8_t oflag) {
         }
         lfnOrd = order = ldir->order & 0X1F;
         checksum = ldir->checksum;
+        if (len > 13UL*order) {
+          // Name is longer than a full length LFN.
+          lfnOrd = 0;
+          continue;
+        }
       } else if (ldir->order != --order || checksum != ldir->checksum) {
         lfnOrd = 0;
         continue;
@@ -390,6 +728,8 @@ bool FatFile::open(FatFile* dirFile, fname_t* fname, uint8_t oflag) {
           goto found;
         }
         fnameFound = true;
+      } else if (seqScanned) {
+        sfnSeqCheck(fname, seqHash, dir->name, &seqUsed);
       }
     } else {
       lfnOrd = 0;
@@ -440,7 +780,7 @@ create:
     freeFound += 16;
   }
   if (fnameFound) {
-    if (!dirFile->lfnUniqueSfn(fname)) {
+    if (!dirFile->lfnUniqueSfn(fname, seqScanned ? &seqUsed : nullptr)) {
       goto fail;
     }
   }
@@ -488,6 +828,20 @@ create:
   }
   // Force write of entry to device.
   dirFile->m_vol->cacheDirty();
+#if USE_FAT_DIR_INDEX
+  if (slot) {
+    if (freeIndex == slot->freeIndex) {
+      slot->freeIndex = curIndex + 1;
+    }
+    if (curIndex >= slot->endIndex) {
+      slot->endIndex = curIndex + 1;
+    }
+    if (lfnOrd) {
+      nameIndex->insert(slot, lfnHash(fname->lfn, len), curIndex);
+    }
+    nameIndex->insert(slot, sfnHash(fname->sfn), curIndex);
+  }
+#endif  // USE_FAT_DIR_INDEX
 
 open:
   // open entry in cache.
@@ -581,6 +935,19 @@ bool FatFile::remove() {
   // Mark entry deleted.
   dir->name[0] = FAT_NAME_DELETED;
 
+#if USE_FAT_DIR_INDEX
+  if (m_vol->m_dirNameIndex) {
+    FatDirIndexSlot* slot = m_vol->m_dirNameIndex->get(m_dirCluster);
+    if (slot) {
+      m_vol->m_dirNameIndex->remove(slot, m_dirIndex);
+      if (slot->freeIndex > (uint32_t)(m_dirIndex - m_lfnOrd)) {
+        slot->freeIndex = m_dirIndex - m_lfnOrd;
+      }
+    }
+  }
+#endif  // USE_FAT_DIR_INDEX
+  // Cached paths may use the removed entry.
+  m_vol->pathCacheClear();
   // Set this file closed.
   m_attributes = FILE_ATTR_CLOSED;
   m_flags = 0;
@@ -632,11 +999,13 @@ fail:
   return false;
 }
 //------------------------------------------------------------------------------
-bool FatFile::lfnUniqueSfn(fname_t* fname) {
-  const uint8_t FIRST_HASH_SEQ = 2;  // min value is 2
+bool FatFile::lfnUniqueSfn(fname_t* fname, const uint8_t* seqUsed) {
   uint8_t pos = fname->seqPos;;
   dir_t *dir;
   uint16_t hex;
+#if USE_FAT_DIR_INDEX
+  FatDirIndexSlot* slot = seqUsed ? nullptr : dirIndexSlot();
+#endif  // USE_FAT_DIR_INDEX
 
   DBG_HALT_IF(!(fname->flags & FNAME_FLAG_LOST_CHARS));
   DBG_HALT_IF(fname->sfn[pos] != '~' && fname->sfn[pos + 1] != '1');
@@ -646,7 +1015,7 @@ bool FatFile::lfnUniqueSfn(fname_t* fname) {
       fname->sfn[pos + 1] = '0' + seq;
     } else {
       DBG_PRINT_IF(seq > FIRST_HASH_SEQ);
-      hex = Bernstein(seq + fname->len, fname->lfn, fname->len);
+      hex = sfnSeqHash(fname, seq);
       if (pos > 3) {
         // Make space in name for ~HHHH.
         pos = 3;
@@ -658,6 +1027,27 @@ bool FatFile::lfnUniqueSfn(fname_t* fname) {
       }
     }
     fname->sfn[pos] = '~';
+    if (seqUsed && seq < FIRST_HASH_SEQ + SCAN_HASH_SEQ) {
+      if (!(*seqUsed & 1 << (seq - FIRST_HASH_SEQ))) {
+        goto done;
+      }
+      // Name found by the scan in open() - try another.
+      continue;
+    }
+#if USE_FAT_DIR_INDEX
+    if (slot) {
+      int8_t rtn = dirIndexFindSfn(slot, fname->sfn);
+      if (rtn < 0) {
+        DBG_FAIL_MACRO;
+        goto fail;
+      }
+      if (rtn == 0) {
+        goto done;
+      }
+      // Name found - try another.
+      continue;
+    }
+#endif  // USE_FAT_DIR_INDEX
     rewind();
     while (1) {
       dir = readDirCache(true);
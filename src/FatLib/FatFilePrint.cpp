@@ -39,23 +39,40 @@ static void printHex(print_t* pr, uint8_t w, uint16_t h) {
   pr->write(ptr);
 }
 //------------------------------------------------------------------------------
+static size_t printSize(print_t* pr, uint32_t size) {
+  char buf[11];
+  char *ptr = buf + sizeof(buf);
+  *--ptr = 0;
+  ptr = fmtBase10(ptr, size);
+  while (ptr > buf) {
+    *--ptr = ' ';
+  }
+  return pr->write(buf);
+}
+//------------------------------------------------------------------------------
 int FatFile::printf(const char* fmt, ...) {
   va_list ap;
+  FmtBuffer<FatFile> buf(this);
   va_start(ap, fmt);
-  return vfprintf(this, fmt, ap);
+  int n = vfprintf(&buf, fmt, ap);
+  return buf.flush() ? n : -1;
 }
 //------------------------------------------------------------------------------
 int FatFile::mprintf(const char* fmt, ...) {
   va_list ap;
+  FmtBuffer<FatFile> buf(this);
   va_start(ap, fmt);
-  return vmprintf(this, fmt, ap);
+  int n = vmprintf(&buf, fmt, ap);
+  return buf.flush() ? n : -1;
 }
 //------------------------------------------------------------------------------
 #if ENABLE_ARDUINO_FEATURES
 int FatFile::mprintf(const __FlashStringHelper *ifsh, ...) {
   va_list ap;
+  FmtBuffer<FatFile> buf(this);
   va_start(ap, ifsh);
-  return vmprintf(this, ifsh, ap);
+  int n = vmprintf(&buf, ifsh, ap);
+  return buf.flush() ? n : -1;
 }
 #endif  // ENABLE_ARDUINO_FEATURES
 //------------------------------------------------------------------------------
@@ -98,31 +115,54 @@ void FatFile::dmpFile(print_t* pr, uint32_t pos, size_t n) {
 }
 //------------------------------------------------------------------------------
 void FatFile::ls(print_t* pr, uint8_t flags, uint8_t indent) {
-  FatFile file;
+  FsDirEntry entry;
+  lsDir(pr, flags, indent, &entry);
+}
+//------------------------------------------------------------------------------
+// One entry is shared by all levels of a recursive list.  It is not used
+// after the call to list a subdirectory.
+void FatFile::lsDir(print_t* pr, uint8_t flags, uint8_t indent,
+                    FsDirEntry* entry) {
+  FsDirFilter filter = {FS_ATTRIB_HIDDEN, nullptr};
+  if (flags & LS_A) {
+    filter.skip = 0;
+  }
   rewind();
-  while (file.openNext(this, O_READ)) {
-    // indent for dir level
-    if (!file.isHidden() || (flags & LS_A)) {
-      for (uint8_t i = 0; i < indent; i++) {
-        pr->write(' ');
-      }
-      if (flags & LS_DATE) {
-        file.printModifyDateTime(pr);
-        pr->write(' ');
-      }
-      if (flags & LS_SIZE) {
-        file.printFileSize(pr);
-        pr->write(' ');
+  while (readDir(entry, 1, &filter) == 1) {
+    FatFile file;
+    // Open the file only to recurse or for a name too long for entry.
+    if (entry->isTruncated() || ((flags & LS_R) && entry->isDir())) {
+      uint32_t pos = curPosition();
+      if (!seekSet(entry->dirPosition) || !file.openNext(this, O_READ) ||
+          !seekSet(pos)) {
+        DBG_FAIL_MACRO;
+        return;
       }
+    }
+    // indent for dir level
+    for (uint8_t i = 0; i < indent; i++) {
+      pr->write(' ');
+    }
+    if (flags & LS_DATE) {
+      fsPrintDateTime(pr, entry->modifyDateTime);
+      pr->write(' ');
+    }
+    if (flags & LS_SIZE) {
+      printSize(pr, entry->fileSize);
+      pr->write(' ');
+    }
+    if (entry->isTruncated()) {
       file.printName(pr);
-      if (file.isDir()) {
-        pr->write('/');
-      }
-      pr->write('\r');
-      pr->write('\n');
-      if ((flags & LS_R) && file.isDir()) {
-        file.ls(pr, flags, indent + 2);
-      }
+    } else {
+      pr->write(entry->name);
+    }
+    if (entry->isDir()) {
+      pr->write('/');
+    }
+    pr->write('\r');
+    pr->write('\n');
+    if ((flags & LS_R) && entry->isDir()) {
+      file.lsDir(pr, flags, indent + 2, entry);
     }
     file.close();
   }
@@ -153,12 +193,5 @@ fail:
 }
 //------------------------------------------------------------------------------
 size_t FatFile::printFileSize(print_t* pr) {
-  char buf[11];
-  char *ptr = buf + sizeof(buf);
-  *--ptr = 0;
-  ptr = fmtBase10(ptr, fileSize());
-  while (ptr > buf) {
-    *--ptr = ' ';
-  }
-  return pr->write(buf);
+  return printSize(pr, fileSize());
 }
@@ -27,9 +27,28 @@
 #include "FatFile.h"
 #include "FatVolume.h"
 //------------------------------------------------------------------------------
-bool FatFile::getSFN(char* name) {
+void FatFile::dirName(const DirFat_t* dir, char* name) {
   uint8_t j = 0;
   uint8_t lcBit = FAT_CASE_LC_BASE;
+  for (uint8_t i = 0; i < 11; i++) {
+    if (dir->name[i] == ' ') {
+      continue;
+    }
+    if (i == 8) {
+      // Position bit for extension.
+      lcBit = FAT_CASE_LC_EXT;
+      name[j++] = '.';
+    }
+    char c = dir->name[i];
+    if ('A' <= c && c <= 'Z' && (lcBit & dir->caseFlags)) {
+      c += 'a' - 'A';
+    }
+    name[j++] = c;
+  }
+  name[j] = 0;
+}
+//------------------------------------------------------------------------------
+bool FatFile::getSFN(char* name) {
   DirFat_t *dir;
 
   if (!isOpen()) {
@@ -48,22 +67,7 @@ bool FatFile::getSFN(char* name) {
     goto fail;
   }
   // format name
-  for (uint8_t i = 0; i < 11; i++) {
-    if (dir->name[i] == ' ') {
-      continue;
-    }
-    if (i == 8) {
-      // Position bit for extension.
-      lcBit = FAT_CASE_LC_EXT;
-      name[j++] = '.';
-    }
-    char c = dir->name[i];
-    if ('A' <= c && c <= 'Z' && (lcBit & dir->caseFlags)) {
-      c += 'a' - 'A';
-    }
-    name[j++] = c;
-  }
-  name[j] = 0;
+  dirName(dir, name);
   return true;
 
 fail:
@@ -286,6 +290,8 @@ bool FatFile::remove() {
   // Mark entry deleted.
   dir->name[0] = FAT_NAME_DELETED;
 
+  // Cached paths may use the removed entry.
+  m_vol->pathCacheClear();
   // Set this file closed.
   m_attributes = FILE_ATTR_CLOSED;
   m_flags = 0;
@@ -27,55 +27,20 @@
 #include "../common/FsStructs.h"
 #include "FatPartition.h"
 
-//------------------------------------------------------------------------------
-cache_t* FatCache::read(uint32_t sector, uint8_t option) {
-  if (m_lbn != sector) {
-    if (!sync()) {
-      DBG_FAIL_MACRO;
-      goto fail;
-    }
-    if (!(option & CACHE_OPTION_NO_READ)) {
-      if (!m_part->readSector(sector, m_buffer.data)) {
-        DBG_FAIL_MACRO;
-        goto fail;
-      }
-    }
-    m_status = 0;
-    m_lbn = sector;
-  }
-  m_status |= option & CACHE_STATUS_MASK;
-  return &m_buffer;
-
-fail:
-
-  return nullptr;
-}
-//------------------------------------------------------------------------------
-bool FatCache::sync() {
-  if (m_status & CACHE_STATUS_DIRTY) {
-    if (!m_part->writeSector(m_lbn, m_buffer.data)) {
-      DBG_FAIL_MACRO;
-      goto fail;
-    }
-    // mirror second FAT
-    if (m_status & CACHE_STATUS_MIRROR_FAT) {
-      uint32_t sector = m_lbn + m_part->sectorsPerFat();
-      if (!m_part->writeSector(sector, m_buffer.data)) {
-        DBG_FAIL_MACRO;
-        goto fail;
-      }
-    }
-    m_status &= ~CACHE_STATUS_DIRTY;
-  }
-  return true;
-
-fail:
-  return false;
-}
 //------------------------------------------------------------------------------
 bool FatPartition::allocateCluster(uint32_t current, uint32_t* next) {
   uint32_t find = current ? current : m_allocSearchStart;
   uint32_t start = find;
+#if USE_FAT_ALLOCATION_BITMAP
+  if (m_allocBitmap) {
+    find = allocBitmapFind(start, 1);
+    if (find) {
+      goto found;
+    }
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+#endif  // USE_FAT_ALLOCATION_BITMAP
   while (1) {
     find++;
     // If at end of FAT go to beginning of FAT.
@@ -97,6 +62,9 @@ bool FatPartition::allocateCluster(uint32_t current, uint32_t* next) {
       goto fail;
     }
   }
+#if USE_FAT_ALLOCATION_BITMAP
+ found:
+#endif  // USE_FAT_ALLOCATION_BITMAP
   // mark end of chain
   if (!fatPutEOC(find)) {
     DBG_FAIL_MACRO;
@@ -131,6 +99,19 @@ bool FatPartition::allocContiguous(uint32_t count, uint32_t* firstCluster) {
   // Start at cluster after last allocated cluster.
   uint32_t startCluster = m_allocSearchStart;
   endCluster = bgnCluster = startCluster + 1;
+#if USE_FAT_ALLOCATION_BITMAP
+  if (m_allocBitmap) {
+    bgnCluster = allocBitmapFind(startCluster, count);
+    if (!bgnCluster) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    endCluster = bgnCluster + count - 1;
+    // don't update search start if clusters before bgnCluster were checked.
+    setStart = bgnCluster == (startCluster + 1);
+    goto found;
+  }
+#endif  // USE_FAT_ALLOCATION_BITMAP
 
   // search the FAT for free clusters
   while (1) {
@@ -163,6 +144,9 @@ bool FatPartition::allocContiguous(uint32_t count, uint32_t* firstCluster) {
     }
     endCluster++;
   }
+#if USE_FAT_ALLOCATION_BITMAP
+ found:
+#endif  // USE_FAT_ALLOCATION_BITMAP
   // remember possible next free cluster
   if (setStart) {
     m_allocSearchStart = endCluster + 1;
@@ -191,6 +175,97 @@ bool FatPartition::allocContiguous(uint32_t count, uint32_t* firstCluster) {
 fail:
   return false;
 }
+#if USE_FAT_ALLOCATION_BITMAP
+//------------------------------------------------------------------------------
+// Find count free clusters starting after start and wrapping to cluster 2.
+// return first cluster or zero if not found.
+uint32_t FatPartition::allocBitmapFind(uint32_t start, uint32_t count) {
+  uint32_t find = allocBitmapFindRun(start + 1, m_lastCluster + 1, count);
+  return find ? find : allocBitmapFindRun(2, start + 1, count);
+}
+//------------------------------------------------------------------------------
+// Find count free clusters in [bgn, end) a word at a time.
+// return first cluster or zero if not found.
+uint32_t FatPartition::allocBitmapFindRun(uint32_t bgn, uint32_t end,
+                                          uint32_t count) {
+  // Bit index of clusters.
+  uint32_t pos = bgn - 2;
+  uint32_t last = end - 2;
+  // Length of free run that ends at pos.
+  uint32_t run = 0;
+  while (pos < last) {
+    uint8_t bit = pos & 31;
+    uint32_t nb = 32 - bit;
+    if (nb > (last - pos)) {
+      nb = last - pos;
+    }
+    uint32_t w = m_allocBitmap[pos >> 5] >> bit;
+    if (nb < 32) {
+      w &= (1UL << nb) - 1;
+    }
+    while (nb) {
+      // Free clusters are zero bits.
+      uint32_t n = w ? ctz32(w) : 32;
+      if (n > nb) {
+        n = nb;
+      }
+      if ((run + n) >= count) {
+        return pos - run + 2;
+      }
+      run += n;
+      pos += n;
+      nb -= n;
+      if (nb == 0) {
+        break;
+      }
+      w >>= n;
+      if (count >= 32) {
+        // Runs inside the word are too short so skip to the free
+        // clusters at the top of the word.
+        n = nb - (32 - clz32(w));
+        run = 0;
+        pos += nb - n;
+        nb = n;
+        w = 0;
+        continue;
+      }
+      // Skip allocated clusters.
+      n = ~w ? ctz32(~w) : 32;
+      if (n > nb) {
+        n = nb;
+      }
+      run = 0;
+      pos += n;
+      nb -= n;
+      if (n < 32) {
+        w >>= n;
+      }
+    }
+  }
+  return 0;
+}
+#endif  // USE_FAT_ALLOCATION_BITMAP
+//------------------------------------------------------------------------------
+#if FS_READ_AHEAD_SECTORS
+// Return sector data from the read-ahead buffer or nullptr to use the cache.
+// ns is the number of sectors left in the cluster.
+const uint8_t* FatPartition::cacheReadAhead(uint32_t sector, uint32_t ns) {
+  const uint8_t* src = m_readAhead.get(sector);
+  if (!src && ns > 1 && m_readAhead.isNext(sector) &&
+      !m_cache.contains(sector)) {
+    if (ns > m_readAhead.capacity()) {
+      ns = m_readAhead.capacity();
+    }
+    // Device must have current data for the run.
+    if ((!m_cache.contains(sector, ns) || m_cache.sync()) &&
+        writeBufferSync(sector, ns)) {
+      src = m_readAhead.fill(sector, ns);
+    }
+  }
+  m_readAhead.setLast(sector);
+  return src;
+}
+#endif  // FS_READ_AHEAD_SECTORS
 //------------------------------------------------------------------------------
 uint32_t FatPartition::clusterStartSector(uint32_t cluster) const {
   return m_dataStartSector + ((cluster - 2) << m_sectorsPerClusterShift);
@@ -267,6 +342,11 @@ bool FatPartition::fatPut(uint32_t cluster, uint32_t value) {
 
   // error if reserved cluster of beyond FAT
   DBG_HALT_IF(cluster < 2 || cluster > m_lastCluster);
+#if USE_FAT_ALLOCATION_BITMAP
+  if (m_allocBitmap) {
+    allocBitmapPut(m_allocBitmap, cluster, value != 0);
+  }
+#endif  // USE_FAT_ALLOCATION_BITMAP
 
   if (fatType() == 32) {
     sector = m_fatStartSector + (cluster >> (m_bytesPerSectorShift - 2));
@@ -370,6 +450,17 @@ int32_t FatPartition::freeClusterCount() {
     return m_freeClusterCount;
   }
 #endif  // MAINTAIN_FREE_CLUSTER_COUNT
+#if USE_FAT_ALLOCATION_BITMAP
+  if (m_allocBitmap) {
+    uint32_t used = 0;
+    uint32_t nw = allocationBitmapWords();
+    for (uint32_t i = 0; i < nw; i++) {
+      used += popcount32(m_allocBitmap[i]);
+    }
+    setFreeClusterCount(clusterCount() - used);
+    return clusterCount() - used;
+  }
+#endif  // USE_FAT_ALLOCATION_BITMAP
   uint32_t free = 0;
   uint32_t sector;
   uint32_t todo = m_lastCluster + 1;
@@ -425,22 +516,99 @@ int32_t FatPartition::freeClusterCount() {
 fail:
   return -1;
 }
+#if USE_FAT_FSINFO
+//------------------------------------------------------------------------------
+bool FatPartition::fsInfoRead(uint32_t sector) {
+  uint32_t free;
+  uint32_t next;
+  FsInfo_t* fsi = reinterpret_cast<FsInfo_t*>
+                  (cacheFetchData(sector, FatCache::CACHE_FOR_READ));
+  if (!fsi) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  // Ignore FSInfo with bad signatures.
+  if (getLe32(fsi->leadSignature) != FSINFO_LEAD_SIGNATURE ||
+      getLe32(fsi->structSignature) != FSINFO_STRUCT_SIGNATURE ||
+      getLe32(fsi->trailSignature) != FSINFO_TRAIL_SIGNATURE) {
+    return true;
+  }
+  m_fsInfoSector = sector;
+  // Values are hints.  Use them only if they are in range.
+  free = getLe32(fsi->freeCount);
+  if (free <= clusterCount()) {
+    setFreeClusterCount(free);
+  }
+  next = getLe32(fsi->nextFree);
+  if (2 <= next && next <= m_lastCluster) {
+    m_allocSearchStart = next - 1;
+  }
+  return true;
+
+fail:
+  return false;
+}
+//------------------------------------------------------------------------------
+bool FatPartition::fsInfoSync() {
+  FsInfo_t* fsi;
+  uint32_t free = 0XFFFFFFFF;
+  if (!m_fsInfoDirty) {
+    return true;
+  }
+  fsi = reinterpret_cast<FsInfo_t*>
+        (cacheFetchData(m_fsInfoSector, FatCache::CACHE_FOR_WRITE));
+  if (!fsi) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+#if MAINTAIN_FREE_CLUSTER_COUNT
+  if (m_freeClusterCount >= 0) {
+    free = m_freeClusterCount;
+  }
+#endif  // MAINTAIN_FREE_CLUSTER_COUNT
+  setLe32(fsi->freeCount, free);
+  setLe32(fsi->nextFree, m_allocSearchStart < m_lastCluster ?
+                         m_allocSearchStart + 1 : 0XFFFFFFFF);
+  m_fsInfoDirty = false;
+  return true;
+
+fail:
+  return false;
+}
+#endif  // USE_FAT_FSINFO
 //------------------------------------------------------------------------------
 bool FatPartition::init(BlockDevice* dev, uint8_t part) {
   uint32_t clusterCount;
   uint32_t totalSectors;
   uint32_t volumeStartSector = 0;
   m_blockDev = dev;
+#if USE_FAT_ALLOCATION_BITMAP
+  m_allocBitmap = nullptr;
+#endif  // USE_FAT_ALLOCATION_BITMAP
+#if USE_FAT_DIR_INDEX
+  m_dirNameIndex = nullptr;
+#endif  // USE_FAT_DIR_INDEX
   pbs_t* pbs;
   BpbFat32_t* bpb;
   MbrSector_t* mbr;
   uint8_t tmp;
   m_fatType = 0;
   m_allocSearchStart = 1;
-  m_cache.init(this);
+#if USE_FAT_FSINFO
+  m_fsInfoSector = 0;
+  m_fsInfoDirty = false;
+#endif  // USE_FAT_FSINFO
+  m_cache.init(dev);
 #if USE_SEPARATE_FAT_CACHE
-  m_fatCache.init(this);
+  m_fatCache.init(dev);
 #endif  // USE_SEPARATE_FAT_CACHE
+#if FS_WRITE_BUFFER_SECTORS
+  m_writeBuffer.init(dev);
+#endif  // FS_WRITE_BUFFER_SECTORS
+#if FS_READ_AHEAD_SECTORS
+  m_readAhead.init(dev);
+#endif  // FS_READ_AHEAD_SECTORS
+  pathCacheClear();
   // if part == 0 assume super floppy with FAT boot sector in sector zero
   // if part > 0 assume mbr volume with partition table
   if (part) {
@@ -481,6 +649,11 @@ bool FatPartition::init(BlockDevice* dev, uint8_t part) {
     m_sectorsPerFat = getLe32(bpb->sectorsPerFat32);
   }
   m_fatStartSector = volumeStartSector + getLe16(bpb->reservedSectorCount);
+  // FAT sectors are mirrored in the second FAT.
+  m_cache.setMirrorOffset(m_sectorsPerFat);
+#if USE_SEPARATE_FAT_CACHE
+  m_fatCache.setMirrorOffset(m_sectorsPerFat);
+#endif  // USE_SEPARATE_FAT_CACHE
 
   // count for FAT16 zero for FAT32
   m_rootDirEntryCount = getLe16(bpb->rootDirEntryCount);
@@ -517,6 +690,14 @@ bool FatPartition::init(BlockDevice* dev, uint8_t part) {
   } else {
     m_rootDirStart = getLe32(bpb->fat32RootCluster);
     m_fatType = 32;
+#if USE_FAT_FSINFO
+    uint16_t fsInfo = getLe16(bpb->fat32FSInfoSector);
+    if (fsInfo && fsInfo < getLe16(bpb->reservedSectorCount) &&
+        !fsInfoRead(volumeStartSector + fsInfo)) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+#endif  // USE_FAT_FSINFO
   }
   return true;
 
@@ -585,6 +766,10 @@ bool FatPartition::wipe(print_t* pr) {
     goto fail;
   }
   if (fatType() == 32) {
+    // Root cluster is the only allocated cluster.
+    setFreeClusterCount(clusterCount() - 1);
+    m_allocSearchStart = m_rootDirStart;
+    fsInfoDirty();
     // Reserve root cluster.
     if (!fatPutEOC(m_rootDirStart) || !cacheSync()) {
       DBG_FAIL_MACRO;
@@ -602,3 +787,63 @@ fail:
   m_fatType = 0;
   return false;
 }
+#if USE_FAT_ALLOCATION_BITMAP
+//------------------------------------------------------------------------------
+bool FatPartition::setAllocationBitmap(uint32_t* bitmap, size_t count) {
+  uint32_t free = 0;
+  uint32_t cluster;
+  m_allocBitmap = nullptr;
+  if (!bitmap) {
+    return true;
+  }
+  if (!m_fatType || count < allocationBitmapWords()) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  memset(bitmap, 0, 4*allocationBitmapWords());
+  if (fatType() == 16 || fatType() == 32) {
+    // Scan FAT a sector at a time.
+    uint32_t sector = m_fatStartSector;
+    uint16_t n = fatType() == 16 ? m_bytesPerSector/2 : m_bytesPerSector/4;
+    cluster = 0;
+    while (cluster <= m_lastCluster) {
+      cache_t* pc = cacheFetchFat(sector++, FatCache::CACHE_FOR_READ);
+      if (!pc) {
+        DBG_FAIL_MACRO;
+        goto fail;
+      }
+      for (uint16_t i = 0; i < n && cluster <= m_lastCluster; i++, cluster++) {
+        uint32_t f = fatType() == 16 ? pc->fat16[i] : pc->fat32[i];
+        if (cluster < 2) {
+          continue;
+        }
+        if (f) {
+          allocBitmapPut(bitmap, cluster, true);
+        } else {
+          free++;
+        }
+      }
+    }
+  } else {
+    for (cluster = 2; cluster <= m_lastCluster; cluster++) {
+      uint32_t f;
+      int8_t fg = fatGet(cluster, &f);
+      if (fg < 0) {
+        DBG_FAIL_MACRO;
+        goto fail;
+      }
+      if (fg == 0 || f) {
+        allocBitmapPut(bitmap, cluster, true);
+      } else {
+        free++;
+      }
+    }
+  }
+  setFreeClusterCount(free);
+  m_allocBitmap = bitmap;
+  return true;
+
+fail:
+  return false;
+}
+#endif  // USE_FAT_ALLOCATION_BITMAP
@@ -32,6 +32,11 @@
 #include "FatLibConfig.h"
 #include "SysCall.h"
 #include "BlockDevice.h"
+#include "FatDirIndex.h"
+#include "../common/FsCache.h"
+#include "../common/FsPathCache.h"
+#include "../common/FsReadAhead.h"
+#include "../common/FsWriteBuffer.h"
 #include "../common/FsStructs.h"
 
 /** Type for FAT12 partition */
@@ -60,73 +65,9 @@ union cache_t {
   /** Used to access cached directory entries. */
   dir_t    dir[16];
 };
-//==============================================================================
-/**
- * \class FatCache
- * \brief Sector cache.
- */
-class FatCache {
- public:
-  /** Cached sector is dirty */
-  static const uint8_t CACHE_STATUS_DIRTY = 1;
-  /** Cashed sector is FAT entry and must be mirrored in second FAT. */
-  static const uint8_t CACHE_STATUS_MIRROR_FAT = 2;
-  /** Cache sector status bits */
-  static const uint8_t CACHE_STATUS_MASK
-    = CACHE_STATUS_DIRTY | CACHE_STATUS_MIRROR_FAT;
-  /** Sync existing sector but do not read new sector. */
-  static const uint8_t CACHE_OPTION_NO_READ = 4;
-  /** Cache sector for read. */
-  static const uint8_t CACHE_FOR_READ = 0;
-  /** Cache sector for write. */
-  static const uint8_t CACHE_FOR_WRITE = CACHE_STATUS_DIRTY;
-  /** Reserve cache sector for write - do not read from sector device. */
-  static const uint8_t CACHE_RESERVE_FOR_WRITE
-    = CACHE_STATUS_DIRTY | CACHE_OPTION_NO_READ;
-  /** \return Cache sector address. */
-  cache_t* buffer() {
-    return &m_buffer;
-  }
-  /** Set current sector dirty. */
-  void dirty() {
-    m_status |= CACHE_STATUS_DIRTY;
-  }
-  /** Initialize the cache.
-   * \param[in] vol FatPartition that owns this FatCache.
-   */
-  void init(FatPartition *vol) {
-    m_part = vol;
-    invalidate();
-  }
-  /** Invalidate current cache sector. */
-  void invalidate() {
-    m_status = 0;
-    m_lbn = 0XFFFFFFFF;
-  }
-  /** \return dirty status */
-  bool isDirty() {
-    return m_status & CACHE_STATUS_DIRTY;
-  }
-  /** \return Logical sector number for cached sector. */
-  uint32_t sector() {
-    return m_lbn;
-  }
-  /** Read a sector into the cache.
-   * \param[in] sector Sector to read.
-   * \param[in] option mode for cached sector.
-   * \return Address of cached sector. */
-  cache_t* read(uint32_t sector, uint8_t option);
-  /** Write current sector if dirty.
-   * \return true for success else false.
-   */
-  bool sync();
-
- private:
-  uint8_t m_status;
-  FatPartition* m_part;
-  uint32_t m_lbn;
-  cache_t m_buffer;
-};
+//------------------------------------------------------------------------------
+/** FAT16/FAT32 sector cache. */
+typedef FsCache FatCache;
 //==============================================================================
 /**
  * \class FatPartition
@@ -174,7 +115,15 @@ class FatPartition {
       return nullptr;
     }
     m_cache.invalidate();
-    return m_cache.buffer();
+    return cacheAddress();
+  }
+  /** Write all dirty sectors and update the second FAT.  Use this call
+   * to bound the time the second FAT is stale when
+   * USE_DEFERRED_FAT_MIRROR is nonzero.
+   * \return true for success or false for failure.
+   */
+  bool syncFatMirror() {
+    return cacheSync();
   }
   /** \return The total number of clusters in the volume. */
   uint32_t clusterCount() const {
@@ -217,6 +166,43 @@ class FatPartition {
    * the value false is returned for failure.
    */
   bool init(BlockDevice* dev, uint8_t part);
+#if USE_FAT_ALLOCATION_BITMAP
+  /** \return The number of 32-bit words required for an allocation bitmap. */
+  size_t allocationBitmapWords() const {
+    return (clusterCount() + 31)/32;
+  }
+  /** Use a RAM bitmap of allocated clusters to find free clusters.
+   *
+   * The bitmap is built from the FAT and then kept current by all
+   * FAT updates.  It must remain valid until the volume is initialized
+   * again or the bitmap is removed.
+   *
+   * \param[in] bitmap Storage for allocationBitmapWords() words or
+   *            nullptr to stop using a bitmap.
+   * \param[in] count Number of words in \a bitmap.
+   *
+   * \return true for success or false if \a bitmap is too small or
+   *         an I/O error occurs.
+   */
+  bool setAllocationBitmap(uint32_t* bitmap, size_t count);
+#endif  // USE_FAT_ALLOCATION_BITMAP
+#if USE_FAT_DIR_INDEX
+  /** Use a hash index for name lookup in large directories.
+   *
+   * Directories are indexed when a file is first opened in them and the
+   * index is kept current as files are created and removed.  The index
+   * must remain valid until the volume is initialized again or the index
+   * is removed.
+   *
+   * \param[in] index The index or nullptr to stop using an index.
+   */
+  void setDirIndex(FatDirIndex* index) {
+    if (index) {
+      index->clear();
+    }
+    m_dirNameIndex = index;
+  }
+#endif  // USE_FAT_DIR_INDEX
   /** \return The number of entries in the root directory for FAT16 volumes. */
   uint16_t rootDirEntryCount() const {
     return m_rootDirEntryCount;
@@ -246,8 +232,7 @@ class FatPartition {
   }
 //------------------------------------------------------------------------------
  private:
-  // Allow FatFile and FatCache access to FatPartition private functions.
-  friend class FatCache;
+  // Allow FatFile access to FatPartition private functions.
   friend class FatFile;
 //------------------------------------------------------------------------------
   static const uint8_t  m_bytesPerSectorShift = 9;
@@ -266,25 +251,115 @@ class FatPartition {
   uint32_t m_fatStartSector;          // Start sector for first FAT.
   uint32_t m_lastCluster;             // Last cluster number in FAT.
   uint32_t m_rootDirStart;            // Start sector FAT16, cluster FAT32.
+#if USE_FAT_ALLOCATION_BITMAP
+  uint32_t* m_allocBitmap;            // Set bit for each allocated cluster.
+  uint32_t allocBitmapFind(uint32_t start, uint32_t count);
+  uint32_t allocBitmapFindRun(uint32_t bgn, uint32_t end, uint32_t count);
+  void allocBitmapPut(uint32_t* bitmap, uint32_t cluster, bool value) {
+    uint32_t mask = 1UL << ((cluster - 2) & 31);
+    if (value) {
+      bitmap[(cluster - 2) >> 5] |= mask;
+    } else {
+      bitmap[(cluster - 2) >> 5] &= ~mask;
+    }
+  }
+#endif  // USE_FAT_ALLOCATION_BITMAP
+#if USE_FAT_DIR_INDEX
+  FatDirIndex* m_dirNameIndex;        // Optional directory name index.
+#endif  // USE_FAT_DIR_INDEX
+#if USE_FAT_FSINFO
+  uint32_t m_fsInfoSector;            // FAT32 FSInfo sector, zero if none.
+  bool     m_fsInfoDirty;             // FSInfo count or hint has changed.
+  void fsInfoDirty() {
+    m_fsInfoDirty = m_fsInfoSector != 0;
+  }
+  bool fsInfoRead(uint32_t sector);
+  bool fsInfoSync();
+#else  // USE_FAT_FSINFO
+  void fsInfoDirty() {}
+  bool fsInfoSync() {
+    return true;
+  }
+#endif  // USE_FAT_FSINFO
 //------------------------------------------------------------------------------
   // sector I/O functions.
+  void preEraseHint(uint32_t cluster, uint32_t count) {
+    m_blockDev->preEraseHint(clusterStartSector(cluster),
+                             count << m_sectorsPerClusterShift);
+  }
   bool readSector(uint32_t sector, uint8_t* dst) {
-    return m_blockDev->readSector(sector, dst);
+    return writeBufferSync(sector, 1) && m_blockDev->readSector(sector, dst);
   }
   bool syncDevice() {
     return m_blockDev->syncDevice();
   }
   bool writeSector(uint32_t sector, const uint8_t* src) {
-    return m_blockDev->writeSector(sector, src);
+    readAheadInvalidate(sector, 1);
+    return writeBufferSync() && m_blockDev->writeSector(sector, src);
   }
 #if USE_MULTI_SECTOR_IO
   bool readSectors(uint32_t sector, uint8_t* dst, size_t ns) {
-    return m_blockDev->readSectors(sector, dst, ns);
+    return writeBufferSync(sector, ns) &&
+           m_blockDev->readSectors(sector, dst, ns);
   }
   bool writeSectors(uint32_t sector, const uint8_t* src, size_t ns) {
-    return m_blockDev->writeSectors(sector, src, ns);
+    readAheadInvalidate(sector, ns);
+    return writeBufferSync() && m_blockDev->writeSectors(sector, src, ns);
   }
 #endif  // USE_MULTI_SECTOR_IO
+  // A sector is never in both the write buffer and the cache.
+#if FS_WRITE_BUFFER_SECTORS
+  FsWriteBufferArray<FS_WRITE_BUFFER_SECTORS> m_writeBuffer;
+  bool writeBehind(uint32_t sector, const uint8_t* src) {
+    if (!m_writeBuffer.write(sector, src)) {
+      return false;
+    }
+    m_cache.invalidate(sector, 1);
+    readAheadInvalidate(sector, 1);
+    return true;
+  }
+  bool writeBufferSync() {
+    return m_writeBuffer.sync();
+  }
+  bool writeBufferSync(uint32_t sector, size_t ns) {
+    return !m_writeBuffer.contains(sector, ns) || m_writeBuffer.sync();
+  }
+#else  // FS_WRITE_BUFFER_SECTORS
+  bool writeBehind(uint32_t sector, const uint8_t* src) {
+    m_cache.invalidate(sector, 1);
+    return writeSector(sector, src);
+  }
+  bool writeBufferSync() {
+    return true;
+  }
+  bool writeBufferSync(uint32_t sector, size_t ns) {
+    (void)sector;
+    (void)ns;
+    return true;
+  }
+#endif  // FS_WRITE_BUFFER_SECTORS
+  // Read-ahead data must be invalidated when a sector is modified.
+#if FS_READ_AHEAD_SECTORS
+  FsReadAheadArray<FS_READ_AHEAD_SECTORS> m_readAhead;
+  const uint8_t* cacheReadAhead(uint32_t sector, uint32_t ns);
+  void readAheadInvalidate(uint32_t sector, size_t ns) {
+    m_readAhead.invalidate(sector, ns);
+  }
+#else  // FS_READ_AHEAD_SECTORS
+  void readAheadInvalidate(uint32_t sector, size_t ns) {
+    (void)sector;
+    (void)ns;
+  }
+#endif  // FS_READ_AHEAD_SECTORS
+  // Cached paths must be cleared when a directory entry is removed or changed.
+#if FS_PATH_CACHE_ENTRIES
+  FsPathCacheArray<FS_PATH_CACHE_ENTRIES> m_pathCache;
+  void pathCacheClear() {
+    m_pathCache.clear();
+  }
+#else  // FS_PATH_CACHE_ENTRIES
+  void pathCacheClear() {}
+#endif  // FS_PATH_CACHE_ENTRIES
 #if MAINTAIN_FREE_CLUSTER_COUNT
   int32_t  m_freeClusterCount;     // Count of free clusters in volume.
   void setFreeClusterCount(int32_t value) {
@@ -294,6 +369,7 @@ class FatPartition {
     if (m_freeClusterCount >= 0) {
       m_freeClusterCount += change;
     }
+    fsInfoDirty();
   }
 #else  // MAINTAIN_FREE_CLUSTER_COUNT
   void setFreeClusterCount(int32_t value) {
@@ -301,19 +377,21 @@ class FatPartition {
   }
   void updateFreeClusterCount(int32_t change) {
     (void)change;
+    fsInfoDirty();
   }
 #endif  // MAINTAIN_FREE_CLUSTER_COUNT
 
 // sector caches
-  FatCache m_cache;
+  FsCacheArray<FS_CACHE_SECTOR_COUNT> m_cache;
 #if USE_SEPARATE_FAT_CACHE
-  FatCache m_fatCache;
+  FsCacheArray<1> m_fatCache;
   cache_t* cacheFetchFat(uint32_t sector, uint8_t options) {
-    return m_fatCache.read(sector,
-                           options | FatCache::CACHE_STATUS_MIRROR_FAT);
+    options |= FatCache::CACHE_STATUS_MIRROR_FAT;
+    return reinterpret_cast<cache_t*>(m_fatCache.get(sector, options));
   }
   bool cacheSync() {
-    return m_cache.sync() && m_fatCache.sync() && syncDevice();
+    return fsInfoSync() && writeBufferSync() && m_cache.syncMirror() &&
+           m_fatCache.syncMirror() && syncDevice();
   }
 #else  //
   cache_t* cacheFetchFat(uint32_t sector, uint8_t options) {
@@ -321,26 +399,37 @@ class FatPartition {
                           options | FatCache::CACHE_STATUS_MIRROR_FAT);
   }
   bool cacheSync() {
-    return m_cache.sync() && syncDevice();
+    return fsInfoSync() && writeBufferSync() && m_cache.syncMirror() &&
+           syncDevice();
   }
 #endif  // USE_SEPARATE_FAT_CACHE
   cache_t* cacheFetchData(uint32_t sector, uint8_t options) {
-    return m_cache.read(sector, options);
+    if (!writeBufferSync(sector, 1)) {
+      return nullptr;
+    }
+    if (options & FatCache::CACHE_STATUS_DIRTY) {
+      readAheadInvalidate(sector, 1);
+    }
+    return reinterpret_cast<cache_t*>(m_cache.get(sector, options));
   }
-  void cacheInvalidate() {
-    m_cache.invalidate();
+  bool cacheContains(uint32_t sector, size_t ns = 1) {
+    return m_cache.contains(sector, ns);
+  }
+  void cacheInvalidate(uint32_t sector, size_t ns = 1) {
+    m_cache.invalidate(sector, ns);
   }
   bool cacheSyncData() {
     return m_cache.sync();
   }
   cache_t *cacheAddress() {
-    return m_cache.buffer();
+    return reinterpret_cast<cache_t*>(m_cache.cacheBuffer());
   }
   uint32_t cacheSectorNumber() {
     return m_cache.sector();
   }
   void cacheDirty() {
     m_cache.dirty();
+    readAheadInvalidate(m_cache.sector(), 1);
   }
 //------------------------------------------------------------------------------
   bool allocateCluster(uint32_t current, uint32_t* next);
@@ -32,9 +32,22 @@
 #ifdef __AVR__
 #include <avr/io.h>
 #endif  // __AVR__
-/** For Debug - must be one */
+/**
+ * Set ENABLE_ARDUINO_FEATURES nonzero to use the Arduino core for Print,
+ * Stream, SPI and timing.  The value is zero for a host build, where
+ * SysCall.h supplies print_t and the volume is attached to a
+ * HostBlockDevice instead of an SD card.
+ */
+#ifndef ENABLE_ARDUINO_FEATURES
+#if defined(ARDUINO) || defined(PLATFORM_ID)
 #define ENABLE_ARDUINO_FEATURES 1
+#else  // defined(ARDUINO) || defined(PLATFORM_ID)
+#define ENABLE_ARDUINO_FEATURES 0
+#endif  // defined(ARDUINO) || defined(PLATFORM_ID)
+#endif  // ENABLE_ARDUINO_FEATURES
+#if ENABLE_ARDUINO_FEATURES
 #include "Arduino.h"
+#endif  // ENABLE_ARDUINO_FEATURES
 //------------------------------------------------------------------------------
 /** Experimental - set nonzero to enable. */
 #define USE_FAT_FILE_FLAG_CONTIGUOUS 1
@@ -82,12 +95,30 @@
  */
 #define USE_STANDARD_SPI_LIBRARY 0
 //------------------------------------------------------------------------------
+/**
+ * Set USE_FAT_FSINFO nonzero to use the FAT32 FSInfo sector.  The free
+ * cluster count and next free cluster hint are read when the volume is
+ * mounted and written back by sync when allocation has changed.
+ */
+#ifndef USE_FAT_FSINFO
+#ifdef __AVR__
+#define USE_FAT_FSINFO 0
+#else  // __AVR__
+#define USE_FAT_FSINFO 1
+#endif  // __AVR__
+#endif  // USE_FAT_FSINFO
+//------------------------------------------------------------------------------
 /**
  * Set MAINTAIN_FREE_CLUSTER_COUNT nonzero to keep the count of free clusters
  * updated.  This will increase the speed of the freeClusterCount() call
  * after the first call.  Extra flash will be required.
+ *
+ * The count is maintained by default if USE_FAT_FSINFO is nonzero so the
+ * FSInfo free count remains valid.
  */
-#define MAINTAIN_FREE_CLUSTER_COUNT 0
+#ifndef MAINTAIN_FREE_CLUSTER_COUNT
+#define MAINTAIN_FREE_CLUSTER_COUNT USE_FAT_FSINFO
+#endif  // MAINTAIN_FREE_CLUSTER_COUNT
 //------------------------------------------------------------------------------
 /**
  * To enable SD card CRC checking for SPI, set USE_SD_CRC nonzero.
@@ -167,6 +198,17 @@
 #define USE_SEPARATE_FAT_CACHE 0
 #endif  // __arm__
 //------------------------------------------------------------------------------
+/**
+ * Set USE_DEFERRED_FAT_MIRROR nonzero to delay writes to the second FAT of
+ * FAT16/FAT32 volumes.  A FAT sector is written once when it leaves the
+ * cache and the range of changed sectors is copied to the second FAT by
+ * sync(), close() or syncFatMirror().  The second FAT is stale between
+ * these calls.
+ */
+#ifndef USE_DEFERRED_FAT_MIRROR
+#define USE_DEFERRED_FAT_MIRROR 0
+#endif  // USE_DEFERRED_FAT_MIRROR
+//------------------------------------------------------------------------------
 /**
  * Set USE_EXFAT_BITMAP_CACHE nonzero to use a second 512 byte cache
  * for exFAT bitmap entries.  This improves performance for large
@@ -178,6 +220,163 @@
 #define USE_EXFAT_BITMAP_CACHE 0
 #endif  // __arm__
 //------------------------------------------------------------------------------
+/**
+ * Set FS_CACHE_SECTOR_COUNT to the number of 512 byte sectors in the
+ * FAT16/FAT32 and exFAT volume cache.  Directory, FAT and partial data
+ * sectors share this LRU cache so a larger cache avoids rereading and
+ * rewriting sectors in metadata heavy applications.
+ *
+ * The default, one, is the classic single sector cache.  Each added
+ * sector uses 512 bytes of RAM per volume.
+ */
+#ifndef FS_CACHE_SECTOR_COUNT
+#define FS_CACHE_SECTOR_COUNT 1
+#endif  // FS_CACHE_SECTOR_COUNT
+//------------------------------------------------------------------------------
+/**
+ * Set FS_WRITE_BUFFER_SECTORS to the number of 512 byte sectors in the
+ * per-volume write-behind buffer.  Full file data sectors are collected
+ * and written as one multi-sector burst when the buffer fills, the file
+ * moves to a non-sequential sector, or the file is synced or closed.
+ * This helps small record writes, especially with shared SPI.
+ *
+ * Buffered sectors are not on the card until one of these events, so a
+ * power failure or reset can lose up to this many sectors that would
+ * otherwise have been written.  Call sync() after data that must survive.
+ *
+ * The default, zero, disables the buffer and each full sector is written
+ * immediately.
+ */
+#ifndef FS_WRITE_BUFFER_SECTORS
+#define FS_WRITE_BUFFER_SECTORS 0
+#endif  // FS_WRITE_BUFFER_SECTORS
+//------------------------------------------------------------------------------
+/**
+ * Set FS_READ_AHEAD_SECTORS nonzero to enable a per-volume read-ahead
+ * buffer of this many 512 byte sectors.  When a small file read moves to
+ * the sector after the last sector read, the following sectors of the
+ * cluster are read with one multi-sector command.  This speeds up
+ * line oriented parsing with calls like fgets() and getline().
+ */
+#ifndef FS_READ_AHEAD_SECTORS
+#define FS_READ_AHEAD_SECTORS 0
+#endif  // FS_READ_AHEAD_SECTORS
+//------------------------------------------------------------------------------
+/**
+ * Set FS_PATH_CACHE_ENTRIES to the number of subdirectory path components
+ * cached per volume.  A cached component of a path is opened from its
+ * directory entry position instead of by searching the parent directory,
+ * so repeated opens of files in nested directories cost about the same
+ * as an open in the last directory.  Each entry uses 44 bytes.
+ *
+ * The default, zero, disables the cache.
+ */
+#ifndef FS_PATH_CACHE_ENTRIES
+#define FS_PATH_CACHE_ENTRIES 0
+#endif  // FS_PATH_CACHE_ENTRIES
+//------------------------------------------------------------------------------
+/**
+ * Set FS_DIR_ENTRY_NAME_SIZE to the size in bytes of the name field in an
+ * FsDirEntry filled by readDir().  Longer names are truncated.  The
+ * minimum is 13, enough for a FAT short name.
+ */
+#ifndef FS_DIR_ENTRY_NAME_SIZE
+#define FS_DIR_ENTRY_NAME_SIZE 64
+#endif  // FS_DIR_ENTRY_NAME_SIZE
+//------------------------------------------------------------------------------
+/**
+ * Set FS_STREAM_BUF_SIZE to the size in bytes of the internal buffer in
+ * each fstream, ifstream, and ofstream.  Characters are read and written
+ * in blocks of this size instead of one call to read() or write() per
+ * character.  A stream can use a caller supplied buffer with setbuf().
+ *
+ * The default, zero, makes streams unbuffered unless setbuf() is called.
+ */
+#ifndef FS_STREAM_BUF_SIZE
+#define FS_STREAM_BUF_SIZE 0
+#endif  // FS_STREAM_BUF_SIZE
+//------------------------------------------------------------------------------
+/**
+ * Set FS_FMT_BUFFER_SIZE to the size in bytes of the stack buffer used by
+ * printf(), printField(), and printFields().  Formatted output is collected
+ * in this buffer and written with one call to write() when it is full or
+ * at the end of the call.
+ */
+#ifndef FS_FMT_BUFFER_SIZE
+#if defined(__AVR__) || defined(__MKL26Z64__)
+#define FS_FMT_BUFFER_SIZE 32
+#else  // defined(__AVR__) || defined(__MKL26Z64__)
+#define FS_FMT_BUFFER_SIZE 128
+#endif  // defined(__AVR__) || defined(__MKL26Z64__)
+#endif  // FS_FMT_BUFFER_SIZE
+//------------------------------------------------------------------------------
+/**
+ * Set USE_SMALL_DOUBLE_TABLE nonzero to format doubles with about 750 bytes
+ * of tables instead of about 10 KB.  The small tables compute each power
+ * of ten with an extra multiply so formatting is a little slower.
+ *
+ * Not used if double is 32-bit, as on AVR.
+ */
+#ifndef USE_SMALL_DOUBLE_TABLE
+#ifdef __ARM_ARCH_6M__
+#define USE_SMALL_DOUBLE_TABLE 1
+#else  // __ARM_ARCH_6M__
+#define USE_SMALL_DOUBLE_TABLE 0
+#endif  // __ARM_ARCH_6M__
+#endif  // USE_SMALL_DOUBLE_TABLE
+//------------------------------------------------------------------------------
+/**
+ * Set USE_FILE_EXTENT_MAP nonzero to allow an FsExtentMap to be attached
+ * to an open file with setExtentMap().  The map records runs of contiguous
+ * clusters so seeks and reads of fragmented files use a binary search
+ * instead of following the FAT chain from the start of the file.
+ */
+#ifndef USE_FILE_EXTENT_MAP
+#ifdef __AVR__
+#define USE_FILE_EXTENT_MAP 0
+#else  // __AVR__
+#define USE_FILE_EXTENT_MAP 1
+#endif  // __AVR__
+#endif  // USE_FILE_EXTENT_MAP
+//------------------------------------------------------------------------------
+/**
+ * Set USE_FAT_DIR_INDEX nonzero to allow a FatDirIndex to be attached to a
+ * FAT16/FAT32 volume with setDirIndex().  Opens and creates in indexed
+ * directories read only the entries with a matching name hash instead of
+ * scanning the directory.  The index is used when USE_LONG_FILE_NAMES is
+ * nonzero.
+ */
+#ifndef USE_FAT_DIR_INDEX
+#ifdef __AVR__
+#define USE_FAT_DIR_INDEX 0
+#else  // __AVR__
+#define USE_FAT_DIR_INDEX 1
+#endif  // __AVR__
+#endif  // USE_FAT_DIR_INDEX
+//------------------------------------------------------------------------------
+/**
+ * Set USE_FAT_ALLOCATION_BITMAP nonzero to allow a RAM bitmap of allocated
+ * clusters for FAT16/FAT32 volumes.  The application supplies the bitmap
+ * with setAllocationBitmap().  Cluster allocation then scans the bitmap
+ * instead of reading the FAT.
+ */
+#ifndef USE_FAT_ALLOCATION_BITMAP
+#ifdef __AVR__
+#define USE_FAT_ALLOCATION_BITMAP 0
+#else  // __AVR__
+#define USE_FAT_ALLOCATION_BITMAP 1
+#endif  // __AVR__
+#endif  // USE_FAT_ALLOCATION_BITMAP
+//------------------------------------------------------------------------------
+/**
+ * Set USE_ASYNC_IO nonzero to implement submitRead(), submitWrite() and
+ * poll() with non-blocking transfers in SdSpiCard and SdioCard.  The
+ * default, zero, completes the transfer before these functions return.
+ */
+#ifndef USE_ASYNC_IO
+#define USE_ASYNC_IO 0
+#endif  // USE_ASYNC_IO
+//------------------------------------------------------------------------------
 /**
  * Set USE_MULTI_SECTOR_IO nonzero to use multi-sector SD read/write.
  *
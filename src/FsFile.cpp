@@ -137,6 +137,24 @@ bool FsFile::openNext(FsFile* dir, uint8_t oflag) {
   return false;
 }
 //-----------------------------------------------------------------------------
+bool FsFile::openNext(FsFile* dir, uint8_t oflag, char* name, size_t size) {
+  close();
+  if (dir->m_fFile) {
+    m_fFile = new (m_fileMem) FatFile;
+    if (m_fFile->openNext(dir->m_fFile, oflag, name, size)) {
+      return true;
+    }
+    m_fFile = nullptr;
+  } else if (dir->m_xFile) {
+    m_xFile = new (m_fileMem) ExFatFile;
+    if (m_xFile->openNext(dir->m_xFile, oflag, name, size)) {
+      return true;
+    }
+    m_xFile = nullptr;
+  }
+  return false;
+}
+//-----------------------------------------------------------------------------
 bool FsFile::remove() {
   if (m_fFile) {
     if (m_fFile->remove()) {
@@ -31,6 +31,7 @@
 #include "common/FsNew.h"
 #include "FatLib/FatLib.h"
 #include "ExFatLib/ExFatLib.h"
+#include "FsVolume.h"
 /**
  * \class FsFile
  * \brief FsFile class.
@@ -115,6 +116,7 @@ class FsFile {
    * (including the final null byte). Usually the length
    * of the array \a str is used.
    * \param[in] delim Optional set of delimiters. The default is "\n".
+   * A NUL byte is also a delimiter if \a delim is given.
    *
    * \return For success fgets() returns the length of the string in \a str.
    * If no data is read, fgets() returns zero for EOF or -1 if an error occurred.
@@ -304,6 +306,14 @@ class FsFile {
    * \return a file object.
    */
   bool openNext(FsFile* dir, uint8_t oflag = O_READ);
+  /** Opens the next file or folder in a directory and gets its name.
+   * \param[in] dir directory containing files.
+   * \param[in] oflag open flags.
+   * \param[out] name An array of characters for the file's name.
+   * \param[in] size The size of the array in bytes.
+   * \return true for success or false for failure.
+   */
+  bool openNext(FsFile* dir, uint8_t oflag, char* name, size_t size);
   /** Return the next available byte without consuming it.
    *
    * \return The byte if no error and not at eof else -1;
@@ -364,10 +374,24 @@ class FsFile {
   }
   /** \return the current file position. */
   uint64_t position() {return curPosition();}
+#if USE_FILE_EXTENT_MAP
+  /** Attach a cluster extent map to an open file.
+   *
+   * \param[in] map The extent map or nullptr to detach the current map.
+   *
+   * \return true for success or false if the file is not an open file.
+   */
+  bool setExtentMap(FsExtentMap* map) {
+    return m_fFile ? m_fFile->setExtentMap(map) :
+           m_xFile ? m_xFile->setExtentMap(map) : false;
+  }
+#endif  // USE_FILE_EXTENT_MAP
    /** Print a number followed by a field terminator.
    * \param[in] value The number to be printed.
    * \param[in] term The field terminator.  Use '\\n' for CR LF.
-   * \param[in] prec Number of digits after decimal point.
+   * \param[in] prec Number of digits after decimal point.  Use
+   *                 FMT_SHORTEST for the shortest form that reads back
+   *                 as the same value.
    * \return The number of bytes written or -1 if an error occurs.
    */
   size_t printField(double value, char term, uint8_t prec = 2) {
@@ -377,11 +401,14 @@ class FsFile {
   /** Print a number followed by a field terminator.
    * \param[in] value The number to be printed.
    * \param[in] term The field terminator.  Use '\\n' for CR LF.
-   * \param[in] prec Number of digits after decimal point.
+   * \param[in] prec Number of digits after decimal point.  Use
+   *                 FMT_SHORTEST for the shortest form that reads back
+   *                 as the same value.
    * \return The number of bytes written or -1 if an error occurs.
    */
   size_t printField(float value, char term, uint8_t prec = 2) {
-     return printField(static_cast<double>(value), term, prec);
+    return m_fFile ? m_fFile->printField(value, term, prec) :
+           m_xFile ? m_xFile->printField(value, term, prec) : 0;
   }
   /** Print a number followed by a field terminator.
    * \param[in] value The number to be printed.
@@ -393,6 +420,20 @@ class FsFile {
     return m_fFile ? m_fFile->printField(value, term) :
            m_xFile ? m_xFile->printField(value, term) : 0;
   }
+  /** Print a CSV row.
+   *
+   * The values are separated by commas and followed by CR LF.  The row
+   * is written with one call to write() if it fits in FS_FMT_BUFFER_SIZE
+   * bytes.
+   *
+   * \param[in] values The values to be printed.
+   * \return The number of bytes written or -1 if an error occurs.
+   */
+  template<typename... Types>
+  size_t printFields(Types... values) {
+    return m_fFile ? m_fFile->printFields(values...) :
+           m_xFile ? m_xFile->printFields(values...) : 0;
+  }
   /** Read the next byte from a file.
    *
    * \return For success return the next byte in the file as an int.
@@ -419,6 +460,110 @@ class FsFile {
     return m_fFile ? m_fFile->read(buf, count) :
            m_xFile ? m_xFile->read(buf, count) : -1;
   }
+#if ENABLE_ARDUINO_FEATURES
+  /** Read bytes from a file.  Replaces the byte at a time Stream version.
+   *
+   * \param[out] buffer Pointer to the location that will receive the data.
+   * \param[in] length Maximum number of bytes to read.
+   *
+   * \return The number of bytes read, zero at EOF or for an error.
+   */
+  size_t readBytes(char* buffer, size_t length) {
+    int n = read(buffer, length);
+    return n < 0 ? 0 : n;
+  }
+  /** Read bytes from a file.  Replaces the byte at a time Stream version.
+   *
+   * \param[out] buffer Pointer to the location that will receive the data.
+   * \param[in] length Maximum number of bytes to read.
+   *
+   * \return The number of bytes read, zero at EOF or for an error.
+   */
+  size_t readBytes(uint8_t* buffer, size_t length) {
+    return readBytes(reinterpret_cast<char*>(buffer), length);
+  }
+  /** Read bytes until a terminator is found.  Replaces the byte at a
+   * time Stream version.
+   *
+   * \param[in] terminator Character that ends the read.
+   * \param[out] buffer Pointer to the location that will receive the data.
+   * \param[in] length Maximum number of bytes to store.
+   *
+   * \return The number of bytes stored, zero at EOF or for an error.
+   */
+  size_t readBytesUntil(char terminator, char* buffer, size_t length) {
+    int n = readUntil(terminator, buffer, length);
+    return n < 0 ? 0 : n;
+  }
+  /** Read bytes until a terminator is found.  Replaces the byte at a
+   * time Stream version.
+   *
+   * \param[in] terminator Character that ends the read.
+   * \param[out] buffer Pointer to the location that will receive the data.
+   * \param[in] length Maximum number of bytes to store.
+   *
+   * \return The number of bytes stored, zero at EOF or for an error.
+   */
+  size_t readBytesUntil(char terminator, uint8_t* buffer, size_t length) {
+    return readBytesUntil(terminator, reinterpret_cast<char*>(buffer), length);
+  }
+#endif  // ENABLE_ARDUINO_FEATURES
+  /** Read the names and metadata of the next files in a directory.
+   *
+   * \param[out] entry Array of entries to be filled.
+   * \param[in] count Number of entries in the array.
+   * \param[in] filter Entries to skip, nullptr for all entries.
+   *
+   * \return The number of entries filled, zero at the end of the
+   * directory or -1 if an error occurs.
+   */
+  int readDir(FsDirEntry* entry, size_t count = 1,
+              const FsDirFilter* filter = nullptr) {
+    return m_fFile ? m_fFile->readDir(entry, count, filter) :
+           m_xFile ? m_xFile->readDir(entry, count, filter) : -1;
+  }
+  /** Read a line without copying it if possible.
+   *
+   * The line is read as in fgets() with \a buf and \a size, then the
+   * delimiter is removed.  A line that fills \a buf is continued by the
+   * next call.
+   *
+   * If the line lies inside one sector and contains no CR before the
+   * delimiter, \a *line points into the volume cache and no data is
+   * copied.  This line is not null terminated and is only valid until the
+   * next call that accesses the volume.  Otherwise the line is copied to
+   * \a buf and null terminated.
+   *
+   * \param[out] line Set to the start of the line.
+   * \param[out] buf Buffer for lines that can not be returned in the cache.
+   * \param[in] size Size of \a buf, at least two.
+   * \param[in] delim Optional set of delimiters. The default is "\n".
+   * A NUL byte is also a delimiter if \a delim is given.
+   *
+   * \return The length of the line or -1 at end-of-file or if an error
+   * occurred.
+   */
+  int readLine(const char** line, char* buf, size_t size,
+               const char* delim = nullptr) {
+    return m_fFile ? m_fFile->readLine(line, buf, size, delim) :
+           m_xFile ? m_xFile->readLine(line, buf, size, delim) : -1;
+  }
+  /** Read bytes until a terminator is found.
+   *
+   * The terminator is consumed but not stored.  If \a count bytes are
+   * stored first, the terminator is left for the next read.
+   *
+   * \param[in] terminator Character that ends the read.
+   * \param[out] buf Pointer to the location that will receive the data.
+   * \param[in] count Maximum number of bytes to store.
+   *
+   * \return The number of bytes stored, zero at EOF, or -1 if an error
+   * occurred.
+   */
+  int readUntil(char terminator, void* buf, size_t count) {
+    return m_fFile ? m_fFile->readUntil(terminator, buf, count) :
+           m_xFile ? m_xFile->readUntil(terminator, buf, count) : -1;
+  }
   /** Remove a file.
    *
    * The directory entry and all data for the file are deleted.
@@ -589,6 +734,19 @@ class FsFile {
     return m_fFile ? m_fFile->write(buf, count) :
            m_xFile ? m_xFile->write(buf, count) : 0;
   }
+#if ENABLE_ARDUINO_FEATURES
+  /** Write data to a file.  Replaces the byte at a time Print version
+   * used by print() for strings and numbers.
+   *
+   * \param[in] buffer Pointer to the location of the data to be written.
+   * \param[in] size Number of bytes to write.
+   *
+   * \return The number of bytes written.
+   */
+  size_t write(const uint8_t* buffer, size_t size) {
+    return write(static_cast<const void*>(buffer), size);
+  }
+#endif  // ENABLE_ARDUINO_FEATURES
 
  private:
   newalign_t m_fileMem[FS_ALIGN_DIM(ExFatFile, FatFile)];
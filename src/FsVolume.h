@@ -74,6 +74,49 @@ class FsVolume {
     return m_fVol ? m_fVol->freeClusterCount() :
            m_xVol ? m_xVol->freeClusterCount() : 0;
   }
+  /** Count free clusters.  For exFAT the allocation bitmap is read
+   * with multi-sector reads into a caller supplied buffer.
+   * \param[in] buf Buffer for bitmap sectors.
+   * \param[in] size Size of \a buf in bytes.
+   * \return the free cluster count.
+   */
+  uint32_t freeClusterCount(uint8_t* buf, size_t size) {
+    return m_fVol ? m_fVol->freeClusterCount() :
+           m_xVol ? m_xVol->freeClusterCount(buf, size) : 0;
+  }
+#if USE_FAT_ALLOCATION_BITMAP
+  /** Use a RAM bitmap of allocated clusters for FAT16/FAT32 allocation.
+   * exFAT volumes always use the allocation bitmap on the volume.
+   *
+   * \param[in] bitmap Storage for (clusterCount() + 31)/32 words or
+   *            nullptr to stop using a bitmap.
+   * \param[in] count Number of words in \a bitmap.
+   *
+   * \return true for success else false.
+   */
+  bool setAllocationBitmap(uint32_t* bitmap, size_t count) {
+    return m_fVol ? m_fVol->setAllocationBitmap(bitmap, count) :
+           m_xVol != nullptr;
+  }
+#endif  // USE_FAT_ALLOCATION_BITMAP
+#if USE_FAT_DIR_INDEX
+  /** Use a hash index for name lookup in FAT16/FAT32 directories.
+   * The call is ignored for exFAT volumes.
+   *
+   * \param[in] index The index or nullptr to stop using an index.
+   */
+  void setDirIndex(FatDirIndex* index) {
+    if (m_fVol) m_fVol->setDirIndex(index);
+  }
+#endif  // USE_FAT_DIR_INDEX
+  /** Write all dirty sectors and update the second FAT of a FAT16/FAT32
+   * volume.  See USE_DEFERRED_FAT_MIRROR.
+   *
+   * \return true for success else false.
+   */
+  bool syncFatMirror() {
+    return m_fVol ? m_fVol->syncFatMirror() : m_xVol != nullptr;
+  }
   /** \return The volume's cluster size in sectors. */
   uint32_t sectorsPerCluster() const {
     return m_fVol ? m_fVol->sectorsPerCluster() :
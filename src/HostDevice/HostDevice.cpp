@@ -0,0 +1,367 @@
+/**
+ * Copyright (c) 20011-2017 Bill Greiman
+ * This file is part of the SdFs library for SD memory cards.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#include "HostDevice.h"
+#if !ENABLE_ARDUINO_FEATURES
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include "../common/DebugMacros.h"
+//==============================================================================
+bool HostBlockDevice::readSectors(uint32_t sector, uint8_t* dst, size_t ns) {
+  m_readCalls++;
+  if (ns > m_sectorCount || sector > m_sectorCount - ns) {
+    DBG_FAIL_MACRO;
+    return false;
+  }
+  m_sectorsRead += ns;
+  return devRead(sector, dst, ns);
+}
+//------------------------------------------------------------------------------
+bool HostBlockDevice::syncDevice() {
+  m_syncCalls++;
+  return devSync();
+}
+//------------------------------------------------------------------------------
+bool HostBlockDevice::writeSectors(uint32_t sector,
+                                   const uint8_t* src, size_t ns) {
+  m_writeCalls++;
+  if (ns > m_sectorCount || sector > m_sectorCount - ns) {
+    DBG_FAIL_MACRO;
+    return false;
+  }
+  m_sectorsWritten += ns;
+  return devWrite(sector, src, ns);
+}
+//==============================================================================
+bool RamBlockDevice::begin(uint32_t sectorCount) {
+  end();
+  m_data = reinterpret_cast<uint8_t*>(calloc(sectorCount, HOST_SECTOR_SIZE));
+  if (!m_data) {
+    DBG_FAIL_MACRO;
+    return false;
+  }
+  m_owner = true;
+  m_sectorCount = sectorCount;
+  clearStats();
+  return true;
+}
+//------------------------------------------------------------------------------
+bool RamBlockDevice::begin(uint8_t* image, uint32_t sectorCount) {
+  end();
+  if (!image) {
+    DBG_FAIL_MACRO;
+    return false;
+  }
+  m_data = image;
+  m_sectorCount = sectorCount;
+  clearStats();
+  return true;
+}
+//------------------------------------------------------------------------------
+bool RamBlockDevice::devRead(uint32_t sector, uint8_t* dst, size_t ns) {
+  memcpy(dst, m_data + HOST_SECTOR_SIZE*sector, HOST_SECTOR_SIZE*ns);
+  return true;
+}
+//------------------------------------------------------------------------------
+bool RamBlockDevice::devWrite(uint32_t sector,
+                              const uint8_t* src, size_t ns) {
+  memcpy(m_data + HOST_SECTOR_SIZE*sector, src, HOST_SECTOR_SIZE*ns);
+  return true;
+}
+//------------------------------------------------------------------------------
+void RamBlockDevice::end() {
+  if (m_owner) {
+    free(m_data);
+  }
+  m_data = nullptr;
+  m_owner = false;
+  m_sectorCount = 0;
+}
+//==============================================================================
+static uint64_t monotonicMicros() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return 1000000ULL*ts.tv_sec + ts.tv_nsec/1000;
+}
+//------------------------------------------------------------------------------
+bool LatencyRamBlockDevice::devRead(uint32_t sector, uint8_t* dst, size_t ns) {
+  asyncWait();
+  if (timedOut(m_readMicros)) {
+    usleep(m_timeoutMicros);
+    return false;
+  }
+  usleep(m_readMicros*ns);
+  return RamBlockDevice::devRead(sector, dst, ns);
+}
+//------------------------------------------------------------------------------
+bool LatencyRamBlockDevice::devSync() {
+  asyncWait();
+  return RamBlockDevice::devSync();
+}
+//------------------------------------------------------------------------------
+bool LatencyRamBlockDevice::devWrite(uint32_t sector,
+                                     const uint8_t* src, size_t ns) {
+  asyncWait();
+  if (timedOut(m_writeMicros)) {
+    usleep(m_timeoutMicros);
+    return false;
+  }
+  usleep(m_writeMicros*ns);
+  return RamBlockDevice::devWrite(sector, src, ns);
+}
+//------------------------------------------------------------------------------
+bool LatencyRamBlockDevice::poll() {
+  bool rtn;
+  if (m_asyncState == ASYNC_IDLE) {
+    return true;
+  }
+  if (monotonicMicros() < m_asyncDeadline) {
+    return false;
+  }
+  if (m_asyncTimedOut) {
+    DBG_FAIL_MACRO;
+    rtn = false;
+  } else if (m_asyncState == ASYNC_READ) {
+    rtn = RamBlockDevice::devRead(m_asyncSector, m_asyncBuf, m_asyncCount);
+  } else {
+    rtn = RamBlockDevice::devWrite(m_asyncSector, m_asyncBuf, m_asyncCount);
+  }
+  m_asyncState = ASYNC_IDLE;
+  if (m_asyncCallback) {
+    m_asyncCallback(m_asyncContext, rtn);
+  }
+  return true;
+}
+//------------------------------------------------------------------------------
+bool LatencyRamBlockDevice::submit(uint8_t state, uint32_t sector,
+                                   uint8_t* buf, size_t ns, uint32_t micros,
+                                   BlockIoCallback callback, void* context) {
+  asyncWait();
+  if (ns > m_sectorCount || sector > m_sectorCount - ns) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  m_asyncSector = sector;
+  m_asyncBuf = buf;
+  m_asyncCount = ns;
+  m_asyncCallback = callback;
+  m_asyncContext = context;
+  m_asyncTimedOut = timedOut(micros);
+  m_asyncDeadline = monotonicMicros() +
+                    (m_asyncTimedOut ? m_timeoutMicros : (uint64_t)micros*ns);
+  m_asyncState = state;
+  return true;
+
+ fail:
+  if (callback) {
+    callback(context, false);
+  }
+  return false;
+}
+//------------------------------------------------------------------------------
+bool LatencyRamBlockDevice::submitRead(uint32_t sector, uint8_t* dst,
+                                       size_t ns, BlockIoCallback callback,
+                                       void* context) {
+  return submit(ASYNC_READ, sector, dst, ns,
+                m_readMicros, callback, context);
+}
+//------------------------------------------------------------------------------
+bool LatencyRamBlockDevice::submitWrite(uint32_t sector, const uint8_t* src,
+                                        size_t ns, BlockIoCallback callback,
+                                        void* context) {
+  return submit(ASYNC_WRITE, sector, const_cast<uint8_t*>(src), ns,
+                m_writeMicros, callback, context);
+}
+//==============================================================================
+bool SdRamBlockDevice::devRead(uint32_t sector, uint8_t* dst, size_t ns) {
+  endStream();
+  return RamBlockDevice::devRead(sector, dst, ns);
+}
+//------------------------------------------------------------------------------
+bool SdRamBlockDevice::devSync() {
+  endStream();
+  return RamBlockDevice::devSync();
+}
+//------------------------------------------------------------------------------
+bool SdRamBlockDevice::devWrite(uint32_t sector,
+                                const uint8_t* src, size_t ns) {
+  if (!m_inStream || sector != m_streamEnd) {
+    endStream();
+    uint32_t eraseCount = m_eraseRange.eraseCount(sector, ns);
+    if (eraseCount > 1) {
+      if (eraseCount > 0X7FFFFF || eraseCount > m_sectorCount - sector) {
+        DBG_FAIL_MACRO;
+        return false;
+      }
+      m_acmd23Calls++;
+      m_sectorsErased += eraseCount;
+    }
+    m_eraseEnd = sector + eraseCount;
+    m_streamEnd = sector;
+    m_inStream = true;
+  }
+  m_eraseRange.written(sector, ns);
+  m_streamEnd += ns;
+  return RamBlockDevice::devWrite(sector, src, ns);
+}
+//------------------------------------------------------------------------------
+void SdRamBlockDevice::endStream() {
+  if (!m_inStream) {
+    return;
+  }
+  m_inStream = false;
+  // Pre-erased sectors after the last sector written are undefined.
+  for (uint32_t s = m_streamEnd; s < m_eraseEnd; s++) {
+    uint8_t* p = data() + HOST_SECTOR_SIZE*s;
+    for (size_t i = 0; i < HOST_SECTOR_SIZE; i++) {
+      m_seed = 1103515245*m_seed + 12345;
+      p[i] = m_seed >> 16;
+    }
+  }
+}
+//==============================================================================
+bool FileBlockDevice::begin(const char* path,
+                            uint8_t options, uint32_t sectorCount) {
+  struct stat st;
+  int flags = O_RDWR;
+  end();
+  m_options = options;
+  if (options & FILE_DEVICE_CREATE) {
+    flags |= O_CREAT;
+  }
+#ifdef O_DIRECT
+  if (options & FILE_DEVICE_DIRECT) {
+    flags |= O_DIRECT;
+  }
+#else  // O_DIRECT
+  m_options &= ~FILE_DEVICE_DIRECT;
+#endif  // O_DIRECT
+  m_fd = open(path, flags, 0644);
+  if (m_fd < 0) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  if (m_options & FILE_DEVICE_DIRECT) {
+    void* ptr;
+    if (posix_memalign(&ptr, HOST_SECTOR_SIZE,
+                       BOUNCE_SECTORS*HOST_SECTOR_SIZE)) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    m_bounce = reinterpret_cast<uint8_t*>(ptr);
+  }
+  if (fstat(m_fd, &st)) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  if (S_ISBLK(st.st_mode)) {
+    off_t size = lseek(m_fd, 0, SEEK_END);
+    if (size < 0) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    m_sectorCount = size/HOST_SECTOR_SIZE;
+  } else if ((options & FILE_DEVICE_CREATE) && sectorCount &&
+    static_cast<uint64_t>(st.st_size) < (uint64_t)HOST_SECTOR_SIZE*sectorCount) {
+    if (ftruncate(m_fd, (off_t)HOST_SECTOR_SIZE*sectorCount)) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    m_sectorCount = sectorCount;
+  } else {
+    m_sectorCount = st.st_size/HOST_SECTOR_SIZE;
+  }
+  if (sectorCount && sectorCount < m_sectorCount) {
+    m_sectorCount = sectorCount;
+  }
+  clearStats();
+  return true;
+
+ fail:
+  end();
+  return false;
+}
+//------------------------------------------------------------------------------
+bool FileBlockDevice::devRead(uint32_t sector, uint8_t* dst, size_t ns) {
+  while (ns) {
+    size_t n = needBounce(dst) && ns > BOUNCE_SECTORS ? BOUNCE_SECTORS : ns;
+    uint8_t* buf = needBounce(dst) ? m_bounce : dst;
+    size_t nb = HOST_SECTOR_SIZE*n;
+    if (pread(m_fd, buf, nb, (off_t)HOST_SECTOR_SIZE*sector) != (ssize_t)nb) {
+      DBG_FAIL_MACRO;
+      return false;
+    }
+    if (buf != dst) {
+      memcpy(dst, buf, nb);
+    }
+    dst += nb;
+    sector += n;
+    ns -= n;
+  }
+  return true;
+}
+//------------------------------------------------------------------------------
+bool FileBlockDevice::devSync() {
+  if (m_options & FILE_DEVICE_FSYNC) {
+    return fdatasync(m_fd) == 0;
+  }
+  return true;
+}
+//------------------------------------------------------------------------------
+bool FileBlockDevice::devWrite(uint32_t sector,
+                               const uint8_t* src, size_t ns) {
+  while (ns) {
+    size_t n = needBounce(src) && ns > BOUNCE_SECTORS ? BOUNCE_SECTORS : ns;
+    const uint8_t* buf = src;
+    size_t nb = HOST_SECTOR_SIZE*n;
+    if (needBounce(src)) {
+      memcpy(m_bounce, src, nb);
+      buf = m_bounce;
+    }
+    if (pwrite(m_fd, buf, nb, (off_t)HOST_SECTOR_SIZE*sector) != (ssize_t)nb) {
+      DBG_FAIL_MACRO;
+      return false;
+    }
+    src += nb;
+    sector += n;
+    ns -= n;
+  }
+  return true;
+}
+//------------------------------------------------------------------------------
+void FileBlockDevice::end() {
+  if (m_fd >= 0) {
+    close(m_fd);
+  }
+  free(m_bounce);
+  m_fd = -1;
+  m_bounce = nullptr;
+  m_options = 0;
+  m_sectorCount = 0;
+}
+#endif  // !ENABLE_ARDUINO_FEATURES
@@ -0,0 +1,366 @@
+/**
+ * Copyright (c) 20011-2017 Bill Greiman
+ * This file is part of the SdFs library for SD memory cards.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#ifndef HostDevice_h
+#define HostDevice_h
+/**
+ * \file
+ * \brief Block devices and print_t for a host (non-Arduino) build.
+ */
+#include <stdio.h>
+#include "SysCall.h"
+#include "BlockDeviceInterface.h"
+#include "../common/FsEraseRange.h"
+#if !ENABLE_ARDUINO_FEATURES
+//------------------------------------------------------------------------------
+/** Size of a sector for host devices. */
+const size_t HOST_SECTOR_SIZE = 512;
+//------------------------------------------------------------------------------
+/**
+ * \class HostBlockDevice
+ * \brief Base class for host block devices with I/O statistics.
+ */
+class HostBlockDevice : public BlockDeviceInterface {
+ public:
+  HostBlockDevice() : m_sectorCount(0) {
+    clearStats();
+  }
+  /** Reset the I/O statistics. */
+  void clearStats() {
+    m_readCalls = 0;
+    m_writeCalls = 0;
+    m_sectorsRead = 0;
+    m_sectorsWritten = 0;
+    m_syncCalls = 0;
+  }
+  /** \return number of readSector() and readSectors() calls. */
+  uint32_t readCalls() const {return m_readCalls;}
+  /** \return number of sectors read. */
+  uint32_t sectorsRead() const {return m_sectorsRead;}
+  /** \return number of syncDevice() calls. */
+  uint32_t syncCalls() const {return m_syncCalls;}
+  /** \return number of writeSector() and writeSectors() calls. */
+  uint32_t writeCalls() const {return m_writeCalls;}
+  /** \return number of sectors written. */
+  uint32_t sectorsWritten() const {return m_sectorsWritten;}
+  /** \return device size in sectors. */
+  uint32_t sectorCount() {return m_sectorCount;}
+  /**
+   * Read a 512 byte sector.
+   *
+   * \param[in] sector Logical sector to be read.
+   * \param[out] dst Pointer to the location that will receive the data.
+   * \return true for success or false for failure.
+   */
+  bool readSector(uint32_t sector, uint8_t* dst) {
+    return readSectors(sector, dst, 1);
+  }
+  /**
+   * Read multiple 512 byte sectors.
+   *
+   * \param[in] sector Logical sector to be read.
+   * \param[out] dst Pointer to the location that will receive the data.
+   * \param[in] ns Number of sectors to be read.
+   * \return true for success or false for failure.
+   */
+  bool readSectors(uint32_t sector, uint8_t* dst, size_t ns);
+  /** \return true for success or false for failure. */
+  bool syncDevice();
+  /**
+   * Writes a 512 byte sector.
+   *
+   * \param[in] sector Logical sector to be written.
+   * \param[in] src Pointer to the location of the data to be written.
+   * \return true for success or false for failure.
+   */
+  bool writeSector(uint32_t sector, const uint8_t* src) {
+    return writeSectors(sector, src, 1);
+  }
+  /**
+   * Write multiple 512 byte sectors.
+   *
+   * \param[in] sector Logical sector to be written.
+   * \param[in] src Pointer to the location of the data to be written.
+   * \param[in] ns Number of sectors to be written.
+   * \return true for success or false for failure.
+   */
+  bool writeSectors(uint32_t sector, const uint8_t* src, size_t ns);
+
+ protected:
+  /// @cond SHOW_PROTECTED
+  virtual bool devRead(uint32_t sector, uint8_t* dst, size_t ns) = 0;
+  virtual bool devSync() = 0;
+  virtual bool devWrite(uint32_t sector, const uint8_t* src, size_t ns) = 0;
+  uint32_t m_sectorCount;
+  /// @endcond
+
+ private:
+  uint32_t m_readCalls;
+  uint32_t m_writeCalls;
+  uint32_t m_sectorsRead;
+  uint32_t m_sectorsWritten;
+  uint32_t m_syncCalls;
+};
+//------------------------------------------------------------------------------
+/**
+ * \class RamBlockDevice
+ * \brief Block device backed by a RAM image.
+ */
+class RamBlockDevice : public HostBlockDevice {
+ public:
+  RamBlockDevice() : m_data(nullptr), m_owner(false) {}
+  ~RamBlockDevice() {end();}
+  /** Allocate a zero filled image.
+   * \param[in] sectorCount Size of the image in sectors.
+   * \return true for success or false for failure.
+   */
+  bool begin(uint32_t sectorCount);
+  /** Use a caller supplied image.
+   * \param[in] image Image buffer, sectorCount*512 bytes.
+   * \param[in] sectorCount Size of the image in sectors.
+   * \return true for success or false for failure.
+   */
+  bool begin(uint8_t* image, uint32_t sectorCount);
+  /** \return pointer to the image or nullptr if not started. */
+  uint8_t* data() {return m_data;}
+  /** Release the image. */
+  void end();
+
+ protected:
+  /// @cond SHOW_PROTECTED
+  bool devRead(uint32_t sector, uint8_t* dst, size_t ns);
+  bool devSync() {return true;}
+  bool devWrite(uint32_t sector, const uint8_t* src, size_t ns);
+  /// @endcond
+
+ private:
+  uint8_t* m_data;
+  bool m_owner;
+};
+//------------------------------------------------------------------------------
+/**
+ * \class LatencyRamBlockDevice
+ * \brief RAM block device with per-sector latency and asynchronous I/O.
+ *
+ * Synchronous transfers sleep for the latency.  Transfers started by
+ * submitRead() or submitWrite() complete in poll() once the latency has
+ * elapsed.  Asynchronous transfers are not counted in the I/O statistics.
+ *
+ * If a timeout is set and the latency of a sector exceeds it, a transfer
+ * fails after the timeout without reading or writing data, like a card
+ * that stops responding.
+ */
+class LatencyRamBlockDevice : public RamBlockDevice {
+ public:
+  LatencyRamBlockDevice() : m_readMicros(0), m_writeMicros(0),
+    m_timeoutMicros(0), m_asyncState(ASYNC_IDLE) {}
+  ~LatencyRamBlockDevice() {asyncWait();}
+  /** \return true if no transfer is in progress. */
+  bool poll();
+  /** Set the simulated latency.
+   * \param[in] readMicros Microseconds to read a sector.
+   * \param[in] writeMicros Microseconds to write a sector.
+   */
+  void setLatency(uint32_t readMicros, uint32_t writeMicros) {
+    m_readMicros = readMicros;
+    m_writeMicros = writeMicros;
+  }
+  /** Set the simulated timeout.
+   * \param[in] micros Microseconds to wait for a sector, zero for none.
+   */
+  void setTimeout(uint32_t micros) {
+    m_timeoutMicros = micros;
+  }
+  /**
+   * Start a non-blocking read of 512 byte sectors.
+   *
+   * \param[in] sector Logical sector to be read.
+   * \param[out] dst Pointer to the location that will receive the data.
+   * \param[in] ns Number of sectors to be read.
+   * \param[in] callback Function called when the transfer completes.
+   * \param[in] context Value passed to callback.
+   * \return true if the transfer was started or false for failure.
+   */
+  bool submitRead(uint32_t sector, uint8_t* dst, size_t ns,
+                  BlockIoCallback callback = nullptr, void* context = nullptr);
+  /**
+   * Start a non-blocking write of 512 byte sectors.
+   *
+   * \param[in] sector Logical sector to be written.
+   * \param[in] src Pointer to the location of the data to be written.
+   * \param[in] ns Number of sectors to be written.
+   * \param[in] callback Function called when the transfer completes.
+   * \param[in] context Value passed to callback.
+   * \return true if the transfer was started or false for failure.
+   */
+  bool submitWrite(uint32_t sector, const uint8_t* src, size_t ns,
+                   BlockIoCallback callback = nullptr,
+                   void* context = nullptr);
+
+ private:
+  static const uint8_t ASYNC_IDLE = 0;
+  static const uint8_t ASYNC_READ = 1;
+  static const uint8_t ASYNC_WRITE = 2;
+  void asyncWait() {
+    while (!poll()) {}
+  }
+  bool devRead(uint32_t sector, uint8_t* dst, size_t ns);
+  bool devSync();
+  bool devWrite(uint32_t sector, const uint8_t* src, size_t ns);
+  bool submit(uint8_t state, uint32_t sector, uint8_t* buf, size_t ns,
+              uint32_t micros, BlockIoCallback callback, void* context);
+  bool timedOut(uint32_t micros) {
+    return m_timeoutMicros && micros > m_timeoutMicros;
+  }
+
+  uint32_t m_readMicros;
+  uint32_t m_writeMicros;
+  uint32_t m_timeoutMicros;
+  uint8_t m_asyncState;
+  bool m_asyncTimedOut;
+  uint32_t m_asyncSector;
+  uint8_t* m_asyncBuf;
+  size_t m_asyncCount;
+  BlockIoCallback m_asyncCallback;
+  void* m_asyncContext;
+  uint64_t m_asyncDeadline;
+};
+//------------------------------------------------------------------------------
+/**
+ * \class SdRamBlockDevice
+ * \brief RAM block device that models SD write streams and ACMD23.
+ *
+ * Writes behave like SdSpiCard with dedicated SPI.  A write that does not
+ * continue the current stream starts a new one with the pre-erase count
+ * of an FsEraseRange set by preEraseHint().  When the stream ends,
+ * pre-erased sectors that were not written have undefined contents and
+ * are filled with random data.  A read or syncDevice() ends the stream.
+ */
+class SdRamBlockDevice : public RamBlockDevice {
+ public:
+  SdRamBlockDevice() : m_acmd23Calls(0), m_sectorsErased(0),
+    m_streamEnd(0), m_eraseEnd(0), m_inStream(false), m_seed(1) {}
+  /** \return number of ACMD23 commands. */
+  uint32_t acmd23Calls() const {return m_acmd23Calls;}
+  /** \return sum of ACMD23 pre-erase counts. */
+  uint32_t sectorsErased() const {return m_sectorsErased;}
+  /**
+   * Declare a range of sectors with no data that must be preserved.
+   *
+   * \param[in] sector First sector in the range.
+   * \param[in] count Number of sectors in the range.
+   */
+  void preEraseHint(uint32_t sector, uint32_t count) {
+    m_eraseRange.set(sector, count);
+  }
+
+ private:
+  bool devRead(uint32_t sector, uint8_t* dst, size_t ns);
+  bool devSync();
+  bool devWrite(uint32_t sector, const uint8_t* src, size_t ns);
+  void endStream();
+
+  FsEraseRange m_eraseRange;
+  uint32_t m_acmd23Calls;
+  uint32_t m_sectorsErased;
+  uint32_t m_streamEnd;
+  uint32_t m_eraseEnd;
+  bool m_inStream;
+  uint32_t m_seed;
+};
+//------------------------------------------------------------------------------
+/** Open the image file with O_DIRECT to bypass the host page cache. */
+const uint8_t FILE_DEVICE_DIRECT = 1;
+/** Create or extend the image file to the requested size. */
+const uint8_t FILE_DEVICE_CREATE = 2;
+/** Call fdatasync() for syncDevice(). */
+const uint8_t FILE_DEVICE_FSYNC = 4;
+/**
+ * \class FileBlockDevice
+ * \brief Block device backed by an image file or a raw device node.
+ */
+class FileBlockDevice : public HostBlockDevice {
+ public:
+  FileBlockDevice() : m_fd(-1), m_bounce(nullptr), m_options(0) {}
+  ~FileBlockDevice() {end();}
+  /** Open an image file.
+   * \param[in] path Image file or device path.
+   * \param[in] options FILE_DEVICE_DIRECT, FILE_DEVICE_CREATE and
+   *            FILE_DEVICE_FSYNC bits.
+   * \param[in] sectorCount Size for FILE_DEVICE_CREATE, zero to use the
+   *            current size of the file.
+   * \return true for success or false for failure.
+   */
+  bool begin(const char* path, uint8_t options = 0, uint32_t sectorCount = 0);
+  /** Close the image file. */
+  void end();
+
+ private:
+  // Sectors in the aligned bounce buffer used for O_DIRECT.
+  static const size_t BOUNCE_SECTORS = 64;
+  bool devRead(uint32_t sector, uint8_t* dst, size_t ns);
+  bool devSync();
+  bool devWrite(uint32_t sector, const uint8_t* src, size_t ns);
+  bool needBounce(const void* buf) {
+    return (m_options & FILE_DEVICE_DIRECT) &&
+           (reinterpret_cast<uintptr_t>(buf) & (HOST_SECTOR_SIZE - 1));
+  }
+
+  int m_fd;
+  uint8_t* m_bounce;
+  uint8_t m_options;
+};
+//------------------------------------------------------------------------------
+/**
+ * \class StdioPrint
+ * \brief print_t for a stdio stream.
+ */
+class StdioPrint : public print_t {
+ public:
+  /** Constructor.
+   * \param[in] stream stdio stream for output.
+   */
+  explicit StdioPrint(FILE* stream = stdout) : m_stream(stream) {}
+  /** Write a byte.
+   * \param[in] b byte to write.
+   * \return one for success else zero.
+   */
+  size_t write(uint8_t b) {
+    return putc(b, m_stream) == EOF ? 0 : 1;
+  }
+  /** Write a buffer.
+   * \param[in] buf data to write.
+   * \param[in] n number of bytes to write.
+   * \return number of bytes written.
+   */
+  size_t write(const uint8_t* buf, size_t n) {
+    return fwrite(buf, 1, n, m_stream);
+  }
+  using print_t::write;
+
+ private:
+  FILE* m_stream;
+};
+#endif  // !ENABLE_ARDUINO_FEATURES
+#endif  // HostDevice_h
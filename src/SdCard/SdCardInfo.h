@@ -62,6 +62,7 @@
   SD_CARD_ERROR(CMD59, "Set CRC mode")\
   SD_CARD_ERROR(ACMD6, "Set SDIO bus width")\
   SD_CARD_ERROR(ACMD13, "Read extended status")\
+  SD_CARD_ERROR(ACMD23, "Set pre-erased count")\
   SD_CARD_ERROR(ACMD41, "Activate card initialization")\
   SD_CARD_ERROR(READ_TOKEN, "Bad read data token")\
   SD_CARD_ERROR(READ_CRC, "Read CRC error")\
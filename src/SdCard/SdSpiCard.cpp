@@ -118,16 +118,43 @@ static uint16_t CRC_CCITT(const uint8_t* data, size_t n) {
 #endif  // USE_SD_CRC
 //==============================================================================
 // SdSpiCard member functions
+#if USE_ASYNC_IO
+//------------------------------------------------------------------------------
+bool SdSpiCard::asyncDone(bool success) {
+  BlockIoCallback callback = m_asyncCallback;
+  m_asyncState = IDLE_STATE;
+  m_asyncCallback = nullptr;
+  if (callback) {
+    callback(m_asyncContext, success);
+  }
+  return true;
+}
+//------------------------------------------------------------------------------
+void SdSpiCard::asyncStart(uint8_t state, uint8_t* buf, size_t ns, bool stop,
+                           BlockIoCallback callback, void* context) {
+  m_asyncBuf = buf;
+  m_asyncCount = ns;
+  m_asyncCallback = callback;
+  m_asyncContext = context;
+  m_asyncMS = curTimeMS();
+  m_asyncStop = stop;
+  m_asyncState = state;
+}
+#endif  // USE_ASYNC_IO
 //------------------------------------------------------------------------------
 bool SdSpiCard::begin(SdSpiDriver* spi, SdSpiConfig spiConfig) {
   m_errorCode = SD_CARD_ERROR_NONE;
   m_type = 0;
   m_spiDriver = spi;
+#if USE_ASYNC_IO
+  m_asyncState = IDLE_STATE;
+#endif  // USE_ASYNC_IO
   uint16_t t0 = curTimeMS();
   uint32_t arg;
 #if ENABLE_DEDICATED_SPI
   m_sharedSpi = !(spiConfig.options & DEDICATED_SPI);
   m_spiActive = false;
+  m_eraseRange.clear();
 #else  // ENABLE_DEDICATED_SPI
   if (spiConfig.options & DEDICATED_SPI) {
       error(SD_CARD_ERROR_INVALID_CARD_CONFIG);
@@ -210,6 +237,8 @@ fail:
 //------------------------------------------------------------------------------
 // send command and return error code.  Return zero for OK
 uint8_t SdSpiCard::cardCommand(uint8_t cmd, uint32_t arg) {
+  // finish any asynchronous transfer
+  asyncWait();
   // select card
   if (!m_spiActive) {
     spiStart();
@@ -304,6 +333,7 @@ bool SdSpiCard::eraseSingleSectorEnable() {
 }
 //------------------------------------------------------------------------------
 bool SdSpiCard::isBusy() {
+  asyncWait();
   bool rtn = true;
   bool spiActive = m_spiActive;
   if (!spiActive) {
@@ -332,6 +362,99 @@ bool SdSpiCard::isTimedOut(uint16_t startMS, uint16_t timeoutMS) {
   return (curTimeMS() - startMS) > timeoutMS;
 }
 //------------------------------------------------------------------------------
+bool SdSpiCard::poll() {
+#if USE_ASYNC_IO
+  while (m_asyncState != IDLE_STATE) {
+    if (m_asyncCount == 0) {
+      // All data transferred.
+      bool rtn = true;
+      if (m_asyncStop) {
+        uint8_t state = m_asyncState;
+        // Stop token must wait for programming of the last sector.
+        if (state == WRITE_STATE && spiReceive() != 0XFF) {
+          goto busy;
+        }
+        m_asyncState = IDLE_STATE;
+#if ENABLE_DEDICATED_SPI
+        m_curState = IDLE_STATE;
+#endif  // ENABLE_DEDICATED_SPI
+        rtn = state == READ_STATE ? readStop() : writeStop();
+      }
+      return asyncDone(rtn);
+    }
+    m_status = spiReceive();
+    if (m_asyncState == READ_STATE) {
+      // Wait for start sector token.
+      if (m_status == 0XFF) {
+        goto busy;
+      }
+      if (!receiveData(m_asyncBuf, 512)) {
+        return asyncDone(false);
+      }
+    } else {
+      // Wait for programming of previous sector.
+      if (m_status != 0XFF) {
+        goto busy;
+      }
+      if (!writeData(WRITE_MULTIPLE_TOKEN, m_asyncBuf)) {
+        return asyncDone(false);
+      }
+    }
+    m_asyncBuf += 512;
+    m_asyncCount--;
+    m_asyncMS = curTimeMS();
+  }
+  return true;
+
+ busy:
+  if (m_asyncState == READ_STATE) {
+    if (isTimedOut(m_asyncMS, SD_READ_TIMEOUT)) {
+      error(SD_CARD_ERROR_READ_TIMEOUT);
+      goto fail;
+    }
+  } else if (isTimedOut(m_asyncMS, SD_WRITE_TIMEOUT)) {
+    error(SD_CARD_ERROR_WRITE_TIMEOUT);
+    goto fail;
+  }
+  return false;
+
+ fail:
+  spiStop();
+  return asyncDone(false);
+#else  // USE_ASYNC_IO
+  return true;
+#endif  // USE_ASYNC_IO
+}
+//------------------------------------------------------------------------------
+void SdSpiCard::preEraseHint(uint32_t sector, uint32_t count) {
+#if ENABLE_DEDICATED_SPI
+  if (!m_sharedSpi) {
+    m_eraseRange.set(sector, count);
+  }
+#else  // ENABLE_DEDICATED_SPI
+  (void)sector;
+  (void)count;
+#endif  // ENABLE_DEDICATED_SPI
+}
+#if ENABLE_DEDICATED_SPI
+//------------------------------------------------------------------------------
+// Start or continue a read stream for ns sectors at sector.
+bool SdSpiCard::readStream(uint32_t sector, size_t ns) {
+  if (m_curState != READ_STATE || sector != m_curSector) {
+    if (!syncDevice()) {
+      return false;
+    }
+    if (!SdSpiCard::readStart(sector)) {
+      return false;
+    }
+    m_curSector = sector;
+    m_curState = READ_STATE;
+  }
+  m_curSector += ns;
+  return true;
+}
+#endif  // ENABLE_DEDICATED_SPI
+//------------------------------------------------------------------------------
 bool SdSpiCard::readSingle(uint32_t sector, uint8_t* dst) {
   SD_TRACE("RB", sector);
   // use address if not SDHC card
@@ -358,17 +481,23 @@ bool SdSpiCard::readData(uint8_t *dst) {
 }
 //------------------------------------------------------------------------------
 bool SdSpiCard::readData(uint8_t* dst, size_t count) {
-#if USE_SD_CRC
-  uint16_t crc;
-#endif  // USE_SD_CRC
   // wait for start sector token
   uint16_t t0 = curTimeMS();
   while ((m_status = spiReceive()) == 0XFF) {
     if (isTimedOut(t0, SD_READ_TIMEOUT)) {
       error(SD_CARD_ERROR_READ_TIMEOUT);
-      goto fail;
+      spiStop();
+      return false;
     }
   }
+  return receiveData(dst, count);
+}
+//------------------------------------------------------------------------------
+// receive data after the token in m_status
+bool SdSpiCard::receiveData(uint8_t* dst, size_t count) {
+#if USE_SD_CRC
+  uint16_t crc;
+#endif  // USE_SD_CRC
   if (m_status != DATA_START_SECTOR) {
     error(SD_CARD_ERROR_READ_TOKEN);
     goto fail;
@@ -559,23 +688,16 @@ fail:
 }
 //------------------------------------------------------------------------------
 bool SdSpiCard::readSectors(uint32_t sector, uint8_t* dst, size_t ns) {
+  asyncWait();
 #if ENABLE_DEDICATED_SPI
-  if (m_curState != READ_STATE || sector != m_curSector) {
-    if (!syncDevice()) {
-      return false;
-    }
-    if (!SdSpiCard::readStart(sector)) {
-      return false;
-    }
-    m_curSector = sector;
-    m_curState = READ_STATE;
+  if (!readStream(sector, ns)) {
+    return false;
   }
   for (size_t i = 0; i < ns; i++, dst += 512) {
     if (!readData(dst, 512)) {
       return false;
     }
   }
-  m_curSector += ns;
   return m_sharedSpi ? syncDevice() : true;
 #else  // ENABLE_DEDICATED_SPI
   if (!readStart(sector)) {
@@ -589,8 +711,74 @@ bool SdSpiCard::readSectors(uint32_t sector, uint8_t* dst, size_t ns) {
   return readStop();
 #endif  // ENABLE_DEDICATED_SPI
 }
+//------------------------------------------------------------------------------
+bool SdSpiCard::submitRead(uint32_t sector, uint8_t* dst, size_t ns,
+                           BlockIoCallback callback, void* context) {
+#if USE_ASYNC_IO
+  bool stop = true;
+  asyncWait();
+#if ENABLE_DEDICATED_SPI
+  if (!readStream(sector, ns)) {
+    goto fail;
+  }
+  stop = m_sharedSpi;
+#else  // ENABLE_DEDICATED_SPI
+  if (!readStart(sector)) {
+    goto fail;
+  }
+#endif  // ENABLE_DEDICATED_SPI
+  asyncStart(READ_STATE, dst, ns, stop, callback, context);
+  return true;
+
+ fail:
+  if (callback) {
+    callback(context, false);
+  }
+  return false;
+#else  // USE_ASYNC_IO
+  bool rtn = readSectors(sector, dst, ns);
+  if (callback) {
+    callback(context, rtn);
+  }
+  return rtn;
+#endif  // USE_ASYNC_IO
+}
+//------------------------------------------------------------------------------
+bool SdSpiCard::submitWrite(uint32_t sector, const uint8_t* src, size_t ns,
+                            BlockIoCallback callback, void* context) {
+#if USE_ASYNC_IO
+  bool stop = true;
+  asyncWait();
+#if ENABLE_DEDICATED_SPI
+  if (!writeStream(sector, ns)) {
+    goto fail;
+  }
+  stop = m_sharedSpi;
+#else  // ENABLE_DEDICATED_SPI
+  if (ns > 1 ? !writeStart(sector, ns) : !writeStart(sector)) {
+    goto fail;
+  }
+#endif  // ENABLE_DEDICATED_SPI
+  asyncStart(WRITE_STATE, const_cast<uint8_t*>(src), ns, stop,
+             callback, context);
+  return true;
+
+ fail:
+  if (callback) {
+    callback(context, false);
+  }
+  return false;
+#else  // USE_ASYNC_IO
+  bool rtn = writeSectors(sector, src, ns);
+  if (callback) {
+    callback(context, rtn);
+  }
+  return rtn;
+#endif  // USE_ASYNC_IO
+}
 //-----------------------------------------------------------------------------
 bool SdSpiCard::syncDevice() {
+  asyncWait();
 #if ENABLE_DEDICATED_SPI
   if (m_curState == READ_STATE) {
     if (!SdSpiCard::readStop()) {
@@ -607,26 +795,19 @@ bool SdSpiCard::syncDevice() {
 }
 //------------------------------------------------------------------------------
 bool SdSpiCard::writeSectors(uint32_t sector, const uint8_t* src, size_t ns) {
-  #if ENABLE_DEDICATED_SPI
-  if (m_curState != WRITE_STATE || m_curSector != sector) {
-    if (!syncDevice()) {
-      return false;
-    }
-    if (!writeStart(sector)) {
-      return false;
-    }
-    m_curSector = sector;
-    m_curState = WRITE_STATE;
+  asyncWait();
+#if ENABLE_DEDICATED_SPI
+  if (!writeStream(sector, ns)) {
+    return false;
   }
   for (size_t i = 0; i < ns; i++, src += 512) {
     if (!writeData(src)) {
       return false;
     }
   }
-  m_curSector += ns;
   return m_sharedSpi ? syncDevice() : true;
 #else  // ENABLE_DEDICATED_SPI
-  if (!writeStart(sector)) {
+  if (ns > 1 ? !writeStart(sector, ns) : !writeStart(sector)) {
     goto fail;
   }
   for (size_t i = 0; i < ns; i++, src += 512) {
@@ -681,6 +862,27 @@ fail:
   spiStop();
   return false;
 }
+#if ENABLE_DEDICATED_SPI
+//------------------------------------------------------------------------------
+// Start or continue a write stream for ns sectors at sector.
+bool SdSpiCard::writeStream(uint32_t sector, size_t ns) {
+  if (m_curState != WRITE_STATE || m_curSector != sector) {
+    if (!syncDevice()) {
+      return false;
+    }
+    uint32_t eraseCount = m_eraseRange.eraseCount(sector, ns);
+    if (eraseCount > 1 ? !writeStart(sector, eraseCount) :
+                         !writeStart(sector)) {
+      return false;
+    }
+    m_curSector = sector;
+    m_curState = WRITE_STATE;
+  }
+  m_eraseRange.written(sector, ns);
+  m_curSector += ns;
+  return true;
+}
+#endif  // ENABLE_DEDICATED_SPI
 //------------------------------------------------------------------------------
 bool SdSpiCard::writeStart(uint32_t sector) {
   // use address if not SDHC card
@@ -693,6 +895,25 @@ bool SdSpiCard::writeStart(uint32_t sector) {
   }
   return true;
 
+fail:
+  spiStop();
+  return false;
+}
+//------------------------------------------------------------------------------
+bool SdSpiCard::writeStart(uint32_t sector, uint32_t eraseCount) {
+  SD_TRACE("WS", sector);
+  // ACMD23 count is 23 bits.
+  if (eraseCount == 0 || eraseCount > 0X7FFFFF) {
+    error(SD_CARD_ERROR_WRITE_START);
+    goto fail;
+  }
+  // send pre-erase count
+  if (cardAcmd(ACMD23, eraseCount)) {
+    error(SD_CARD_ERROR_ACMD23);
+    goto fail;
+  }
+  return writeStart(sector);
+
 fail:
   spiStop();
   return false;
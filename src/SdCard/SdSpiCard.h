@@ -32,6 +32,7 @@
 #include "SysCall.h"
 #include "SdCardInfo.h"
 #include "SdCardInterface.h"
+#include "../common/FsEraseRange.h"
 #include "../SpiDriver/SdSpiDriver.h"
 //==============================================================================
 /**
@@ -102,6 +103,27 @@ class SdSpiCard {
    * \return true if busy else false.
    */
   bool isBusy();
+  /**
+   * Advance a transfer started by submitRead() or submitWrite().
+   *
+   * Sends or receives sectors while the card is ready and returns
+   * when the card is busy.  Chip select stays low until the transfer
+   * completes.
+   *
+   * \return true if no transfer is in progress.
+   */
+  bool poll();
+  /**
+   * Declare a range of sectors with no data that must be preserved.
+   *
+   * With dedicated SPI, a multi-sector write that starts in the range
+   * uses ACMD23 to pre-erase the rest of the range.  The range shrinks
+   * as it is written.
+   *
+   * \param[in] sector First sector in the range.
+   * \param[in] count Number of sectors in the range.
+   */
+  void preEraseHint(uint32_t sector, uint32_t count);
 
   /**
    * Read a 512 byte sector from an SD card.
@@ -197,6 +219,35 @@ class SdSpiCard {
    * the value false is returned for failure.
    */
   bool readStop();
+  /**
+   * Start a non-blocking read of 512 byte sectors.  Call poll()
+   * until it returns true.
+   *
+   * \param[in] sector Logical sector to be read.
+   * \param[out] dst Pointer to the location that will receive the data.
+   * \param[in] ns Number of sectors to be read.
+   * \param[in] callback Function called when the transfer completes.
+   * \param[in] context Value passed to callback.
+   * \return The value true is returned if the transfer was started and
+   * the value false is returned for failure.
+   */
+  bool submitRead(uint32_t sector, uint8_t* dst, size_t ns,
+                  BlockIoCallback callback = nullptr, void* context = nullptr);
+  /**
+   * Start a non-blocking write of 512 byte sectors.  Call poll()
+   * until it returns true.
+   *
+   * \param[in] sector Logical sector to be written.
+   * \param[in] src Pointer to the location of the data to be written.
+   * \param[in] ns Number of sectors to be written.
+   * \param[in] callback Function called when the transfer completes.
+   * \param[in] context Value passed to callback.
+   * \return The value true is returned if the transfer was started and
+   * the value false is returned for failure.
+   */
+  bool submitWrite(uint32_t sector, const uint8_t* src, size_t ns,
+                   BlockIoCallback callback = nullptr,
+                   void* context = nullptr);
   /** \return success if sync successful. Not for user apps. */
   bool syncDevice();
   /** Return the card type: SD V1, SD V2 or SDHC/SDXC
@@ -289,6 +340,7 @@ class SdSpiCard {
   uint8_t cardCommand(uint8_t cmd, uint32_t arg);
   bool isTimedOut(uint16_t startMS, uint16_t timeoutMS);
   bool readData(uint8_t* dst, size_t count);
+  bool receiveData(uint8_t* dst, size_t count);
   bool readRegister(uint8_t cmd, void* buf);
 
   void type(uint8_t value) {
@@ -324,10 +376,30 @@ class SdSpiCard {
   void spiUnselect() {
     m_spiDriver->unselect();
   }
-#if ENABLE_DEDICATED_SPI
   static const uint8_t IDLE_STATE = 0;
   static const uint8_t READ_STATE = 1;
   static const uint8_t WRITE_STATE = 2;
+#if USE_ASYNC_IO
+  bool asyncDone(bool success);
+  void asyncStart(uint8_t state, uint8_t* buf, size_t ns, bool stop,
+                  BlockIoCallback callback, void* context);
+  void asyncWait() {
+    while (!poll()) {}
+  }
+  uint8_t* m_asyncBuf;
+  size_t m_asyncCount;
+  BlockIoCallback m_asyncCallback;
+  void* m_asyncContext;
+  uint16_t m_asyncMS;
+  uint8_t m_asyncState;
+  bool m_asyncStop;
+#else  // USE_ASYNC_IO
+  void asyncWait() {}
+#endif  // USE_ASYNC_IO
+#if ENABLE_DEDICATED_SPI
+  bool readStream(uint32_t sector, size_t ns);
+  bool writeStream(uint32_t sector, size_t ns);
+  FsEraseRange m_eraseRange;
   uint32_t m_curSector;
   uint8_t m_curState;
   bool    m_sharedSpi;
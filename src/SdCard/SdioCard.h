@@ -101,6 +101,12 @@ class SdioCard : public SdCardInterface {
   bool isBusy();
   /** \return the SD clock frequency in kHz. */
   uint32_t kHzSdClk();
+  /**
+   * Advance a transfer started by submitRead() or submitWrite().
+   *
+   * \return true if no transfer is in progress.
+   */
+  bool poll();
   /**
    * Read a 512 byte sector from an SD card.
    *
@@ -183,6 +189,37 @@ class SdioCard : public SdCardInterface {
   bool readStop();
   /** \return SDIO card status. */
   uint32_t status();
+  /**
+   * Start a non-blocking read of 512 byte sectors.  Call poll()
+   * until it returns true.  The read is synchronous in FIFO mode
+   * or if dst is not 32-bit aligned.
+   *
+   * \param[in] sector Logical sector to be read.
+   * \param[out] dst Pointer to the location that will receive the data.
+   * \param[in] ns Number of sectors to be read.
+   * \param[in] callback Function called when the transfer completes.
+   * \param[in] context Value passed to callback.
+   * \return The value true is returned if the transfer was started and
+   * the value false is returned for failure.
+   */
+  bool submitRead(uint32_t sector, uint8_t* dst, size_t ns,
+                  BlockIoCallback callback = nullptr, void* context = nullptr);
+  /**
+   * Start a non-blocking write of 512 byte sectors.  Call poll()
+   * until it returns true.  The write is synchronous in FIFO mode
+   * or if src is not 32-bit aligned.
+   *
+   * \param[in] sector Logical sector to be written.
+   * \param[in] src Pointer to the location of the data to be written.
+   * \param[in] ns Number of sectors to be written.
+   * \param[in] callback Function called when the transfer completes.
+   * \param[in] context Value passed to callback.
+   * \return The value true is returned if the transfer was started and
+   * the value false is returned for failure.
+   */
+  bool submitWrite(uint32_t sector, const uint8_t* src, size_t ns,
+                   BlockIoCallback callback = nullptr,
+                   void* context = nullptr);
   /** \return success if sync successful. Not for user apps. */
   bool syncDevice();
   /** Return the card type: SD V1, SD V2 or SDHC
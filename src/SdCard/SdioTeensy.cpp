@@ -177,6 +177,20 @@ static uint32_t m_sdClkKhz = 0;
 static uint32_t m_ocr;
 static cid_t m_cid;
 static csd_t m_csd;
+#if USE_ASYNC_IO
+const uint8_t ASYNC_IDLE = 0;
+const uint8_t ASYNC_WAIT_READY = 1;
+const uint8_t ASYNC_DMA = 2;
+static uint8_t m_asyncState = ASYNC_IDLE;
+static uint8_t m_asyncError;
+static uint32_t m_asyncXfertyp;
+static uint32_t m_asyncSector;
+static uint8_t* m_asyncBuf;
+static size_t m_asyncCount;
+static BlockIoCallback m_asyncCallback;
+static void* m_asyncContext;
+static uint32_t m_asyncMicros;
+#endif  // USE_ASYNC_IO
 //=============================================================================
 #define USE_DEBUG_MODE 0
 #if USE_DEBUG_MODE
@@ -340,21 +354,94 @@ static bool isBusyTransferComplete() {
   return !(SDHC_IRQSTAT & (SDHC_IRQSTAT_TC | SDHC_IRQSTAT_ERROR));
 }
 //-----------------------------------------------------------------------------
+// Start a DMA transfer.  Card must be ready for data.
+static void rdWrStart(uint32_t xfertyp,
+                      uint32_t sector, uint8_t* buf, size_t n) {
+  enableDmaIrs();
+  SDHC_DSADDR  = (uint32_t)buf;
+  SDHC_CMDARG = m_highCapacity ? sector : 512*sector;
+  SDHC_BLKATTR = SDHC_BLKATTR_BLKCNT(n) | SDHC_BLKATTR_BLKSIZE(512);
+  SDHC_IRQSIGEN = SDHC_IRQSIGEN_MASK;
+  SDHC_XFERTYP = xfertyp;
+}
+//-----------------------------------------------------------------------------
+#if USE_ASYNC_IO
+static bool asyncDone(bool success) {
+  m_asyncState = ASYNC_IDLE;
+  if (!success) {
+    sdError(m_asyncError);
+  }
+  if (m_asyncCallback) {
+    m_asyncCallback(m_asyncContext, success);
+  }
+  return true;
+}
+//-----------------------------------------------------------------------------
+// Return true if no transfer is in progress.
+static bool asyncPoll() {
+  if (m_asyncState == ASYNC_WAIT_READY) {
+    if (isBusyCMD13()) {
+      if ((micros() - m_asyncMicros) > BUSY_TIMEOUT_MICROS) {
+        m_asyncError = SD_CARD_ERROR_CMD13;
+        return asyncDone(false);
+      }
+      return false;
+    }
+    rdWrStart(m_asyncXfertyp, m_asyncSector, m_asyncBuf, m_asyncCount);
+    m_asyncState = ASYNC_DMA;
+    m_asyncMicros = micros();
+  }
+  if (m_asyncState == ASYNC_DMA) {
+    if (isBusyDMA()) {
+      if ((micros() - m_asyncMicros) > BUSY_TIMEOUT_MICROS) {
+        return asyncDone(false);
+      }
+      return false;
+    }
+    return asyncDone((m_irqstat & SDHC_IRQSTAT_TC) &&
+                     !(m_irqstat & SDHC_IRQSTAT_ERROR));
+  }
+  return true;
+}
+//-----------------------------------------------------------------------------
+static void asyncWait() {
+  while (!asyncPoll()) {
+    yield();
+  }
+}
+//-----------------------------------------------------------------------------
+static bool asyncSubmit(uint32_t xfertyp, uint8_t error, uint32_t sector,
+                        uint8_t* buf, size_t n, BlockIoCallback callback,
+                        void* context) {
+  asyncWait();
+  m_asyncXfertyp = xfertyp;
+  m_asyncError = error;
+  m_asyncSector = sector;
+  m_asyncBuf = buf;
+  m_asyncCount = n;
+  m_asyncCallback = callback;
+  m_asyncContext = context;
+  m_asyncMicros = micros();
+  m_asyncState = ASYNC_WAIT_READY;
+  // Start the DMA now if the card is ready.
+  asyncPoll();
+  return true;
+}
+#else  // USE_ASYNC_IO
+inline bool asyncPoll() {return true;}
+inline void asyncWait() {}
+#endif  // USE_ASYNC_IO
+//-----------------------------------------------------------------------------
 static bool rdWrSectors(uint32_t xfertyp,
                        uint32_t sector, uint8_t* buf, size_t n) {
   if ((3 & (uint32_t)buf) || n == 0) {
     return sdError(SD_CARD_ERROR_DMA);
   }
+  asyncWait();
   if (yieldTimeout(isBusyCMD13)) {
     return sdError(SD_CARD_ERROR_CMD13);
   }
-  enableDmaIrs();
-  SDHC_DSADDR  = (uint32_t)buf;
-  SDHC_CMDARG = m_highCapacity ? sector : 512*sector;
-  SDHC_BLKATTR = SDHC_BLKATTR_BLKCNT(n) | SDHC_BLKATTR_BLKSIZE(512);
-  SDHC_IRQSIGEN = SDHC_IRQSIGEN_MASK;
-  SDHC_XFERTYP = xfertyp;
-
+  rdWrStart(xfertyp, sector, buf, n);
   return waitDmaStatus();
 }
 //-----------------------------------------------------------------------------
@@ -554,6 +641,7 @@ uint32_t SdioCard::sectorCount() {
 }
 //-----------------------------------------------------------------------------
 bool SdioCard::erase(uint32_t firstSector, uint32_t lastSector) {
+  asyncWait();
   // check for single sector erase
   if (!m_csd.v1.erase_blk_en) {
     // erase size mask
@@ -595,6 +683,9 @@ uint32_t SdioCard::errorLine() const {
 }
 //-----------------------------------------------------------------------------
 bool SdioCard::isBusy() {
+  if (!asyncPoll()) {
+    return true;
+  }
   return m_busyFcn ? m_busyFcn() : m_initDone && isBusyCMD13();
 }
 //-----------------------------------------------------------------------------
@@ -602,6 +693,10 @@ uint32_t SdioCard::kHzSdClk() {
   return m_sdClkKhz;
 }
 //-----------------------------------------------------------------------------
+bool SdioCard::poll() {
+  return asyncPoll();
+}
+//-----------------------------------------------------------------------------
 bool SdioCard::readSector(uint32_t sector, uint8_t* dst) {
   if (m_sdioConfig.useDma()) {
     uint8_t aligned[512];
@@ -742,7 +837,43 @@ uint32_t SdioCard::status() {
   return statusCMD13();
 }
 //-----------------------------------------------------------------------------
+bool SdioCard::submitRead(uint32_t sector, uint8_t* dst, size_t n,
+                          BlockIoCallback callback, void* context) {
+#if USE_ASYNC_IO
+  if (m_sdioConfig.useDma() && !(3 & (uint32_t)dst) && n != 0) {
+    return asyncSubmit(n == 1 ? CMD17_DMA_XFERTYP : CMD18_DMA_XFERTYP,
+                       n == 1 ? SD_CARD_ERROR_CMD17 : SD_CARD_ERROR_CMD18,
+                       sector, dst, n, callback, context);
+  }
+#endif  // USE_ASYNC_IO
+  // FIFO mode and unaligned buffers are synchronous.
+  bool rtn = readSectors(sector, dst, n);
+  if (callback) {
+    callback(context, rtn);
+  }
+  return rtn;
+}
+//-----------------------------------------------------------------------------
+bool SdioCard::submitWrite(uint32_t sector, const uint8_t* src, size_t n,
+                           BlockIoCallback callback, void* context) {
+#if USE_ASYNC_IO
+  uint8_t* ptr = const_cast<uint8_t*>(src);
+  if (m_sdioConfig.useDma() && !(3 & (uint32_t)ptr) && n != 0) {
+    return asyncSubmit(n == 1 ? CMD24_DMA_XFERTYP : CMD25_DMA_XFERTYP,
+                       n == 1 ? SD_CARD_ERROR_CMD24 : SD_CARD_ERROR_CMD25,
+                       sector, ptr, n, callback, context);
+  }
+#endif  // USE_ASYNC_IO
+  // FIFO mode and unaligned buffers are synchronous.
+  bool rtn = writeSectors(sector, src, n);
+  if (callback) {
+    callback(context, rtn);
+  }
+  return rtn;
+}
+//-----------------------------------------------------------------------------
 bool SdioCard::syncDevice() {
+  asyncWait();
   if (m_curState == READ_STATE) {
     m_curState = IDLE_STATE;
     if (!SdioCard::readStop()) {
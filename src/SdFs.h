@@ -29,16 +29,21 @@
  * \brief main SdFs include file.
  */
 #include "SysCall.h"
+#if ENABLE_ARDUINO_FEATURES
 #include "SdCard/SdCard.h"
+#endif  // ENABLE_ARDUINO_FEATURES
 #include "ExFatLib/ExFatLib.h"
 #include "FatLib/FatLib.h"
 #include "iostream/ArduinoStream.h"
 #include "iostream/fstream.h"
 #include "FsVolume.h"
 #include "FsFile.h"
+#include "common/FsDirIterator.h"
+#include "common/BufferedPrint.h"
 //------------------------------------------------------------------------------
 /** SdFs version YYYYMMDD */
 #define SD_FS_DATE 20180624
+#if ENABLE_ARDUINO_FEATURES
 //==============================================================================
 /**
  * \class SdBase
@@ -306,6 +311,7 @@ class SdExFat : public SdBase<ExFatVolume> {
  */
 class SdFs : public SdBase<FsVolume> {
 };
+#endif  // ENABLE_ARDUINO_FEATURES
 #endif  // SdFs_h
 
 
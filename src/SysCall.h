@@ -107,6 +107,8 @@ inline void SysCall::yield() {}
 #endif  // ESP8266
 //-----------------------------------------------------------------------------
 #else  // ENABLE_ARDUINO_FEATURES
+#include <string.h>
+#include <time.h>
 
 #ifndef F
 /** Define macro for strings stored in flash. */
@@ -118,19 +120,164 @@ inline void SysCall::yield() {}
 #ifndef LOW
 #define LOW 0
 #endif  // LOW
+#ifndef DEC
+#define DEC 10
+#endif  // DEC
+#ifndef HEX
+#define HEX 16
+#endif  // HEX
 void digitalWrite(uint8_t, int);
-
-class  print_t {
+//-----------------------------------------------------------------------------
+/**
+ * \class print_t
+ * \brief Minimal replacement for the Arduino Print class.
+ *
+ * A derived class must implement write(uint8_t).  Override the
+ * buffer version of write() if the output device has a faster path.
+ */
+class print_t {
  public:
-  virtual size_t write(char c) = 0;
-  virtual size_t write(const char* s) = 0;
-  size_t print(const char* s) {return write(s);}
+  print_t() : m_writeError(0) {}
+  virtual ~print_t() {}
+  /** \return nonzero if a write error has occurred. */
+  int getWriteError() {return m_writeError;}
+  /** Clear the write error. */
+  void clearWriteError() {setWriteError(0);}
+  /** Write a byte.
+   * \param[in] b byte to write.
+   * \return one for success else zero.
+   */
+  virtual size_t write(uint8_t b) = 0;
+  /** Write a buffer.
+   * \param[in] buf data to write.
+   * \param[in] n number of bytes to write.
+   * \return number of bytes written.
+   */
+  virtual size_t write(const uint8_t* buf, size_t n) {
+    size_t i;
+    for (i = 0; i < n; i++) {
+      if (write(buf[i]) != 1) {
+        break;
+      }
+    }
+    return i;
+  }
+  /** Write a string.
+   * \param[in] str zero terminated string.
+   * \return number of bytes written.
+   */
+  size_t write(const char* str) {
+    return str ? write(str, strlen(str)) : 0;
+  }
+  /** Write characters.
+   * \param[in] buf characters to write.
+   * \param[in] n number of characters to write.
+   * \return number of bytes written.
+   */
+  size_t write(const char* buf, size_t n) {
+    return write(reinterpret_cast<const uint8_t*>(buf), n);
+  }
+  /** \return number of bytes written. \param[in] str string to print. */
+  size_t print(const char* str) {return write(str);}
+  /** \return number of bytes written. \param[in] c character to print. */
+  size_t print(char c) {return write(static_cast<uint8_t>(c));}
+  /** Print a number.
+   * \param[in] n number to print.
+   * \param[in] base radix for conversion, two to sixteen.
+   * \return number of bytes written.
+   */
+  size_t print(unsigned long n, int base = DEC) {  // NOLINT
+    char buf[8*sizeof(n) + 1];
+    char* str = buf + sizeof(buf);
+    if (base < 2 || base > 16) {
+      base = DEC;
+    }
+    do {
+      uint8_t d = n % base;
+      n /= base;
+      *--str = d < 10 ? d + '0' : d + 'A' - 10;
+    } while (n);
+    return write(str, buf + sizeof(buf) - str);
+  }
+  /** Print a number.
+   * \param[in] n number to print.
+   * \param[in] base radix for conversion, two to sixteen.
+   * \return number of bytes written.
+   */
+  size_t print(long n, int base = DEC) {  // NOLINT
+    if (n < 0 && base == DEC) {
+      return write(static_cast<uint8_t>('-')) + print(0UL - static_cast<unsigned long>(n), base);  // NOLINT
+    }
+    return print(static_cast<unsigned long>(n), base);  // NOLINT
+  }
+  /** \return number of bytes written. \param[in] n number to print.
+   *  \param[in] base radix for conversion. */
+  size_t print(unsigned int n, int base = DEC) {
+    return print(static_cast<unsigned long>(n), base);  // NOLINT
+  }
+  /** \return number of bytes written. \param[in] n number to print.
+   *  \param[in] base radix for conversion. */
+  size_t print(int n, int base = DEC) {
+    return print(static_cast<long>(n), base);  // NOLINT
+  }
+  /** \return number of bytes written. \param[in] n number to print.
+   *  \param[in] base radix for conversion. */
+  size_t print(uint8_t n, int base = DEC) {
+    return print(static_cast<unsigned long>(n), base);  // NOLINT
+  }
+  /** \return number of bytes written. \param[in] n number to print.
+   *  \param[in] base radix for conversion. */
+  size_t print(uint16_t n, int base = DEC) {
+    return print(static_cast<unsigned long>(n), base);  // NOLINT
+  }
+  /** \return number of bytes written. */
+  size_t println() {return write("\r\n", 2);}
+  /** Print a value followed by CR/LF.
+   * \param[in] v value to print.
+   * \return number of bytes written.
+   */
+  template<typename Type>
+  size_t println(Type v) {
+    size_t n = print(v);
+    return n + println();
+  }
+  /** Print a number followed by CR/LF.
+   * \param[in] v number to print.
+   * \param[in] base radix for conversion.
+   * \return number of bytes written.
+   */
+  template<typename Type>
+  size_t println(Type v, int base) {
+    size_t n = print(v, base);
+    return n + println();
+  }
+
+ protected:
+  /** Set the write error.
+   * \param[in] err error value, nonzero for an error.
+   */
+  void setWriteError(int err = 1) {m_writeError = err;}
+
+ private:
+  int m_writeError;
 };
 //-----------------------------------------------------------------------------
 /** \return the time in milliseconds. */
 inline uint32_t curMs() {
-  return 0;
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return 1000UL*ts.tv_sec + ts.tv_nsec/1000000;
 }
+//-----------------------------------------------------------------------------
+/** \return the time in milliseconds. */
+inline uint16_t curTimeMS() {
+  return curMs();
+}
+//-----------------------------------------------------------------------------
+/**
+ * \class SysCall
+ * \brief SysCall - Class to wrap system calls.
+ */
 class SysCall {
  public:
   /** Halt execution of this thread. */
@@ -160,5 +307,5 @@ struct SPISettings {
     clockHz = 4000000;
   }
 };
-#endif  // IS_ARDUINO
+#endif  // ENABLE_ARDUINO_FEATURES
 #endif  // SysCall_h
@@ -34,6 +34,7 @@
 #ifndef FILE_WRITE
 #define FILE_WRITE (O_RDWR | O_CREAT | O_AT_END)
 #endif  // FILE_WRITE
+#if ENABLE_ARDUINO_FEATURES
 //-----------------------------------------------------------------------------
 /**
  * \class PrintFile
@@ -54,6 +55,15 @@ class PrintFile : public Print, public BaseFile {
   size_t write(uint8_t b) {
     return BaseFile::write(&b, 1);
   }
+  /** Write data.  Replaces the byte at a time Print version used by
+   * print() for strings and numbers.
+   * \param[in] buffer location of the data to write.
+   * \param[in] size number of bytes to write.
+   * \return number of bytes written.
+   */
+  size_t write(const uint8_t* buffer, size_t size) {
+    return BaseFile::write(buffer, size);
+  }
 };
 //-----------------------------------------------------------------------------
 /**
@@ -127,6 +137,48 @@ class StreamFile : public Stream, public BaseFile {
   int read() {
     return BaseFile::read();
   }
+  /** Read bytes.  Replaces the byte at a time Stream version.
+   *
+   * \param[out] buffer location for the data.
+   * \param[in] length maximum number of bytes to read.
+   * \return number of bytes read, zero at EOF or for an error.
+   */
+  size_t readBytes(char* buffer, size_t length) {
+    int n = BaseFile::read(buffer, length);
+    return n < 0 ? 0 : n;
+  }
+  /** Read bytes.  Replaces the byte at a time Stream version.
+   *
+   * \param[out] buffer location for the data.
+   * \param[in] length maximum number of bytes to read.
+   * \return number of bytes read, zero at EOF or for an error.
+   */
+  size_t readBytes(uint8_t* buffer, size_t length) {
+    return readBytes(reinterpret_cast<char*>(buffer), length);
+  }
+  /** Read bytes until a terminator is found.  Replaces the byte at a
+   * time Stream version.
+   *
+   * \param[in] terminator character that ends the read.
+   * \param[out] buffer location for the data.
+   * \param[in] length maximum number of bytes to store.
+   * \return number of bytes stored, zero at EOF or for an error.
+   */
+  size_t readBytesUntil(char terminator, char* buffer, size_t length) {
+    int n = BaseFile::readUntil(terminator, buffer, length);
+    return n < 0 ? 0 : n;
+  }
+  /** Read bytes until a terminator is found.  Replaces the byte at a
+   * time Stream version.
+   *
+   * \param[in] terminator character that ends the read.
+   * \param[out] buffer location for the data.
+   * \param[in] length maximum number of bytes to store.
+   * \return number of bytes stored, zero at EOF or for an error.
+   */
+  size_t readBytesUntil(char terminator, uint8_t* buffer, size_t length) {
+    return readBytesUntil(terminator, reinterpret_cast<char*>(buffer), length);
+  }
   /** Rewind a file if it is a directory */
   void rewindDirectory() {
     if (BaseFile::isDir()) {
@@ -155,8 +207,15 @@ class StreamFile : public Stream, public BaseFile {
   size_t write(uint8_t b) {
     return BaseFile::write(b);
   }
+  /** Write data to a file.  Replaces the byte at a time Print version
+   * used by print() for strings and numbers.
+   * \param[in] buffer location of the data to write.
+   * \param[in] size number of bytes to write.
+   * \return number of bytes written.
+   */
   size_t write(const uint8_t *buffer, size_t size) {
     return BaseFile::write(buffer, size);
   }
 };
+#endif  // ENABLE_ARDUINO_FEATURES
 #endif  // ArduinoFiles_h
@@ -0,0 +1,123 @@
+/**
+ * Copyright (c) 20011-2017 Bill Greiman
+ * This file is part of the SdFs library for SD memory cards.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#ifndef BufferedPrint_h
+#define BufferedPrint_h
+/**
+ * \file
+ * \brief BufferedPrint class
+ */
+#include <string.h>
+#include "SysCall.h"
+//------------------------------------------------------------------------------
+/**
+ * \class BufferedPrint
+ * \brief Gather small Print writes into one file write.
+ *
+ * print() of a char and code that writes one byte at a time call the
+ * file's write() once per byte.  BufferedPrint collects these bytes and
+ * writes them with a single call when the buffer is full.
+ *
+ * Call flush() or sync() before any other access to the file.
+ */
+template<class WriteClass, uint8_t BUF_DIM>
+class BufferedPrint : public print_t {
+ public:
+  BufferedPrint() : m_wr(nullptr), m_in(0) {}
+  /** Constructor.
+   * \param[in] wr File or device that receives the data.
+   */
+  explicit BufferedPrint(WriteClass* wr) : m_wr(wr), m_in(0) {}
+  /** Destructor writes any data in the buffer. */
+  ~BufferedPrint() {flush();}
+  /** Initialize the object.
+   * \param[in] wr File or device that receives the data.
+   */
+  void begin(WriteClass* wr) {
+    m_wr = wr;
+    m_in = 0;
+  }
+  /** Write the data in the buffer to the file.  A failed write sets
+   * the write error.
+   */
+  void flush() {
+    flushBuf();
+  }
+  /** Write the data in the buffer and sync the file.
+   * \return true for success or false for failure.
+   */
+  bool sync() {
+    return flushBuf() && m_wr->sync();
+  }
+  /** Write a byte.
+   * \param[in] b byte to write.
+   * \return one.
+   */
+  size_t write(uint8_t b) {
+    if (m_in >= BUF_DIM) {
+      flush();
+    }
+    m_buf[m_in++] = b;
+    return 1;
+  }
+  /** Write data.
+   * \param[in] buf location of the data.
+   * \param[in] n number of bytes to write.
+   * \return number of bytes written.
+   */
+  size_t write(const uint8_t* buf, size_t n) {
+    if ((m_in + n) > BUF_DIM) {
+      flush();
+      if (n >= BUF_DIM) {
+        // too large for the buffer
+        size_t rtn = m_wr->write(buf, n);
+        if (rtn != n) {
+          setWriteError();
+        }
+        return rtn;
+      }
+    }
+    memcpy(m_buf + m_in, buf, n);
+    m_in += n;
+    return n;
+  }
+  using print_t::write;
+
+ private:
+  bool flushBuf() {
+    if (m_in) {
+      size_t n = m_in;
+      m_in = 0;
+      if (m_wr->write(m_buf, n) != n) {
+        setWriteError();
+        return false;
+      }
+    }
+    return true;
+  }
+  WriteClass* m_wr;
+  uint8_t m_in;
+  uint8_t m_buf[BUF_DIM];
+};
+#endif  // BufferedPrint_h
@@ -0,0 +1,212 @@
+/**
+ * Copyright (c) 20011-2017 Bill Greiman
+ * This file is part of the SdFs library for SD memory cards.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#ifndef FmtBuffer_h
+#define FmtBuffer_h
+/**
+ * \file
+ * \brief FmtBuffer class for formatted file output.
+ */
+#include <string.h>
+#include "FsConfig.h"
+#include "FmtNumber.h"
+//------------------------------------------------------------------------------
+/**
+ * \class FmtBuffer
+ * \brief Collect formatted output for a file in a stack buffer.
+ *
+ * Numbers are formatted into the buffer and the buffer is written with
+ * one call to the file's write() when it is full or by flush().  Use a
+ * DIM of one to write each field directly.
+ */
+template<class File, size_t DIM = FS_FMT_BUFFER_SIZE>
+class FmtBuffer {
+ public:
+  /** Constructor.
+   * \param[in] file File that receives the output.
+   */
+  explicit FmtBuffer(File* file)
+    : m_file(file), m_count(0), m_in(0), m_error(false) {}
+  /** \return The number of bytes written or -1 if an error occurred. */
+  size_t count() {
+    return m_error ? static_cast<size_t>(-1) : m_count + m_in;
+  }
+  /** Print a number followed by a field terminator.
+   * \param[in] value The number to be printed.
+   * \param[in] term The field terminator.  Use '\\n' for CR LF.
+   * \param[in] prec Number of digits after decimal point or FMT_SHORTEST.
+   */
+  void field(double value, char term, uint8_t prec = 2) {
+    char buf[FMT_DOUBLE_SIZE + 2];
+    char* str = buf + sizeof(buf);
+    str = fmtTerm(str, term);
+    if (prec == FMT_SHORTEST) {
+      str = fmtShortest(str, value, false);
+    } else {
+      str = fmtDouble(str, value, prec, false);
+    }
+    write(str, buf + sizeof(buf) - str);
+  }
+  /** Print a number followed by a field terminator.
+   * \param[in] value The number to be printed.
+   * \param[in] term The field terminator.  Use '\\n' for CR LF.
+   * \param[in] prec Number of digits after decimal point or FMT_SHORTEST.
+   */
+  void field(float value, char term, uint8_t prec = 2) {
+    if (prec == FMT_SHORTEST) {
+      char buf[FMT_DOUBLE_SIZE + 2];
+      char* str = buf + sizeof(buf);
+      str = fmtTerm(str, term);
+      str = fmtShortest(str, value, false);
+      write(str, buf + sizeof(buf) - str);
+    } else {
+      field(static_cast<double>(value), term, prec);
+    }
+  }
+  /** Print a string followed by a field terminator.
+   * \param[in] str The string to be printed.
+   * \param[in] term The field terminator.  Use '\\n' for CR LF.
+   */
+  void field(const char* str, char term) {
+    char buf[2];
+    write(str, strlen(str));
+    str = fmtTerm(buf + sizeof(buf), term);
+    write(str, buf + sizeof(buf) - str);
+  }
+  /** Print a string followed by a field terminator.
+   * \param[in] str The string to be printed.
+   * \param[in] term The field terminator.  Use '\\n' for CR LF.
+   */
+  void field(char* str, char term) {
+    field(static_cast<const char*>(str), term);
+  }
+  /** Print a number followed by a field terminator.
+   * \param[in] value The number to be printed.
+   * \param[in] term The field terminator.  Use '\\n' for CR LF.
+   */
+  template <typename Type>
+  void field(Type value, char term) {
+    char buf[3*sizeof(Type) + 3];
+    char* str = buf + sizeof(buf);
+    bool neg = value < 0;
+    str = fmtTerm(str, term);
+    // negate as unsigned so the most negative value fits
+    if (sizeof(Type) > 4) {
+      uint64_t u = value;
+      str = fmtBase10(str, neg ? 0 - u : u);
+    } else {
+      uint32_t u = value;
+      if (neg) {
+        u = 0U - u;
+      }
+      if (sizeof(Type) < 4) {
+        str = fmtBase10(str, (uint16_t)u);
+      } else {
+        str = fmtBase10(str, u);
+      }
+    }
+    if (neg) {
+      *--str = '-';
+    }
+    write(str, &buf[sizeof(buf)] - str);
+  }
+  /** Print the last field of a row followed by CR LF.
+   * \param[in] value The value to be printed.
+   */
+  template <typename Type>
+  void fields(Type value) {
+    field(value, '\n');
+  }
+  /** Print fields separated by commas and followed by CR LF.
+   * \param[in] value The first value to be printed.
+   * \param[in] rest The remaining values.
+   */
+  template <typename Type, typename... Rest>
+  void fields(Type value, Rest... rest) {
+    field(value, ',');
+    fields(rest...);
+  }
+  /** Write the buffer to the file.
+   * \return true for success or false if an error occurred.
+   */
+  bool flush() {
+    if (m_in) {
+      if (m_file->write(m_buf, m_in) != m_in) {
+        m_error = true;
+      }
+      m_count += m_in;
+      m_in = 0;
+    }
+    return !m_error;
+  }
+  /** Write a character.
+   * \param[in] c The character.
+   * \return one.
+   */
+  size_t write(char c) {
+    if (m_in >= DIM) {
+      flush();
+    }
+    m_buf[m_in++] = c;
+    return 1;
+  }
+  /** Write characters.
+   * \param[in] str Location of the characters.
+   * \param[in] n Number of characters.
+   * \return \a n.
+   */
+  size_t write(const char* str, size_t n) {
+    if ((m_in + n) > DIM) {
+      flush();
+      if (n > DIM) {
+        // too large for the buffer
+        if (m_file->write(str, n) != n) {
+          m_error = true;
+        }
+        m_count += n;
+        return n;
+      }
+    }
+    memcpy(m_buf + m_in, str, n);
+    m_in += n;
+    return n;
+  }
+
+ private:
+  static char* fmtTerm(char* str, char term) {
+    if (term) {
+      *--str = term;
+      if (term == '\n') {
+        *--str = '\r';
+      }
+    }
+    return str;
+  }
+  File* m_file;
+  size_t m_count;
+  size_t m_in;
+  bool m_error;
+  char m_buf[DIM];
+};
+#endif  // FmtBuffer_h
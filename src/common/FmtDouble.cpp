@@ -0,0 +1,1935 @@
+/**
+ * Copyright (c) 20011-2017 Bill Greiman
+ * This file is part of the SdFs library for SD memory cards.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#include <float.h>
+#include <string.h>
+#include "FsConfig.h"
+#include "FmtNumber.h"
+#ifdef __AVR__
+#include <avr/pgmspace.h>
+#endif  // __AVR__
+// Shortest round trip digits are found with the Schubfach algorithm of
+// Raffaello Giulietti, "The Schubfach way to render doubles", 2020.
+//
+// Fixed and exponent formats use the exact binary value so results are
+// correctly rounded, ties to even, like printf() in glibc.
+//------------------------------------------------------------------------------
+/** Largest digits after the decimal point for fixed format. */
+const uint8_t FIXED_MAX_PREC = 17;
+/** Largest digits after the decimal point for exponent format. */
+const uint8_t EXP_MAX_PREC = 16;
+/** Values this large use exponent format instead of fixed format. */
+const double FIXED_MAX_VALUE = 1e17;
+/** Remainder is zero for scaleTen() rounding. */
+const int8_t RND_ZERO = -2;
+//------------------------------------------------------------------------------
+static inline uint64_t mul128(uint64_t a, uint64_t b, uint64_t* hi) {
+#ifdef __SIZEOF_INT128__
+  unsigned __int128 p = (unsigned __int128)a*b;
+  *hi = p >> 64;
+  return p;
+#else  // __SIZEOF_INT128__
+  uint64_t a0 = (uint32_t)a;
+  uint64_t a1 = a >> 32;
+  uint64_t b0 = (uint32_t)b;
+  uint64_t b1 = b >> 32;
+  uint64_t p00 = a0*b0;
+  uint64_t p01 = a0*b1;
+  uint64_t p10 = a1*b0;
+  uint64_t mid = (p00 >> 32) + (uint32_t)p01 + (uint32_t)p10;
+  *hi = a1*b1 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+  return (mid << 32) | (uint32_t)p00;
+#endif  // __SIZEOF_INT128__
+}
+//------------------------------------------------------------------------------
+static inline uint64_t mulHigh(uint64_t a, uint64_t b) {
+  uint64_t hi;
+  mul128(a, b, &hi);
+  return hi;
+}
+//------------------------------------------------------------------------------
+// floor(e*log10(2))
+static inline int16_t flog10pow2(int16_t e) {
+  return (e*INT64_C(661971961083)) >> 41;
+}
+//------------------------------------------------------------------------------
+// floor(e*log10(2) + log10(3/4))
+static inline int16_t flog10ThreeQuartersPow2(int16_t e) {
+  return (e*INT64_C(661971961083) - INT64_C(274743187321)) >> 41;
+}
+//------------------------------------------------------------------------------
+// floor(e*log2(10))
+static inline int16_t flog2pow10(int16_t e) {
+  return (e*INT64_C(913124641741)) >> 38;
+}
+//------------------------------------------------------------------------------
+static uint64_t pow10(uint8_t n) {
+  uint64_t p = 1;
+  while (n--) {
+    p *= 10;
+  }
+  return p;
+}
+//==============================================================================
+#if DBL_MANT_DIG == 53
+// Tables for 10^e = g*2^r with 2^125 < g < 2^126.  The value of g is
+// floor(10^e*2^-r) + 1 split into {g >> 63, g & 0X7FFFFFFFFFFFFFFF}.
+const int16_t POW10_MIN = -292;
+const int16_t POW10_MAX = 324;
+static const uint64_t pow5Table[] = {
+  0X0000000000000001, 0X0000000000000005,
+  0X0000000000000019, 0X000000000000007D,
+  0X0000000000000271, 0X0000000000000C35,
+  0X0000000000003D09, 0X000000000001312D,
+  0X000000000005F5E1, 0X00000000001DCD65,
+  0X00000000009502F9, 0X0000000002E90EDD,
+  0X000000000E8D4A51, 0X0000000048C27395,
+  0X000000016BCC41E9, 0X000000071AFD498D,
+  0X0000002386F26FC1, 0X000000B1A2BC2EC5,
+  0X000003782DACE9D9, 0X00001158E460913D,
+  0X000056BC75E2D631, 0X0001B1AE4D6E2EF5,
+  0X000878678326EAC9, 0X002A5A058FC295ED,
+  0X00D3C21BCECCEDA1, 0X0422CA8B0A00A425,
+  0X14ADF4B7320334B9, 0X6765C793FA10079D
+};
+#if USE_SMALL_DOUBLE_TABLE
+// g is computed from every 27th power of five, {hi, lo} of floor(g) for
+// 10^(POW10_BASE + 27*i), times the power of five in pow5Table[] for the
+// remaining digits.  A two bit correction for each e is in pow10Delta[].
+const int16_t POW10_BASE = -297;
+const uint8_t POW10_STEP = 27;
+static const uint64_t pow10Base[][2] = {
+  {0X29DB1608CE3B4988, 0X6BCABCAE02BDBC93},  // -297
+  {0X21CF93DD7888939A, 0X169DD129BA0128A4},  // -270
+  {0X369FD6FD64259A12, 0X2BCE691D541AA267},  // -243
+  {0X2C200E4B310D277B, 0X2F635E5365AAB3EC},  // -216
+  {0X23A4E198A20ABD4F, 0X951FAD1EDCA0BBA7},  // -189
+  {0X39960A6CC11AC2BE, 0X832D2968C44A9444},  // -162
+  {0X2E8486919439377A, 0XE4BCD358985B3904},  // -135
+  {0X2593A163246E8995, 0X4E9A81FE35443E1B},  // -108
+  {0X3CB559E42AD070A8, 0XBEB89CA6508FEE70},  // -81
+  {0X310A3416A91D4793, 0X2AA5F8530F09AE21},  // -54
+  {0X279D346DE4781F92, 0X1DD7A89933D54D1F},  // -27
+  {0X2000000000000000, 0X0000000000000000},  // 0
+  {0X33B2E3C9FD0803CE, 0X8000000000000000},  // 27
+  {0X29C30F1029939B14, 0X6664242D97D9F649},  // 54
+  {0X21BC2B266D3A36BF, 0X5A680A2ECF7B5C68},  // 81
+  {0X36807B99069C237A, 0X7A039BD208332525},  // 108
+  {0X2C06B9D16C407A79, 0X17B01773FDCB9FE3},  // 135
+  {0X23906B7A7EFAF09F, 0X451623C4EFA11CC1},  // 162
+  {0X3974FBCA0A890BA0, 0X63C59A322A1B697E},  // 189
+  {0X2E69D2818DF38BB8, 0X5B654F8AF5C5CDA4},  // 216
+  {0X257E0F4287EDA736, 0X52AF6BC405593E63},  // 243
+  {0X3C928069CF3CB733, 0XEF18CECE59CF233B},  // 270
+  {0X30EE0D60427A13C1, 0XC2A18BE03B11C032},  // 297
+  {0X278676E4AD38C6EA, 0X5B01E8B09AA0D1B4}   // 324
+};
+static const uint32_t pow10Delta[] = {
+  0X55145045, 0X54000404, 0X55454551, 0X50510101,
+  0X54550505, 0X59651555, 0X10041556, 0X00000400,
+  0X14510400, 0X01440504, 0X05501155, 0X5A545555,
+  0X59551595, 0X51055426, 0X41551540, 0X51415551,
+  0X10515105, 0X05445405, 0X00000045, 0X00000000,
+  0X00000000, 0X00000000, 0X00000000, 0X59599000,
+  0X5959965A, 0X11040510, 0X55100415, 0X95495555,
+  0X65954554, 0X55565555, 0X44505051, 0X00441545,
+  0X04055041, 0X51551151, 0X51010414, 0X00000004,
+  0X00000000, 0X00000000, 0X00000000
+};
+//------------------------------------------------------------------------------
+static void pow10G(int16_t e, uint64_t* g1, uint64_t* g0) {
+  uint16_t i = e - POW10_MIN;
+  const uint64_t* b = pow10Base[(e - POW10_BASE)/POW10_STEP];
+  uint64_t m = pow5Table[(e - POW10_BASE)%POW10_STEP];
+  // p2:p1:p0 = b*m
+  uint64_t h1;
+  uint64_t h2;
+  uint64_t p0 = mul128(b[1], m, &h1);
+  uint64_t p1 = mul128(b[0], m, &h2) + h1;
+  uint64_t p2 = h2 + (p1 < h1);
+  // shift right to 126 bits
+  uint8_t sh = p2 ? 66 - __builtin_clzll(p2) : 2 - __builtin_clzll(p1);
+  uint64_t hi = p1;
+  uint64_t lo = p0;
+  if (sh) {
+    lo = (p0 >> sh) | (p1 << (64 - sh));
+    hi = (p1 >> sh) | (p2 << (64 - sh));
+  }
+  uint64_t inc = 1 + ((pow10Delta[i/16] >> 2*(i%16)) & 3);
+  lo += inc;
+  hi += lo < inc;
+  *g1 = (hi << 1) | (lo >> 63);
+  *g0 = lo & 0X7FFFFFFFFFFFFFFF;
+}
+#else  // USE_SMALL_DOUBLE_TABLE
+static const uint64_t pow10Table[][2] = {
+  {0X7FBBD8FE5F5E6E27, 0X497A3A2704EEC3DF},  // -292
+  {0X4FD5679EFB9B04D8, 0X5DEC645863153A6C},  // -291
+  {0X63CAC186BA81C60E, 0X75677D6E7BDA8906},  // -290
+  {0X7CBD71E869223792, 0X52C15CCA1AD12B48},  // -289
+  {0X4DF6673141B562BB, 0X53B8D9FE50C2BB0D},  // -288
+  {0X617400FD9222BB6A, 0X48A7107DE4F369D0},  // -287
+  {0X79D1013CF6AB6A45, 0X1AD0D49D5E304444},  // -286
+  {0X4C22A0C61A2B226B, 0X20C284E25ADE2AAB},  // -285
+  {0X5F2B48F7A0B5EB06, 0X08F3261AF195B555},  // -284
+  {0X76F61B3588E365C7, 0X4B2FEFA1ADFB22AB},  // -283
+  {0X4A59D101758E1F9C, 0X5EFDF5C50CBCF5AB},  // -282
+  {0X5CF04541D2F1A783, 0X76BD73364FEC3315},  // -281
+  {0X742C569247AE1164, 0X746CD003E3E73FDB},  // -280
+  {0X489BB61B6CCCCADF, 0X08C402026E7087E9},  // -279
+  {0X5AC2A3A247FFFD96, 0X6AF502830A0CA9E3},  // -278
+  {0X71734C8AD9FFFCFC, 0X45B24323CC8FD45C},  // -277
+  {0X46E80FD6C83FFE1D, 0X6B8F69F65FD9E4B9},  // -276
+  {0X58A213CC7A4FFDA5, 0X26734473F7D05DE8},  // -275
+  {0X6ECA98BF98E3FD0E, 0X50101590F5C47561},  // -274
+  {0X453E9F77BF8E7E29, 0X120A0D7A999AC95D},  // -273
+  {0X568E4755AF721DB3, 0X368C90D940017BB4},  // -272
+  {0X6C31D92B1B4EA520, 0X242FB50F9001DAA1},  // -271
+  {0X439F27BAF1112734, 0X169DD129BA0128A5},  // -270
+  {0X5486F1A9AD557101, 0X1C454574288172CE},  // -269
+  {0X69A8AE1418AACD41, 0X435696D132A1CF81},  // -268
+  {0X42096CCC8F6AC048, 0X7A161E42BFA521B1},  // -267
+  {0X528BC7FFB345705B, 0X189BA5D36F8E6A1D},  // -266
+  {0X672EB9FFA016CC71, 0X7EC28F484B7204A4},  // -265
+  {0X407D343FC40E3FC7, 0X1F39998D2F2742E7},  // -264
+  {0X509C814FB511CFB9, 0X0707FFF07AF113A1},  // -263
+  {0X64C3A1A3A25643A7, 0X28C9FFEC99AD5889},  // -262
+  {0X7DF48A0C8AEBD491, 0X12FC7FE7C018AEAB},  // -261
+  {0X4EB8D647D6D364DA, 0X5BDDCFF0D80F6D2B},  // -260
+  {0X62670BD9CC883E11, 0X32D543ED0E134875},  // -259
+  {0X7B00CED03FAA4D95, 0X5F8A94E851981A93},  // -258
+  {0X4CE0814227CA707D, 0X4BB69D1132FF109C},  // -257
+  {0X6018A192B1BD0C9C, 0X7EA444557FBED4C3},  // -256
+  {0X781EC9F75E2C4FC4, 0X1E4D556ADFAE89F3},  // -255
+  {0X4B133E3A9ADBB1DA, 0X52F05562CBCD1638},  // -254
+  {0X5DD80DC941929E51, 0X27AC6ABB7EC05BC6},  // -253
+  {0X754E113B91F745E5, 0X5197856A5E7072B8},  // -252
+  {0X4950CAC53B3A8BAF, 0X42FEB3627B0647B3},  // -251
+  {0X5BA4FD768A092E9B, 0X33BE603B19C7D99F},  // -250
+  {0X728E3CD42C8B7A42, 0X20ADF849E039D007},  // -249
+  {0X4798E6049BD72C69, 0X346CBB2E2C242205},  // -248
+  {0X597F1F85C2CCF783, 0X6187E9F9B72D2A86},  // -247
+  {0X6FDEE76733803564, 0X59E9E47824F87527},  // -246
+  {0X45EB50A08030215E, 0X78322ECB171B4939},  // -245
+  {0X576624C8A03C29B6, 0X563EBA7DDCE21B87},  // -244
+  {0X6D3FADFAC84B3424, 0X2BCE691D541AA268},  // -243
+  {0X4447CCBCBD2F0096, 0X5B6101B25490A581},  // -242
+  {0X5559BFEBEC7AC0BC, 0X3239421EE9B4CEE1},  // -241
+  {0X6AB02FE6E79970EB, 0X3EC792A6A422029A},  // -240
+  {0X42AE1DF050BFE693, 0X173CBBA8269541A0},  // -239
+  {0X5359A56C64EFE037, 0X7D0BEA92303A9208},  // -238
+  {0X68300EC77E2BD845, 0X7C4EE536BC49368A},  // -237
+  {0X411E093CAEDB672B, 0X5DB14F4235ADC217},  // -236
+  {0X51658B8BDA9240F6, 0X551DA312C319329C},  // -235
+  {0X65BEEE6ED136D134, 0X2A650BD773DF7F43},  // -234
+  {0X7F2EAA0A85848581, 0X34FE4ECD50D75F14},  // -233
+  {0X4F7D2A469372D370, 0X711EF14052869B6C},  // -232
+  {0X635C74D8384F884D, 0X0D66AD9067284247},  // -231
+  {0X7C33920E46636A60, 0X30C058F480F252D9},  // -230
+  {0X4DA03B48EBFE227C, 0X1E783798D09773C8},  // -229
+  {0X61084A1B26FDAB1B, 0X2616457F04BD50BA},  // -228
+  {0X794A5CA1F0BD15E2, 0X0F9BD6DEC5ECA4E8},  // -227
+  {0X4BCE79E536762DAD, 0X29C1664B3BB3E711},  // -226
+  {0X5EC2185E8413B918, 0X5431BFDE0AA0E0D5},  // -225
+  {0X76729E762518A75E, 0X693E2FD58D49190B},  // -224
+  {0X4A07A309D72F689B, 0X21C6DDE5784DAFA7},  // -223
+  {0X5C898BCC4CFB42C2, 0X0A38955ED6611B90},  // -222
+  {0X73ABEEBF603A1372, 0X4CC6BAB68BF96274},  // -221
+  {0X484B75379C244C27, 0X4FFC34B2177BDD89},  // -220
+  {0X5A5E5285832D5F31, 0X43FB41DE9D5AD4EB},  // -219
+  {0X70F5E726E3F8B6FD, 0X74FA125644B18A26},  // -218
+  {0X4699B0784E7B725E, 0X591C4B75EAEEF658},  // -217
+  {0X58401C96621A4EF6, 0X2F635E5365AAB3ED},  // -216
+  {0X6E5023BBFAA0E2B3, 0X7B3C35E83F1560E9},  // -215
+  {0X44F216557CA48DB0, 0X3D05A1B1276D5C92},  // -214
+  {0X562E9BEADBCDB11C, 0X4C470A1D7148B3B6},  // -213
+  {0X6BBA42E592C11D63, 0X5F58CCA4CD9AE0A3},  // -212
+  {0X435469CF7BB8B25E, 0X2B977FE70080CC66},  // -211
+  {0X542984435AA6DEF5, 0X767D5FE0C0A0FF80},  // -210
+  {0X6933E554315096B3, 0X341CB7D8F0C93F5F},  // -209
+  {0X41C06F549ED25E30, 0X1091F2E7967DC79C},  // -208
+  {0X52308B29C686F5BC, 0X14B66FA17C1D3983},  // -207
+  {0X66BCADF43828B32B, 0X19E40B89DB2487E3},  // -206
+  {0X4035ECB8A3196FFB, 0X002E873628F6D4EE},  // -205
+  {0X504367E6CBDFCBF9, 0X603A2903B3348A2A},  // -204
+  {0X645441E07ED7BEF8, 0X1848B344A001ACB4},  // -203
+  {0X7D6952589E8DAEB6, 0X1E5AE015C80217E1},  // -202
+  {0X4E61D37763188D31, 0X72F8CC0D9D014EED},  // -201
+  {0X61FA48553BDEB07E, 0X2FB6FF110441A2A8},  // -200
+  {0X7A78DA6A8AD65C9D, 0X7BA4BED545520B52},  // -199
+  {0X4C8B888296C5F9E2, 0X5D46F7454B534713},  // -198
+  {0X5FAE6AA33C77785B, 0X3498B5169E2818D8},  // -197
+  {0X779A054C0B955672, 0X21BEE25C45B21F0E},  // -196
+  {0X4AC0434F873D5607, 0X35174D79AB8F5369},  // -195
+  {0X5D705423690CAB89, 0X225D20D816732843},  // -194
+  {0X74CC692C434FD66B, 0X4AF4690E1C0FF253},  // -193
+  {0X48FFC1BBAA11E603, 0X1ED8C1A8D189F774},  // -192
+  {0X5B3FB22A94965F84, 0X068EF21305EC7551},  // -191
+  {0X720F9EB539BBF765, 0X0832AE97C76792A5},  // -190
+  {0X4749C33144157A9F, 0X151FAD1EDCA0BBA8},  // -189
+  {0X591C33FD951AD946, 0X7A67986693C8EA91},  // -188
+  {0X6F6340FCFA618F98, 0X59017E8038BB2536},  // -187
+  {0X459E089E1C7CF9BF, 0X37A0EF102374F742},  // -186
+  {0X57058AC5A39C382F, 0X25892AD42C523512},  // -185
+  {0X6CC6ED770C83463B, 0X0EEB75893766C256},  // -184
+  {0X43FC546A67D20BE4, 0X79532975C2A03976},  // -183
+  {0X54FB698501C68EDE, 0X17A7F3D3334847D4},  // -182
+  {0X6A3A43E642383295, 0X5D91F0C8001A59C8},  // -181
+  {0X42646A6FE9631F9D, 0X4A7B367D0010781D},  // -180
+  {0X52FD850BE3BBE784, 0X7D1A041C40149625},  // -179
+  {0X67BCE64EDCAAE166, 0X1C6085235019BBAE},  // -178
+  {0X40D60FF149EACCDF, 0X71BC53361210154D},  // -177
+  {0X510B93ED9C658017, 0X6E2B680396941AA0},  // -176
+  {0X654E78E9037EE01D, 0X69B642047C392148},  // -175
+  {0X7EA21723445E9825, 0X2423D2859B476999},  // -174
+  {0X4F254E760ABB1F17, 0X26966393810CA200},  // -173
+  {0X62EEA2138D69E6DD, 0X103BFC78614FCA80},  // -172
+  {0X7BAA4A9870C46094, 0X344AFB9679A3BD20},  // -171
+  {0X4D4A6E9F467ABC5C, 0X60AEDD3E0C065634},  // -170
+  {0X609D0A4718196B73, 0X78DA948D8F07EBC1},  // -169
+  {0X78C44CD8DE1FC650, 0X771139B0F2C9E6B1},  // -168
+  {0X4B7AB0078AD3DBF2, 0X4A6AC40E97BE302F},  // -167
+  {0X5E595C096D88D2EF, 0X1D0575123DADBC3A},  // -166
+  {0X75EFB30BC8EB07AB, 0X0446D256CD192B49},  // -165
+  {0X49B5CFE75D92E4CA, 0X72AC4376402FBB0E},  // -164
+  {0X5C2343E134F79DFD, 0X4F575453D03BA9D1},  // -163
+  {0X732C14D98235857D, 0X032D2968C44A9445},  // -162
+  {0X47FB8D07F161736E, 0X11FC39E17AAE9CAB},  // -161
+  {0X59FA7049EDB9D049, 0X567B4859D95A43D6},  // -160
+  {0X70790C5C6928445C, 0X0C1A1A704FB0D4CC},  // -159
+  {0X464BA7B9C1B92AB9, 0X4790508631CE84FF},  // -158
+  {0X57DE91A832277567, 0X797464A7BE42263F},  // -157
+  {0X6DD636123EB152C1, 0X77D17DD1ADD2AFCF},  // -156
+  {0X44A5E1CB672ED3B9, 0X1AE2EEA30CA3ADE1},  // -155
+  {0X55CF5A3E40FA88A7, 0X419BAA4BCFCC995A},  // -154
+  {0X6B4330CDD1392AD1, 0X320294DEC3BFBFB0},  // -153
+  {0X4309FE80A2C3BAC2, 0X6F419D0B3A57D7CE},  // -152
+  {0X53CC7E20CB74A973, 0X4B12044E08EDCDC2},  // -151
+  {0X68BF9DA8FE51D3D0, 0X3DD685618B294132},  // -150
+  {0X4177C2899EF32462, 0X26A6135CF6F9C8BF},  // -149
+  {0X51D5B32C06AFED7A, 0X704F983434B83AEF},  // -148
+  {0X664B1FF7085BE8D9, 0X4C637E4141E649AB},  // -147
+  {0X7FDDE7F4CA72E30F, 0X7F7C5DD1925FDC15},  // -146
+  {0X4FEAB0F8FE87CDE9, 0X7FADBAA2FB7BE98D},  // -145
+  {0X63E55D373E29C164, 0X3F99294BBA5AE3F1},  // -144
+  {0X7CDEB4850DB431BD, 0X4F7F739EA8F19CED},  // -143
+  {0X4E0B30D328909F16, 0X41AFA84329970214},  // -142
+  {0X618DFD07F2B4C6DC, 0X121B9253F3FCC299},  // -141
+  {0X79F17C49EF61F893, 0X16A276E8F0FBF33F},  // -140
+  {0X4C36EDAE359D3B5B, 0X7E258A51969D7808},  // -139
+  {0X5F44A919C3048A32, 0X7DAEECE5FC44D609},  // -138
+  {0X7715D36033C5ACBF, 0X5D1AA81F7B560B8C},  // -137
+  {0X4A6DA41C205B8BF7, 0X6A30A913AD15C738},  // -136
+  {0X5D090D2328726EF5, 0X64BCD358985B3905},  // -135
+  {0X744B506BF28F0AB3, 0X1DEC082EBE720746},  // -134
+  {0X48AF1243779966B0, 0X02B3851D3707448C},  // -133
+  {0X5ADAD6D4557FC05C, 0X0360666484C915AF},  // -132
+  {0X71918C896ADFB073, 0X04387FFDA5FB5B1B},  // -131
+  {0X46FAF7D5E2CBCE47, 0X72A34FFE87BD18F1},  // -130
+  {0X58B9B5CB5B7EC1D9, 0X6F4C23FE29AC5F2D},  // -129
+  {0X6EE8233E325E7250, 0X2B1F2CFDB41776F8},  // -128
+  {0X45511606DF7B0772, 0X1AF37C1E908EAA5B},  // -127
+  {0X56A55B889759C94E, 0X61B05B2634B254F2},  // -126
+  {0X6C4EB26ABD303BA2, 0X3A1C71EFC1DEEA2E},  // -125
+  {0X43B12F82B63E2545, 0X4451C735D92B525D},  // -124
+  {0X549D7B6363CDAE96, 0X756639034F7626F4},  // -123
+  {0X69C4DA3C3CC11A3C, 0X52BFC7442353B0B1},  // -122
+  {0X421B0865A5F8B065, 0X73B7DC8A96144E6F},  // -121
+  {0X52A1CA7F0F76DC7F, 0X30A5D3AD3B99620B},  // -120
+  {0X674A3D1ED354939F, 0X1CCF48988A7FBA8D},  // -119
+  {0X408E66334414DC43, 0X42018D5F568FD498},  // -118
+  {0X50B1FFC0151A1354, 0X3281F0B72C33C9BE},  // -117
+  {0X64DE7FB01A609829, 0X3F226CE4F740BC2E},  // -116
+  {0X7E161F9C20F8BE33, 0X6EEB081E3510EB39},  // -115
+  {0X4ECDD3C1949B76E0, 0X3552E512E12A9304},  // -114
+  {0X628148B1F9C25498, 0X42A79E57997537C5},  // -113
+  {0X7B219ADE7832E9BE, 0X535185ED7FD285B6},  // -112
+  {0X4CF500CB0B1FD217, 0X1412F3B46FE39392},  // -111
+  {0X603240FDCDE7C69C, 0X7917B0A18BDC7876},  // -110
+  {0X783ED13D4161B844, 0X175D9CC9EED39694},  // -109
+  {0X4B2742C648DD132A, 0X4E9A81FE35443E1C},  // -108
+  {0X5DF11377DB1457F5, 0X2241227DC2954DA3},  // -107
+  {0X756D5855D1D96DF2, 0X4AD16B1D333AA10C},  // -106
+  {0X49645735A327E4B7, 0X4EC2E2F24004A4A8},  // -105
+  {0X5BBD6D030BF1DDE5, 0X42739BAED005CDD2},  // -104
+  {0X72ACC843CEEE555E, 0X7310829A84074146},  // -103
+  {0X47ABFD2A6154F55B, 0X27EA51A0928488CC},  // -102
+  {0X5996FC74F9AA32B2, 0X11E4E608B725AAFF},  // -101
+  {0X6FFCBB923814BF5E, 0X565E1F8AE4EF15BE},  // -100
+  {0X45FDF53B630CF79B, 0X15FAD3B6CF156D97},  // -99
+  {0X577D728A3BD03581, 0X7B7988A482DAC8FD},  // -98
+  {0X6D5CCF2CCAC442E2, 0X3A57EACDA3917B3C},  // -97
+  {0X445A017BFEBAA9CD, 0X4476F2C0863AED06},  // -96
+  {0X557081DAFE695440, 0X7594AF70A7C9A847},  // -95
+  {0X6ACCA251BE03A951, 0X12F9DB4CD1BC1258},  // -94
+  {0X42BFE57316C249D2, 0X5BDC291003158B77},  // -93
+  {0X536FDECFDC72DC47, 0X32D3335403DAEE55},  // -92
+  {0X684BD683D38F9359, 0X1F88002904D1A9EA},  // -91
+  {0X412F66126439BC17, 0X63B50019A3030A33},  // -90
+  {0X517B3F96FD482B1D, 0X5CA240200BC3CCBF},  // -89
+  {0X65DA0F7CBC9A35E5, 0X13CAD0280EB4BFEF},  // -88
+  {0X7F50935BEBC0C35E, 0X38BD84321261EFEB},  // -87
+  {0X4F925C1973587A1B, 0X0376729F4B7D35F3},  // -86
+  {0X6376F31FD02E98A1, 0X64540F471E5C836F},  // -85
+  {0X7C54AFE7C43A3ECA, 0X1D691318E5F3A44B},  // -84
+  {0X4DB4EDF0DAA4673E, 0X3261ABEF8FB846AF},  // -83
+  {0X6122296D114D810D, 0X7EFA16EB73A6585B},  // -82
+  {0X796AB3C855A0E151, 0X3EB89CA6508FEE71},  // -81
+  {0X4BE2B05D35848CD2, 0X773361E7F259F507},  // -80
+  {0X5EDB5C7482E5B007, 0X55003A61EEF07249},  // -79
+  {0X76923391A39F1C09, 0X4A4048FA6AAC8EDB},  // -78
+  {0X4A1B603B06437185, 0X7E682D9C82ABD949},  // -77
+  {0X5CA23849C7D44DE7, 0X3E023903A356CF9B},  // -76
+  {0X73CAC65C39C96161, 0X2D82C7448C2C8382},  // -75
+  {0X485EBBF9A41DDCDC, 0X6C71BC8AD79BD231},  // -74
+  {0X5A766AF80D255414, 0X078E2BAD8D82C6BD},  // -73
+  {0X711405B6106EA919, 0X0971B698F0E3786D},  // -72
+  {0X46AC8391CA4529AF, 0X55E7121F968E2B44},  // -71
+  {0X5857A4763CD6741B, 0X4B60D6A77C31B615},  // -70
+  {0X6E6D8D93CC0C1122, 0X3E390C515B3E239A},  // -69
+  {0X4504787C5F878AB5, 0X46E3A7B2D906D640},  // -68
+  {0X5645969B77696D62, 0X789C919F8F488BD0},  // -67
+  {0X6BD6FC425543C8BB, 0X56C3B607731AAEC4},  // -66
+  {0X43665DA9754A5D75, 0X263A51C4A7F0AD3B},  // -65
+  {0X543FF513D29CF4D2, 0X4FC8E635D1ECD88A},  // -64
+  {0X694FF258C7443207, 0X23BB1FC346680EAC},  // -63
+  {0X41D1F7777C8A9F44, 0X4654F3DA0C01092C},  // -62
+  {0X524675555BAD4715, 0X57EA30D08F014B76},  // -61
+  {0X66D812AAB29898DB, 0X0DE4BD04B2C19E54},  // -60
+  {0X40470BAAAF9F5F88, 0X78AEF622EFB902F5},  // -59
+  {0X5058CE955B87376B, 0X16DAB3ABABA743B2},  // -58
+  {0X646F023AB2690545, 0X7C9160969691149E},  // -57
+  {0X7D8AC2C95F034697, 0X3BB5B8BC3C3559C5},  // -56
+  {0X4E76B9BDDB620C1E, 0X55519375A5A1581B},  // -55
+  {0X6214682D523A8F26, 0X2AA5F8530F09AE22},  // -54
+  {0X7A998238A6C932EF, 0X754F7667D2CC19AB},  // -53
+  {0X4C9FF163683DBFD5, 0X7951AA00E3BF900B},  // -52
+  {0X5FC7EDBC424D2FCB, 0X37A614811CAF740D},  // -51
+  {0X77B9E92B52E07BBE, 0X258F99A163DB5111},  // -50
+  {0X4AD431BB13CC4D56, 0X7779C004DE6912AB},  // -49
+  {0X5D893E29D8BF60AC, 0X5558300616035755},  // -48
+  {0X74EB8DB44EEF38D7, 0X6AAE3C079B842D2A},  // -47
+  {0X49133890B1558386, 0X72ACE584C1329C3B},  // -46
+  {0X5B5806B4DDAAE468, 0X4F581EE5F17F4349},  // -45
+  {0X722E086215159D82, 0X632E269F6DDF141B},  // -44
+  {0X475CC53D4D2D8271, 0X5DFCD823A4AB6C91},  // -43
+  {0X5933F68CA078E30E, 0X157C0E2C8DD647B5},  // -42
+  {0X6F80F42FC8971BD1, 0X5ADB11B7B14BD9A3},  // -41
+  {0X45B0989DDD5E7163, 0X08C8EB12CECF6806},  // -40
+  {0X571CBEC554B60DBB, 0X6AFB25D782834207},  // -39
+  {0X6CE3EE76A9E3912A, 0X65B9EF4D63241289},  // -38
+  {0X440E750A2A2E3ABA, 0X5F9435905DF68B96},  // -37
+  {0X5512124CB4B9C969, 0X377942F475742E7B},  // -36
+  {0X6A5696DFE1E83BC3, 0X655793B192D13A1A},  // -35
+  {0X42761E4BED31255A, 0X2F56BC4EFBC2C450},  // -34
+  {0X5313A5DEE87D6EB0, 0X7B2C6B62BAB37564},  // -33
+  {0X67D88F56A29CCA5D, 0X19F7863B696052BD},  // -32
+  {0X40E7599625A1FE7A, 0X203AB3E521DC33B6},  // -31
+  {0X51212FFBAF0A7E18, 0X684960DE6A5340A4},  // -30
+  {0X65697BFA9ACD1D9F, 0X025BB91604E810CD},  // -29
+  {0X7EC3DAF941806506, 0X62F2A75B86221500},  // -28
+  {0X4F3A68DBC8F03F24, 0X1DD7A89933D54D20},  // -27
+  {0X63090312BB2C4EED, 0X254D92BF80CAA068},  // -26
+  {0X7BCB43D769F762A8, 0X4EA0F76F60FD4882},  // -25
+  {0X4D5F0A66A23A9DA9, 0X31249AA59C9E4D51},  // -24
+  {0X60B6CD004AC94513, 0X5D6DC14F03C5E0A5},  // -23
+  {0X78E480405D7B9658, 0X54C931A2C4B758CF},  // -22
+  {0X4B8ED0283A6D3DF7, 0X34FDBF05BAF29781},  // -21
+  {0X5E72843249088D75, 0X223D2EC729AF3D62},  // -20
+  {0X760F253EDB4AB0D2, 0X4ACC7A78F41B0CBA},  // -19
+  {0X49C97747490EAE83, 0X4EBFCC8B9890E7F4},  // -18
+  {0X5C3BD5191B525A24, 0X426FBFAE7EB521F1},  // -17
+  {0X734ACA5F6226F0AD, 0X530BAF9A1E626A6D},  // -16
+  {0X480EBE7B9D58566C, 0X43E74DC052FD8285},  // -15
+  {0X5A126E1A84AE6C07, 0X54E1213067BCE326},  // -14
+  {0X709709A125DA0709, 0X4A19697C81AC1BEF},  // -13
+  {0X465E6604B7A84465, 0X7E4FE1EDD10B9175},  // -12
+  {0X57F5FF85E592557F, 0X3DE3DA69454E75D3},  // -11
+  {0X6DF37F675EF6EADF, 0X2D5CD10396A21347},  // -10
+  {0X44B82FA09B5A52CB, 0X4C5A02A23E254C0D},  // -9
+  {0X55E63B88C230E77E, 0X3F70834ACDAE9F10},  // -8
+  {0X6B5FCA6AF2BD215E, 0X0F4CA41D811A46D4},  // -7
+  {0X431BDE82D7B634DA, 0X698FE69270B06C44},  // -6
+  {0X53E2D6238DA3C211, 0X43F3E0370CDC8755},  // -5
+  {0X68DB8BAC710CB295, 0X74F0D844D013A92B},  // -4
+  {0X4189374BC6A7EF9D, 0X5916872B020C49BB},  // -3
+  {0X51EB851EB851EB85, 0X0F5C28F5C28F5C29},  // -2
+  {0X6666666666666666, 0X3333333333333334},  // -1
+  {0X4000000000000000, 0X0000000000000001},  // 0
+  {0X5000000000000000, 0X0000000000000001},  // 1
+  {0X6400000000000000, 0X0000000000000001},  // 2
+  {0X7D00000000000000, 0X0000000000000001},  // 3
+  {0X4E20000000000000, 0X0000000000000001},  // 4
+  {0X61A8000000000000, 0X0000000000000001},  // 5
+  {0X7A12000000000000, 0X0000000000000001},  // 6
+  {0X4C4B400000000000, 0X0000000000000001},  // 7
+  {0X5F5E100000000000, 0X0000000000000001},  // 8
+  {0X7735940000000000, 0X0000000000000001},  // 9
+  {0X4A817C8000000000, 0X0000000000000001},  // 10
+  {0X5D21DBA000000000, 0X0000000000000001},  // 11
+  {0X746A528800000000, 0X0000000000000001},  // 12
+  {0X48C2739500000000, 0X0000000000000001},  // 13
+  {0X5AF3107A40000000, 0X0000000000000001},  // 14
+  {0X71AFD498D0000000, 0X0000000000000001},  // 15
+  {0X470DE4DF82000000, 0X0000000000000001},  // 16
+  {0X58D15E1762800000, 0X0000000000000001},  // 17
+  {0X6F05B59D3B200000, 0X0000000000000001},  // 18
+  {0X4563918244F40000, 0X0000000000000001},  // 19
+  {0X56BC75E2D6310000, 0X0000000000000001},  // 20
+  {0X6C6B935B8BBD4000, 0X0000000000000001},  // 21
+  {0X43C33C1937564800, 0X0000000000000001},  // 22
+  {0X54B40B1F852BDA00, 0X0000000000000001},  // 23
+  {0X69E10DE76676D080, 0X0000000000000001},  // 24
+  {0X422CA8B0A00A4250, 0X0000000000000001},  // 25
+  {0X52B7D2DCC80CD2E4, 0X0000000000000001},  // 26
+  {0X6765C793FA10079D, 0X0000000000000001},  // 27
+  {0X409F9CBC7C4A04C2, 0X1000000000000001},  // 28
+  {0X50C783EB9B5C85F2, 0X5400000000000001},  // 29
+  {0X64F964E68233A76F, 0X2900000000000001},  // 30
+  {0X7E37BE2022C0914B, 0X1340000000000001},  // 31
+  {0X4EE2D6D415B85ACE, 0X7C08000000000001},  // 32
+  {0X629B8C891B267182, 0X5B0A000000000001},  // 33
+  {0X7B426FAB61F00DE3, 0X31CC800000000001},  // 34
+  {0X4D0985CB1D3608AE, 0X0F1FD00000000001},  // 35
+  {0X604BE73DE4838AD9, 0X52E7C40000000001},  // 36
+  {0X785EE10D5DA46D90, 0X07A1B50000000001},  // 37
+  {0X4B3B4CA85A86C47A, 0X04C5112000000001},  // 38
+  {0X5E0A1FD271287598, 0X45F6556800000001},  // 39
+  {0X758CA7C70D7292FE, 0X5773EAC200000001},  // 40
+  {0X4977E8DC68679BDF, 0X16A872B940000001},  // 41
+  {0X5BD5E313828182D6, 0X7C528F6790000001},  // 42
+  {0X72CB5BD86321E38C, 0X5B67334174000001},  // 43
+  {0X47BF19673DF52E37, 0X79208008E8800001},  // 44
+  {0X59AEDFC10D7279C5, 0X7768A00B22A00001},  // 45
+  {0X701A97B150CF1837, 0X3542C80DEB480001},  // 46
+  {0X46109ECED2816F22, 0X5149BD08B30D0001},  // 47
+  {0X5794C6828721CAEB, 0X259C2C4ADFD04001},  // 48
+  {0X6D79F82328EA3DA6, 0X0F03375D97C45001},  // 49
+  {0X446C3B15F9926687, 0X6962029A7EDAB201},  // 50
+  {0X558749DB77F70029, 0X63BA83411E915E81},  // 51
+  {0X6AE91C5255F4C034, 0X1CA924116635B621},  // 52
+  {0X42D1B1B375B8F820, 0X51E9B68ADFE191D5},  // 53
+  {0X53861E2053273628, 0X6664242D97D9F64A},  // 54
+  {0X6867A5A867F103B2, 0X7FFD2D38FDD073DC},  // 55
+  {0X4140C78940F6A24F, 0X6FFE3C439EA2486A},  // 56
+  {0X5190F96B91344AE3, 0X6BFDCB54864ADA84},  // 57
+  {0X65F537C675815D9C, 0X66FD3E29A7DD9125},  // 58
+  {0X7F7285B812E1B504, 0X00BC8DB411D4F56E},  // 59
+  {0X4FA793930BCD1122, 0X4075D8908B251965},  // 60
+  {0X63917877CEC0556B, 0X10934EB4ADEE5FBE},  // 61
+  {0X7C75D695C2706AC5, 0X74B82261D969F7AD},  // 62
+  {0X4DC9A61D998642BB, 0X58F3157D27E23ACC},  // 63
+  {0X613C0FA4FFE7D36A, 0X4F2FDADC71DAC97F},  // 64
+  {0X798B138E3FE1C845, 0X22FBD1938E517BDF},  // 65
+  {0X4BF6EC38E7ED1D2B, 0X25DD62FC38F2ED6C},  // 66
+  {0X5EF4A74721E86476, 0X0F54BBBB472FA8C6},  // 67
+  {0X76B1D118EA627D93, 0X5329EAAA18FB92F8},  // 68
+  {0X4A2F22AF927D8E7C, 0X23FA32AA4F9D3BDB},  // 69
+  {0X5CBAEB5B771CF21B, 0X2CF8BF54E3848AD2},  // 70
+  {0X73E9A63254E42EA2, 0X1836EF2A1C65AD86},  // 71
+  {0X487207DF750E9D25, 0X2F22557A51BF8C74},  // 72
+  {0X5A8E89D75252446E, 0X5AEAEAD8E62F6F91},  // 73
+  {0X71322C4D26E6D58A, 0X31A5A58F1FBB4B75},  // 74
+  {0X46BF5BB038504576, 0X3F07877973D50F29},  // 75
+  {0X586F329C466456D4, 0X0EC96957D0CA52F3},  // 76
+  {0X6E8AFF4357FD6C89, 0X127BC3ADC4FCE7B0},  // 77
+  {0X4516DF8A16FE63D5, 0X5B8D5A4C9B1E10CE},  // 78
+  {0X565C976C9CBDFCCB, 0X1270B0DFC1E59502},  // 79
+  {0X6BF3BD47C3ED7BFD, 0X770CDD17B25EFA42},  // 80
+  {0X4378564CDA746D7E, 0X5A680A2ECF7B5C69},  // 81
+  {0X54566BE0111188DE, 0X31020CBA835A3384},  // 82
+  {0X696C06D81555EB15, 0X7D428FE92430C065},  // 83
+  {0X41E384470D55B2ED, 0X5E4999F1B69E783F},  // 84
+  {0X525C6558D0AB1FA9, 0X15DC006E2446164F},  // 85
+  {0X66F37EAF04D5E793, 0X3B530089AD579BE2},  // 86
+  {0X40582F2D6305B0BC, 0X1513E0560C56C16E},  // 87
+  {0X506E3AF8BBC71CEB, 0X1A58D86B8F6C71C9},  // 88
+  {0X6489C9B6EAB8E426, 0X00EF0E8673478E3B},  // 89
+  {0X7DAC3C24A5671D2F, 0X412AD228101971C9},  // 90
+  {0X4E8BA596E760723D, 0X58BAC3590A0FE71E},  // 91
+  {0X622E8EFCA1388ECD, 0X0EE9742F4C93E0E6},  // 92
+  {0X7ABA32BBC986B280, 0X32A3D13B1FB8D91F},  // 93
+  {0X4CB45FB55DF42F90, 0X1FA662C4F3D387B3},  // 94
+  {0X5FE177A2B5713B74, 0X278FFB7630C869A0},  // 95
+  {0X77D9D58B62CD8A51, 0X3173FA53BCFA8408},  // 96
+  {0X4AE825771DC07672, 0X6EE87C74561C9285},  // 97
+  {0X5DA22ED4E530940F, 0X4AA29B916BA3B726},  // 98
+  {0X750ABA8A1E7CB913, 0X3D4B4275C68CA4F0},  // 99
+  {0X4926B496530DF3AC, 0X164F09899C17E716},  // 100
+  {0X5B7061BBE7D17097, 0X1BE2CBEC031DE0DC},  // 101
+  {0X724C7A2AE1C5CCBD, 0X02DB7EE703E55912},  // 102
+  {0X476FCC5ACD1B9FF6, 0X11C92F50626F57AC},  // 103
+  {0X594BBF71806287F3, 0X563B7B247B0B2D96},  // 104
+  {0X6F9EAF4DE07B29F0, 0X4BCA59ED99CDF8FC},  // 105
+  {0X45C32D90AC4CFA36, 0X2F5E78348020BB9E},  // 106
+  {0X5733F8F4D76038C3, 0X7B361641A028EA85},  // 107
+  {0X6D00F7320D3846F4, 0X7A039BD208332526},  // 108
+  {0X44209A7F48432C59, 0X0C424163451FF738},  // 109
+  {0X5528C11F1A53F76F, 0X2F52D1BC1667F506},  // 110
+  {0X6A72F166E0E8F54B, 0X1B27862B1C01F247},  // 111
+  {0X4287D6E04C91994F, 0X00F8B3DAF181376D},  // 112
+  {0X5329CC985FB5FFA2, 0X6136E0D1ADE18548},  // 113
+  {0X67F43FBE77A37F8B, 0X398499061959E699},  // 114
+  {0X40F8A7D70AC62FB7, 0X13F2DFA3CFD83020},  // 115
+  {0X5136D1CCCD77BBA4, 0X78EF978CC3CE3C28},  // 116
+  {0X6584864000D5AA8E, 0X172B7D6FF4C1CB32},  // 117
+  {0X7EE5A7D0010B1531, 0X5CF65CCBF1F23DFE},  // 118
+  {0X4F4F88E200A6ED3F, 0X0A19F9FF773766BF},  // 119
+  {0X63236B1A80D0A88E, 0X6CA0787F5505406F},  // 120
+  {0X7BEC45E12104D2B2, 0X47C8969F2A46908A},  // 121
+  {0X4D73ABACB4A303AF, 0X4CDD5E237A6C1A57},  // 122
+  {0X60D09697E1CBC49B, 0X4014B5AC590720EC},  // 123
+  {0X7904BC3DDA3EB5C2, 0X3019E3176F48E927},  // 124
+  {0X4BA2F5A6A8673199, 0X3E102DEEA58D91B9},  // 125
+  {0X5E8BB3105280FDFF, 0X6D94396A4EF0F627},  // 126
+  {0X762E9FD467213D7F, 0X68F947C4E2AD33B0},  // 127
+  {0X49DD23E4C074C66F, 0X719BCCDB0DAC404E},  // 128
+  {0X5C546CDDF091F80B, 0X6E02C011D1175062},  // 129
+  {0X736988156CB6760E, 0X69837016455D247A},  // 130
+  {0X4821F50D63F209C9, 0X21F2260DEB5A36CC},  // 131
+  {0X5A2A7250BCEE8C3B, 0X4A6EAF916630C47F},  // 132
+  {0X70B50EE4EC2A2F4A, 0X3D0A5B75BFBCF59F},  // 133
+  {0X4671294F139A5D8E, 0X4626792997D61984},  // 134
+  {0X580D73A2D880F4F2, 0X17B01773FDCB9FE4},  // 135
+  {0X6E10D08B8EA1322E, 0X5D9C1D50FD3E87DD},  // 136
+  {0X44CA82573924BF5D, 0X1A8192529E4714EB},  // 137
+  {0X55FD22ED076DEF34, 0X4121F6E745D8DA25},  // 138
+  {0X6B7C6BA849496B01, 0X516A74A1174F10AE},  // 139
+  {0X432DC3492DCDE2E1, 0X02E288E4AE916A6D},  // 140
+  {0X53F9341B79415B99, 0X239B2B1DDA35C508},  // 141
+  {0X68F781225791B27F, 0X4C81F5E550C3364A},  // 142
+  {0X419AB0B576BB0F8F, 0X5FD139AF527A01EF},  // 143
+  {0X52015CE2D469D373, 0X57C5881B2718826A},  // 144
+  {0X6681B41B89844850, 0X4DB6EA21F0DEA304},  // 145
+  {0X4011109135F2AD32, 0X30925255368B25E3},  // 146
+  {0X501554B5836F587E, 0X7CB6E6EA842DEF5C},  // 147
+  {0X641AA9E2E44B2E9E, 0X5BE4A0A525396B32},  // 148
+  {0X7D21545B9D5DFA46, 0X32DDC8CE6E87C5FF},  // 149
+  {0X4E34D4B9425ABC6B, 0X7FCA9D810514DBBF},  // 150
+  {0X61C209E792F16B86, 0X7FBD44E1465A12AF},  // 151
+  {0X7A328C6177ADC668, 0X5FAC961997F0975B},  // 152
+  {0X4C5F97BCEACC9C01, 0X3BCBDDCFFEF65E99},  // 153
+  {0X5F777DAC257FC301, 0X6ABED543FEB3F63F},  // 154
+  {0X77555D172EDFB3C2, 0X256E8A94FE60F3CF},  // 155
+  {0X4A955A2E7D4BD059, 0X3765169D1EFC9861},  // 156
+  {0X5D3AB0BA1C9EC46F, 0X653E5C4466BBBE7A},  // 157
+  {0X74895CE8A3C6758B, 0X5E8DF355806AAE18},  // 158
+  {0X48D5DA11665C0977, 0X2B18B8157042ACCF},  // 159
+  {0X5B0B5095BFF30BD5, 0X15DEE61ACC535803},  // 160
+  {0X71CE24BB2FEFCECA, 0X3B569FA17F682E03},  // 161
+  {0X4720D6F4FDF5E13E, 0X451623C4EFA11CC2},  // 162
+  {0X58E90CB23D73598E, 0X165BACB62B8963F3},  // 163
+  {0X6F234FDECCD02FF1, 0X5BF297E3B66BBCEF},  // 164
+  {0X457611EB40021DF7, 0X09779EEE52035616},  // 165
+  {0X56D396661002A574, 0X6BD586A9E6842B9B},  // 166
+  {0X6C887BFF94034ED2, 0X06CAE85460253682},  // 167
+  {0X43D54D7FBC821143, 0X243ED134BC174211},  // 168
+  {0X54CAA0DFABA29594, 0X0D4E8581EB1D1295},  // 169
+  {0X69FD4917968B3AF9, 0X10A226E265E4573B},  // 170
+  {0X423E4DAEBE1704DB, 0X5A65584D7FAEB685},  // 171
+  {0X52CDE11A6D9CC612, 0X50FEAE60DF9A6426},  // 172
+  {0X678159610903F797, 0X253E59F91780FD2F},  // 173
+  {0X40B0D7DCA5A27ABE, 0X4746F83BAEB09E3E},  // 174
+  {0X50DD0DD3CF0B196E, 0X1918B64A9A5CC5CD},  // 175
+  {0X65145148C2CDDFC9, 0X5F5EE3DD40F3F740},  // 176
+  {0X7E59659AF38157BC, 0X17369CD49130F510},  // 177
+  {0X4EF7DF80D830D6D5, 0X4E822204DABE992A},  // 178
+  {0X62B5D7610E3D0C8B, 0X0222AA86116E3F75},  // 179
+  {0X7B634D3951CC4FAD, 0X62AB552795C9CF52},  // 180
+  {0X4D1E1043D31FB1CC, 0X4DAB1538BD9E2193},  // 181
+  {0X60659454C7E79E3F, 0X6115DA86ED05A9F8},  // 182
+  {0X787EF969F9E185CF, 0X595B5128A8471476},  // 183
+  {0X4B4F5BE23C2CF3A1, 0X67D912B9692C6CCA},  // 184
+  {0X5E2332DACB38308A, 0X21CF5767C37787FC},  // 185
+  {0X75ABFF917E063CAC, 0X6A432D41B45569FB},  // 186
+  {0X498B7FBAEEC3E5EC, 0X0269FC4910B5623D},  // 187
+  {0X5BEE5FA9AA74DF67, 0X03047B5B54E2BACC},  // 188
+  {0X72E9F79415121740, 0X63C59A322A1B697F},  // 189
+  {0X47D23ABC8D2B4E88, 0X3E5B805F5A5121F0},  // 190
+  {0X59C6C96BB076222A, 0X4DF2607730E56A6C},  // 191
+  {0X70387BC69C93AAB5, 0X216EF894FD1EC506},  // 192
+  {0X46234D5C21DC4AB1, 0X24E55B5D1E333B24},  // 193
+  {0X57AC20B32A535D5D, 0X4E1EB23465C009ED},  // 194
+  {0X6D9728DFF4E834B5, 0X01A65EC17F300C68},  // 195
+  {0X447E798BF91120F1, 0X1107FB38EF7E07C1},  // 196
+  {0X559E17EEF755692D, 0X3549FA072B5D89B1},  // 197
+  {0X6B059DEAB52AC378, 0X629C7888F634EC1E},  // 198
+  {0X42E382B2B13ABA2B, 0X3DA1CB5599E11393},  // 199
+  {0X539C635F5D8968B6, 0X2D0A3E2B00595877},  // 200
+  {0X68837C3734EBC2E3, 0X784CCDB5C06FAE95},  // 201
+  {0X41522DA2811359CE, 0X3B3000919845CD1D},  // 202
+  {0X51A6B90B21583042, 0X09FC00B5FE574065},  // 203
+  {0X6610674DE9AE3C52, 0X4C7B00E37DED107E},  // 204
+  {0X7F9481216419CB67, 0X1F99C11C5D68549D},  // 205
+  {0X4FBCD0B4DE901F20, 0X43C018B1BA6134E2},  // 206
+  {0X63AC04E2163426E8, 0X54B01EDE28F9821B},  // 207
+  {0X7C97061A9BC130A2, 0X69DC2695B337E2A1},  // 208
+  {0X4DDE63D0A158BE65, 0X6229981D9002EDA5},  // 209
+  {0X6155FCC4C9AEEDFF, 0X1AB3FE24F403A90E},  // 210
+  {0X79AB7BF5FC1AA97F, 0X0160FDAE31049351},  // 211
+  {0X4C0B2D79BD90A9EF, 0X30DC9E8CDEA2DC13},  // 212
+  {0X5F0DF8D82CF4D46B, 0X1D13C630164B9318},  // 213
+  {0X76D1770E38320986, 0X0458B7BC1BDE77DD},  // 214
+  {0X4A42EA68E31F45F3, 0X62B772D5916B0AEB},  // 215
+  {0X5CD3A5031BE71770, 0X5B654F8AF5C5CDA5},  // 216
+  {0X74088E43E2E0DD4C, 0X723EA36DB337410E},  // 217
+  {0X488558EA6DCC8A50, 0X07672624900288A9},  // 218
+  {0X5AA6AF25093FACE4, 0X0940EFADB4032AD3},  // 219
+  {0X71505AEE4B8F981D, 0X0B912B992103F588},  // 220
+  {0X46D238D4EF39BF12, 0X173ABB3FB4A27975},  // 221
+  {0X5886C70A2B082ED6, 0X5D096A0FA1CB17D2},  // 222
+  {0X6EA878CCB5CA3A8C, 0X344BC4938A3DDDC7},  // 223
+  {0X45294B7FF19E6497, 0X60AF5ADC3666AA9C},  // 224
+  {0X56739E5FEE05FDBD, 0X58DB319344005543},  // 225
+  {0X6C1085F7E9877D2D, 0X0F11FDF815006A94},  // 226
+  {0X438A53BAF1F4AE3C, 0X196B3EBB0D20429D},  // 227
+  {0X546CE8A9AE71D9CB, 0X1FC60E69D0685344},  // 228
+  {0X698822D41A0E503E, 0X07B7920444826815},  // 229
+  {0X41F515C49048F226, 0X64D2BB42AAD1810D},  // 230
+  {0X52725B35B45B2EB0, 0X3E076A135585E150},  // 231
+  {0X670EF2032171FA5C, 0X4D8944982AE759A4},  // 232
+  {0X40695741F4E73C79, 0X7075CADF1AD09807},  // 233
+  {0X5083AD1272210B98, 0X2C933D96E184BE08},  // 234
+  {0X64A498570EA94E7E, 0X37B80CFC99E5ED8A},  // 235
+  {0X7DCDBE6CD253A21E, 0X05A6103BC05F68ED},  // 236
+  {0X4EA0970403744552, 0X6387CA25583BA194},  // 237
+  {0X6248BCC5045156A7, 0X3C69BCAEAE4A89F9},  // 238
+  {0X7ADAEBF64565AC51, 0X2B842BDA59DD2C77},  // 239
+  {0X4CC8D379EB5F8BB2, 0X6B329B68782A3BCB},  // 240
+  {0X5FFB085866376E9F, 0X45FF42429634CABD},  // 241
+  {0X77F9CA6E7FC54A47, 0X377F12D33BC1FD6D},  // 242
+  {0X4AFC1E850FDB4E6C, 0X52AF6BC405593E64},  // 243
+  {0X5DBB262653D22207, 0X675B46B506AF8DFD},  // 244
+  {0X7529EFAFE8C6AA89, 0X61321862485B717C},  // 245
+  {0X493A35CDF17C2A96, 0X0CBF4F3D6D3926EE},  // 246
+  {0X5B88C3416DDB353B, 0X4FEF230CC88770A9},  // 247
+  {0X726AF411C952028A, 0X43EAEBCFFAA94CD3},  // 248
+  {0X4782D88B1DD34196, 0X4A72D361FCA9D004},  // 249
+  {0X59638EADE54811FC, 0X1D0F883A7BD44405},  // 250
+  {0X6FBC72595E9A167B, 0X24536A491AC95506},  // 251
+  {0X45D5C777DB204E0D, 0X06B4226DB0BDD524},  // 252
+  {0X574B3955D1E86190, 0X28612B091CED4A6D},  // 253
+  {0X6D1E07AB466279F4, 0X327975CB64289D08},  // 254
+  {0X4432C4CB0BFD8C38, 0X5F8BE99F1E996225},  // 255
+  {0X553F75FDCEFCEF46, 0X776EE406E63FBAAE},  // 256
+  {0X6A8F537D42BC2B18, 0X554A9D089FCFA95A},  // 257
+  {0X4299942E49B59AEF, 0X354EA22563E1C9D8},  // 258
+  {0X533FF939DC2301AB, 0X22A24AAEBCDA3C4E},  // 259
+  {0X680FF788532BC216, 0X0B4ADD5A6C10CB62},  // 260
+  {0X4109FAB533FB594D, 0X670ECA58838A7F1D},  // 261
+  {0X514C796280FA2FA1, 0X20D27CEEA46D1EE4},  // 262
+  {0X659F97BB2138BB89, 0X49071C2A4D88669D},  // 263
+  {0X7F077DA9E986EA6B, 0X7B48E334E0EA8045},  // 264
+  {0X4F64AE8A31F45283, 0X3D0D8E010C92902B},  // 265
+  {0X633DDA2CBE716724, 0X2C50F1814FB73436},  // 266
+  {0X7C0D50B7EE0DC0ED, 0X37652DE1A3A50143},  // 267
+  {0X4D885272F4C89894, 0X329F3CAD064720CA},  // 268
+  {0X60EA670FB1FABEB9, 0X3F470BD847D8E8FD},  // 269
+  {0X792500D39E796E67, 0X6F18CECE59CF233C},  // 270
+  {0X4BB72084430BE500, 0X756F8140F8217605},  // 271
+  {0X5EA4E8A553CEDE41, 0X12CB61913629D387},  // 272
+  {0X764E22CEA8C295D1, 0X377E39F583B44868},  // 273
+  {0X49F0D5C129799DA2, 0X72AEE4397250AD41},  // 274
+  {0X5C6D0B3173D8050B, 0X4F5A9D47CEE4D891},  // 275
+  {0X73884DFDD0CE064E, 0X43314499C29E0EB6},  // 276
+  {0X483530BEA280C3F1, 0X09FECAE019A2C932},  // 277
+  {0X5A427CEE4B20F4ED, 0X2C7E7D98200B7B7E},  // 278
+  {0X70D31C29DDE93228, 0X579E1CFE280E5A5D},  // 279
+  {0X4683F19A2AB1BF59, 0X36C2D21ED908F87B},  // 280
+  {0X5824EE00B55E2F2F, 0X647386A68F4B3699},  // 281
+  {0X6E2E2980E2B5BAFB, 0X5D906850331E043F},  // 282
+  {0X44DCD9F08DB194DD, 0X2A7A41321FF2C2A8},  // 283
+  {0X5614106CB11DFA14, 0X5518D17EA7EF7352},  // 284
+  {0X6B991487DD657899, 0X6A5F05DE51EB5026},  // 285
+  {0X433FACD4EA5F6B60, 0X127B63AAF3331218},  // 286
+  {0X540F980A24F74638, 0X171A3C95AFFFD69E},  // 287
+  {0X69137E0CAE3517C6, 0X1CE0CBBB1BFFCC45},  // 288
+  {0X41AC2EC7ECE12EDB, 0X720C7F54F17FDFAB},  // 289
+  {0X52173A79E8197A92, 0X6E8F9F2A2DDFD796},  // 290
+  {0X669D0918621FD937, 0X4A3386F4B957CD7B},  // 291
+  {0X402225AF3D53E7C2, 0X5E603458F3D6E06D},  // 292
+  {0X502AAF1B0CA8E1B3, 0X35F8416F30CC9888},  // 293
+  {0X64355AE1CFD31A20, 0X237651CAFCFFBEAA},  // 294
+  {0X7D42B19A43C7E0A8, 0X2C53E63DBC3FAE55},  // 295
+  {0X4E49AF006A5CEC69, 0X1BB46FE695A7CCF5},  // 296
+  {0X61DC1AC084F42783, 0X42A18BE03B11C033},  // 297
+  {0X7A532170A6313164, 0X3349EED849D6303F},  // 298
+  {0X4C73F4E667DEBEDE, 0X600E35472E25DE28},  // 299
+  {0X5F90F22001D66E96, 0X3811C298F9AF55B1},  // 300
+  {0X77752EA8024C0A3C, 0X0616333F381B2B1E},  // 301
+  {0X4AA93D29016F8665, 0X43CDE0078310FAF3},  // 302
+  {0X5D538C7341CB67FE, 0X74C1580963D539AF},  // 303
+  {0X74A86F90123E41FE, 0X51F1AE0BBCCA881B},  // 304
+  {0X48E945BA0B66E93F, 0X13370CC755FE9511},  // 305
+  {0X5B2397288E40A38E, 0X7804CFF92B7E3A55},  // 306
+  {0X71EC7CF2B1D0CC72, 0X560603F7765DC8EA},  // 307
+  {0X4733CE17AF227FC7, 0X55C3C27AA9FA9D93},  // 308
+  {0X5900C19D9AEB1FB9, 0X4B34B319547944F7},  // 309
+  {0X6F40F20501A5E7A7, 0X7E01DFDFA9979635},  // 310
+  {0X458897432107B0C8, 0X7EC12BEBC9FEBDE1},  // 311
+  {0X56EABD13E9499CFB, 0X1E7176E6BC7E6D59},  // 312
+  {0X6CA56C58E39C043A, 0X060DD4A06B9E08B0},  // 313
+  {0X43E763B78E4182A4, 0X23C8A4E44342C56E},  // 314
+  {0X54E13CA571D1E34D, 0X2CBACE1D541376C9},  // 315
+  {0X6A198BCECE465C20, 0X57E981A4A918547B},  // 316
+  {0X424FF76140EBF994, 0X36F1F106E9AF34CD},  // 317
+  {0X52E3F5399126F7F9, 0X44AE6D48A41B0201},  // 318
+  {0X679CF287F570B5F7, 0X75DA089ACD21C281},  // 319
+  {0X40C21794F96671BA, 0X79A84560C0351991},  // 320
+  {0X50F29D7A37C00E29, 0X581256B8F0425FF5},  // 321
+  {0X652F44D8C5B011B4, 0X0E16EC672C52F7F2},  // 322
+  {0X7E7B160EF71C1621, 0X119CA780F767B5EE},  // 323
+  {0X4F0CEDC95A718DD4, 0X5B01E8B09AA0D1B5}   // 324
+};
+//------------------------------------------------------------------------------
+static void pow10G(int16_t e, uint64_t* g1, uint64_t* g0) {
+  *g1 = pow10Table[e - POW10_MIN][0];
+  *g0 = pow10Table[e - POW10_MIN][1];
+}
+#endif  // USE_SMALL_DOUBLE_TABLE
+//------------------------------------------------------------------------------
+static uint64_t pow5(uint8_t n) {
+  return pow5Table[n];
+}
+//------------------------------------------------------------------------------
+static uint64_t rop(uint64_t g1, uint64_t g0, uint64_t cp) {
+  const uint64_t MASK63 = 0X7FFFFFFFFFFFFFFF;
+  uint64_t x1 = mulHigh(g0, cp);
+  uint64_t y1;
+  uint64_t y0 = mul128(g1, cp, &y1);
+  uint64_t z = (y0 >> 1) + x1;
+  uint64_t vbp = y1 + (z >> 63);
+  return vbp | (((z & MASK63) + MASK63) >> 63);
+}
+//------------------------------------------------------------------------------
+// Shortest decimal f*10^exp in the rounding interval of c*2^q.
+static uint64_t shortestDouble(int16_t q, uint64_t c, int16_t* exp) {
+  const uint64_t C_MIN = UINT64_C(1) << 52;
+  const int16_t Q_MIN = -1074;
+  uint64_t out = c & 1;
+  uint64_t cb = c << 2;
+  uint64_t cbr = cb + 2;
+  uint64_t cbl;
+  int16_t k;
+  if (c != C_MIN || q == Q_MIN) {
+    cbl = cb - 2;
+    k = flog10pow2(q);
+  } else {
+    cbl = cb - 1;
+    k = flog10ThreeQuartersPow2(q);
+  }
+  uint8_t h = q + flog2pow10(-k) + 2;
+  uint64_t g1;
+  uint64_t g0;
+  pow10G(-k, &g1, &g0);
+  uint64_t vb = rop(g1, g0, cb << h);
+  uint64_t vbl = rop(g1, g0, cbl << h);
+  uint64_t vbr = rop(g1, g0, cbr << h);
+  uint64_t s = vb >> 2;
+  // Java allows two digits here, test s >= 10 so the result is shortest.
+  if (s >= 10) {
+    // s/10 for s < 2^64/10
+    uint64_t sp10 = 10*mulHigh(s, UINT64_C(0X19999999999999A0));
+    uint64_t tp10 = sp10 + 10;
+    bool upin = vbl + out <= sp10 << 2;
+    bool wpin = (tp10 << 2) + out <= vbr;
+    if (upin != wpin) {
+      *exp = k;
+      return upin ? sp10 : tp10;
+    }
+  }
+  uint64_t t = s + 1;
+  bool uin = vbl + out <= s << 2;
+  bool win = (t << 2) + out <= vbr;
+  *exp = k;
+  if (uin != win) {
+    return uin ? s : t;
+  }
+  int64_t cmp = vb - ((s + t) << 1);
+  return cmp < 0 || (cmp == 0 && (s & 1) == 0) ? s : t;
+}
+//------------------------------------------------------------------------------
+static uint64_t shortest(double value, int16_t* exp) {
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  uint64_t t = bits & ((UINT64_C(1) << 52) - 1);
+  int16_t bq = bits >> 52;
+  if (bq) {
+    int16_t mq = 1075 - bq;
+    uint64_t c = t | (UINT64_C(1) << 52);
+    // integer values
+    if (0 < mq && mq < 53) {
+      uint64_t f = c >> mq;
+      if (f << mq == c) {
+        *exp = 0;
+        return f;
+      }
+    }
+    return shortestDouble(-mq, c, exp);
+  }
+  // subnormal, 5e-324 and 1e-323 are too close to zero for the algorithm
+  if (t < 3) {
+    *exp = -324;
+    return 5*t;
+  }
+  return shortestDouble(-1074, t, exp);
+}
+#elif DBL_MANT_DIG == 24
+//------------------------------------------------------------------------------
+static uint64_t pow5(uint8_t n) {
+  uint64_t p = 1;
+  while (n--) {
+    p *= 5;
+  }
+  return p;
+}
+#else  // DBL_MANT_DIG
+#error unsupported double format
+#endif  // DBL_MANT_DIG
+//==============================================================================
+// Table of g1 + 1 for float values.
+const int16_t FLT_POW10_MIN = -31;
+const int16_t FLT_POW10_MAX = 45;
+#ifdef __AVR__
+static const uint64_t pow10Float[] PROGMEM = {
+#else  // __AVR__
+static const uint64_t pow10Float[] = {
+#endif  // __AVR__
+  0X40E7599625A1FE7B,  // -31
+  0X51212FFBAF0A7E19,  // -30
+  0X65697BFA9ACD1DA0,  // -29
+  0X7EC3DAF941806507,  // -28
+  0X4F3A68DBC8F03F25,  // -27
+  0X63090312BB2C4EEE,  // -26
+  0X7BCB43D769F762A9,  // -25
+  0X4D5F0A66A23A9DAA,  // -24
+  0X60B6CD004AC94514,  // -23
+  0X78E480405D7B9659,  // -22
+  0X4B8ED0283A6D3DF8,  // -21
+  0X5E72843249088D76,  // -20
+  0X760F253EDB4AB0D3,  // -19
+  0X49C97747490EAE84,  // -18
+  0X5C3BD5191B525A25,  // -17
+  0X734ACA5F6226F0AE,  // -16
+  0X480EBE7B9D58566D,  // -15
+  0X5A126E1A84AE6C08,  // -14
+  0X709709A125DA070A,  // -13
+  0X465E6604B7A84466,  // -12
+  0X57F5FF85E5925580,  // -11
+  0X6DF37F675EF6EAE0,  // -10
+  0X44B82FA09B5A52CC,  // -9
+  0X55E63B88C230E77F,  // -8
+  0X6B5FCA6AF2BD215F,  // -7
+  0X431BDE82D7B634DB,  // -6
+  0X53E2D6238DA3C212,  // -5
+  0X68DB8BAC710CB296,  // -4
+  0X4189374BC6A7EF9E,  // -3
+  0X51EB851EB851EB86,  // -2
+  0X6666666666666667,  // -1
+  0X4000000000000001,  // 0
+  0X5000000000000001,  // 1
+  0X6400000000000001,  // 2
+  0X7D00000000000001,  // 3
+  0X4E20000000000001,  // 4
+  0X61A8000000000001,  // 5
+  0X7A12000000000001,  // 6
+  0X4C4B400000000001,  // 7
+  0X5F5E100000000001,  // 8
+  0X7735940000000001,  // 9
+  0X4A817C8000000001,  // 10
+  0X5D21DBA000000001,  // 11
+  0X746A528800000001,  // 12
+  0X48C2739500000001,  // 13
+  0X5AF3107A40000001,  // 14
+  0X71AFD498D0000001,  // 15
+  0X470DE4DF82000001,  // 16
+  0X58D15E1762800001,  // 17
+  0X6F05B59D3B200001,  // 18
+  0X4563918244F40001,  // 19
+  0X56BC75E2D6310001,  // 20
+  0X6C6B935B8BBD4001,  // 21
+  0X43C33C1937564801,  // 22
+  0X54B40B1F852BDA01,  // 23
+  0X69E10DE76676D081,  // 24
+  0X422CA8B0A00A4251,  // 25
+  0X52B7D2DCC80CD2E5,  // 26
+  0X6765C793FA10079E,  // 27
+  0X409F9CBC7C4A04C3,  // 28
+  0X50C783EB9B5C85F3,  // 29
+  0X64F964E68233A770,  // 30
+  0X7E37BE2022C0914C,  // 31
+  0X4EE2D6D415B85ACF,  // 32
+  0X629B8C891B267183,  // 33
+  0X7B426FAB61F00DE4,  // 34
+  0X4D0985CB1D3608AF,  // 35
+  0X604BE73DE4838ADA,  // 36
+  0X785EE10D5DA46D91,  // 37
+  0X4B3B4CA85A86C47B,  // 38
+  0X5E0A1FD271287599,  // 39
+  0X758CA7C70D7292FF,  // 40
+  0X4977E8DC68679BE0,  // 41
+  0X5BD5E313828182D7,  // 42
+  0X72CB5BD86321E38D,  // 43
+  0X47BF19673DF52E38,  // 44
+  0X59AEDFC10D7279C6   // 45
+};
+//------------------------------------------------------------------------------
+static uint64_t floatG(int16_t e) {
+#ifdef __AVR__
+  uint64_t g;
+  memcpy_P(&g, &pow10Float[e - FLT_POW10_MIN], sizeof(g));
+  return g;
+#else  // __AVR__
+  return pow10Float[e - FLT_POW10_MIN];
+#endif  // __AVR__
+}
+//------------------------------------------------------------------------------
+static uint32_t ropFloat(uint64_t g, uint64_t cp) {
+  const uint64_t MASK32 = 0XFFFFFFFF;
+  uint64_t x1 = mulHigh(g, cp);
+  return (x1 >> 31) | (((x1 & MASK32) + MASK32) >> 32);
+}
+//------------------------------------------------------------------------------
+// Shortest decimal f*10^exp in the rounding interval of c*2^q.
+static uint32_t shortestFloat(int16_t q, uint32_t c, int16_t* exp) {
+  const uint32_t C_MIN = UINT32_C(1) << 23;
+  const int16_t Q_MIN = -149;
+  uint32_t out = c & 1;
+  uint64_t cb = (uint64_t)c << 2;
+  uint64_t cbr = cb + 2;
+  uint64_t cbl;
+  int16_t k;
+  if (c != C_MIN || q == Q_MIN) {
+    cbl = cb - 2;
+    k = flog10pow2(q);
+  } else {
+    cbl = cb - 1;
+    k = flog10ThreeQuartersPow2(q);
+  }
+  uint8_t h = q + flog2pow10(-k) + 33;
+  uint64_t g = floatG(-k);
+  uint32_t vb = ropFloat(g, cb << h);
+  uint32_t vbl = ropFloat(g, cbl << h);
+  uint32_t vbr = ropFloat(g, cbr << h);
+  uint32_t s = vb >> 2;
+  if (s >= 10) {
+    uint32_t sp10 = 10*(uint32_t)((s*UINT64_C(1717986919)) >> 34);
+    uint32_t tp10 = sp10 + 10;
+    bool upin = vbl + out <= sp10 << 2;
+    bool wpin = (tp10 << 2) + out <= vbr;
+    if (upin != wpin) {
+      *exp = k;
+      return upin ? sp10 : tp10;
+    }
+  }
+  uint32_t t = s + 1;
+  bool uin = vbl + out <= s << 2;
+  bool win = (t << 2) + out <= vbr;
+  *exp = k;
+  if (uin != win) {
+    return uin ? s : t;
+  }
+  int32_t cmp = vb - ((s + t) << 1);
+  return cmp < 0 || (cmp == 0 && (s & 1) == 0) ? s : t;
+}
+//------------------------------------------------------------------------------
+static uint32_t shortest(float value, int16_t* exp) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  uint32_t t = bits & ((UINT32_C(1) << 23) - 1);
+  int16_t bq = bits >> 23;
+  if (bq) {
+    int16_t mq = 150 - bq;
+    uint32_t c = t | (UINT32_C(1) << 23);
+    // integer values
+    if (0 < mq && mq < 24) {
+      uint32_t f = c >> mq;
+      if (f << mq == c) {
+        *exp = 0;
+        return f;
+      }
+    }
+    return shortestFloat(-mq, c, exp);
+  }
+  // subnormal, shortest for t*2^-149 with t < 8 is tiny[t]*10^-45
+  if (t < 8) {
+    static const uint8_t tiny[] = {0, 1, 3, 4, 6, 7, 8, 10};
+    *exp = -45;
+    return tiny[t];
+  }
+  return shortestFloat(-149, t, exp);
+}
+#if DBL_MANT_DIG == 24
+//------------------------------------------------------------------------------
+static uint32_t shortest(double value, int16_t* exp) {
+  return shortest(static_cast<float>(value), exp);
+}
+#endif  // DBL_MANT_DIG == 24
+//==============================================================================
+// Exact conversion.
+//------------------------------------------------------------------------------
+// Split positive value into c*2^q.
+static uint64_t split(double value, int16_t* q) {
+#if DBL_MANT_DIG == 53
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  uint64_t c = bits & ((UINT64_C(1) << 52) - 1);
+  int16_t bq = bits >> 52;
+  if (bq) {
+    c |= UINT64_C(1) << 52;
+    bq--;
+  }
+  *q = bq - 1074;
+#else  // DBL_MANT_DIG == 53
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  uint32_t c = bits & ((UINT32_C(1) << 23) - 1);
+  int16_t bq = bits >> 23;
+  if (bq) {
+    c |= UINT32_C(1) << 23;
+    bq--;
+  }
+  *q = bq - 149;
+#endif  // DBL_MANT_DIG == 53
+  return c;
+}
+//------------------------------------------------------------------------------
+// Compare hi:lo, less than 2^n, with 2^(n - 1).
+static int8_t cmpHalf(uint64_t hi, uint64_t lo, uint8_t n) {
+  if (!hi && !lo) {
+    return RND_ZERO;
+  }
+  uint64_t halfHi = n > 64 ? UINT64_C(1) << (n - 65) : 0;
+  uint64_t halfLo = n > 64 ? 0 : UINT64_C(1) << (n - 1);
+  if (hi != halfHi) {
+    return hi < halfHi ? -1 : 1;
+  }
+  return lo < halfLo ? -1 : lo > halfLo ? 1 : 0;
+}
+//------------------------------------------------------------------------------
+// Return floor(hi:lo/2^n) and compare the remainder with 2^(n - 1).
+static uint64_t shiftRound(uint64_t hi, uint64_t lo, uint8_t n, int8_t* rnd) {
+  uint64_t r;
+  if (n < 64) {
+    r = (hi << (64 - n)) | (lo >> n);
+    lo &= (UINT64_C(1) << n) - 1;
+    hi = 0;
+  } else if (n == 64) {
+    r = hi;
+    hi = 0;
+  } else {
+    r = hi >> (n - 64);
+    hi &= (UINT64_C(1) << (n - 64)) - 1;
+  }
+  *rnd = cmpHalf(hi, lo, n);
+  return r;
+}
+//------------------------------------------------------------------------------
+// Big integer for the rare conversions that need more than 128 bits.
+const uint8_t BIG_WORDS = (DBL_MANT_DIG - DBL_MIN_EXP + 128)/32;
+struct FmtBig {
+  uint32_t w[BIG_WORDS];
+  uint8_t n;
+};
+//------------------------------------------------------------------------------
+static void bigSet(FmtBig* b, uint64_t v) {
+  for (b->n = 0; v; v >>= 32) {
+    b->w[b->n++] = v;
+  }
+}
+//------------------------------------------------------------------------------
+static void bigMul(FmtBig* b, uint32_t m) {
+  uint32_t carry = 0;
+  for (uint8_t i = 0; i < b->n; i++) {
+    uint64_t t = (uint64_t)b->w[i]*m + carry;
+    b->w[i] = t;
+    carry = t >> 32;
+  }
+  if (carry) {
+    b->w[b->n++] = carry;
+  }
+}
+//------------------------------------------------------------------------------
+static void bigShl(FmtBig* b, uint16_t n) {
+  if (!b->n) {
+    return;
+  }
+  uint8_t k = n/32;
+  uint8_t r = n%32;
+  if (r) {
+    uint32_t top = b->w[b->n - 1] >> (32 - r);
+    for (uint8_t i = b->n - 1; i > 0; i--) {
+      b->w[i + k] = (b->w[i] << r) | (b->w[i - 1] >> (32 - r));
+    }
+    b->w[k] = b->w[0] << r;
+    b->n += k;
+    if (top) {
+      b->w[b->n++] = top;
+    }
+  } else {
+    for (uint8_t i = b->n; i-- > 0;) {
+      b->w[i + k] = b->w[i];
+    }
+    b->n += k;
+  }
+  memset(b->w, 0, 4*k);
+}
+//------------------------------------------------------------------------------
+static void bigShr1(FmtBig* b) {
+  for (uint8_t i = 0; i < b->n; i++) {
+    b->w[i] >>= 1;
+    if (i + 1 < b->n) {
+      b->w[i] |= b->w[i + 1] << 31;
+    }
+  }
+  if (b->n && !b->w[b->n - 1]) {
+    b->n--;
+  }
+}
+//------------------------------------------------------------------------------
+static int8_t bigCmp(const FmtBig* a, const FmtBig* b) {
+  if (a->n != b->n) {
+    return a->n < b->n ? -1 : 1;
+  }
+  for (uint8_t i = a->n; i-- > 0;) {
+    if (a->w[i] != b->w[i]) {
+      return a->w[i] < b->w[i] ? -1 : 1;
+    }
+  }
+  return 0;
+}
+//------------------------------------------------------------------------------
+// a -= b for a >= b
+static void bigSub(FmtBig* a, const FmtBig* b) {
+  uint32_t borrow = 0;
+  for (uint8_t i = 0; i < a->n; i++) {
+    uint64_t t = (uint64_t)a->w[i] - (i < b->n ? b->w[i] : 0) - borrow;
+    a->w[i] = t;
+    borrow = (t >> 32) & 1;
+  }
+  while (a->n && !a->w[a->n - 1]) {
+    a->n--;
+  }
+}
+//------------------------------------------------------------------------------
+// Return floor(c*2^q*10^s), less than 2^60, and compare the
+// remainder with one half.
+static uint64_t scaleTen(uint64_t c, int16_t q, int16_t s, int8_t* rnd) {
+  if (0 <= s && s < 28) {
+    uint64_t hi;
+    uint64_t lo = mul128(c, pow5(s), &hi);
+    int16_t n = -(q + s);
+    if (n <= 0) {
+      *rnd = RND_ZERO;
+      return lo << -n;
+    }
+    if (n < 128) {
+      return shiftRound(hi, lo, n, rnd);
+    }
+  } else if (-28 < s && s < 0) {
+    uint64_t p = pow5(-s);
+    int16_t n = -s - q;
+    if (n <= 0) {
+      if (64 - __builtin_clzll(c) - n < 64) {
+        c <<= -n;
+        uint64_t r = c%p;
+        *rnd = r ? (2*r > p ? 1 : -1) : RND_ZERO;
+        return c/p;
+      }
+    } else if (n < 64) {
+      // floor(c/(p*2^n)) = floor(floor(c/2^n)/p)
+      uint64_t c0 = c & ((UINT64_C(1) << n) - 1);
+      uint64_t r = (c >> n)%p;
+      if (2*r > p) {
+        *rnd = 1;
+      } else if (2*r + 1 == p) {
+        *rnd = cmpHalf(0, c0, n);
+        if (*rnd == RND_ZERO) {
+          *rnd = -1;
+        }
+      } else {
+        *rnd = r || c0 ? -1 : RND_ZERO;
+      }
+      return (c >> n)/p;
+    }
+  }
+  FmtBig num;
+  FmtBig den;
+  bigSet(&num, c);
+  bigSet(&den, 1);
+  FmtBig* b = s > 0 ? &num : &den;
+  for (uint16_t n = s < 0 ? -s : s; n;) {
+    uint8_t m = n < 13 ? n : 13;
+    bigMul(b, pow5(m));
+    n -= m;
+  }
+  if (q + s > 0) {
+    bigShl(&num, q + s);
+  } else {
+    bigShl(&den, -(q + s));
+  }
+  // binary long division
+  bigShl(&den, 60);
+  uint64_t d = 0;
+  for (uint8_t i = 0; i <= 60; i++) {
+    d <<= 1;
+    if (bigCmp(&num, &den) >= 0) {
+      bigSub(&num, &den);
+      d |= 1;
+    }
+    if (i < 60) {
+      bigShr1(&den);
+    }
+  }
+  if (!num.n) {
+    *rnd = RND_ZERO;
+  } else {
+    bigShl(&num, 1);
+    *rnd = bigCmp(&num, &den);
+  }
+  return d;
+}
+//------------------------------------------------------------------------------
+// Round c*2^q to prec + 1 significant digits d*10^(exp - prec).
+static uint64_t expDigits(uint64_t c, int16_t q, uint8_t prec, int16_t* exp) {
+  if (!c) {
+    *exp = 0;
+    return 0;
+  }
+  int16_t k = flog10pow2(q + 63 - __builtin_clzll(c));
+  int8_t rnd;
+  uint64_t d = scaleTen(c, q, prec - k, &rnd);
+  uint64_t lim = pow10(prec + 1);
+  bool up;
+  if (d >= lim) {
+    uint8_t r = d%10;
+    d /= 10;
+    k++;
+    up = r > 5 || (r == 5 && (rnd != RND_ZERO || (d & 1)));
+  } else {
+    up = rnd > 0 || (rnd == 0 && (d & 1));
+  }
+  d += up;
+  if (d >= lim) {
+    d /= 10;
+    k++;
+  }
+  *exp = k;
+  return d;
+}
+//------------------------------------------------------------------------------
+// Next fraction digit of hi:lo/2^n.
+static uint8_t nextDigit(uint64_t* hi, uint64_t* lo, uint8_t n) {
+  if (n < 61) {
+    // hi is zero and 10*lo is less than 2^64
+    uint64_t t = 10*(*lo);
+    *lo = t & ((UINT64_C(1) << n) - 1);
+    return t >> n;
+  }
+  uint64_t h;
+  uint64_t l = mul128(*lo, 10, &h);
+  h += 10*(*hi);
+  if (n < 64) {
+    *hi = 0;
+    *lo = l & ((UINT64_C(1) << n) - 1);
+    return (h << (64 - n)) | (l >> n);
+  }
+  *lo = l;
+  if (n == 64) {
+    *hi = 0;
+    return h;
+  }
+  *hi = h & ((UINT64_C(1) << (n - 64)) - 1);
+  return h >> (n - 64);
+}
+//==============================================================================
+// Decimal to binary conversion.
+//
+// Most values are rounded with the Eisel-Lemire method, w*10^q is
+// multiplied by a 128-bit lower bound for 10^q.  Values too close to a
+// rounding boundary are rounded exactly with scaleTen() and cmpDigits().
+//------------------------------------------------------------------------------
+/** Binary floating point format for scan results. */
+struct ScanFmt {
+  /** Significand bits including the hidden bit. */
+  uint8_t mant;
+  /** Exponent of the smallest subnormal. */
+  int16_t emin;
+  /** Largest exponent e for finite m*2^e. */
+  int16_t emax;
+};
+const ScanFmt SCAN_FLOAT = {24, -149, 104};
+#if DBL_MANT_DIG == 53
+const ScanFmt SCAN_DOUBLE = {53, -1074, 971};
+#endif  // DBL_MANT_DIG == 53
+/** Significant digits kept in ScanNum::w. */
+const uint8_t SCAN_MAX_DIGITS = 19;
+/** Largest exponent field value. */
+const int16_t SCAN_MAX_EXP = 9999;
+/** Decimal number parsed by scanDecimal(). */
+struct ScanNum {
+  /** First SCAN_MAX_DIGITS significant digits. */
+  uint64_t w;
+  /** Value is w*10^q. */
+  int32_t q;
+  /** Nonzero digits follow the SCAN_MAX_DIGITS digits in w. */
+  bool trunc;
+  /** Value is negative. */
+  bool neg;
+  /** First significant digit if trunc is true. */
+  const char* digits;
+  /** End of the significand. */
+  const char* end;
+};
+//------------------------------------------------------------------------------
+// Parse [+-]ddd[.ddd][e[+-]ddd] and return the end or nullptr for no digits.
+static const char* scanDecimal(const char* str, ScanNum* num) {
+  uint64_t w = 0;
+  int32_t q = 0;
+  bool trunc = false;
+  while (isSpace(*str)) {
+    str++;
+  }
+  num->neg = *str == '-';
+  if (*str == '-' || *str == '+') {
+    str++;
+  }
+  const char* bgn = str;
+  while (isDigit(*str)) {
+    w = 10*w + *str++ - '0';
+  }
+  int32_t nd = str - bgn;
+  if (*str == '.') {
+    const char* frac = ++str;
+    while (isDigit(*str)) {
+      w = 10*w + *str++ - '0';
+    }
+    q = frac - str;
+    nd -= q;
+  }
+  if (!nd) {
+    return nullptr;
+  }
+  num->end = str;
+  if (nd > SCAN_MAX_DIGITS) {
+    // Rescan for the first SCAN_MAX_DIGITS significant digits.
+    bool dot = false;
+    w = 0;
+    q = 0;
+    nd = 0;
+    for (const char* ptr = bgn; ptr < num->end; ptr++) {
+      if (*ptr == '.') {
+        dot = true;
+      } else if (!nd && *ptr == '0') {
+        q -= dot;
+      } else if (nd < SCAN_MAX_DIGITS) {
+        if (!nd) {
+          num->digits = ptr;
+        }
+        w = 10*w + *ptr - '0';
+        nd++;
+        q -= dot;
+      } else {
+        trunc |= *ptr != '0';
+        q += !dot;
+      }
+    }
+  }
+  if (*str == 'e' || *str == 'E') {
+    const char* ptr = str + 1;
+    bool expNeg = *ptr == '-';
+    if (*ptr == '-' || *ptr == '+') {
+      ptr++;
+    }
+    if (isDigit(*ptr)) {
+      int16_t exp = 0;
+      for (; isDigit(*ptr); ptr++) {
+        if (exp < SCAN_MAX_EXP/10) {
+          exp = 10*exp + *ptr - '0';
+        }
+      }
+      q += expNeg ? -exp : exp;
+      str = ptr;
+    }
+  }
+  num->w = w;
+  num->q = q;
+  num->trunc = trunc;
+  return str;
+}
+//------------------------------------------------------------------------------
+// Lower bound hi:lo*2^(flog2pow10(e) - 127) for 10^e with hi >= 2^63.
+// Return zero if e is not in the table or n with an error less than 2^n.
+static uint8_t pow10Bound(int16_t e, uint64_t* hi, uint64_t* lo) {
+#if DBL_MANT_DIG == 53
+  if (e < POW10_MIN || e > POW10_MAX) {
+    return 0;
+  }
+  uint64_t g1;
+  uint64_t g0;
+  pow10G(e, &g1, &g0);
+  // floor(10^e*2^-r) is g - 1
+  if (g0-- == 0) {
+    g0 = 0X7FFFFFFFFFFFFFFF;
+    g1--;
+  }
+  *hi = (g1 << 1) | (g0 >> 62);
+  *lo = g0 << 2;
+  return 2;
+#else  // DBL_MANT_DIG == 53
+  if (e < FLT_POW10_MIN || e > FLT_POW10_MAX) {
+    return 0;
+  }
+  *hi = (floatG(e) - 1) << 1;
+  *lo = 0;
+  return 65;
+#endif  // DBL_MANT_DIG == 53
+}
+//------------------------------------------------------------------------------
+// Round w*10^q to m*2^e.  Return false if the error of the 128-bit
+// product could change the result.
+static bool scanFast(const ScanNum* num, int16_t q, const ScanFmt* fmt,
+                     uint64_t* m, int16_t* e) {
+  uint64_t hi;
+  uint64_t lo;
+  uint8_t err = pow10Bound(q, &hi, &lo);
+  if (!err) {
+    return false;
+  }
+  uint8_t lz = __builtin_clzll(num->w);
+  uint64_t w = num->w << lz;
+  // x2:x1 is the high 128 bits of w*hi:lo, x2 >= 2^62.
+  uint64_t x2;
+  uint64_t x1 = mul128(w, hi, &x2);
+  uint64_t t = mulHigh(w, lo);
+  x1 += t;
+  x2 += x1 < t;
+  int16_t b = flog2pow10(q) - 63 - lz;
+  if (!(x2 >> 63)) {
+    x2 = (x2 << 1) | (x1 >> 63);
+    x1 <<= 1;
+    b--;
+  }
+  // Value is in [x2:x1, x2:x1 + 2^err)*2^b.  Truncated digits add less
+  // than 10^-18 of the value.
+  err = num->trunc ? 70 : err + 2;
+  int16_t sh = 128 - fmt->mant;
+  int16_t ex = b + sh;
+  if (ex < fmt->emin) {
+    sh += fmt->emin - ex;
+    ex = fmt->emin;
+    if (sh > 128) {
+      return false;
+    }
+  }
+  // round bit is bit rb of x2
+  uint8_t rb = sh - 65;
+  uint64_t r = x2 >> rb;
+  uint64_t u1 = x1 + (err < 64 ? (UINT64_C(1) << err) - 1 : ~UINT64_C(0));
+  uint64_t u2 = x2 + (err > 64 ? (UINT64_C(1) << (err - 64)) - 1 : 0);
+  u2 += u1 < x1;
+  if (u2 < x2 || (u2 >> rb) != r) {
+    return false;
+  }
+  if ((r & 1) && !(x2 & ((UINT64_C(1) << rb) - 1)) && !x1) {
+    // may be a tie
+    return false;
+  }
+  *m = (r >> 1) + (r & 1);
+  *e = ex;
+  return true;
+}
+//------------------------------------------------------------------------------
+// Compare the digits in [str, end), the first at 10^(k - 1), with h*2^e.
+static int8_t cmpDigits(const char* str, const char* end, int16_t k,
+                        uint64_t h, int16_t e) {
+  FmtBig num;
+  FmtBig den;
+  bigSet(&num, h);
+  bigSet(&den, 1);
+  if (e > 0) {
+    bigShl(&num, e);
+  } else {
+    bigShl(&den, -e);
+  }
+  FmtBig* b = k > 0 ? &den : &num;
+  uint16_t n = k < 0 ? -k : k;
+  for (uint16_t i = n; i;) {
+    uint8_t m = i < 13 ? i : 13;
+    bigMul(b, pow5(m));
+    i -= m;
+  }
+  bigShl(b, n);
+  // digits of num/den, less than about one, follow the decimal point
+  for (; str < end; str++) {
+    if (!isDigit(*str)) {
+      continue;
+    }
+    uint8_t d = 0;
+    bigMul(&num, 10);
+    while (bigCmp(&num, &den) >= 0) {
+      bigSub(&num, &den);
+      d++;
+    }
+    if (*str - '0' != d) {
+      return *str - '0' < d ? -1 : 1;
+    }
+  }
+  return num.n ? -1 : 0;
+}
+//------------------------------------------------------------------------------
+// Round w*10^q to m*2^e using exact arithmetic.
+static uint64_t scanExact(const ScanNum* num, int16_t q, const ScanFmt* fmt,
+                          int16_t* e) {
+  int16_t ex = 63 - __builtin_clzll(num->w) + flog2pow10(q) - fmt->mant + 1;
+  if (ex < fmt->emin) {
+    ex = fmt->emin;
+  }
+  int8_t rnd;
+  uint64_t m = scaleTen(num->w, -ex, q, &rnd);
+  if (m >> fmt->mant) {
+    ex++;
+    m = scaleTen(num->w, -ex, q, &rnd);
+  }
+  bool up;
+  if (!num->trunc) {
+    up = rnd > 0 || (rnd == 0 && (m & 1));
+  } else if (rnd == -1) {
+    // Truncated digits are less than 0.01 of the unit in the last place.
+    int8_t cmp = cmpDigits(num->digits, num->end, q + SCAN_MAX_DIGITS,
+                           2*m + 1, ex - 1);
+    up = cmp > 0 || (cmp == 0 && (m & 1));
+  } else {
+    up = rnd != RND_ZERO;
+  }
+  *e = ex;
+  return m + up;
+}
+//------------------------------------------------------------------------------
+// Round num to m*2^e.  The result is infinite if e > fmt->emax.
+static uint64_t scanBinary(const ScanNum* num, const ScanFmt* fmt,
+                           int16_t* e) {
+  *e = fmt->emin;
+  // w is less than 10^20
+  if (!num->w || num->q + 20 <= flog10pow2(fmt->emin - 1)) {
+    return 0;
+  }
+  if (num->q > flog10pow2(fmt->emax + fmt->mant)) {
+    *e = fmt->emax + 1;
+    return 0;
+  }
+  uint64_t m;
+  if (!scanFast(num, num->q, fmt, &m, e)) {
+    m = scanExact(num, num->q, fmt, e);
+  }
+  if (m >> fmt->mant) {
+    m >>= 1;
+    (*e)++;
+  }
+  return m;
+}
+//==============================================================================
+// Format n with exactly nd digits.
+static char* fmtDigits(char* str, uint64_t n, int16_t nd) {
+  char* bgn = str - nd;
+  str = fmtBase10(str, n);
+  while (str > bgn) {
+    *--str = '0';
+  }
+  return str;
+}
+//------------------------------------------------------------------------------
+static char* fmtExponent(char* str, int16_t exp, char expChar) {
+  bool neg = exp < 0;
+  if (neg) {
+    exp = -exp;
+  }
+  str = fmtBase10(str, (uint16_t)exp);
+  if (exp < 10) {
+    *--str = '0';
+  }
+  *--str = neg ? '-' : '+';
+  *--str = expChar;
+  return str;
+}
+//------------------------------------------------------------------------------
+// Format the nd digits of f as d.ddd*10^exp.  Use exponent format
+// if expChar is nonzero.
+static char* fmtDecimal(char* str, uint64_t f, uint8_t nd, int16_t exp,
+                        bool altFmt, char expChar) {
+  if (expChar) {
+    str = fmtExponent(str, exp, expChar);
+    exp = 0;
+  }
+  // digits after the decimal point
+  int16_t frac = nd - 1 - exp;
+  if (frac <= 0) {
+    if (altFmt) {
+      *--str = '.';
+    }
+    while (frac++ < 0) {
+      *--str = '0';
+    }
+    return fmtBase10(str, f);
+  }
+  if (frac >= nd) {
+    str = fmtDigits(str, f, frac);
+    *--str = '.';
+    *--str = '0';
+    return str;
+  }
+  uint64_t p = pow10(frac);
+  str = fmtDigits(str, f%p, frac);
+  *--str = '.';
+  return fmtBase10(str, f/p);
+}
+//------------------------------------------------------------------------------
+// Format f*10^exp like %g with trailing zeros removed unless altFmt.
+static char* fmtGeneral(char* str, uint64_t f, uint8_t nd, int16_t exp,
+                        uint8_t prec, bool altFmt, bool caps) {
+  while (!altFmt && nd > 1 && f%10 == 0) {
+    f /= 10;
+    nd--;
+  }
+  bool useExp = exp < -4 || exp >= prec;
+  return fmtDecimal(str, f, nd, exp, altFmt, useExp ? (caps ? 'E' : 'e') : 0);
+}
+//------------------------------------------------------------------------------
+static char* fmtFixed(char* str, double value, uint8_t prec, bool altFmt) {
+  int16_t q;
+  uint64_t c = split(value, &q);
+  uint64_t whole;
+  uint64_t hi = 0;
+  uint64_t lo = 0;
+  uint8_t n = 0;
+  if (q >= 0) {
+    whole = c << q;
+  } else if (q > -64) {
+    n = -q;
+    whole = c >> n;
+    lo = c & ((UINT64_C(1) << n) - 1);
+  } else if (q > -125) {
+    // 10*(hi:lo) must be less than 2^128
+    n = -q;
+    whole = 0;
+    lo = c;
+  } else {
+    // value*10^FIXED_MAX_PREC is less than one half
+    whole = 0;
+  }
+  char* end = str;
+  str -= prec;
+  for (char* ptr = str; ptr < end; ptr++) {
+    *ptr = '0' + (n ? nextDigit(&hi, &lo, n) : 0);
+  }
+  int8_t rnd = n ? cmpHalf(hi, lo, n) : RND_ZERO;
+  bool odd = prec ? end[-1] & 1 : whole & 1;
+  if (rnd > 0 || (rnd == 0 && odd)) {
+    // propagate the carry
+    for (char* ptr = end;; *ptr = '0') {
+      if (ptr == str) {
+        whole++;
+        break;
+      }
+      if (*--ptr != '9') {
+        (*ptr)++;
+        break;
+      }
+    }
+  }
+  if (prec || altFmt) {
+    *--str = '.';
+  }
+  return fmtBase10(str, whole);
+}
+//------------------------------------------------------------------------------
+static char* fmtNonFinite(char* str, double value, bool caps) {
+  str -= 3;
+  if (isnan(value)) {
+    memcpy(str, caps ? "NAN" : "nan", 3);
+  } else {
+    memcpy(str, caps ? "INF" : "inf", 3);
+  }
+  return str;
+}
+//------------------------------------------------------------------------------
+// Format shortest digits f*10^exp.
+static char* fmtRoundTrip(char* str, uint64_t f, int16_t exp, bool caps) {
+  while (f && f%10 == 0) {
+    f /= 10;
+    exp++;
+  }
+  uint8_t nd = 1;
+  for (uint64_t p = 10; nd < 19 && f >= p; p *= 10) {
+    nd++;
+  }
+  return fmtGeneral(str, f, nd, exp + nd - 1, 17, false, caps);
+}
+//==============================================================================
+char* fmtDouble(char* str, double value, uint8_t prec, bool altFmt) {
+  return fmtDouble(str, value, prec, altFmt, 'f');
+}
+//------------------------------------------------------------------------------
+char* fmtDouble(char* str, double value,
+                uint8_t prec, bool altFmt, char expChar) {
+  bool caps = expChar == 'E' || expChar == 'F' || expChar == 'G';
+  bool neg = value < 0;
+  if (neg) {
+    value = -value;
+  }
+  if (isnan(value) || isinf(value)) {
+    str = fmtNonFinite(str, value, caps);
+  } else if (expChar == 'g' || expChar == 'G') {
+    if (prec == 0) {
+      prec = 1;
+    } else if (prec > EXP_MAX_PREC + 1) {
+      prec = EXP_MAX_PREC + 1;
+    }
+    int16_t q;
+    int16_t exp;
+    uint64_t c = split(value, &q);
+    uint64_t f = expDigits(c, q, prec - 1, &exp);
+    str = fmtGeneral(str, f, prec, exp, prec, altFmt, caps);
+  } else if (expChar == 'e' || expChar == 'E' || value >= FIXED_MAX_VALUE) {
+    if (prec > EXP_MAX_PREC) {
+      prec = EXP_MAX_PREC;
+    }
+    int16_t q;
+    int16_t exp;
+    uint64_t c = split(value, &q);
+    uint64_t f = expDigits(c, q, prec, &exp);
+    str = fmtDecimal(str, f, prec + 1, exp, altFmt, caps ? 'E' : 'e');
+  } else {
+    if (prec > FIXED_MAX_PREC) {
+      prec = FIXED_MAX_PREC;
+    }
+    str = fmtFixed(str, value, prec, altFmt);
+  }
+  if (neg) {
+    *--str = '-';
+  }
+  return str;
+}
+//------------------------------------------------------------------------------
+char* fmtShortest(char* str, double value, bool caps) {
+  bool neg = value < 0;
+  if (neg) {
+    value = -value;
+  }
+  if (isnan(value) || isinf(value)) {
+    str = fmtNonFinite(str, value, caps);
+  } else {
+    int16_t exp = 0;
+    uint64_t f = value ? shortest(value, &exp) : 0;
+    str = fmtRoundTrip(str, f, exp, caps);
+  }
+  if (neg) {
+    *--str = '-';
+  }
+  return str;
+}
+//------------------------------------------------------------------------------
+char* fmtShortest(char* str, float value, bool caps) {
+  bool neg = value < 0;
+  if (neg) {
+    value = -value;
+  }
+  if (isnan(value) || isinf(value)) {
+    str = fmtNonFinite(str, value, caps);
+  } else {
+    int16_t exp = 0;
+    uint32_t f = value ? shortest(value, &exp) : 0;
+    str = fmtRoundTrip(str, f, exp, caps);
+  }
+  if (neg) {
+    *--str = '-';
+  }
+  return str;
+}
+//------------------------------------------------------------------------------
+#if DBL_MANT_DIG == 53
+double scanDouble(const char* str, char** ptr) {
+  ScanNum num;
+  const char* end = scanDecimal(str, &num);
+  if (ptr) {
+    *ptr = const_cast<char*>(end ? end : str);
+  }
+  if (!end) {
+    return 0;
+  }
+  double v;
+  if (!num.trunc && num.w <= (UINT64_C(1) << 53) &&
+      -19 <= num.q && num.q <= 19) {
+    // exact operands so the result is correctly rounded
+    v = num.w;
+    if (num.q < 0) {
+      v /= pow10(-num.q);
+    } else {
+      v *= pow10(num.q);
+    }
+  } else {
+    int16_t e;
+    uint64_t m = scanBinary(&num, &SCAN_DOUBLE, &e);
+    uint64_t bits = e > SCAN_DOUBLE.emax ? UINT64_C(0X7FF0000000000000) :
+                    ((uint64_t)(e + 1074) << 52) + m;
+    memcpy(&v, &bits, sizeof(v));
+  }
+  return num.neg ? -v : v;
+}
+#endif  // DBL_MANT_DIG == 53
+//------------------------------------------------------------------------------
+float scanFloat(const char* str, char** ptr) {
+  ScanNum num;
+  const char* end = scanDecimal(str, &num);
+  if (ptr) {
+    *ptr = const_cast<char*>(end ? end : str);
+  }
+  if (!end) {
+    return 0;
+  }
+  float v;
+  if (!num.trunc && num.w <= (UINT32_C(1) << 24) &&
+      -10 <= num.q && num.q <= 10) {
+    // exact operands so the result is correctly rounded
+    v = num.w;
+    if (num.q < 0) {
+      v /= pow10(-num.q);
+    } else {
+      v *= pow10(num.q);
+    }
+  } else {
+    int16_t e;
+    uint32_t m = scanBinary(&num, &SCAN_FLOAT, &e);
+    uint32_t bits = e > SCAN_FLOAT.emax ? UINT32_C(0X7F800000) :
+                    ((uint32_t)(e + 149) << 23) + m;
+    memcpy(&v, &bits, sizeof(v));
+  }
+  return num.neg ? -v : v;
+}
+#if DBL_MANT_DIG == 24
+//------------------------------------------------------------------------------
+double scanDouble(const char* str, char** ptr) {
+  return scanFloat(str, ptr);
+}
+#endif  // DBL_MANT_DIG == 24
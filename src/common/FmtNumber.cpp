@@ -22,6 +22,7 @@
  * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
  * DEALINGS IN THE SOFTWARE.
  */
+#include <string.h>
 #include "FmtNumber.h"
 // always use fmtBase10() - seems fast even on teensy 3.6.
 #define USE_FMT_BASE10 1
@@ -30,6 +31,10 @@
 #ifdef __AVR__
 #include <avr/pgmspace.h>
 #define USE_STIMMER
+#elif !defined(__ARM_ARCH_6M__)
+// Use two digits per divide by 100 if the divide can be done by a multiply.
+// Cortex-M0 has no 32x32->64 multiply so it keeps the shift and add.
+#define USE_DIGIT_PAIRS
 #endif  // __AVR__
 //------------------------------------------------------------------------------
 // Stimmer div/mod 10 for AVR
@@ -156,9 +161,43 @@ unsigned divu10(unsigned n) {
 // return q + (r > 9);
 }
 */
+#ifdef USE_DIGIT_PAIRS
+//------------------------------------------------------------------------------
+// Digit pairs "00" to "99" for fmtBase10().
+static const char digitPairs[] =
+  "00010203040506070809"
+  "10111213141516171819"
+  "20212223242526272829"
+  "30313233343536373839"
+  "40414243444546474849"
+  "50515253545556575859"
+  "60616263646566676869"
+  "70717273747576777879"
+  "80818283848586878889"
+  "90919293949596979899";
+//------------------------------------------------------------------------------
+static char* fmtPairs(char* str, uint32_t n) {
+  while (n > 99) {
+    uint32_t q = n/100;
+    str -= 2;
+    memcpy(str, &digitPairs[2*(n - 100*q)], 2);
+    n = q;
+  }
+  if (n > 9) {
+    str -= 2;
+    memcpy(str, &digitPairs[2*n], 2);
+  } else {
+    *--str = n + '0';
+  }
+  return str;
+}
+#endif  // USE_DIGIT_PAIRS
 //------------------------------------------------------------------------------
 // Format 16-bit unsigned
 char* fmtBase10(char* str, uint16_t n) {
+#ifdef USE_DIGIT_PAIRS
+  return fmtPairs(str, n);
+#else  // USE_DIGIT_PAIRS
   while (n > 9) {
 #ifdef USE_STIMMER
     uint8_t tmp8, r;
@@ -180,10 +219,14 @@ char* fmtBase10(char* str, uint16_t n) {
   }
   *--str = n + '0';
   return str;
+#endif  // USE_DIGIT_PAIRS
 }
 //------------------------------------------------------------------------------
 // format 32-bit unsigned
 char* fmtBase10(char* str, uint32_t n) {
+#ifdef USE_DIGIT_PAIRS
+  return fmtPairs(str, n);
+#else  // USE_DIGIT_PAIRS
   while (n > 0XFFFF) {
 #ifdef USE_STIMMER
     uint8_t tmp8, r;
@@ -204,6 +247,22 @@ char* fmtBase10(char* str, uint32_t n) {
     *--str = r + '0';
   }
   return fmtBase10(str, (uint16_t)n);
+#endif  // USE_DIGIT_PAIRS
+}
+//------------------------------------------------------------------------------
+// format 64-bit unsigned
+char* fmtBase10(char* str, uint64_t n) {
+  while (n > 0XFFFFFFFF) {
+    // nine digits per 64-bit divide
+    uint64_t q = n/1000000000;
+    char* end = str - 9;
+    str = fmtBase10(str, (uint32_t)(n - 1000000000*q));
+    while (str > end) {
+      *--str = '0';
+    }
+    n = q;
+  }
+  return fmtBase10(str, (uint32_t)n);
 }
 //------------------------------------------------------------------------------
 char* fmtSigned(char* str, int32_t num, uint8_t base, bool caps) {
@@ -212,7 +271,7 @@ char* fmtSigned(char* str, int32_t num, uint8_t base, bool caps) {
     neg = true;
     num = -num;
   }
-  str = fmtUnsigned(str, num, base, caps);
+  str = fmtUnsigned(str, (uint32_t)num, base, caps);
   if (neg) {
     *--str = '-';
   }
@@ -223,6 +282,14 @@ char* fmtUnsigned(char* str, uint32_t num, uint8_t base, bool caps) {
 #if USE_FMT_BASE10
   if (base == 10) return fmtBase10(str, (uint32_t)num);
 #endif  // USE_FMT_BASE10
+  if (base == 16 || base == 8) {
+    uint8_t shift = base == 16 ? 4 : 3;
+    do {
+      int c = num & (base - 1);
+      *--str = c + (c < 10 ? '0' : caps ? 'A' - 10 : 'a' - 10);
+    } while (num >>= shift);
+    return str;
+  }
   do {
     int c = num%base;
     *--str = c + (c < 10 ? '0' : caps ? 'A' - 10 : 'a' - 10);
@@ -230,279 +297,16 @@ char* fmtUnsigned(char* str, uint32_t num, uint8_t base, bool caps) {
   return str;
 }
 //-----------------------------------------------------------------------------
-
-static const double powTen[] = {1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9};
-static const double rnd[] =
-  {5e-1, 5e-2, 5e-3, 5e-4, 5e-5, 5e-6, 5e-7, 5e-8, 5e-9, 5e-10};
-static const size_t MAX_PREC = sizeof(powTen)/sizeof(powTen[0]);
-
-char *fmtDouble(char *str, double num, uint8_t prec, bool altFmt) {
-  bool neg = num < 0;
-  if (neg) {
-    num = -num;
-  }
-  if (isnan(num)) {
-    *--str = 'n';
-    *--str = 'a';
-    *--str = 'n';
-    return str;
-  }
-  if (isinf(num)) {
-    *--str = 'f';
-    *--str = 'n';
-    *--str = 'i';
-    return str;
+char* fmtUnsigned(char* str, uint64_t num, uint8_t base, bool caps) {
+  if (num <= 0XFFFFFFFF) {
+    return fmtUnsigned(str, (uint32_t)num, base, caps);
   }
-  // last float < 2^32
-  if (num > 4294967040.0) {
-    *--str = 'f';
-    *--str = 'v';
-    *--str = 'o';
-    return str;
-  }
-
-  if (prec > MAX_PREC) {
-    prec = MAX_PREC;
-  }
-  num += rnd[prec];
-  uint32_t ul = num;
-  if (prec) {
-    char* s = str - prec;
-    uint32_t f = (num - ul)*powTen[prec - 1];
-    str = fmtBase10(str, f);
-    while (str > s) {
-      *--str = '0';
-    }
-  }
-  if (prec || altFmt) {
-    *--str = '.';
-  }
-  str = fmtBase10(str, ul);
-  if (neg) {
-    *--str = '-';
-  }
-  return str;
-}
-//------------------------------------------------------------------------------
-/** Print a number followed by a field terminator.
- * \param[in] value The number to be printed.
- * \param[in] ptr Pointer to last char in buffer.
- * \param[in] prec Number of digits after decimal point.
- * \param[in] expChar Use exp format if non zero.
- * \return Pointer to first character of result.
- */
-char* fmtDouble(char* str, double value,
-                uint8_t prec, bool altFmt, char expChar) {
-  if (expChar != 'e' && expChar != 'E') {
-    expChar = 0;
-  }
-  bool neg = value < 0;
-  if (neg) {
-    value = -value;
-  }
-  // check for nan inf ovf
-  if (isnan(value)) {
-    *--str = 'n';
-    *--str = 'a';
-    *--str = 'n';
-    return str;
-  }
-  if (isinf(value)) {
-    *--str = 'f';
-    *--str = 'n';
-    *--str = 'i';
-    return str;
-  }
-  if (!expChar && value > 4294967040.0) {
-    *--str = 'f';
-    *--str = 'v';
-    *--str = 'o';
-    return str;
-  }
-  if (prec > 9) {
-    prec = 9;
-  }
-  if (expChar) {
-    int8_t exp = 0;
-    bool expNeg = false;
-    if (value) {
-      if (value > 10.0L) {
-        while (value > 1e16L) {
-          value *= 1e-16L;
-          exp += 16;
-        }
-        while (value > 1e4L) {
-          value *= 1e-4L;
-          exp += 4;
-        }
-        while (value > 10.0L) {
-          value *= 0.1L;
-          exp++;
-        }
-      } else if (value < 1.0L) {
-         while (value < 1e-16L) {
-          value *= 1e16L;
-          exp -= 16;
-        }
-         while (value < 1e-4L) {
-          value *= 1e4L;
-          exp -= 4;
-        }
-        while (value < 1.0L) {
-          value *= 10.0L;
-          exp--;
-        }
-      }
-      value += rnd[prec];
-      if (value >= 10.0L) {
-        value *= 0.1L;
-        exp++;
-      }
-      expNeg = exp < 0;
-      if (expNeg) {
-        exp = -exp;
-      }
-    }
-    str = fmtBase10(str, (uint16_t)exp);
-    if (exp < 10) {
-      *--str = '0';
-    }
-    *--str = expNeg ? '-' : '+';
-    *--str = expChar;
-  } else {
-    // round value
-    value += rnd[prec];
-  }
-
-  uint32_t whole = value;
-  if (prec) {
-    char* tmp = str - prec;
-    uint32_t fraction = (value - whole)*powTen[prec - 1];
-    str = fmtBase10(str, fraction);
-    while (str > tmp) {
-      *--str = '0';
-    }
-  }
-  if (prec || altFmt)*--str = '.';
-  str = fmtBase10(str, whole);
-  if (neg) {
-    *--str = '-';
+  if (base == 10) {
+    return fmtBase10(str, num);
   }
+  do {
+    int c = num%base;
+    *--str = c + (c < 10 ? '0' : caps ? 'A' - 10 : 'a' - 10);
+  } while (num /= base);
   return str;
 }
-//==============================================================================
-//  functions below not used
-//------------------------------------------------------------------------------
-#ifndef DOXYGEN_SHOULD_SKIP_THIS
-#ifdef __AVR__
-static const float m[] PROGMEM = {1e-1, 1e-2, 1e-4, 1e-8, 1e-16, 1e-32};
-static const float p[] PROGMEM = {1e+1, 1e+2, 1e+4, 1e+8, 1e+16, 1e+32};
-#else  // __AVR__
-static const float m[] = {1e-1, 1e-2, 1e-4, 1e-8, 1e-16, 1e-32};
-static const float p[] = {1e+1, 1e+2, 1e+4, 1e+8, 1e+16, 1e+32};
-#endif  // __AVR__
-#endif  // DOXYGEN_SHOULD_SKIP_THIS
-// scale float v by power of ten. return v*10^n
-float scale10(float v, int8_t n) {
-  const float *s;
-  if (n < 0) {
-    n = -n;
-    s = m;
-  } else {
-    s = p;
-  }
-  n &= 63;
-  for (uint8_t i = 0; n; n >>= 1, i++) {
-#ifdef __AVR__
-    if (n & 1) {
-      v *= pgm_read_float(&s[i]);
-    }
-#else  // __AVR__
-    if (n & 1) {
-      v *= s[i];
-    }
-#endif  // __AVR__
-  }
-  return v;
-}
-//------------------------------------------------------------------------------
-float scanFloat(const char* str, char** ptr) {
-  int16_t const EXP_LIMIT = 100;
-  bool digit = false;
-  bool dot = false;
-  uint32_t fract = 0;
-  int fracExp = 0;
-  uint8_t nd = 0;
-  bool neg;
-  int c;
-  float v;
-  const char* successPtr = str;
-
-  if (ptr) {
-    *ptr = const_cast<char*>(str);
-  }
-
-  while (isSpace((c = *str++))) {}
-  neg = c == '-';
-  if (c == '-' || c == '+') {
-    c = *str++;
-  }
-  // Skip leading zeros
-  while (c == '0') {
-    c = *str++;
-    digit = true;
-  }
-  for (;;) {
-    if (isDigit(c)) {
-      digit = true;
-      if (nd < 9) {
-        fract = 10*fract + c - '0';
-        nd++;
-        if (dot) {
-          fracExp--;
-        }
-      } else {
-        if (!dot) {
-          fracExp++;
-        }
-      }
-    } else if (c == '.') {
-      if (dot) {
-        goto fail;
-      }
-      dot = true;
-    } else {
-      if (!digit) {
-        goto fail;
-      }
-      break;
-    }
-    successPtr = str;
-    c = *str++;
-  }
-  if (c == 'e' || c == 'E') {
-    int exp = 0;
-    c = *str++;
-    bool expNeg = c == '-';
-    if (c == '-' || c == '+') {
-      c = *str++;
-    }
-    while (isDigit(c)) {
-      if (exp > EXP_LIMIT) {
-        goto fail;
-      }
-      exp = 10*exp + c - '0';
-      successPtr = str;
-      c = *str++;
-    }
-    fracExp += expNeg ? -exp : exp;
-  }
-  if (ptr) {
-    *ptr = const_cast<char*>(successPtr);
-  }
-  v = scale10(static_cast<float>(fract), fracExp);
-  return neg ? -v : v;
-
-fail:
-  return 0;
-}
@@ -27,6 +27,10 @@
 #include <math.h>
 #include <stdint.h>
 #include <stddef.h>
+/** Size of a buffer for any fmtDouble() or fmtShortest() result. */
+const uint8_t FMT_DOUBLE_SIZE = 40;
+/** Precision that selects the shortest form that reads back exactly. */
+const uint8_t FMT_SHORTEST = 0XFF;
 inline bool isDigit(char c) {
   return '0' <= (c) && (c) <= '9';
 }
@@ -35,8 +39,14 @@ inline bool isSpace(char c) {
 }
 char* fmtBase10(char* str, uint16_t n);
 char* fmtBase10(char* str, uint32_t n);
+char* fmtBase10(char* str, uint64_t n);
 char* fmtDouble(char *str, double d, uint8_t prec, bool altFmt);
 char* fmtDouble(char* str, double d, uint8_t prec, bool altFmt, char expChar);
+char* fmtShortest(char* str, double d, bool caps);
+char* fmtShortest(char* str, float f, bool caps);
 char* fmtSigned(char* str, int32_t n, uint8_t base, bool caps);
 char* fmtUnsigned(char* str, uint32_t n, uint8_t base, bool caps);
+char* fmtUnsigned(char* str, uint64_t n, uint8_t base, bool caps);
+double scanDouble(const char* str, char** ptr);
+float scanFloat(const char* str, char** ptr);
 #endif  // FmtNumber_h
@@ -0,0 +1,282 @@
+/**
+ * Copyright (c) 20011-2017 Bill Greiman
+ * This file is part of the SdFs library for SD memory cards.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#include "FsCache.h"
+#include "DebugMacros.h"
+//------------------------------------------------------------------------------
+bool FsCache::contains(uint32_t sector, size_t ns) {
+  for (uint8_t i = 0; i < m_count; i++) {
+    if ((m_entry[i].sector - sector) < ns) {
+      return true;
+    }
+  }
+  return false;
+}
+//------------------------------------------------------------------------------
+#if USE_DEFERRED_FAT_MIRROR
+bool FsCache::deferMirror(uint32_t sector, uint8_t n) {
+  uint32_t bgn = sector;
+  uint32_t end = sector + n;
+  if (m_mirrorBgn < m_mirrorEnd) {
+    if (m_mirrorBgn < bgn) {
+      bgn = m_mirrorBgn;
+    }
+    if (m_mirrorEnd > end) {
+      end = m_mirrorEnd;
+    }
+    if ((end - bgn) > MIRROR_SPAN) {
+      // Too far from the deferred range so mirror now.
+      return false;
+    }
+  }
+  m_mirrorBgn = bgn;
+  m_mirrorEnd = end;
+  return true;
+}
+#endif  // USE_DEFERRED_FAT_MIRROR
+//------------------------------------------------------------------------------
+uint8_t FsCache::findEntry(uint32_t sector) {
+  for (uint8_t i = 0; i < m_count; i++) {
+    if (m_entry[i].sector == sector) {
+      return i;
+    }
+  }
+  return m_count;
+}
+//------------------------------------------------------------------------------
+uint8_t* FsCache::get(uint32_t sector, uint8_t option) {
+  uint8_t i;
+  if (!m_blockDev) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  i = m_count == 1 || m_entry[m_current].sector == sector ?
+      m_current : findEntry(sector);
+  if (i == m_count || m_entry[i].sector != sector) {
+    if (i == m_count) {
+      // Replace the least recently used sector.
+      i = 0;
+      for (uint8_t k = 1; k < m_count; k++) {
+        if (m_entry[k].lastUse < m_entry[i].lastUse) {
+          i = k;
+        }
+      }
+    }
+    if ((m_entry[i].status & CACHE_STATUS_DIRTY) && !writeEntries(i, 1)) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    m_entry[i].status = 0;
+    m_entry[i].sector = 0XFFFFFFFF;
+    if (!(option & CACHE_OPTION_NO_READ)) {
+      if (!m_blockDev->readSector(sector, entryBuffer(i))) {
+        DBG_FAIL_MACRO;
+        goto fail;
+      }
+    }
+    m_entry[i].sector = sector;
+  }
+  m_entry[i].status |= option & CACHE_STATUS_MASK;
+  if (++m_clock == 0) {
+    // Clock wrapped so restart ages.
+    for (uint8_t k = 0; k < m_count; k++) {
+      m_entry[k].lastUse = 0;
+    }
+    m_clock = 1;
+  }
+  m_entry[i].lastUse = m_clock;
+  m_current = i;
+  return entryBuffer(i);
+
+fail:
+  return nullptr;
+}
+//------------------------------------------------------------------------------
+void FsCache::invalidate() {
+  for (uint8_t i = 0; i < m_count; i++) {
+    m_entry[i].sector = 0XFFFFFFFF;
+    m_entry[i].lastUse = 0;
+    m_entry[i].status = 0;
+  }
+  m_clock = 0;
+  m_current = 0;
+}
+//------------------------------------------------------------------------------
+void FsCache::invalidate(uint32_t sector, size_t ns) {
+  for (uint8_t i = 0; i < m_count; i++) {
+    if ((m_entry[i].sector - sector) < ns) {
+      m_entry[i].sector = 0XFFFFFFFF;
+      m_entry[i].lastUse = 0;
+      m_entry[i].status = 0;
+    }
+  }
+}
+//------------------------------------------------------------------------------
+void FsCache::swapEntry(uint8_t i, uint8_t j) {
+  FsCacheEntry tmp = m_entry[i];
+  m_entry[i] = m_entry[j];
+  m_entry[j] = tmp;
+  uint32_t* pi = reinterpret_cast<uint32_t*>(entryBuffer(i));
+  uint32_t* pj = reinterpret_cast<uint32_t*>(entryBuffer(j));
+  for (size_t k = 0; k < 512/sizeof(uint32_t); k++) {
+    uint32_t t = pi[k];
+    pi[k] = pj[k];
+    pj[k] = t;
+  }
+  if (m_current == i) {
+    m_current = j;
+  } else if (m_current == j) {
+    m_current = i;
+  }
+}
+//------------------------------------------------------------------------------
+bool FsCache::sync() {
+  while (true) {
+    // Find the lowest dirty sector.
+    uint8_t i = m_count;
+    for (uint8_t k = 0; k < m_count; k++) {
+      if ((m_entry[k].status & CACHE_STATUS_DIRTY) &&
+          (i == m_count || m_entry[k].sector < m_entry[i].sector)) {
+        i = k;
+      }
+    }
+    if (i == m_count) {
+      return true;
+    }
+    uint8_t n = 1;
+#if USE_MULTI_SECTOR_IO
+    // Move dirty sectors that follow sector i into the next entries.
+    while (true) {
+      uint8_t j = findEntry(m_entry[i].sector + n);
+      if (j == m_count || !(m_entry[j].status & CACHE_STATUS_DIRTY) ||
+          ((m_entry[i].status ^ m_entry[j].status) & CACHE_STATUS_MIRROR_FAT)) {
+        break;
+      }
+      if (j != (i + n)) {
+        if ((i + n) >= m_count) {
+          // No room after the run so move it to the start of the cache.
+          for (uint8_t k = 0; k < n; k++) {
+            swapEntry(k, i + k);
+          }
+          i = 0;
+          j = findEntry(m_entry[i].sector + n);
+        }
+        swapEntry(i + n, j);
+      }
+      n++;
+    }
+#endif  // USE_MULTI_SECTOR_IO
+    if (!writeEntries(i, n)) {
+      DBG_FAIL_MACRO;
+      return false;
+    }
+  }
+}
+//------------------------------------------------------------------------------
+#if USE_DEFERRED_FAT_MIRROR
+bool FsCache::syncMirror() {
+  if (!sync()) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  while (m_mirrorBgn < m_mirrorEnd) {
+    uint32_t ns = m_mirrorEnd - m_mirrorBgn;
+    uint8_t n = ns < m_count ? ns : m_count;
+    // Place sectors of the run in entries zero through n - 1.
+    for (uint8_t k = 0; k < n; k++) {
+      uint32_t sector = m_mirrorBgn + k;
+      uint8_t j = findEntry(sector);
+      if (j != m_count) {
+        if (j != k) {
+          swapEntry(k, j);
+        }
+        continue;
+      }
+      m_entry[k].status = 0;
+      m_entry[k].sector = 0XFFFFFFFF;
+      m_entry[k].lastUse = 0;
+      if (!m_blockDev->readSector(sector, entryBuffer(k))) {
+        DBG_FAIL_MACRO;
+        goto fail;
+      }
+      m_entry[k].sector = sector;
+    }
+    if (!writeBuffers(m_mirrorBgn + m_mirrorOffset, 0, n)) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    m_mirrorBgn += n;
+  }
+  m_mirrorBgn = 0XFFFFFFFF;
+  m_mirrorEnd = 0;
+  return true;
+
+fail:
+  return false;
+}
+#endif  // USE_DEFERRED_FAT_MIRROR
+//------------------------------------------------------------------------------
+bool FsCache::writeBuffers(uint32_t sector, uint8_t i, uint8_t n) {
+  uint8_t* src = entryBuffer(i);
+#if USE_MULTI_SECTOR_IO
+  if (n > 1) {
+    return m_blockDev->writeSectors(sector, src, n);
+  }
+  return m_blockDev->writeSector(sector, src);
+#else  // USE_MULTI_SECTOR_IO
+  for (uint8_t k = 0; k < n; k++, src += 512) {
+    if (!m_blockDev->writeSector(sector + k, src)) {
+      return false;
+    }
+  }
+  return true;
+#endif  // USE_MULTI_SECTOR_IO
+}
+//------------------------------------------------------------------------------
+bool FsCache::writeEntries(uint8_t i, uint8_t n) {
+  uint32_t sector = m_entry[i].sector;
+  for (uint8_t pass = 0; pass < 2; pass++) {
+    if (!writeBuffers(sector, i, n)) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    // mirror second FAT
+    if (!(m_entry[i].status & CACHE_STATUS_MIRROR_FAT)) {
+      break;
+    }
+#if USE_DEFERRED_FAT_MIRROR
+    if (pass == 0 && deferMirror(sector, n)) {
+      break;
+    }
+#endif  // USE_DEFERRED_FAT_MIRROR
+    sector += m_mirrorOffset;
+  }
+  for (uint8_t k = i; k < (i + n); k++) {
+    m_entry[k].status &= ~CACHE_STATUS_DIRTY;
+  }
+  return true;
+
+fail:
+  return false;
+}
@@ -0,0 +1,215 @@
+/**
+ * Copyright (c) 20011-2017 Bill Greiman
+ * This file is part of the SdFs library for SD memory cards.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#ifndef FsCache_h
+#define FsCache_h
+/**
+ * \file
+ * \brief FsCache sector cache class.
+ */
+#include "SysCall.h"
+#include "BlockDevice.h"
+/**
+ * \struct FsCacheEntry
+ * \brief State of a sector in the cache.
+ */
+struct FsCacheEntry {
+  /** Logical sector number. */
+  uint32_t sector;
+  /** Cache clock at last use. */
+  uint32_t lastUse;
+  /** Status bits. */
+  uint8_t  status;
+};
+//==============================================================================
+/**
+ * \class FsCache
+ * \brief Multi-sector LRU cache with per-sector dirty bits.
+ *
+ * The sector returned by the last get() is the current sector.
+ * cacheBuffer(), dirty(), isDirty() and sector() apply to the current
+ * sector.  A cache with one sector behaves like the original single
+ * buffer cache.
+ */
+class FsCache {
+ public:
+  /** Cached sector is dirty */
+  static const uint8_t CACHE_STATUS_DIRTY = 1;
+  /** Cashed sector is FAT entry and must be mirrored in second FAT. */
+  static const uint8_t CACHE_STATUS_MIRROR_FAT = 2;
+  /** Cache sector status bits */
+  static const uint8_t CACHE_STATUS_MASK
+    = CACHE_STATUS_DIRTY | CACHE_STATUS_MIRROR_FAT;
+  /** Sync existing sector but do not read new sector. */
+  static const uint8_t CACHE_OPTION_NO_READ = 4;
+  /** Cache sector for read. */
+  static const uint8_t CACHE_FOR_READ = 0;
+  /** Cache sector for write. */
+  static const uint8_t CACHE_FOR_WRITE = CACHE_STATUS_DIRTY;
+  /** Reserve cache sector for write - do not read from sector device. */
+  static const uint8_t CACHE_RESERVE_FOR_WRITE
+    = CACHE_STATUS_DIRTY | CACHE_OPTION_NO_READ;
+
+  /** \return Address of the current sector. */
+  uint8_t* cacheBuffer() {
+    return entryBuffer(m_current);
+  }
+  /** Write all dirty sectors and invalidate the cache.
+   * \return Address of the current sector or nullptr for failure.
+   */
+  uint8_t* clear() {
+    if (!sync()) {
+      return nullptr;
+    }
+    invalidate();
+    return cacheBuffer();
+  }
+  /** Check for cached sectors in a range.
+   * \param[in] sector First sector of the range.
+   * \param[in] ns Number of sectors in the range.
+   * \return true if any sector in the range is cached.
+   */
+  bool contains(uint32_t sector, size_t ns = 1);
+  /** Set current sector dirty. */
+  void dirty() {
+    m_entry[m_current].status |= CACHE_STATUS_DIRTY;
+  }
+  /** Initialize the cache.
+   * \param[in] blockDev Block device for this partition.
+   * \param[in] mirrorOffset Offset to the copy of CACHE_STATUS_MIRROR_FAT
+   *            sectors.
+   */
+  void init(BlockDevice* blockDev, uint32_t mirrorOffset = 0) {
+    m_blockDev = blockDev;
+    m_mirrorOffset = mirrorOffset;
+#if USE_DEFERRED_FAT_MIRROR
+    m_mirrorBgn = 0XFFFFFFFF;
+    m_mirrorEnd = 0;
+#endif  // USE_DEFERRED_FAT_MIRROR
+    invalidate();
+  }
+  /** Invalidate all cached sectors. */
+  void invalidate();
+  /** Invalidate cached sectors in a range.  Dirty data is discarded.
+   * \param[in] sector First sector of the range.
+   * \param[in] ns Number of sectors in the range.
+   */
+  void invalidate(uint32_t sector, size_t ns);
+  /** \return dirty status of the current sector. */
+  bool isDirty() {
+    return m_entry[m_current].status & CACHE_STATUS_DIRTY;
+  }
+  /** \return Logical sector number for the current sector. */
+  uint32_t sector() {
+    return m_entry[m_current].sector;
+  }
+  /** \return Number of sectors in the cache. */
+  uint8_t sectorCount() const {
+    return m_count;
+  }
+  /** Fill cache with sector data and make it the current sector.
+   * \param[in] sector Sector to read.
+   * \param[in] option mode for cached sector.
+   * \return Address of cached sector. */
+  uint8_t* get(uint32_t sector, uint8_t option);
+  /** Set the offset to the copy of CACHE_STATUS_MIRROR_FAT sectors.
+   * \param[in] mirrorOffset offset in sectors.
+   */
+  void setMirrorOffset(uint32_t mirrorOffset) {
+    m_mirrorOffset = mirrorOffset;
+  }
+  /** Write all dirty sectors in ascending order.  Runs of adjacent dirty
+   * sectors are written with one writeSectors() call.
+   * \return true for success else false.
+   */
+  bool sync();
+#if USE_DEFERRED_FAT_MIRROR
+  /** Write all dirty sectors then copy the range of CACHE_STATUS_MIRROR_FAT
+   * sectors written since the last call to the mirror.
+   * \return true for success else false.
+   */
+  bool syncMirror();
+#else  // USE_DEFERRED_FAT_MIRROR
+  /** Write all dirty sectors.
+   * \return true for success else false.
+   */
+  bool syncMirror() {
+    return sync();
+  }
+#endif  // USE_DEFERRED_FAT_MIRROR
+
+ protected:
+  /// @cond SHOW_PROTECTED
+  FsCache(FsCacheEntry* entry, uint8_t* buffer, uint8_t count) :
+    m_blockDev(nullptr), m_entry(entry), m_buffer(buffer), m_count(count) {
+#if USE_DEFERRED_FAT_MIRROR
+    m_mirrorBgn = 0XFFFFFFFF;
+    m_mirrorEnd = 0;
+#endif  // USE_DEFERRED_FAT_MIRROR
+    invalidate();
+  }
+  /// @endcond
+
+ private:
+  FsCache(const FsCache&);
+  FsCache& operator=(const FsCache&);
+  uint8_t* entryBuffer(uint8_t i) {
+    return m_buffer + 512*static_cast<size_t>(i);
+  }
+  uint8_t findEntry(uint32_t sector);
+  void swapEntry(uint8_t i, uint8_t j);
+  bool writeBuffers(uint32_t sector, uint8_t i, uint8_t n);
+  bool writeEntries(uint8_t i, uint8_t n);
+#if USE_DEFERRED_FAT_MIRROR
+  // Largest range of sectors copied to the mirror by syncMirror().
+  static const uint32_t MIRROR_SPAN = 32;
+  bool deferMirror(uint32_t sector, uint8_t n);
+  uint32_t m_mirrorBgn;
+  uint32_t m_mirrorEnd;
+#endif  // USE_DEFERRED_FAT_MIRROR
+
+  BlockDevice* m_blockDev;
+  FsCacheEntry* m_entry;
+  uint8_t* m_buffer;
+  uint32_t m_mirrorOffset;
+  uint32_t m_clock;
+  uint8_t m_count;
+  uint8_t m_current;
+};
+//------------------------------------------------------------------------------
+/**
+ * \class FsCacheArray
+ * \brief FsCache with storage for N sectors.
+ */
+template<uint8_t N>
+class FsCacheArray : public FsCache {
+ public:
+  FsCacheArray() :
+    FsCache(m_entries, reinterpret_cast<uint8_t*>(m_buffers), N) {}
+
+ private:
+  FsCacheEntry m_entries[N];
+  uint32_t m_buffers[128*N];
+};
+#endif  // FsCache_h
@@ -0,0 +1,100 @@
+/**
+ * Copyright (c) 20011-2017 Bill Greiman
+ * This file is part of the SdFs library for SD memory cards.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#ifndef FsDirEntry_h
+#define FsDirEntry_h
+/**
+ * \file
+ * \brief FsDirEntry directory listing structures.
+ */
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "FsConfig.h"
+#if FS_DIR_ENTRY_NAME_SIZE < 13
+#error FS_DIR_ENTRY_NAME_SIZE must be at least 13
+#endif  // FS_DIR_ENTRY_NAME_SIZE < 13
+//------------------------------------------------------------------------------
+// FAT and exFAT attribute bits for FsDirEntry::attributes
+/** FsDirEntry attribute for a read-only file. */
+const uint8_t FS_ATTRIB_READ_ONLY = 0X01;
+/** FsDirEntry attribute for a hidden file. */
+const uint8_t FS_ATTRIB_HIDDEN = 0X02;
+/** FsDirEntry attribute for a system file. */
+const uint8_t FS_ATTRIB_SYSTEM = 0X04;
+/** FsDirEntry attribute for a subdirectory. */
+const uint8_t FS_ATTRIB_DIRECTORY = 0X10;
+/** FsDirEntry attribute for a file modified since the last backup. */
+const uint8_t FS_ATTRIB_ARCHIVE = 0X20;
+/** FsDirEntry attributes copied from a directory entry. */
+const uint8_t FS_ATTRIB_COPY = FS_ATTRIB_READ_ONLY | FS_ATTRIB_HIDDEN |
+                               FS_ATTRIB_SYSTEM | FS_ATTRIB_DIRECTORY |
+                               FS_ATTRIB_ARCHIVE;
+//------------------------------------------------------------------------------
+/**
+ * \struct FsDirEntry
+ * \brief Name and metadata for one file returned by readDir().
+ */
+struct FsDirEntry {
+  /** File size in bytes. */
+  uint64_t fileSize;
+  /** First cluster of the file's data, zero if none. */
+  uint32_t firstCluster;
+  /** Create date in the high 16 bits and time in the low 16 bits. */
+  uint32_t createDateTime;
+  /** Modify date in the high 16 bits and time in the low 16 bits. */
+  uint32_t modifyDateTime;
+  /** Position in the parent directory where openNext() opens the file. */
+  uint32_t dirPosition;
+  /** FS_ATTRIB_* bits. */
+  uint8_t attributes;
+  /** File name, truncated to fit. */
+  char name[FS_DIR_ENTRY_NAME_SIZE];
+  /** \return true if the entry is a subdirectory. */
+  bool isDir() const {return attributes & FS_ATTRIB_DIRECTORY;}
+  /** \return true if the entry is hidden. */
+  bool isHidden() const {return attributes & FS_ATTRIB_HIDDEN;}
+  /** \return true if the name fills the name field and may be truncated. */
+  bool isTruncated() const {
+    return strlen(name) >= (FS_DIR_ENTRY_NAME_SIZE - 1);
+  }
+};
+//------------------------------------------------------------------------------
+/**
+ * \struct FsDirFilter
+ * \brief Selects the entries returned by readDir().
+ */
+struct FsDirFilter {
+  /** Skip entries with any of these FS_ATTRIB_* bits set. */
+  uint8_t skip;
+  /** Only return names that start with this prefix, ignoring case.
+   *  Use nullptr for all names.
+   */
+  const char* prefix;
+  /** \return true if the name starts with the prefix.
+   * \param[in] name Name to be checked.
+   */
+  bool matchName(const char* name) const;
+};
+#endif  // FsDirEntry_h
@@ -0,0 +1,80 @@
+/**
+ * Copyright (c) 20011-2017 Bill Greiman
+ * This file is part of the SdFs library for SD memory cards.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#ifndef FsDirIterator_h
+#define FsDirIterator_h
+/**
+ * \file
+ * \brief FsDirIterator directory listing class.
+ */
+#include <stddef.h>
+#include "FsApiConstants.h"
+/**
+ * \class FsDirIterator
+ * \brief Forward iterator over the files in a directory.
+ *
+ * Each call to next() opens the next file and stores its name in a
+ * caller supplied buffer in a single pass over the directory.
+ *
+ * \tparam File FatFile, ExFatFile, or FsFile.
+ */
+template<class File>
+class FsDirIterator {
+ public:
+  /** Constructor.
+   *
+   * \param[in] dir An open directory.
+   * \param[out] name An array of characters for file names.
+   * \param[in] size The size of the name array in characters.
+   */
+  FsDirIterator(File* dir, char* name, size_t size) :
+    m_dir(dir), m_name(name), m_size(size) {}
+  /** \return The file opened by the last call to next(). */
+  File* file() {return &m_file;}
+  /** \return The name of the file opened by the last call to next(). */
+  const char* name() const {return m_name;}
+  /** Close the current file and open the next file in the directory.
+   *
+   * \param[in] oflag open flags.
+   *
+   * \return true for success or false at the end of the directory
+   *         or for an error.
+   */
+  bool next(uint8_t oflag = O_READ) {
+    m_file.close();
+    return m_file.openNext(m_dir, oflag, m_name, m_size);
+  }
+  /** Close the current file and restart at the start of the directory. */
+  void rewind() {
+    m_file.close();
+    m_dir->rewind();
+  }
+
+ private:
+  File* m_dir;
+  File m_file;
+  char* m_name;
+  size_t m_size;
+};
+#endif  // FsDirIterator_h
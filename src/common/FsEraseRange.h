@@ -0,0 +1,86 @@
+/**
+ * Copyright (c) 20011-2017 Bill Greiman
+ * This file is part of the SdFs library for SD memory cards.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#ifndef FsEraseRange_h
+#define FsEraseRange_h
+/**
+ * \file
+ * \brief FsEraseRange pre-erase range class.
+ */
+#include <stddef.h>
+#include <stdint.h>
+//==============================================================================
+/**
+ * \class FsEraseRange
+ * \brief Range of sectors with no data that must be preserved.
+ *
+ * A multi-sector write stream that starts in the range may pre-erase the
+ * rest of the range with ACMD23.  Sectors up to the end of each write are
+ * removed from the range so written data is never pre-erased again.
+ */
+class FsEraseRange {
+ public:
+  FsEraseRange() {clear();}
+  /** Remove all sectors from the range. */
+  void clear() {
+    m_sector = 0;
+    m_end = 0;
+  }
+  /** Pre-erase count for a write stream.
+   * \param[in] sector First sector of the stream.
+   * \param[in] ns Number of sectors in the first write of the stream.
+   * \return Sectors to pre-erase, at least ns and at most the 23-bit
+   *         limit of ACMD23.
+   */
+  uint32_t eraseCount(uint32_t sector, size_t ns) const {
+    size_t n = ns;
+    // A stream may run to the end of the range.
+    if (m_sector <= sector && sector < m_end && m_end - sector > n) {
+      n = m_end - sector;
+    }
+    return n < 0X7FFFFF ? n : 0X7FFFFF;
+  }
+  /** Set the range.
+   * \param[in] sector First sector in the range.
+   * \param[in] count Number of sectors in the range.
+   */
+  void set(uint32_t sector, uint32_t count) {
+    m_sector = sector;
+    m_end = sector + count;
+  }
+  /** Remove sectors below the end of a write from the range.
+   * \param[in] sector First sector written.
+   * \param[in] ns Number of sectors written.
+   */
+  void written(uint32_t sector, size_t ns) {
+    if (sector < m_end && (sector + ns) > m_sector) {
+      m_sector = sector + ns;
+    }
+  }
+
+ private:
+  uint32_t m_sector;
+  uint32_t m_end;
+};
+#endif  // FsEraseRange_h
@@ -0,0 +1,71 @@
+/**
+ * Copyright (c) 20011-2017 Bill Greiman
+ * This file is part of the SdFs library for SD memory cards.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#include "FsExtentMap.h"
+//------------------------------------------------------------------------------
+uint32_t FsExtentMap::find(uint32_t index) {
+  // Binary search for the last extent that starts at or before index.
+  size_t lo = 0;
+  size_t hi = m_count;
+  while (hi - lo > 1) {
+    size_t mid = lo + (hi - lo)/2;
+    if (m_extent[mid].index <= index) {
+      lo = mid;
+    } else {
+      hi = mid;
+    }
+  }
+  return m_extent[lo].cluster + (index - m_extent[lo].index);
+}
+//------------------------------------------------------------------------------
+void FsExtentMap::put(uint32_t index, uint32_t cluster) {
+  if (index != m_mapped) {
+    return;
+  }
+  if (m_count) {
+    FsExtent* last = &m_extent[m_count - 1];
+    if (cluster == last->cluster + (index - last->index)) {
+      m_mapped++;
+      return;
+    }
+  }
+  if (m_count == m_max) {
+    // Map is full.  Clusters past m_mapped require the chain.
+    return;
+  }
+  m_extent[m_count].index = index;
+  m_extent[m_count].cluster = cluster;
+  m_count++;
+  m_mapped++;
+}
+//------------------------------------------------------------------------------
+void FsExtentMap::truncate(uint32_t count) {
+  if (count >= m_mapped) {
+    return;
+  }
+  m_mapped = count;
+  while (m_count && m_extent[m_count - 1].index >= count) {
+    m_count--;
+  }
+}
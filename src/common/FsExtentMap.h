@@ -0,0 +1,131 @@
+/**
+ * Copyright (c) 20011-2017 Bill Greiman
+ * This file is part of the SdFs library for SD memory cards.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#ifndef FsExtentMap_h
+#define FsExtentMap_h
+/**
+ * \file
+ * \brief FsExtentMap cluster extent class.
+ */
+#include <stdint.h>
+#include <stddef.h>
+/**
+ * \struct FsExtent
+ * \brief Run of contiguous clusters in a file.
+ */
+struct FsExtent {
+  /** Index in the file of the first cluster of the run. */
+  uint32_t index;
+  /** Volume cluster number of the first cluster of the run. */
+  uint32_t cluster;
+};
+//==============================================================================
+/**
+ * \class FsExtentMap
+ * \brief Map from file cluster index to volume cluster.
+ *
+ * The map is built as a file's cluster chain is followed and always
+ * describes a prefix of the chain.  When all extents are used, clusters
+ * past the end of the map are found by following the chain from the
+ * last mapped cluster.
+ */
+class FsExtentMap {
+ public:
+  /** Remove all extents. */
+  void clear() {
+    m_count = 0;
+    m_mapped = 0;
+  }
+  /** \return Number of extents in use. */
+  size_t extentCount() const {return m_count;}
+  /** \return Maximum number of extents. */
+  size_t extentMax() const {return m_max;}
+  /** Find a mapped cluster.
+   * \param[in] index Index of the cluster in the file.
+   * \param[out] cluster Volume cluster number.
+   * \return true if \a index is mapped else false.
+   */
+  bool get(uint32_t index, uint32_t* cluster) {
+    if (index >= m_mapped) {
+      return false;
+    }
+    *cluster = find(index);
+    return true;
+  }
+  /** Find the mapped cluster closest to a cluster index.
+   * The map must not be empty.
+   * \param[in] index Index of the cluster in the file.
+   * \param[out] cluster Volume cluster number for the returned index.
+   * \return The lesser of \a index and the last mapped index.
+   */
+  uint32_t lookup(uint32_t index, uint32_t* cluster) {
+    if (index >= m_mapped) {
+      index = m_mapped - 1;
+    }
+    *cluster = find(index);
+    return index;
+  }
+  /** \return Number of file clusters described by the map. */
+  uint32_t mappedCount() const {return m_mapped;}
+  /** Add a cluster to the end of the map.  The call is ignored unless
+   * \a index is the first unmapped index.
+   * \param[in] index Index of the cluster in the file.
+   * \param[in] cluster Volume cluster number.
+   */
+  void put(uint32_t index, uint32_t cluster);
+  /** Remove clusters from the end of the map.
+   * \param[in] count Number of file clusters to keep.
+   */
+  void truncate(uint32_t count);
+
+ protected:
+  /// @cond SHOW_PROTECTED
+  FsExtentMap(FsExtent* extent, size_t max) :
+    m_extent(extent), m_max(max), m_count(0), m_mapped(0) {}
+  /// @endcond
+
+ private:
+  FsExtentMap(const FsExtentMap&);
+  FsExtentMap& operator=(const FsExtentMap&);
+  uint32_t find(uint32_t index);
+
+  FsExtent* m_extent;
+  size_t m_max;
+  size_t m_count;
+  uint32_t m_mapped;
+};
+//------------------------------------------------------------------------------
+/**
+ * \class FsExtentMapArray
+ * \brief FsExtentMap with storage for N extents.
+ */
+template<size_t N>
+class FsExtentMapArray : public FsExtentMap {
+ public:
+  FsExtentMapArray() : FsExtentMap(m_extents, N) {}
+
+ private:
+  FsExtent m_extents[N];
+};
+#endif  // FsExtentMap_h
@@ -0,0 +1,91 @@
+/**
+ * Copyright (c) 20011-2017 Bill Greiman
+ * This file is part of the SdFs library for SD memory cards.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#include "FsLineScan.h"
+//------------------------------------------------------------------------------
+FsLineScan::FsLineScan(const char* delim) {
+  m_nul = delim != nullptr;
+  if (!delim) {
+    delim = "\n";
+  }
+  if (delim[0] && !delim[1] && delim[0] != '\r') {
+    m_useMap = false;
+    m_char = delim[0];
+    return;
+  }
+  m_useMap = true;
+  m_char = 0;
+  memset(m_map, 0, sizeof(m_map));
+  for (const uint8_t* p = (const uint8_t*)delim; *p; p++) {
+    if (*p != '\r') {
+      m_map[*p >> 3] |= 1 << (*p & 7);
+    }
+  }
+  if (m_nul) {
+    m_map[0] |= 1;
+  }
+}
+//------------------------------------------------------------------------------
+size_t FsLineScan::copy(char* dst, size_t cap,
+                        const uint8_t* src, size_t len, size_t* stored) {
+  size_t i = 0;
+  size_t n = 0;
+  while (i < len && n < cap) {
+    if (src[i] == '\r') {
+      i++;
+      continue;
+    }
+    // copy the run up to the next CR
+    size_t k = len - i < cap - n ? len - i : cap - n;
+    const void* cr = memchr(src + i, '\r', k);
+    if (cr) {
+      k = (const uint8_t*)cr - (src + i);
+    }
+    memcpy(dst + n, src + i, k);
+    i += k;
+    n += k;
+  }
+  *stored = n;
+  return i;
+}
+//------------------------------------------------------------------------------
+const uint8_t* FsLineScan::find(const uint8_t* src, size_t len) const {
+  if (!m_useMap) {
+    const uint8_t* p = (const uint8_t*)memchr(src, m_char, len);
+    if (m_nul) {
+      // NUL before the delimiter
+      const void* z = memchr(src, 0, p ? p - src : len);
+      if (z) {
+        p = (const uint8_t*)z;
+      }
+    }
+    return p;
+  }
+  for (const uint8_t* end = src + len; src < end; src++) {
+    if (isDelim(*src)) {
+      return src;
+    }
+  }
+  return nullptr;
+}
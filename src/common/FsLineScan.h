@@ -0,0 +1,87 @@
+/**
+ * Copyright (c) 20011-2017 Bill Greiman
+ * This file is part of the SdFs library for SD memory cards.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#ifndef FsLineScan_h
+#define FsLineScan_h
+/**
+ * \file
+ * \brief FsLineScan class for fgets() and readLine().
+ */
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+//------------------------------------------------------------------------------
+/**
+ * \class FsLineScan
+ * \brief Find delimiters and copy lines in cached sector data.
+ *
+ * A single delimiter is found with memchr().  A set of delimiters uses a
+ * bitmap with one bit for each character value.  CR is never a delimiter
+ * since fgets() deletes CR.  If a delimiter string is given, a NUL byte
+ * is also a delimiter, as it was when fgets() used strchr().
+ */
+class FsLineScan {
+ public:
+  /** Constructor.
+   * \param[in] delim Set of delimiters.  The default, nullptr, is "\n"
+   * without NUL.
+   */
+  explicit FsLineScan(const char* delim);
+  /** Copy a run of data deleting CR characters.
+   *
+   * Copying stops when \a len bytes have been consumed or \a cap characters
+   * have been stored.  A CR is only consumed while there is space for
+   * another character.
+   *
+   * \param[out] dst Location for the copied characters.
+   * \param[in] cap Maximum number of characters to store.
+   * \param[in] src Data to be copied.
+   * \param[in] len Number of bytes in \a src.
+   * \param[out] stored Number of characters stored in \a dst.
+   *
+   * \return The number of bytes consumed from \a src.
+   */
+  static size_t copy(char* dst, size_t cap,
+                     const uint8_t* src, size_t len, size_t* stored);
+  /** Find the first delimiter in a run of data.
+   * \param[in] src Data to be scanned.
+   * \param[in] len Number of bytes in \a src.
+   * \return Pointer to the delimiter or nullptr if none is found.
+   */
+  const uint8_t* find(const uint8_t* src, size_t len) const;
+  /** \return true if \a c is a delimiter.
+   * \param[in] c Character to be checked.
+   */
+  bool isDelim(uint8_t c) const {
+    return m_useMap ? m_map[c >> 3] & (1 << (c & 7)) :
+           c == m_char || (c == 0 && m_nul);
+  }
+
+ private:
+  bool m_nul;
+  bool m_useMap;
+  uint8_t m_char;
+  uint8_t m_map[32];
+};
+#endif  // FsLineScan_h
@@ -0,0 +1,67 @@
+/**
+ * Copyright (c) 20011-2017 Bill Greiman
+ * This file is part of the SdFs library for SD memory cards.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#include <string.h>
+#include "FsPathCache.h"
+//------------------------------------------------------------------------------
+void FsPathCache::clear() {
+  for (uint8_t i = 0; i < m_count; i++) {
+    remove(&m_entry[i]);
+  }
+  m_clock = 0;
+}
+//------------------------------------------------------------------------------
+FsPathCacheEntry* FsPathCache::get(uint32_t parent,
+                                   const void* name, size_t size) {
+  if (size == 0) {
+    return nullptr;
+  }
+  for (uint8_t i = 0; i < m_count; i++) {
+    FsPathCacheEntry* entry = &m_entry[i];
+    if (entry->size == size && entry->parent == parent &&
+        memcmp(entry->name, name, size) == 0) {
+      entry->lastUse = ++m_clock;
+      return entry;
+    }
+  }
+  return nullptr;
+}
+//------------------------------------------------------------------------------
+FsPathCacheEntry* FsPathCache::put(uint32_t parent,
+                                   const void* name, size_t size) {
+  if (size == 0 || size > FsPathCacheEntry::NAME_SIZE) {
+    return nullptr;
+  }
+  FsPathCacheEntry* entry = &m_entry[0];
+  for (uint8_t i = 1; i < m_count; i++) {
+    if (m_entry[i].lastUse < entry->lastUse) {
+      entry = &m_entry[i];
+    }
+  }
+  entry->parent = parent;
+  entry->lastUse = ++m_clock;
+  entry->size = size;
+  memcpy(entry->name, name, size);
+  return entry;
+}
@@ -0,0 +1,130 @@
+/**
+ * Copyright (c) 20011-2017 Bill Greiman
+ * This file is part of the SdFs library for SD memory cards.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#ifndef FsPathCache_h
+#define FsPathCache_h
+/**
+ * \file
+ * \brief FsPathCache path component cache class.
+ */
+#include <stdint.h>
+#include <stddef.h>
+/**
+ * \struct FsPathCacheEntry
+ * \brief Cached directory entry fields for one subdirectory.
+ */
+struct FsPathCacheEntry {
+  /** Maximum size in bytes of a cached name. */
+  static const uint8_t NAME_SIZE = 16;
+  /** First cluster of the parent directory, zero for a root. */
+  uint32_t parent;
+  /** Position of the entry in the parent directory. */
+  uint32_t position;
+  /** Sector (FAT) or cluster (exFAT) that holds the entry. */
+  uint32_t location;
+  /** First cluster of the subdirectory. */
+  uint32_t cluster;
+  /** Length of the subdirectory from its entry. */
+  uint32_t length;
+  /** Cache clock at last use. */
+  uint32_t lastUse;
+  /** File attributes of the open subdirectory. */
+  uint8_t attributes;
+  /** File flags of the open subdirectory. */
+  uint8_t flags;
+  /** LFN entry count (FAT) or secondary entry count (exFAT). */
+  uint8_t count;
+  /** Size of the name in bytes, zero if the entry is not used. */
+  uint8_t size;
+  /** Name as it appeared in the path. */
+  uint8_t name[NAME_SIZE];
+};
+//==============================================================================
+/**
+ * \class FsPathCache
+ * \brief Cache of recently used subdirectory path components.
+ *
+ * Each entry maps a parent directory and a short name to a copy of the
+ * subdirectory's entry fields so a path walk can open it without reading
+ * the parent directory.  The owner must clear() the cache when a directory
+ * entry is removed or a cached subdirectory entry changes.
+ */
+class FsPathCache {
+ public:
+  /** Remove all entries. */
+  void clear();
+  /** Find a subdirectory.
+   * \param[in] parent First cluster of the parent directory.
+   * \param[in] name Name of the subdirectory.
+   * \param[in] size Size of the name in bytes.
+   * \return The entry or nullptr if the name is not cached.
+   */
+  FsPathCacheEntry* get(uint32_t parent, const void* name, size_t size);
+  /** Add a subdirectory, replacing the least recently used entry.
+   * The caller fills in the directory entry fields.
+   * \param[in] parent First cluster of the parent directory.
+   * \param[in] name Name of the subdirectory.
+   * \param[in] size Size of the name in bytes.
+   * \return The entry or nullptr if the name is longer than
+   * FsPathCacheEntry::NAME_SIZE.
+   */
+  FsPathCacheEntry* put(uint32_t parent, const void* name, size_t size);
+  /** Remove an entry.
+   * \param[in] entry Entry returned by get().
+   */
+  void remove(FsPathCacheEntry* entry) {
+    entry->size = 0;
+    entry->lastUse = 0;
+  }
+
+ protected:
+  /// @cond SHOW_PROTECTED
+  FsPathCache(FsPathCacheEntry* entry, uint8_t count) :
+    m_entry(entry), m_clock(0), m_count(count) {
+    clear();
+  }
+  /// @endcond
+
+ private:
+  FsPathCache(const FsPathCache&);
+  FsPathCache& operator=(const FsPathCache&);
+
+  FsPathCacheEntry* m_entry;
+  uint32_t m_clock;
+  uint8_t m_count;
+};
+//------------------------------------------------------------------------------
+/**
+ * \class FsPathCacheArray
+ * \brief FsPathCache with storage for N entries.
+ */
+template<uint8_t N>
+class FsPathCacheArray : public FsPathCache {
+ public:
+  FsPathCacheArray() : FsPathCache(m_entries, N) {}
+
+ private:
+  FsPathCacheEntry m_entries[N];
+};
+#endif  // FsPathCache_h
@@ -0,0 +1,49 @@
+/**
+ * Copyright (c) 20011-2017 Bill Greiman
+ * This file is part of the SdFs library for SD memory cards.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#include "FsReadAhead.h"
+#include "DebugMacros.h"
+//------------------------------------------------------------------------------
+const uint8_t* FsReadAhead::fill(uint32_t sector, size_t ns) {
+  m_count = 0;
+#if USE_MULTI_SECTOR_IO
+  if (!m_blockDev->readSectors(sector, m_buffer, ns)) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+#else  // USE_MULTI_SECTOR_IO
+  for (size_t i = 0; i < ns; i++) {
+    if (!m_blockDev->readSector(sector + i, m_buffer + 512*i)) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+  }
+#endif  // USE_MULTI_SECTOR_IO
+  m_sector = sector;
+  m_count = ns;
+  return m_buffer;
+
+fail:
+  return nullptr;
+}
@@ -0,0 +1,126 @@
+/**
+ * Copyright (c) 20011-2017 Bill Greiman
+ * This file is part of the SdFs library for SD memory cards.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#ifndef FsReadAhead_h
+#define FsReadAhead_h
+/**
+ * \file
+ * \brief FsReadAhead read-ahead buffer class.
+ */
+#include "SysCall.h"
+#include "BlockDevice.h"
+//==============================================================================
+/**
+ * \class FsReadAhead
+ * \brief Read-ahead buffer for sequential file data reads.
+ *
+ * A miss on the sector that follows the last sector requested is treated
+ * as sequential access and the next run of sectors is read with one
+ * readSectors() call.  The owner must invalidate() sectors that are
+ * modified.
+ */
+class FsReadAhead {
+ public:
+  /** \return Maximum number of sectors read ahead. */
+  uint8_t capacity() const {
+    return m_capacity;
+  }
+  /** Read a run of sectors into the buffer.
+   * \param[in] sector First sector of the run.
+   * \param[in] ns Number of sectors, not more than capacity().
+   * \return Address of the first sector or nullptr for failure.
+   */
+  const uint8_t* fill(uint32_t sector, size_t ns);
+  /** Find a buffered sector.
+   * \param[in] sector Sector to find.
+   * \return Address of the sector or nullptr if not buffered.
+   */
+  const uint8_t* get(uint32_t sector) {
+    uint32_t i = sector - m_sector;
+    return i < m_count ? m_buffer + 512*i : nullptr;
+  }
+  /** Initialize the buffer.
+   * \param[in] blockDev Block device for this partition.
+   */
+  void init(BlockDevice* blockDev) {
+    m_blockDev = blockDev;
+    m_count = 0;
+    m_next = 0;
+  }
+  /** Discard buffered sectors if any are in a range.
+   * \param[in] sector First sector of the range.
+   * \param[in] ns Number of sectors in the range.
+   */
+  void invalidate(uint32_t sector, size_t ns = 1) {
+    if ((sector - m_sector) < m_count || (m_sector - sector) < ns) {
+      m_count = 0;
+    }
+  }
+  /** Check for sequential access.
+   * \param[in] sector Sector to check.
+   * \return true if sector follows the last sector requested.
+   */
+  bool isNext(uint32_t sector) const {
+    return sector == m_next;
+  }
+  /** Record the last sector requested.
+   * \param[in] sector Sector requested.
+   */
+  void setLast(uint32_t sector) {
+    m_next = sector + 1;
+  }
+
+ protected:
+  /// @cond SHOW_PROTECTED
+  FsReadAhead(uint8_t* buffer, uint8_t capacity) :
+    m_blockDev(nullptr), m_buffer(buffer), m_sector(0), m_next(0),
+    m_capacity(capacity), m_count(0) {}
+  /// @endcond
+
+ private:
+  FsReadAhead(const FsReadAhead&);
+  FsReadAhead& operator=(const FsReadAhead&);
+
+  BlockDevice* m_blockDev;
+  uint8_t* m_buffer;
+  uint32_t m_sector;
+  uint32_t m_next;
+  uint8_t m_capacity;
+  uint8_t m_count;
+};
+//------------------------------------------------------------------------------
+/**
+ * \class FsReadAheadArray
+ * \brief FsReadAhead with storage for N sectors.
+ */
+template<uint8_t N>
+class FsReadAheadArray : public FsReadAhead {
+ public:
+  FsReadAheadArray() :
+    FsReadAhead(reinterpret_cast<uint8_t*>(m_buffers), N) {}
+
+ private:
+  uint32_t m_buffers[128*N];
+};
+#endif  // FsReadAhead_h
@@ -93,6 +93,18 @@ inline void setLe64(uint8_t* dst, uint64_t src) {
 }
 #endif  // USE_SIMPLE_LITTLE_ENDIAN
 //-----------------------------------------------------------------------------
+// Bit scans of 32-bit words.  The long builtins are used since int is
+// 16 bits on AVR.  ctz32() and clz32() are undefined for zero.
+inline uint8_t popcount32(uint32_t w) {
+  return __builtin_popcountl(w);
+}
+inline uint8_t ctz32(uint32_t w) {
+  return __builtin_ctzl(w);
+}
+inline uint8_t clz32(uint32_t w) {
+  return __builtin_clzl(w) - (8*sizeof(long) - 32);  // NOLINT
+}
+//-----------------------------------------------------------------------------
 const uint16_t MBR_SIGNATURE = 0xAA55;
 const uint16_t PBR_SIGNATURE = 0xAA55;
 
@@ -0,0 +1,74 @@
+/**
+ * Copyright (c) 20011-2017 Bill Greiman
+ * This file is part of the SdFs library for SD memory cards.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#include "FsWriteBuffer.h"
+#include "DebugMacros.h"
+//------------------------------------------------------------------------------
+bool FsWriteBuffer::sync() {
+  if (m_count == 0) {
+    return true;
+  }
+#if USE_MULTI_SECTOR_IO
+  if (!m_blockDev->writeSectors(m_sector, m_buffer, m_count)) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+#else  // USE_MULTI_SECTOR_IO
+  for (uint8_t i = 0; i < m_count; i++) {
+    if (!m_blockDev->writeSector(m_sector + i, m_buffer + 512*i)) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+  }
+#endif  // USE_MULTI_SECTOR_IO
+  m_count = 0;
+  return true;
+
+fail:
+  return false;
+}
+//------------------------------------------------------------------------------
+bool FsWriteBuffer::write(uint32_t sector, const uint8_t* src) {
+  uint32_t i = sector - m_sector;
+  if (m_count == 0 || i > m_count) {
+    if (!sync()) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    m_sector = sector;
+    i = 0;
+  }
+  memcpy(m_buffer + 512*i, src, 512);
+  if (i == m_count) {
+    m_count++;
+  }
+  if (m_count == m_capacity && !sync()) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  return true;
+
+fail:
+  return false;
+}
@@ -0,0 +1,107 @@
+/**
+ * Copyright (c) 20011-2017 Bill Greiman
+ * This file is part of the SdFs library for SD memory cards.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#ifndef FsWriteBuffer_h
+#define FsWriteBuffer_h
+/**
+ * \file
+ * \brief FsWriteBuffer write-behind buffer class.
+ */
+#include "SysCall.h"
+#include "BlockDevice.h"
+//==============================================================================
+/**
+ * \class FsWriteBuffer
+ * \brief Write-behind buffer for a run of consecutive data sectors.
+ *
+ * Full data sectors are collected and written with one writeSectors()
+ * call when the buffer is full, a sector is not the next in the run,
+ * or sync() is called.  The owner must sync() before a device read or
+ * cache fetch of a buffered sector.
+ */
+class FsWriteBuffer {
+ public:
+  /** Check for buffered sectors in a range.
+   * \param[in] sector First sector of the range.
+   * \param[in] ns Number of sectors in the range.
+   * \return true if any sector in the range is buffered.
+   */
+  bool contains(uint32_t sector, size_t ns = 1) {
+    return m_count &&
+           ((sector - m_sector) < m_count || (m_sector - sector) < ns);
+  }
+  /** Initialize the buffer.
+   * \param[in] blockDev Block device for this partition.
+   */
+  void init(BlockDevice* blockDev) {
+    m_blockDev = blockDev;
+    m_count = 0;
+  }
+  /** \return true if no sectors are buffered. */
+  bool isEmpty() const {
+    return m_count == 0;
+  }
+  /** Write the buffered sectors.
+   * \return true for success else false.
+   */
+  bool sync();
+  /** Add a sector to the buffer.
+   * \param[in] sector Logical sector to be written.
+   * \param[in] src Pointer to the location of the data to be written.
+   * \return true for success else false.
+   */
+  bool write(uint32_t sector, const uint8_t* src);
+
+ protected:
+  /// @cond SHOW_PROTECTED
+  FsWriteBuffer(uint8_t* buffer, uint8_t capacity) :
+    m_blockDev(nullptr), m_buffer(buffer), m_sector(0),
+    m_capacity(capacity), m_count(0) {}
+  /// @endcond
+
+ private:
+  FsWriteBuffer(const FsWriteBuffer&);
+  FsWriteBuffer& operator=(const FsWriteBuffer&);
+
+  BlockDevice* m_blockDev;
+  uint8_t* m_buffer;
+  uint32_t m_sector;
+  uint8_t m_capacity;
+  uint8_t m_count;
+};
+//------------------------------------------------------------------------------
+/**
+ * \class FsWriteBufferArray
+ * \brief FsWriteBuffer with storage for N sectors.
+ */
+template<uint8_t N>
+class FsWriteBufferArray : public FsWriteBuffer {
+ public:
+  FsWriteBufferArray() :
+    FsWriteBuffer(reinterpret_cast<uint8_t*>(m_buffers), N) {}
+
+ private:
+  uint32_t m_buffers[128*N];
+};
+#endif  // FsWriteBuffer_h
@@ -36,6 +36,9 @@
 #define PRINTF_USE_FLOAT 2
 //-----------------------------------------------------------------------------
 /** Formatted print.
+ *
+ * Floating values are correctly rounded.  \%g and \%G with no precision
+ * print the shortest form that reads back as the same value.
  *
  * \param[in] file destination file or device.
  * \param[in] fmt format string.
@@ -46,7 +49,7 @@
 template<typename F>
 int vfprintf(F* file, const char *fmt, va_list ap) {
 #if PRINTF_USE_FLOAT
-  char buf[30];
+  char buf[FMT_DOUBLE_SIZE];
   double f;
 #else
    char buf[15];
@@ -178,7 +181,7 @@ int vfprintf(F* file, const char *fmt, va_list ap) {
           } else if (plusSign) {
             prefix[np++] = plusSign;
           }
-          str = fmtUnsigned(str, ln, 10, true);
+          str = fmtUnsigned(str, (uint32_t)ln, 10, true);
           nz = prec + str - ptr;
         }
         break;
@@ -197,6 +200,23 @@ int vfprintf(F* file, const char *fmt, va_list ap) {
         }
         str = fmtDouble(str, f, prec < 0 ? 6 : prec, altForm, c);
         break;
+
+      // shortest form that reads back exactly if no precision
+      case 'g':
+      case 'G':
+        f = va_arg(ap, double);
+        if (f < 0) {
+          f = -f;
+          prefix[np++] = '-';
+        } else if (plusSign) {
+          prefix[np++] = plusSign;
+        }
+        if (prec < 0) {
+          str = fmtShortest(str, f, c == 'G');
+        } else {
+          str = fmtDouble(str, f, prec, altForm, c);
+        }
+        break;
 #elif PRINTF_USE_FLOAT > 0
       case 'f':
       case 'F':
@@ -228,7 +248,7 @@ int vfprintf(F* file, const char *fmt, va_list ap) {
       printUnsigned:
         ln = isLong ? va_arg(ap, long) : va_arg(ap, int);
         if (prec || ln) {
-          str = fmtUnsigned(str, ln, base, c == 'X');
+          str = fmtUnsigned(str, (uint32_t)ln, base, c == 'X');
           nz = prec + str - ptr;
         }
         if (altForm && ln) {
@@ -367,13 +387,13 @@ int vmprintf(F* file, const char *fmt, va_list ap) {
 
       case 'u':
         n = isLong ? va_arg(ap, long) : va_arg(ap, int);
-        str = fmtUnsigned(str, n, 10, true);
+        str = fmtUnsigned(str, (uint32_t)n, 10, true);
         break;
 
       case 'x':
       case 'X':
         n = isLong ? va_arg(ap, long) : va_arg(ap, int);
-        str = fmtUnsigned(str, n, 16, c == 'X');
+        str = fmtUnsigned(str, (uint32_t)n, 16, c == 'X');
         break;
 
       default:
@@ -458,13 +478,13 @@ int vmprintf(F file, const __FlashStringHelper *ifsh, va_list ap) {
 
       case 'u':
         n = isLong ? va_arg(ap, long) : va_arg(ap, int);
-        str = fmtUnsigned(str, n, 10, true);
+        str = fmtUnsigned(str, (uint32_t)n, 10, true);
         break;
 
       case 'x':
       case 'X':
         n = isLong ? va_arg(ap, long) : va_arg(ap, int);
-        str = fmtUnsigned(str, n, 16, c == 'X');
+        str = fmtUnsigned(str, (uint32_t)n, 16, c == 'X');
         break;
 
       default:
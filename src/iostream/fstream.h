@@ -37,12 +37,72 @@
  */
 template<class BaseFile>
 class BaseStream : protected BaseFile, virtual public ios {
+ public:
+  BaseStream() {
+#if FS_STREAM_BUF_SIZE
+    m_buf = m_internalBuf;
+#else  // FS_STREAM_BUF_SIZE
+    m_buf = nullptr;
+#endif  // FS_STREAM_BUF_SIZE
+    m_bufSize = FS_STREAM_BUF_SIZE;
+    m_next = 0;
+    m_end = 0;
+    m_bufWrite = false;
+    m_writeError = false;
+  }
+#if DESTRUCTOR_CLOSES_FILE
+  ~BaseStream() {
+    flushBuf();
+  }
+#endif  // DESTRUCTOR_CLOSES_FILE
+
  protected:
   /// @cond SHOW_PROTECTED
   //---------------------------------------------------------------------------
-  int16_t getch() {
+  void close() {
+    flushBuf();
+    BaseFile::close();
+  }
+  //---------------------------------------------------------------------------
+  // Write buffered data or move the file back to the next unread byte.
+  bool flushBuf() {
+    bool rtn = true;
+    if (m_bufWrite) {
+      if (m_end && write(m_buf, m_end) != static_cast<int>(m_end)) {
+        rtn = false;
+      }
+    } else if (m_next < m_end) {
+      rtn = BaseFile::seekCur(-static_cast<int32_t>(m_end - m_next));
+    }
+    m_next = 0;
+    m_end = 0;
+    m_bufWrite = false;
+    return rtn;
+  }
+  //---------------------------------------------------------------------------
+  int16_t getByte() {
     uint8_t c;
-    int8_t s = BaseFile::read(&c, 1);
+    int s;
+    // The buffer holds unread file data only if it is not a write buffer.
+    if (m_next < m_end && !m_bufWrite) {
+      return m_buf[m_next++];
+    }
+    if (!m_buf) {
+      s = BaseFile::read(&c, 1);
+    } else {
+      if (m_bufWrite && !flushBuf()) {
+        setstate(badbit);
+        return -1;
+      }
+      m_next = 0;
+      m_end = 0;
+      s = BaseFile::read(m_buf, m_bufSize);
+      if (s > 0) {
+        m_end = s;
+        c = m_buf[m_next++];
+        s = 1;
+      }
+    }
     if (s != 1) {
       if (s < 0) {
         setstate(badbit);
@@ -51,10 +111,32 @@ class BaseStream : protected BaseFile, virtual public ios {
       }
       return -1;
     }
-    if (c != '\r' || (getmode() & ios::binary)) {
-      return c;
+    return c;
+  }
+  //---------------------------------------------------------------------------
+  int16_t getch() {
+    uint8_t c;
+    int16_t b = getByte();
+    if (b != '\r' || (getmode() & ios::binary)) {
+      return b;
+    }
+    if (m_buf && !m_bufWrite) {
+      if (m_next == m_end) {
+        // Refill without losing the '\r' if at EOF.
+        int s = BaseFile::read(m_buf, m_bufSize);
+        if (s <= 0) {
+          return '\r';
+        }
+        m_next = 0;
+        m_end = s;
+      }
+      if (m_buf[m_next] == '\n') {
+        m_next++;
+        return '\n';
+      }
+      return '\r';
     }
-    s = BaseFile::read(&c, 1);
+    int8_t s = BaseFile::read(&c, 1);
     if (s == 1 && c == '\n') {
       return c;
     }
@@ -70,8 +152,21 @@ class BaseStream : protected BaseFile, virtual public ios {
     m_writeError = false;
   }
   //---------------------------------------------------------------------------
+  void getpos(pos_t* pos) {
+    if (m_buf) {
+      pos->position = tellpos();
+      pos->cluster = 0;
+    } else {
+      BaseFile::fgetpos(pos);
+    }
+  }
+  //---------------------------------------------------------------------------
   void open(const char* path, ios::openmode mode) {
     uint8_t flags;  //////////////////////////////////////////  fix flags  /////////////////////////////////
+    m_next = 0;
+    m_end = 0;
+    m_bufWrite = false;
+    m_writeError = false;
     switch (mode & (app | in | out | trunc)) {
     case app | in:
     case app | in | out:
@@ -142,7 +237,7 @@ class BaseStream : protected BaseFile, virtual public ios {
       char c = str[n];
       if (c == '\0' || (c == '\n' && !(getmode() & ios::binary))) {
         if (n > 0) {
-          write(str, n);
+          putbuf(str, n);
         }
         if (c == '\0') {
           break;
@@ -164,6 +259,9 @@ class BaseStream : protected BaseFile, virtual public ios {
    */
   bool seekoff(off_type off, seekdir way) {
     pos_type pos;
+    if (!flushBuf()) {
+      return false;
+    }
     switch (way) {
     case beg:
       pos = off;
@@ -187,7 +285,18 @@ class BaseStream : protected BaseFile, virtual public ios {
    * \param[in] pos
    */
   bool seekpos(pos_type pos) {
-    return BaseFile::seekSet(pos);
+    return flushBuf() && BaseFile::seekSet(pos);
+  }
+  //---------------------------------------------------------------------------
+  /** Internal do not use
+   * \param[in] buf
+   * \param[in] size
+   */
+  bool setbuf(char* buf, size_t size) {
+    bool rtn = flushBuf();
+    m_buf = size ? reinterpret_cast<uint8_t*>(buf) : nullptr;
+    m_bufSize = m_buf ? size : 0;
+    return rtn;
   }
   //---------------------------------------------------------------------------
   /** Internal do not use
@@ -197,6 +306,35 @@ class BaseStream : protected BaseFile, virtual public ios {
     m_mode = mode;
   }
   //---------------------------------------------------------------------------
+  void setpos(pos_t* pos) {
+    if (!m_buf) {
+      BaseFile::fsetpos(pos);
+      return;
+    }
+    // Stay in the read buffer if the position is buffered.
+    if (!m_bufWrite) {
+      uint64_t start = BaseFile::curPosition() - m_end;
+      if (start <= pos->position && pos->position <= start + m_end) {
+        m_next = pos->position - start;
+        return;
+      }
+    }
+    if (flushBuf()) {
+      BaseFile::seekSet(pos->position);
+    }
+  }
+  //---------------------------------------------------------------------------
+  bool sync() {
+    return flushBuf() && BaseFile::sync();
+  }
+  //---------------------------------------------------------------------------
+  pos_type tellpos() {
+    if (m_bufWrite) {
+      return BaseFile::curPosition() + m_end;
+    }
+    return BaseFile::curPosition() - (m_end - m_next);
+  }
+  //---------------------------------------------------------------------------
   int write(const void* buf, size_t n) {
     int rtn = BaseFile::write(buf, n);
     if (static_cast<int>(n) != rtn) {
@@ -205,14 +343,53 @@ class BaseStream : protected BaseFile, virtual public ios {
     return rtn;
   }
   //---------------------------------------------------------------------------
+  // Copy characters to the buffer.  Large blocks bypass the buffer.
+  void putbuf(const char* str, size_t n) {
+    if (!m_buf) {
+      write(str, n);
+      return;
+    }
+    if (!m_bufWrite) {
+      if (!flushBuf()) {
+        m_writeError = true;
+        return;
+      }
+      m_bufWrite = true;
+    }
+    if ((m_end + n) > m_bufSize) {
+      if (!flushBuf()) {
+        return;
+      }
+      m_bufWrite = true;
+      if (n >= m_bufSize) {
+        write(str, n);
+        return;
+      }
+    }
+    memcpy(m_buf + m_end, str, n);
+    m_end += n;
+  }
+  //---------------------------------------------------------------------------
   void write(char c) {
-    BaseFile::write(&c, 1);
+    if (m_buf && m_bufWrite && m_end < m_bufSize) {
+      m_buf[m_end++] = c;
+    } else {
+      putbuf(&c, 1);
+    }
   }
   /// @endcond
 
  private:
   bool m_writeError;
+  bool m_bufWrite;
   ios::openmode m_mode;
+  uint8_t* m_buf;
+  size_t m_bufSize;
+  size_t m_next;
+  size_t m_end;
+#if FS_STREAM_BUF_SIZE
+  uint8_t m_internalBuf[FS_STREAM_BUF_SIZE];
+#endif  // FS_STREAM_BUF_SIZE
 };
 //=============================================================================
 /**
@@ -268,6 +445,18 @@ class fstreamBase : public iostream, BaseStream<BaseFile>  {
   bool is_open() {
     return BaseFile::isOpen();
   }
+  /** Set the buffer for reads and writes.  Any buffered data is
+   * written or discarded first.
+   *
+   * \param[in] buf The buffer, nullptr for unbuffered I/O.
+   * \param[in] size The size of the buffer in bytes.
+   *
+   * \return true for success or false if buffered data could not be
+   * written.
+   */
+  bool setbuf(char* buf, size_t size) {
+    return BaseStream<BaseFile>::setbuf(buf, size);
+  }
 
  protected:
   /// @cond SHOW_PROTECTED
@@ -281,7 +470,7 @@ class fstreamBase : public iostream, BaseStream<BaseFile>  {
   * \param[out] pos
   */
   void getpos(pos_t* pos) {
-    BaseFile::fgetpos(pos);
+    BaseStream<BaseFile>::getpos(pos);
   }
   /** Internal - do not use
    * \param[in] c
@@ -305,13 +494,13 @@ class fstreamBase : public iostream, BaseStream<BaseFile>  {
     return BaseStream<BaseFile>::seekpos(pos);
   }
   void setpos(pos_t* pos) {
-    BaseFile::fsetpos(pos);
+    BaseStream<BaseFile>::setpos(pos);
   }
   bool sync() {
     return BaseStream<BaseFile>::sync();
   }
   pos_type tellpos() {
-    return BaseFile::curPosition();
+    return BaseStream<BaseFile>::tellpos();
   }
   /// @endcond
 };
@@ -338,6 +527,18 @@ class ifstreamBase : public istream, BaseStream<BaseFile>  {
   bool is_open() {
     return BaseFile::isOpen();
   }
+  /** Set the buffer for reads and writes.  Any buffered data is
+   * written or discarded first.
+   *
+   * \param[in] buf The buffer, nullptr for unbuffered I/O.
+   * \param[in] size The size of the buffer in bytes.
+   *
+   * \return true for success or false if buffered data could not be
+   * written.
+   */
+  bool setbuf(char* buf, size_t size) {
+    return BaseStream<BaseFile>::setbuf(buf, size);
+  }
   /** Open an ifstream
    * \param[in] path file to open
    * \param[in] mode open mode
@@ -360,7 +561,7 @@ class ifstreamBase : public istream, BaseStream<BaseFile>  {
    * \param[out] pos
    */
   void getpos(pos_t* pos) {
-    BaseFile::fgetpos(pos);
+    BaseStream<BaseFile>::getpos(pos);
   }
   /** Internal - do not use
    * \param[in] pos
@@ -372,10 +573,10 @@ class ifstreamBase : public istream, BaseStream<BaseFile>  {
     return BaseStream<BaseFile>::seekpos(pos);
   }
   void setpos(pos_t* pos) {
-    BaseFile::fsetpos(pos);
+    BaseStream<BaseFile>::setpos(pos);
   }
   pos_type tellpos() {
-    return BaseFile::curPosition();
+    return BaseStream<BaseFile>::tellpos();
   }
   /// @endcond
 };
@@ -417,6 +618,18 @@ class ofstreamBase : public ostream, BaseStream<BaseFile>  {
   bool is_open() {
     return BaseFile::isOpen();
   }
+  /** Set the buffer for reads and writes.  Any buffered data is
+   * written or discarded first.
+   *
+   * \param[in] buf The buffer, nullptr for unbuffered I/O.
+   * \param[in] size The size of the buffer in bytes.
+   *
+   * \return true for success or false if buffered data could not be
+   * written.
+   */
+  bool setbuf(char* buf, size_t size) {
+    return BaseStream<BaseFile>::setbuf(buf, size);
+  }
 
  protected:
   /// @cond SHOW_PROTECTED
@@ -444,7 +657,7 @@ class ofstreamBase : public ostream, BaseStream<BaseFile>  {
     return BaseStream<BaseFile>::sync();
   }
   pos_type tellpos() {
-    return BaseFile::curPosition();
+    return BaseStream<BaseFile>::tellpos();
   }
   /// @endcond
 };
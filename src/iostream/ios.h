@@ -84,8 +84,10 @@ class ios_base {
   static const fmtflags hex        = 0x0010;
   /** base 8 flag */
   static const fmtflags oct        = 0x0020;
-  // static const fmtflags fixed      = 0x0040;
-  // static const fmtflags scientific = 0x0080;
+  /** use fixed format for floating numbers */
+  static const fmtflags fixed      = 0x0040;
+  /** use exponent format for floating numbers */
+  static const fmtflags scientific = 0x0080;
   /** use strings true/false for bool */
   static const fmtflags boolalpha  = 0x0100;
   /** use prefix 0X for hex and 0 for oct */
@@ -103,7 +105,10 @@ class ios_base {
   static const fmtflags adjustfield = left | right | internal;
   /** mask for basefield */
   static const fmtflags basefield   = dec | hex | oct;
-  // static const fmtflags floatfield  = scientific | fixed;
+  /** mask for floatfield.  If neither flag is set, floating numbers are
+   * printed in the shortest form that reads back as the same value.
+   */
+  static const fmtflags floatfield  = scientific | fixed;
   //----------------------------------------------------------------------------
   /** typedef for iostream open mode */
   typedef uint8_t openmode;
@@ -122,7 +127,7 @@ class ios_base {
   /** truncate an existing stream when opening */
   static const openmode trunc  = 0X80;
   //----------------------------------------------------------------------------
-  ios_base() : m_fill(' '), m_fmtflags(dec | right | skipws)
+  ios_base() : m_fill(' '), m_fmtflags(dec | fixed | right | skipws)
     , m_precision(2), m_width(0) {}
   /** \return fill character */
   char fill() {
@@ -226,6 +231,14 @@ inline ios_base& boolalpha(ios_base& str) {
   str.setf(ios_base::boolalpha);
   return str;
 }
+/** function for defaultfloat manipulator
+ * \param[in] str The stream
+ * \return The stream
+ */
+inline ios_base& defaultfloat(ios_base& str) {
+  str.unsetf(ios_base::floatfield);
+  return str;
+}
 /** function for dec manipulator
  * \param[in] str The stream
  * \return The stream
@@ -234,6 +247,14 @@ inline ios_base& dec(ios_base& str) {
   str.setf(ios_base::dec, ios_base::basefield);
   return str;
 }
+/** function for fixed manipulator
+ * \param[in] str The stream
+ * \return The stream
+ */
+inline ios_base& fixed(ios_base& str) {
+  str.setf(ios_base::fixed, ios_base::floatfield);
+  return str;
+}
 /** function for hex manipulator
  * \param[in] str The stream
  * \return The stream
@@ -322,6 +343,14 @@ inline ios_base& right(ios_base& str) {
   str.setf(ios_base::right, ios_base::adjustfield);
   return str;
 }
+/** function for scientific manipulator
+ * \param[in] str The stream
+ * \return The stream
+ */
+inline ios_base& scientific(ios_base& str) {
+  str.setf(ios_base::scientific, ios_base::floatfield);
+  return str;
+}
 /** function for showbase manipulator
  * \param[in] str The stream
  * \return The stream
@@ -22,9 +22,14 @@
  * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
  * DEALINGS IN THE SOFTWARE.
  */
-#include <float.h>
 #include <ctype.h>
 #include "istream.h"
+/** Significant digits kept by getFloatStr(). */
+uint8_t const FLOAT_DIGITS_MAX = 40;
+/** Size of the getFloatStr() buffer, sign, digits and exponent. */
+uint8_t const FLOAT_STR_SIZE = FLOAT_DIGITS_MAX + 15;
+/** Exponent digits after this value are ignored. */
+int16_t const EXP_LIMIT = 1000;
 //------------------------------------------------------------------------------
 int istream::get() {
   int c;
@@ -122,98 +127,99 @@ void istream::getChar(char* ch) {
   }
 }
 //------------------------------------------------------------------------------
-//
-// http://www.exploringbinary.com/category/numbers-in-computers/
-//
-int16_t const EXP_LIMIT = 100;
-static const uint32_t uint32_max = (uint32_t)-1;
 bool istream::getDouble(double* value) {
+  char str[FLOAT_STR_SIZE];
+  if (!getFloatStr(str)) {
+    return false;
+  }
+  double v = scanDouble(str, nullptr);
+  if (isinf(v)) {
+    setstate(failbit);
+    return false;
+  }
+  *value = v;
+  return true;
+}
+//------------------------------------------------------------------------------
+bool istream::getFloat(float* value) {
+  char str[FLOAT_STR_SIZE];
+  if (!getFloatStr(str)) {
+    return false;
+  }
+  float v = scanFloat(str, nullptr);
+  if (isinf(v)) {
+    setstate(failbit);
+    return false;
+  }
+  *value = v;
+  return true;
+}
+//------------------------------------------------------------------------------
+// Read a number as significant digits and an exponent for scanDouble().
+// Digits after the first FLOAT_DIGITS_MAX are ignored.
+bool istream::getFloatStr(char* str) {
   bool got_digit = false;
   bool got_dot = false;
-  bool neg;
   int16_t c;
-  bool expNeg = false;
-  int16_t exp = 0;
-  int16_t fracExp = 0;
-  uint32_t frac = 0;
+  char buf[12];
+  char* end = buf + sizeof(buf);
+  int32_t exp = 0;
+  uint8_t nd = 0;
   pos_t endPos;
-  double pow10;
-  double v;
 
   getpos(&endPos);
   c = readSkip();
-  neg = c == '-';
   if (c == '-' || c == '+') {
+    *str++ = c;
     c = getch();
   }
   while (1) {
     if (isdigit(c)) {
       got_digit = true;
-      if (frac < uint32_max/10) {
-        frac = frac * 10 + (c  - '0');
-        if (got_dot) {
-          fracExp--;
-        }
+      if (nd < FLOAT_DIGITS_MAX && (nd || c != '0')) {
+        str[nd++] = c;
+        exp -= got_dot;
+      } else if (nd) {
+        exp += !got_dot;
       } else {
-        if (!got_dot) {
-          fracExp++;
-        }
+        // leading zero
+        exp -= got_dot;
       }
     } else if (!got_dot && c == '.') {
       got_dot = true;
     } else {
       break;
     }
-    if (fracExp < -EXP_LIMIT || fracExp > EXP_LIMIT) {
-      goto fail;
-    }
     c = getch(&endPos);
   }
   if (!got_digit) {
     goto fail;
   }
+  if (!nd) {
+    str[nd++] = '0';
+  }
+  str += nd;
   if (c == 'e' || c == 'E') {
+    int16_t n = 0;
     c = getch();
-    expNeg = c == '-';
+    bool expNeg = c == '-';
     if (c == '-' || c == '+') {
       c = getch();
     }
     while (isdigit(c)) {
-      if (exp > EXP_LIMIT) {
-        goto fail;
+      if (n < EXP_LIMIT) {
+        n = n * 10 + (c - '0');
       }
-      exp = exp * 10 + (c - '0');
       c = getch(&endPos);
     }
-  }
-  v = static_cast<double>(frac);
-  exp = expNeg ? fracExp - exp : fracExp + exp;
-  expNeg = exp < 0;
-  if (expNeg) {
-    exp = -exp;
-  }
-  pow10 = 10.0;
-  while (exp) {
-    if (exp & 1) {
-      if (expNeg) {
-        // check for underflow
-        if (v < FLT_MIN * pow10  && frac != 0) {
-          goto fail;
-        }
-        v /= pow10;
-      } else {
-        // check for overflow
-        if (v > FLT_MAX / pow10) {
-          goto fail;
-        }
-        v *= pow10;
-      }
-    }
-    pow10 *= pow10;
-    exp >>= 1;
+    exp += expNeg ? -n : n;
   }
   setpos(&endPos);
-  *value = neg ? -v : v;
+  *str++ = 'e';
+  for (char* ptr = fmtSigned(end, exp, 10, false); ptr < end; ptr++) {
+    *str++ = *ptr;
+  }
+  *str = '\0';
   return true;
 
 fail:
@@ -254,13 +260,14 @@ istream& istream::getline(char *str, streamsize n, char delim) {
   return *this;
 }
 //------------------------------------------------------------------------------
-bool istream::getNumber(uint32_t posMax, uint32_t negMax, uint32_t* num) {
+bool istream::getNumber(unsigned long posMax,  // NOLINT
+                        unsigned long negMax, unsigned long* num) {  // NOLINT
   int16_t c;
   int8_t any = 0;
   int8_t have_zero = 0;
   uint8_t neg;
-  uint32_t val = 0;
-  uint32_t cutoff;
+  unsigned long val = 0;  // NOLINT
+  unsigned long cutoff;  // NOLINT
   uint8_t cutlim;
   pos_t endPos;
   uint8_t f = flags() & basefield;
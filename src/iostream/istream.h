@@ -192,9 +192,7 @@ class istream : public virtual ios {
    * \return Is always *this.  Failure is indicated by the state of *this.
    */
   istream &operator>> (float& arg) {
-    double v;
-    getDouble(&v);
-    arg = v;
+    getFloat(&arg);
     return *this;
   }
   /**
@@ -203,7 +201,7 @@ class istream : public virtual ios {
    * \return Is always *this.  Failure is indicated by the state of *this.
    */
   istream& operator>> (void*& arg) {
-    uint32_t val;
+    unsigned long val;  // NOLINT
     getNumber(&val);
     arg = reinterpret_cast<void*>(val);
     return *this;
@@ -355,27 +353,32 @@ class istream : public virtual ios {
   void getBool(bool *b);
   void getChar(char* ch);
   bool getDouble(double* value);
+  bool getFloat(float* value);
+  bool getFloatStr(char* str);
   template <typename T>  void getNumber(T* value);
-  bool getNumber(uint32_t posMax, uint32_t negMax, uint32_t* num);
+  bool getNumber(unsigned long posMax,  // NOLINT
+                 unsigned long negMax, unsigned long* num);  // NOLINT
   void getStr(char *str);
   int16_t readSkip();
 
   size_t m_gcount;
 };
 //------------------------------------------------------------------------------
+// Numbers are converted as unsigned long, the widest type extracted.
 template <typename T>
 void istream::getNumber(T* value) {
-  uint32_t tmp;
+  typedef unsigned long num_t;  // NOLINT
+  num_t tmp;
   if ((T)-1 < 0) {
     // number is signed, max positive value
-    uint32_t const m = ((uint32_t)-1) >> (33 - sizeof(T) * 8);
+    num_t const m = ((num_t)-1) >> (8*(sizeof(num_t) - sizeof(T)) + 1);
     // max absolute value of negative number is m + 1.
     if (getNumber(m, m + 1, &tmp)) {
       *value = (T)tmp;
     }
   } else {
     // max unsigned value for T
-    uint32_t const m = (T)-1;
+    num_t const m = (T)-1;
     if (getNumber(m, m, &tmp)) {
       *value = (T)tmp;
     }
@@ -24,6 +24,7 @@
  */
 #include <string.h>
 #include "ostream.h"
+#include "../common/FmtNumber.h"
 #ifndef PSTR
 #define PSTR(x) x
 #endif
@@ -42,14 +43,7 @@ void ostream::fill_not_left(unsigned len) {
 }
 //------------------------------------------------------------------------------
 char* ostream::fmtNum(uint32_t n, char *ptr, uint8_t base) {
-  char a = flags() & uppercase ? 'A' - 10 : 'a' - 10;
-  do {
-    uint32_t m = n;
-    n /= base;
-    char c = m - base * n;
-    *--ptr = c < 10 ? c + '0' : c + a;
-  } while (n);
-  return ptr;
+  return fmtUnsigned(ptr, n, base, flags() & uppercase);
 }
 //------------------------------------------------------------------------------
 void ostream::putBool(bool b) {
@@ -71,69 +65,36 @@ void ostream::putChar(char c) {
 }
 //------------------------------------------------------------------------------
 void ostream::putDouble(double n) {
-  uint8_t nd = precision();
-  double round = 0.5;
-  char sign;
-  char buf[13];  // room for sign, 10 digits, '.', and zero byte
-  char *ptr = buf + sizeof(buf) - 1;
-  char *str = ptr;
-  // terminate string
-  *ptr = '\0';
-
-  // get sign and make nonnegative
-  if (n < 0.0) {
-    sign = '-';
+  char buf[FMT_DOUBLE_SIZE];
+  char* ptr = buf + sizeof(buf) - 1;
+  char* str;
+  bool neg = n < 0;
+  if (neg) {
     n = -n;
-  } else {
-    sign = flags() & showpos ? '+' : '\0';
-  }
-  // check for larger than uint32_t
-  if (n > 4.0E9) {
-    putPgm(PSTR("BIG FLT"));
-    return;
-  }
-  // round up and separate int and fraction parts
-  for (uint8_t i = 0; i < nd; ++i) {
-    round *= 0.1;
-  }
-  n += round;
-  uint32_t intPart = n;
-  double fractionPart = n - intPart;
-
-  // format intPart and decimal point
-  if (nd || (flags() & showpoint)) {
-    *--str = '.';
   }
-  str = fmtNum(intPart, str, 10);
-
-  // calculate length for fill
-  uint8_t len = sign ? 1 : 0;
-  len += nd + ptr - str;
-
-  // extract adjust field
-  fmtflags adj = flags() & adjustfield;
-  if (adj == internal) {
-    if (sign) {
-      putch(sign);
-    }
-    do_fill(len);
+  *ptr = '\0';
+  fmtflags ff = flags() & floatfield;
+  if (ff == fixed) {
+    str = fmtDouble(ptr, n, precision(), flags() & showpoint);
+  } else if (ff == scientific) {
+    str = fmtDouble(ptr, n, precision(), flags() & showpoint,
+                    flags() & uppercase ? 'E' : 'e');
   } else {
-    // do fill for internal or right
-    fill_not_left(len);
-    if (sign) {
-      *--str = sign;
-    }
+    str = fmtShortest(ptr, n, flags() & uppercase);
   }
-  putstr(str);
-  // output fraction
-  while (nd-- > 0) {
-    fractionPart *= 10.0;
-    int digit = static_cast<int>(fractionPart);
-    putch(digit + '0');
-    fractionPart -= digit;
+  putNum(str, ptr, 10, neg);
+}
+//------------------------------------------------------------------------------
+void ostream::putFloat(float n) {
+  if (flags() & floatfield) {
+    putDouble(n);
+    return;
   }
-  // do fill if not done above
-  do_fill(len);
+  char buf[FMT_DOUBLE_SIZE];
+  char* ptr = buf + sizeof(buf) - 1;
+  bool neg = n < 0;
+  *ptr = '\0';
+  putNum(fmtShortest(ptr, neg ? -n : n, flags() & uppercase), ptr, 10, neg);
 }
 //------------------------------------------------------------------------------
 void ostream::putNum(int32_t n) {
@@ -141,17 +102,33 @@ void ostream::putNum(int32_t n) {
   if (neg) {
     n = -n;
   }
-  putNum(n, neg);
+  putNum((uint32_t)n, neg);
 }
 //------------------------------------------------------------------------------
 void ostream::putNum(uint32_t n, bool neg) {
   char buf[13];
   char* ptr = buf + sizeof(buf) - 1;
-  char* num;
-  char* str;
+  *ptr = '\0';
   uint8_t base = flagsToBase();
+  putNum(fmtNum(n, ptr, base), ptr, base, neg);
+}
+//------------------------------------------------------------------------------
+void ostream::putNum(int64_t n) {
+  bool neg = n < 0 && flagsToBase() == 10;
+  putNum(neg ? 0 - (uint64_t)n : (uint64_t)n, neg);
+}
+//------------------------------------------------------------------------------
+void ostream::putNum(uint64_t n, bool neg) {
+  char buf[25];
+  char* ptr = buf + sizeof(buf) - 1;
   *ptr = '\0';
-  str = num = fmtNum(n, ptr, base);
+  uint8_t base = flagsToBase();
+  putNum(fmtUnsigned(ptr, n, base, flags() & uppercase), ptr, base, neg);
+}
+//------------------------------------------------------------------------------
+// Add sign or base prefix and fill to the number in [num, ptr).
+void ostream::putNum(char* num, char* ptr, uint8_t base, bool neg) {
+  char* str = num;
   if (base == 10) {
     if (neg) {
       *--str = '-';
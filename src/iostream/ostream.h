@@ -122,7 +122,7 @@ class ostream : public virtual ios {
    * \return the stream
    */
   ostream &operator<< (float arg) {
-    putDouble(arg);
+    putFloat(arg);
     return *this;
   }
   /** Output signed short
@@ -162,7 +162,11 @@ class ostream : public virtual ios {
    * \return the stream
    */
   ostream &operator<< (long arg) {  // NOLINT
-    putNum((int32_t)arg);
+    if (sizeof(arg) > 4) {
+      putNum((int64_t)arg);
+    } else {
+      putNum((int32_t)arg);
+    }
     return *this;
   }
   /** Output unsigned long
@@ -170,7 +174,27 @@ class ostream : public virtual ios {
    * \return the stream
    */
   ostream &operator<< (unsigned long arg) {  // NOLINT
-    putNum((uint32_t)arg);
+    if (sizeof(arg) > 4) {
+      putNum((uint64_t)arg);
+    } else {
+      putNum((uint32_t)arg);
+    }
+    return *this;
+  }
+  /** Output signed long long
+   * \param[in] arg value to output
+   * \return the stream
+   */
+  ostream &operator<< (long long arg) {  // NOLINT
+    putNum((int64_t)arg);
+    return *this;
+  }
+  /** Output unsigned long long
+   * \param[in] arg value to output
+   * \return the stream
+   */
+  ostream &operator<< (unsigned long long arg) {  // NOLINT
+    putNum((uint64_t)arg);
     return *this;
   }
   /** Output pointer
@@ -178,7 +202,11 @@ class ostream : public virtual ios {
    * \return the stream
    */
   ostream& operator<< (const void* arg) {
-    putNum(reinterpret_cast<uint32_t>(arg));
+    if (sizeof(arg) > 4) {
+      putNum(static_cast<uint64_t>(reinterpret_cast<uintptr_t>(arg)));
+    } else {
+      putNum(static_cast<uint32_t>(reinterpret_cast<uintptr_t>(arg)));
+    }
     return *this;
   }
 #if (defined(ARDUINO) && ENABLE_ARDUINO_FEATURES) || defined(DOXYGEN)
@@ -268,8 +296,12 @@ class ostream : public virtual ios {
   void putBool(bool b);
   void putChar(char c);
   void putDouble(double n);
+  void putFloat(float n);
   void putNum(uint32_t n, bool neg = false);
   void putNum(int32_t n);
+  void putNum(uint64_t n, bool neg = false);
+  void putNum(int64_t n);
+  void putNum(char* num, char* ptr, uint8_t base, bool neg);
   void putPgm(const char* str);
   void putStr(const char* str);
 };